@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+#include "rvlm/core/Algorithms3d.hh"
+
+using rvlm::core::Execution;
+using rvlm::core::SolidArray3d;
+namespace algo = rvlm::core;
+
+namespace {
+
+typedef SolidArray3d<float> Array;
+
+// Scaled sum of two arrays, the axpy of field updates, over a 128^3 grid.
+
+void BM_ZipAxpy(benchmark::State& state) {
+    const std::size_t n = 128;
+    Array x(n, n, n, 1.0f), y(n, n, n, 2.0f);
+    const float a = 0.5f;
+    for (auto _ : state) {
+        algo::zip(y.getBox(), [a](float& yv, float xv) { yv += a*xv; }, y, x);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n * n * n);
+}
+
+void BM_ZipAxpyParallel(benchmark::State& state) {
+    const std::size_t n = 128;
+    Array x(n, n, n, 1.0f), y(n, n, n, 2.0f);
+    const float a = 0.5f;
+    for (auto _ : state) {
+        algo::zip(Execution::Parallel, y.getBox(),
+                  [a](float& yv, float xv) { yv += a*xv; }, y, x);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n * n * n);
+}
+
+void BM_RawAxpy(benchmark::State& state) {
+    const std::size_t n = 128;
+    Array x(n, n, n, 1.0f), y(n, n, n, 2.0f);
+    const float a = 0.5f;
+    for (auto _ : state) {
+        float* py = y.getOrigin();
+        float const* px = x.getOrigin();
+        for (std::size_t i = 0; i < n*n*n; ++i)
+            py[i] += a*px[i];
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n * n * n);
+}
+
+void BM_AtAxpy(benchmark::State& state) {
+    const std::size_t n = 128;
+    Array x(n, n, n, 1.0f), y(n, n, n, 2.0f);
+    const float a = 0.5f;
+    for (auto _ : state) {
+        for (std::size_t ix = 0; ix < n; ++ix)
+        for (std::size_t iy = 0; iy < n; ++iy)
+        for (std::size_t iz = 0; iz < n; ++iz)
+            y.at(ix, iy, iz) += a*x.at(ix, iy, iz);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n * n * n);
+}
+
+} // namespace
+
+BENCHMARK(BM_ZipAxpy)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ZipAxpyParallel)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_RawAxpy)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AtAxpy)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <vector>
+#include "rvlm/core/SolidArray3d.hh"
+#include "rvlm/core/memory/OperatorNewAllocator.hh"
+
+using rvlm::core::SolidArray3d;
+using rvlm::core::memory::Allocator;
+using rvlm::core::memory::OperatorNewAllocator;
+
+namespace {
+
+// Allocation churn: a window of 64 live blocks where every step frees the
+// oldest block and allocates a new one, with sizes cycling through a fixed
+// pseudo-random sequence. The argument is the largest block size in bytes,
+// from small objects to blocks served by mmap.
+
+const std::size_t LIVE = 64, SIZES = 256;
+
+std::vector<std::size_t> blockSizes(std::size_t largest) {
+    std::vector<std::size_t> sizes(SIZES);
+    std::size_t seed = 12345;
+    for (std::size_t i = 0; i < SIZES; ++i) {
+        seed = seed * 1103515245 + 12345;
+        sizes[i] = 16 + (seed >> 8) % largest;
+    }
+    return sizes;
+}
+
+template <typename TAlloc, typename TFree>
+void churn(benchmark::State& state, TAlloc alloc, TFree free) {
+    const std::vector<std::size_t> sizes = blockSizes(static_cast<std::size_t>(state.range(0)));
+    std::vector<void*> live(LIVE, static_cast<void*>(0));
+    std::size_t step = 0;
+    for (auto _ : state) {
+        void*& slot = live[step % LIVE];
+        if (slot)
+            free(slot);
+        slot = alloc(sizes[step % SIZES]);
+        static_cast<char*>(slot)[0] = 1;
+        ++step;
+    }
+    for (std::size_t i = 0; i < LIVE; ++i) {
+        if (live[i])
+            free(live[i]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ChurnMalloc(benchmark::State& state) {
+    churn(state, [](std::size_t size) { return std::malloc(size); },
+                 [](void* p) { std::free(p); });
+}
+
+void BM_ChurnOperatorNew(benchmark::State& state) {
+    churn(state, [](std::size_t size) { return ::operator new(size); },
+                 [](void* p) { ::operator delete(p); });
+}
+
+void BM_ChurnAllocatorInterface(benchmark::State& state) {
+    // Calls go through the virtual interface, as SolidArray3d makes them.
+    OperatorNewAllocator concrete;
+    Allocator* allocator = &concrete;
+    benchmark::DoNotOptimize(allocator);
+    churn(state, [allocator](std::size_t size) { return allocator->allocate(size); },
+                 [allocator](void* p) { allocator->deallocate(p); });
+}
+
+// Creating and destroying whole arrays of N^3 floats, as temporaries of
+// kernels do; the argument is N.
+
+void BM_ChurnSolidArray3d(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+        SolidArray3d<float> a(n, n, n, 0.0f);
+        benchmark::DoNotOptimize(a.getOrigin());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_ChurnMalloc)->Arg(256)->Arg(64 << 10)->Arg(4 << 20);
+BENCHMARK(BM_ChurnOperatorNew)->Arg(256)->Arg(64 << 10)->Arg(4 << 20);
+BENCHMARK(BM_ChurnAllocatorInterface)->Arg(256)->Arg(64 << 10)->Arg(4 << 20);
+BENCHMARK(BM_ChurnSolidArray3d)->Arg(8)->Arg(32)->Arg(128);
@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include "rvlm/core/CellList.hh"
+
+using rvlm::core::BitArray3d;
+using rvlm::core::CellList;
+using rvlm::core::SolidArray3d;
+namespace core = rvlm::core;
+
+namespace {
+
+// Update of two polarization terms of a dispersive material occupying the
+// given percentage of a 128^3 grid, scattered at random: with full-size
+// state arrays, visiting masked cells through runs of the mask, against
+// the same with state compacted in CellList. Counter MB is memory taken
+// by the state.
+
+typedef SolidArray3d<float> Array;
+typedef BitArray3d<> Mask;
+
+const std::size_t N = 128;
+
+void fillMask(Mask& mask, double fraction) {
+    std::mt19937 rng(3);
+    std::bernoulli_distribution pick(fraction);
+    for (std::size_t ix = 0; ix < N; ++ix)
+    for (std::size_t iy = 0; iy < N; ++iy)
+    for (std::size_t iz = 0; iz < N; ++iz)
+        mask.set(ix, iy, iz, pick(rng));
+}
+
+void BM_DispersiveFullArrays(benchmark::State& state) {
+    Mask mask(N, N, N, false);
+    fillMask(mask, state.range(0) * 0.01);
+    Array e(N, N, N, 1.0f), p0(N, N, N, 0.0f), p1(N, N, N, 0.0f);
+    float* pe = e.getOrigin();
+    float* pp0 = p0.getOrigin();
+    float* pp1 = p1.getOrigin();
+    for (auto _ : state) {
+        for (auto const& run: mask.runs()) {
+            const std::size_t row = e.getOffset(run.ix, run.iy, 0);
+            for (std::size_t k = row + run.startZ; k < row + run.stopZ; ++k) {
+                pp0[k] = 0.9f*pp0[k] + 0.1f*pe[k];
+                pp1[k] = 0.8f*pp1[k] + 0.2f*pe[k];
+                pe[k] -= pp0[k] + pp1[k];
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * mask.count());
+    state.counters["MB"] = 2.0 * N*N*N * sizeof(float) / (1 << 20);
+}
+
+void BM_DispersiveCellList(benchmark::State& state) {
+    Mask mask(N, N, N, false);
+    fillMask(mask, state.range(0) * 0.01);
+    Array e(N, N, N, 1.0f);
+    CellList<float, 2> cells(mask);
+    for (auto _ : state) {
+        core::updateCells(cells, [](float& ev, float& q0, float& q1) {
+            q0 = 0.9f*q0 + 0.1f*ev;
+            q1 = 0.8f*q1 + 0.2f*ev;
+            ev -= q0 + q1;
+        }, e);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * cells.size());
+    state.counters["MB"] = (2.0 * sizeof(float) + sizeof(std::size_t))
+                         * cells.size() / (1 << 20);
+}
+
+void BM_CellListBuild(benchmark::State& state) {
+    Mask mask(N, N, N, false);
+    fillMask(mask, state.range(0) * 0.01);
+    for (auto _ : state) {
+        CellList<float, 2> cells(mask);
+        benchmark::DoNotOptimize(cells.getOffsets());
+    }
+    state.SetItemsProcessed(state.iterations() * N*N*N);
+}
+
+} // namespace
+
+BENCHMARK(BM_DispersiveFullArrays)->Arg(2)->Arg(10)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DispersiveCellList)->Arg(2)->Arg(10)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CellListBuild)->Arg(2)->Arg(10)->Unit(benchmark::kMicrosecond);
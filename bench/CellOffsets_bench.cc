@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "rvlm/core/CellOffsets.hh"
+
+using rvlm::core::CellOffsets;
+using rvlm::core::SolidArray3d;
+namespace core = rvlm::core;
+
+namespace {
+
+// Sampling of a million random probe cells of a 128^3 grid.
+
+const std::size_t N = 128;
+const std::size_t PROBES = 1 << 20;
+
+template <typename T>
+struct Probes {
+    SolidArray3d<T> field;
+    std::vector<std::size_t> ix, iy, iz;
+    std::vector<T> out;
+
+    Probes(): field(N, N, N, T(1)), out(PROBES) {
+        std::mt19937 rng(3);
+        std::uniform_int_distribution<std::size_t> cell(0, N-1);
+        for (std::size_t i = 0; i < PROBES; ++i) {
+            ix.push_back(cell(rng));
+            iy.push_back(cell(rng));
+            iz.push_back(cell(rng));
+        }
+    }
+};
+
+template <typename T>
+void BM_GatherAt(benchmark::State& state) {
+    Probes<T> p;
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < PROBES; ++i)
+            p.out[i] = p.field.at(p.ix[i], p.iy[i], p.iz[i]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * PROBES);
+}
+
+template <typename T>
+void BM_GatherCoordinates(benchmark::State& state) {
+    Probes<T> p;
+    for (auto _ : state) {
+        core::gather(p.field, p.ix.data(), p.iy.data(), p.iz.data(),
+                     PROBES, p.out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * PROBES);
+}
+
+template <typename T>
+void BM_GatherOffsets(benchmark::State& state) {
+    Probes<T> p;
+    CellOffsets offsets(p.field, p.ix.data(), p.iy.data(), p.iz.data(), PROBES);
+    for (auto _ : state) {
+        core::gather(p.field, offsets, p.out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * PROBES);
+}
+
+template <typename T>
+void BM_ScatterAddOffsets(benchmark::State& state) {
+    Probes<T> p;
+    CellOffsets offsets(p.field, p.ix.data(), p.iy.data(), p.iz.data(), PROBES);
+    for (auto _ : state) {
+        core::scatterAdd(p.field, offsets, p.out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * PROBES);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_GatherAt, double);
+BENCHMARK_TEMPLATE(BM_GatherCoordinates, double);
+BENCHMARK_TEMPLATE(BM_GatherOffsets, double);
+BENCHMARK_TEMPLATE(BM_GatherOffsets, float);
+BENCHMARK_TEMPLATE(BM_ScatterAddOffsets, double);
@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+#include "rvlm/core/Checkpoint.hh"
+
+using rvlm::core::CheckpointWriter;
+using rvlm::core::DirtyBricks;
+using rvlm::core::IndexBox;
+using rvlm::core::SolidArray3d;
+
+namespace {
+
+// Checkpointing a 256^3 float array (64 MB) into memory, fully and as a
+// delta after a 32x256x32 region changed.
+
+const std::size_t N = 256;
+
+/**
+ * Stream buffer copying into a reusable block of memory, to measure
+ * checkpoint packing without file system costs.
+ */
+class MemoryBuffer: public std::streambuf {
+public:
+    MemoryBuffer(): mData(N*N*N*sizeof(float) + 4096), mSize(0) {}
+
+    void rewind() { mSize = 0; }
+
+protected:
+    std::streamsize xsputn(char const* s, std::streamsize n) override {
+        std::memcpy(&mData[mSize], s, static_cast<std::size_t>(n));
+        mSize += static_cast<std::size_t>(n);
+        return n;
+    }
+
+    int overflow(int c) override {
+        mData[mSize++] = static_cast<char>(c);
+        return c;
+    }
+
+private:
+    std::vector<char> mData;
+    std::size_t       mSize;
+};
+
+void BM_CheckpointBase(benchmark::State& state) {
+    SolidArray3d<float> field(N, N, N, 1.0f);
+    DirtyBricks dirty(field.getBox());
+    CheckpointWriter<float> writer(field, dirty);
+    MemoryBuffer buffer;
+    std::ostream out(&buffer);
+    for (auto _ : state) {
+        buffer.rewind();
+        writer.writeBase(out);
+    }
+    state.SetBytesProcessed(state.iterations() * N*N*N * sizeof(float));
+}
+
+void BM_CheckpointDelta(benchmark::State& state) {
+    SolidArray3d<float> field(N, N, N, 1.0f);
+    DirtyBricks dirty(field.getBox());
+    CheckpointWriter<float> writer(field, dirty);
+    MemoryBuffer buffer;
+    std::ostream out(&buffer);
+    writer.writeBase(out);
+    for (auto _ : state) {
+        buffer.rewind();
+        dirty.markDirty(IndexBox<>(100, 132, 0, N, 40, 72));
+        writer.writeDelta(out);
+    }
+    state.SetBytesProcessed(state.iterations() * N*N*N * sizeof(float));
+}
+
+} // namespace
+
+BENCHMARK(BM_CheckpointBase)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CheckpointDelta)->Unit(benchmark::kMillisecond);
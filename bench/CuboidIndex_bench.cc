@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "rvlm/core/CuboidIndex.hh"
+
+using rvlm::core::Cuboid;
+using rvlm::core::CuboidIndex;
+using rvlm::core::GridGeometry;
+using rvlm::core::IndexBox;
+using rvlm::core::Vector3d;
+
+namespace {
+
+// Scene of small cuboids scattered over the unit cube, plus a few large
+// ones (substrates, background) crossing many bins.
+std::vector<Cuboid<double>> makeScene(std::size_t count) {
+    std::mt19937 rng(2017);
+    std::uniform_real_distribution<double> pos(0.0, 1.0);
+    std::uniform_real_distribution<double> size(0.001, 0.05);
+    std::vector<Cuboid<double>> cuboids;
+    for (std::size_t i = 0; i < count; ++i) {
+        double x = pos(rng), y = pos(rng), z = pos(rng);
+        cuboids.push_back(Cuboid<double>(x, y, z,
+            x + size(rng), y + size(rng), z + size(rng)));
+    }
+    cuboids.push_back(Cuboid<double>(0, 0, 0, 1, 1, 0.1));
+    cuboids.push_back(Cuboid<double>(0, 0, 0, 1, 0.1, 1));
+    return cuboids;
+}
+
+void BM_CuboidIndexBuild(benchmark::State& state) {
+    auto cuboids = makeScene(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        CuboidIndex<double> index(cuboids);
+        benchmark::DoNotOptimize(index.getBinCount());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_CuboidIndexPoints(benchmark::State& state) {
+    auto cuboids = makeScene(static_cast<std::size_t>(state.range(0)));
+    CuboidIndex<double> index(cuboids);
+
+    const std::size_t count = 1 << 20;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> pos(0.0, 1.0);
+    std::vector<double> xs(count), ys(count), zs(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        xs[i] = pos(rng); ys[i] = pos(rng); zs[i] = pos(rng);
+    }
+
+    std::vector<std::size_t> offsets;
+    std::vector<CuboidIndex<double>::IdType> ids;
+    for (auto _ : state) {
+        index.findContaining(count, xs.data(), ys.data(), zs.data(),
+                             offsets, ids);
+        benchmark::DoNotOptimize(ids.data());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Baseline the index is supposed to beat: test every cuboid for each point.
+void BM_LinearScanPoints(benchmark::State& state) {
+    auto cuboids = makeScene(static_cast<std::size_t>(state.range(0)));
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> pos(0.0, 1.0);
+    std::size_t hits = 0;
+    for (auto _ : state) {
+        double x = pos(rng), y = pos(rng), z = pos(rng);
+        for (std::size_t i = 0; i < cuboids.size(); ++i)
+            hits += cuboids[i].contains(x, y, z);
+    }
+    benchmark::DoNotOptimize(hits);
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_CuboidIndexBoxes(benchmark::State& state) {
+    auto cuboids = makeScene(static_cast<std::size_t>(state.range(0)));
+    CuboidIndex<double> index(cuboids);
+    GridGeometry<double> grid(Vector3d<double>(0, 0, 0),
+                              Vector3d<double>(1e-3, 1e-3, 1e-3));
+
+    // 16^3 cell boxes on a 1000^3 grid, as used for tiled preprocessing.
+    std::vector<IndexBox<>> boxes;
+    for (std::ptrdiff_t x = 0; x < 1000; x += 64)
+    for (std::ptrdiff_t y = 0; y < 1000; y += 64)
+    for (std::ptrdiff_t z = 0; z < 1000; z += 64)
+        boxes.push_back(IndexBox<>(x, x+16, y, y+16, z, z+16));
+
+    std::vector<std::size_t> offsets;
+    std::vector<CuboidIndex<double>::BoxHit> hits;
+    for (auto _ : state) {
+        index.findOverlapping(grid, boxes, offsets, hits);
+        benchmark::DoNotOptimize(hits.data());
+    }
+    state.SetItemsProcessed(state.iterations() * boxes.size());
+}
+
+BENCHMARK(BM_CuboidIndexBuild)->Arg(1000)->Arg(10000)->Arg(100000)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_CuboidIndexPoints)->Arg(1000)->Arg(10000)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_LinearScanPoints)->Arg(1000)->Arg(10000);
+BENCHMARK(BM_CuboidIndexBoxes)->Arg(1000)->Arg(10000)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace
@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+#include "rvlm/core/Depositor.hh"
+
+using rvlm::core::Depositor;
+using rvlm::core::DepositionStrategy;
+using rvlm::core::SolidArray3d;
+
+namespace {
+
+// Cloud-in-cell deposition of particles onto a 128^3 grid, either spread
+// uniformly or crowded into a small fraction of the grid. Particles are
+// sorted by cell, as particle codes do periodically.
+
+const std::size_t N = 128;
+
+struct CloudInCell {
+    std::vector<double> const* w;
+
+    template <typename TSink>
+    void operator () (std::size_t i, TSink& sink) const {
+        double q = (*w)[i];
+        sink.add(0, 0, 0, q);  sink.add(0, 0, 1, q);
+        sink.add(0, 1, 0, q);  sink.add(0, 1, 1, q);
+        sink.add(1, 0, 0, q);  sink.add(1, 0, 1, q);
+        sink.add(1, 1, 0, q);  sink.add(1, 1, 1, q);
+    }
+};
+
+void BM_Deposit(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    const bool clustered = state.range(1) != 0;
+    const DepositionStrategy strategy = static_cast<DepositionStrategy>(state.range(2));
+
+    SolidArray3d<double> rho(N, N, N, 0.0);
+    std::vector<std::tuple<std::size_t, std::size_t, std::size_t>> cells;
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<std::size_t> cell(1, N - 2), near(1, N/8);
+    for (std::size_t i = 0; i < count; ++i) {
+        cells.push_back(std::make_tuple(clustered ? near(rng) : cell(rng),
+                                        clustered ? near(rng) : cell(rng),
+                                        cell(rng)));
+    }
+    std::sort(cells.begin(), cells.end());
+
+    std::vector<std::size_t> ix, iy, iz;
+    std::vector<double> w(count, 0.125);
+    for (std::size_t i = 0; i < count; ++i) {
+        ix.push_back(std::get<0>(cells[i]));
+        iy.push_back(std::get<1>(cells[i]));
+        iz.push_back(std::get<2>(cells[i]));
+    }
+
+    Depositor<double> depositor(rho, 1, 8);
+    CloudInCell cic = { &w };
+    for (auto _ : state) {
+        depositor.deposit(ix.data(), iy.data(), iz.data(), count, cic, strategy);
+        benchmark::ClobberMemory();
+    }
+    state.SetLabel(depositor.getLastStrategy() == DepositionStrategy::Atomic ? "atomic" :
+                   depositor.getLastStrategy() == DepositionStrategy::TileBuffers ? "buffers" :
+                   "colored");
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+void strategies(benchmark::internal::Benchmark* b) {
+    for (int clustered = 0; clustered < 2; ++clustered)
+        for (int strategy = 0; strategy < 4; ++strategy)
+            b->Args({1 << 21, clustered, strategy});
+}
+
+} // namespace
+
+BENCHMARK(BM_Deposit)->Apply(strategies);
@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+#include <complex>
+#include <vector>
+#include "rvlm/core/DftAccumulator.hh"
+
+using rvlm::core::DftAccumulator;
+using rvlm::core::IndexBox;
+using rvlm::core::SolidArray3d;
+
+namespace {
+
+// Accumulating a 128x128 face of a float field for a number of
+// frequencies, compared to the straightforward loop evaluating the complex
+// exponent for every cell and frequency.
+
+const std::size_t N = 128;
+
+std::vector<double> makeOmegas(std::size_t count) {
+    std::vector<double> omegas(count);
+    for (std::size_t f = 0; f < count; ++f)
+        omegas[f] = 0.01 * (f + 1);
+    return omegas;
+}
+
+void BM_DftAccumulator(benchmark::State& state) {
+    SolidArray3d<float> field(N, N, 16, 1.0f);
+    IndexBox<> face(0, N, 0, N, 8, 9);
+    DftAccumulator<float> dft(field, face,
+                              makeOmegas(static_cast<std::size_t>(state.range(0))), 0.5);
+    for (auto _ : state) {
+        dft.accumulate();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N*N * state.range(0));
+}
+
+void BM_DftNaive(benchmark::State& state) {
+    SolidArray3d<float> field(N, N, 16, 1.0f);
+    std::vector<double> omegas = makeOmegas(static_cast<std::size_t>(state.range(0)));
+    std::vector<std::complex<float>> result(N*N * omegas.size());
+    std::size_t step = 0;
+    for (auto _ : state) {
+        const double t = 0.5 * step++;
+        std::size_t i = 0;
+        for (std::size_t ix = 0; ix < N; ++ix)
+        for (std::size_t iy = 0; iy < N; ++iy)
+        for (std::size_t f = 0; f < omegas.size(); ++f)
+            result[i++] += field.at(ix, iy, 8) *
+                std::complex<float>(std::polar(1.0, -omegas[f] * t));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N*N * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_DftAccumulator)->Arg(1)->Arg(8)->Arg(32);
+BENCHMARK(BM_DftNaive)->Arg(1)->Arg(8)->Arg(32);
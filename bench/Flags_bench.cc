@@ -0,0 +1,134 @@
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include "rvlm/core/Flags.hh"
+
+using rvlm::core::Flags;
+
+namespace {
+
+// Set operations of Flags over a ring of 64 sets, for a 32-item enumeration
+// held in one word and a 200-item one held in four.
+
+enum class NarrowEnum { First = 0, Last = 31 };
+enum class WideEnum   { First = 0, Last = 199 };
+
+} // namespace
+
+namespace rvlm {
+namespace core {
+template <>
+struct FlagsWidth<WideEnum> {
+    static const std::size_t value = 200;
+};
+} // namespace core
+} // namespace rvlm
+
+namespace {
+
+const std::size_t RING = 64;
+
+template <typename TEnum>
+struct Ring {
+    Flags<TEnum> sets[RING];
+
+    Ring() {
+        const std::size_t bits = Flags<TEnum>::BIT_COUNT;
+        for (std::size_t i = 0; i < RING; ++i) {
+            for (std::size_t b = i % 3; b < bits; b += 1 + (i*7 + b) % 5)
+                sets[i].include(static_cast<TEnum>(b));
+        }
+    }
+};
+
+template <typename TEnum>
+void BM_FlagsUnion(benchmark::State& state) {
+    Ring<TEnum> ring;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        Flags<TEnum> r = ring.sets[i % RING] | ring.sets[(i + 1) % RING];
+        benchmark::DoNotOptimize(r);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename TEnum>
+void BM_FlagsIntersectDifference(benchmark::State& state) {
+    Ring<TEnum> ring;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        Flags<TEnum> r = (ring.sets[i % RING] & ring.sets[(i + 1) % RING])
+                       - ring.sets[(i + 2) % RING];
+        benchmark::DoNotOptimize(r);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename TEnum>
+void BM_FlagsCompare(benchmark::State& state) {
+    Ring<TEnum> ring;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        bool r = ring.sets[i % RING] == ring.sets[(i + 1) % RING] ||
+                 ring.sets[i % RING] <= ring.sets[(i + 3) % RING];
+        benchmark::DoNotOptimize(r);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename TEnum>
+void BM_FlagsContains(benchmark::State& state) {
+    Ring<TEnum> ring;
+    const std::size_t bits = Flags<TEnum>::BIT_COUNT;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        bool r = ring.sets[i % RING].contains(static_cast<TEnum>(i % bits));
+        benchmark::DoNotOptimize(r);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename TEnum>
+void BM_FlagsCount(benchmark::State& state) {
+    Ring<TEnum> ring;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ring.sets[i % RING].count());
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename TEnum>
+void BM_FlagsIterate(benchmark::State& state) {
+    Ring<TEnum> ring;
+    std::size_t i = 0, items = 0;
+    for (auto _ : state) {
+        Flags<TEnum> const& set = ring.sets[i % RING];
+        for (typename Flags<TEnum>::const_iterator it = set.begin(); it != set.end(); ++it) {
+            benchmark::DoNotOptimize(*it);
+            ++items;
+        }
+        ++i;
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(items));
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_FlagsUnion, NarrowEnum);
+BENCHMARK_TEMPLATE(BM_FlagsUnion, WideEnum);
+BENCHMARK_TEMPLATE(BM_FlagsIntersectDifference, NarrowEnum);
+BENCHMARK_TEMPLATE(BM_FlagsIntersectDifference, WideEnum);
+BENCHMARK_TEMPLATE(BM_FlagsCompare, NarrowEnum);
+BENCHMARK_TEMPLATE(BM_FlagsCompare, WideEnum);
+BENCHMARK_TEMPLATE(BM_FlagsContains, NarrowEnum);
+BENCHMARK_TEMPLATE(BM_FlagsContains, WideEnum);
+BENCHMARK_TEMPLATE(BM_FlagsCount, NarrowEnum);
+BENCHMARK_TEMPLATE(BM_FlagsCount, WideEnum);
+BENCHMARK_TEMPLATE(BM_FlagsIterate, NarrowEnum);
+BENCHMARK_TEMPLATE(BM_FlagsIterate, WideEnum);
@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "rvlm/core/Kernels.hh"
+
+using rvlm::core::Isa;
+using rvlm::core::KernelTable;
+using rvlm::core::detectIsa;
+using rvlm::core::isaName;
+using rvlm::core::kernelTable;
+
+namespace {
+
+// Kernels of every instruction set level over rows of 4096 floats, which
+// stay in L1/L2 cache, so that the speed of code rather than of memory is
+// compared. The argument is the level.
+
+const std::size_t N = 4096;
+
+bool selectTable(benchmark::State& state, KernelTable const*& table) {
+    Isa isa = static_cast<Isa>(state.range(0));
+    if (isa > detectIsa()) {
+        state.SkipWithError("instruction set not supported");
+        return false;
+    }
+    table = &kernelTable(isa);
+    state.SetLabel(isaName(table->isa));
+    return true;
+}
+
+void BM_KernelFill(benchmark::State& state) {
+    KernelTable const* table;
+    if (!selectTable(state, table))
+        return;
+    std::vector<float> a(N);
+    for (auto _ : state) {
+        table->f32.fill(a.data(), N, 1.0f);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+void BM_KernelSum(benchmark::State& state) {
+    KernelTable const* table;
+    if (!selectTable(state, table))
+        return;
+    std::vector<float> a(N, 1.5f);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(table->f32.sum(a.data(), N));
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+void BM_KernelMaxAbs(benchmark::State& state) {
+    KernelTable const* table;
+    if (!selectTable(state, table))
+        return;
+    std::vector<double> a(N, -1.5);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(table->f64.maxAbs(a.data(), N));
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+void BM_KernelCurlUpdate(benchmark::State& state) {
+    KernelTable const* table;
+    if (!selectTable(state, table))
+        return;
+    const std::ptrdiff_t S = 64;
+    std::vector<float> e(N, 0.0f), eps(N, 0.5f), h1(N + S, 1.0f), h2(N + S, 2.0f);
+    for (auto _ : state) {
+        table->f32.curlUpdate(e.data(), eps.data(), &h1[S], &h1[S - 1], 0.5f,
+                              &h2[S], &h2[0], 0.25f, N);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+void BM_KernelNarrow(benchmark::State& state) {
+    KernelTable const* table;
+    if (!selectTable(state, table))
+        return;
+    std::vector<double> d(N, 0.1);
+    std::vector<float> f(N);
+    for (auto _ : state) {
+        table->narrow(d.data(), f.data(), N);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+} // namespace
+
+BENCHMARK(BM_KernelFill)->DenseRange(0, 3);
+BENCHMARK(BM_KernelSum)->DenseRange(0, 3);
+BENCHMARK(BM_KernelMaxAbs)->DenseRange(0, 3);
+BENCHMARK(BM_KernelCurlUpdate)->DenseRange(0, 3);
+BENCHMARK(BM_KernelNarrow)->DenseRange(0, 3);
@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+#include "rvlm/core/MaterialGrid.hh"
+#include "rvlm/core/YeeUpdater.hh"
+
+using rvlm::core::CellMedium;
+using rvlm::core::MaterialGrid;
+using rvlm::core::MaterialMedium;
+using rvlm::core::SolidArray3d;
+using rvlm::core::Vector3d;
+using rvlm::core::YeeUpdater;
+
+namespace {
+
+// Yee steps on a 128^3 float grid with a few materials, taking
+// coefficients either from two per-cell arrays (8 bytes per cell) or from
+// a material grid (1 byte per cell).
+
+typedef SolidArray3d<float> Array;
+typedef MaterialGrid<float> Grid;
+typedef MaterialMedium<float> Medium;
+
+const std::size_t N = 128;
+
+void fillMaterials(Array& invEps, Array& invMu) {
+    for (std::size_t ix = 0; ix < N; ++ix)
+    for (std::size_t iy = 0; iy < N; ++iy)
+    for (std::size_t iz = 0; iz < N; ++iz) {
+        std::size_t m = (ix / 8 + iy / 16 + iz / 4) % 5;
+        invEps.at(ix, iy, iz) = 1.0f / (1 + m);
+        invMu.at(ix, iy, iz) = m == 4 ? 0.5f : 1.0f;
+    }
+}
+
+template <typename TMedium>
+void runYee(benchmark::State& state, TMedium const& medium) {
+    std::unique_ptr<Array> f[6];
+    for (int c = 0; c < 6; ++c)
+        f[c].reset(new Array(N, N, N, 0.0f));
+    f[2]->at(N/2, N/2, N/2) = 1.0f;
+
+    Vector3d<float> step(1e-3f, 1e-3f, 1e-3f);
+    YeeUpdater<float, std::size_t, TMedium> updater(
+            *f[0], *f[1], *f[2], *f[3], *f[4], *f[5], step,
+            0.99f * YeeUpdater<float>::courantLimit(step), medium);
+    for (auto _ : state) {
+        updater.step();
+        benchmark::ClobberMemory();
+    }
+    state.counters["cells/s"] = benchmark::Counter(
+            static_cast<double>(N*N*N) * state.iterations(),
+            benchmark::Counter::kIsRate);
+}
+
+void BM_YeeCellMedium(benchmark::State& state) {
+    Array invEps(N, N, N, 1.0f), invMu(N, N, N, 1.0f);
+    fillMaterials(invEps, invMu);
+    runYee(state, CellMedium<float>(invEps, invMu));
+}
+
+void BM_YeeMaterialGrid(benchmark::State& state) {
+    Array invEps(N, N, N, 1.0f), invMu(N, N, N, 1.0f);
+    fillMaterials(invEps, invMu);
+    std::vector<Array const*> arrays;
+    arrays.push_back(&invEps);
+    arrays.push_back(&invMu);
+    Grid grid(arrays);
+    runYee(state, Medium(grid));
+}
+
+void BM_MaterialGridBuild(benchmark::State& state) {
+    Array invEps(N, N, N, 1.0f), invMu(N, N, N, 1.0f);
+    fillMaterials(invEps, invMu);
+    std::vector<Array const*> arrays;
+    arrays.push_back(&invEps);
+    arrays.push_back(&invMu);
+    for (auto _ : state) {
+        Grid grid(arrays);
+        benchmark::DoNotOptimize(grid.getIds().getOrigin());
+    }
+    state.SetItemsProcessed(state.iterations() * N*N*N);
+}
+
+} // namespace
+
+BENCHMARK(BM_YeeCellMedium)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_YeeMaterialGrid)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_MaterialGridBuild)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "rvlm/core/Pyramid3d.hh"
+
+using rvlm::core::IndexBox;
+using rvlm::core::Pyramid3d;
+using rvlm::core::PyramidReduction;
+using rvlm::core::SolidArray3d;
+
+namespace {
+
+// Updating the pyramid over a 256^3 float field after changing all of it,
+// or a small box of it, as monitoring does every output step.
+
+const std::size_t N = 256;
+
+void BM_PyramidFull(benchmark::State& state) {
+    SolidArray3d<float> field(N, N, N, 1.0f);
+    Pyramid3d<float> pyramid(field, static_cast<PyramidReduction>(state.range(0)));
+    for (auto _ : state) {
+        pyramid.markAllDirty();
+        pyramid.update();
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * N*N*N * sizeof(float));
+}
+
+void BM_PyramidDirtyBox(benchmark::State& state) {
+    SolidArray3d<float> field(N, N, N, 1.0f);
+    Pyramid3d<float> pyramid(field);
+    pyramid.update();
+    for (auto _ : state) {
+        pyramid.markDirty(IndexBox<>(100, 132, 40, 72, 0, 32));
+        pyramid.update();
+        benchmark::ClobberMemory();
+    }
+}
+
+void BM_PyramidSlice(benchmark::State& state) {
+    SolidArray3d<float> field(N, N, N, 1.0f);
+    Pyramid3d<float> pyramid(field);
+    const int level = static_cast<int>(state.range(0));
+    IndexBox<> box = pyramid.getLevelBox(level);
+    std::vector<float> slice(static_cast<std::size_t>(box.size(0) * box.size(1)));
+    for (auto _ : state) {
+        pyramid.extractSlice(level, 2, box.size(2) / 2, slice.data());
+        benchmark::ClobberMemory();
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_PyramidFull)->Arg(0)->Arg(1);
+BENCHMARK(BM_PyramidDirtyBox);
+BENCHMARK(BM_PyramidSlice)->Arg(0)->Arg(2);
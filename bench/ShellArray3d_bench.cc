@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+#include "rvlm/core/ShellArray3d.hh"
+
+using rvlm::core::SolidArray3d;
+using rvlm::core::ShellArray3d;
+namespace algo = rvlm::core;
+
+namespace {
+
+// Absorbing layer update psi = b*psi + E over a 10 cells wide shell of a
+// 192^3 grid, with auxiliary fields psi and b stored as full-size arrays
+// and updated slab by slab, against the same in ShellArray3d. Counter MB
+// is memory taken by the auxiliary fields.
+
+typedef SolidArray3d<float, std::ptrdiff_t> Array;
+typedef ShellArray3d<float>                 Shell;
+
+const std::ptrdiff_t N = 192;
+const std::ptrdiff_t WIDTH = 10;
+
+void BM_ShellUpdateFullArrays(benchmark::State& state) {
+    Array field(N, N, N, 1.0f);
+    Array psi(N, N, N, 0.0f), b(N, N, N, 0.5f);
+    Shell geometry(Shell::Box(0, N, 0, N, 0, N), WIDTH);
+    for (auto _ : state) {
+        for (std::size_t s = 0; s < geometry.getSlabCount(); ++s) {
+            algo::zip(geometry.getSlabBox(s),
+                      [](float& p, float bv, float e) { p = bv*p + e; },
+                      psi, b, field);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * geometry.getTotalCount());
+    state.counters["MB"] = 2.0 * N*N*N * sizeof(float) / (1 << 20);
+}
+
+void BM_ShellUpdateSlabs(benchmark::State& state) {
+    Array field(N, N, N, 1.0f);
+    Shell psi(Shell::Box(0, N, 0, N, 0, N), WIDTH, 0.0f);
+    Shell b(Shell::Box(0, N, 0, N, 0, N), WIDTH, 0.5f);
+    for (auto _ : state) {
+        algo::zipShell([](float& p, float bv, float e) { p = bv*p + e; },
+                       psi, b, field);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * psi.getTotalCount());
+    state.counters["MB"] = 2.0 * psi.getTotalCount() * sizeof(float) / (1 << 20);
+}
+
+} // namespace
+
+BENCHMARK(BM_ShellUpdateFullArrays)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ShellUpdateSlabs)->Unit(benchmark::kMillisecond);
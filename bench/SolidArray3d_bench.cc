@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+#include "rvlm/core/SolidArray3d.hh"
+
+using rvlm::core::SolidArray3d;
+
+namespace {
+
+// Summing an N^3 float array through every access path of SolidArray3d:
+// checked at(), at<Axis...>() with permuted coordinates, cursors moved
+// along an axis, and raw pointers with explicit strides. The template
+// argument is the axis of the innermost loop, 2 for storage order and 0
+// for the largest stride; the argument is N, chosen so that arrays fit
+// L1, L2 or only main memory.
+
+typedef SolidArray3d<float> Array;
+
+template <int Inner>
+void BM_ArrayAt(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    Array a(n, n, n, 1.0f);
+    for (auto _ : state) {
+        float sum = 0;
+        std::size_t c[3];
+        for (c[2 - Inner] = 0; c[2 - Inner] < n; ++c[2 - Inner])
+        for (c[1] = 0; c[1] < n; ++c[1])
+        for (c[Inner] = 0; c[Inner] < n; ++c[Inner])
+            sum += a.at(c[0], c[1], c[2]);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n*n*n);
+}
+
+template <int Inner>
+void BM_ArrayAtAxes(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    Array a(n, n, n, 1.0f);
+    for (auto _ : state) {
+        float sum = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t j = 0; j < n; ++j)
+        for (std::size_t k = 0; k < n; ++k)
+            sum += a.at<2 - Inner, 1, Inner>(i, j, k);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n*n*n);
+}
+
+template <int Inner>
+void BM_ArrayCursor(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    Array a(n, n, n, 1.0f);
+    for (auto _ : state) {
+        float sum = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t j = 0; j < n; ++j) {
+            Array::CursorType cursor = a.getCursorX<2 - Inner, 1, Inner>(i, j, 0);
+            for (std::size_t k = 0; k < n; ++k) {
+                sum += a.at(cursor);
+                a.cursorMoveToNext<Inner>(cursor);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n*n*n);
+}
+
+template <int Inner>
+void BM_ArrayRawPointer(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    const std::size_t strides[3] = { n*n, n, 1 };
+    const std::size_t outer = strides[2 - Inner], inner = strides[Inner];
+    Array a(n, n, n, 1.0f);
+    for (auto _ : state) {
+        float const* p = a.getOrigin();
+        float sum = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t j = 0; j < n; ++j) {
+            float const* row = p + i*outer + j*n;
+            for (std::size_t k = 0; k < n; ++k)
+                sum += row[k*inner];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n*n*n);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_ArrayAt, 2)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_ArrayAt, 0)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_ArrayAtAxes, 2)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_ArrayAtAxes, 0)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_ArrayCursor, 2)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_ArrayCursor, 0)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_ArrayRawPointer, 2)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_ArrayRawPointer, 0)->Arg(16)->Arg(64)->Arg(256);
@@ -0,0 +1,100 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "rvlm/core/SolidArray3d.hh"
+#include "rvlm/core/TaskGraph.hh"
+
+using rvlm::core::IndexBox;
+using rvlm::core::SolidArray3d;
+using rvlm::core::TaskGraph;
+using rvlm::core::regionOf;
+
+namespace {
+
+typedef IndexBox<std::ptrdiff_t> Box;
+typedef TaskGraph::Regions Regions;
+
+// Cost of scheduling itself, with empty tasks in a chain through one array
+// and without any dependencies.
+
+void BM_TaskGraphIndependent(benchmark::State& state) {
+    TaskGraph graph;
+    std::atomic<int> count(0);
+    for (auto _ : state) {
+        for (int i = 0; i < 1000; ++i)
+            graph.add([&] { ++count; }, Regions(), Regions());
+        graph.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+
+void BM_TaskGraphChain(benchmark::State& state) {
+    SolidArray3d<float> a(4, 4, 4, 0.0f);
+    TaskGraph graph;
+    std::atomic<int> count(0);
+    for (auto _ : state) {
+        for (int i = 0; i < 1000; ++i)
+            graph.add([&] { ++count; }, Regions(), Regions(1, regionOf(a)));
+        graph.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+
+// Ten steps of a two-pass 7-point smoothing of a 128^3 array in x-slabs,
+// as tasks with halo regions, against the same sweeps done one by one.
+
+const int N = 128, SLABS = 16, STEPS = 10;
+
+void smooth(SolidArray3d<float> const& src, SolidArray3d<float>& dst, int x0, int x1) {
+    for (int ix = std::max(x0, 1); ix < std::min(x1, N - 1); ++ix)
+    for (int iy = 1; iy < N - 1; ++iy) {
+        float const* c = src.getCursor(ix, iy, 0);
+        float* d = dst.getCursor(ix, iy, 0);
+        const std::ptrdiff_t px = N*N, py = N;
+        for (int iz = 1; iz < N - 1; ++iz)
+            d[iz] = (c[iz - px] + c[iz + px] + c[iz - py] + c[iz + py] +
+                     c[iz - 1] + c[iz + 1] + 2*c[iz]) * 0.125f;
+    }
+}
+
+void BM_SlabSweepsSequential(benchmark::State& state) {
+    SolidArray3d<float> u(N, N, N, 1.0f), v(N, N, N, 0.0f);
+    for (auto _ : state) {
+        for (int step = 0; step < STEPS; ++step) {
+            smooth(u, v, 0, N);
+            smooth(v, u, 0, N);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 2*STEPS * N*N*N);
+}
+
+void BM_SlabSweepsTaskGraph(benchmark::State& state) {
+    SolidArray3d<float> u(N, N, N, 1.0f), v(N, N, N, 0.0f);
+    TaskGraph graph;
+    for (auto _ : state) {
+        for (int step = 0; step < STEPS; ++step) {
+            for (int pass = 0; pass < 2; ++pass) {
+                SolidArray3d<float>& src = pass == 0 ? u : v;
+                SolidArray3d<float>& dst = pass == 0 ? v : u;
+                for (int s = 0; s < SLABS; ++s) {
+                    const int x0 = s*N/SLABS, x1 = (s + 1)*N/SLABS;
+                    Box own(x0, x1, 0, N, 0, N);
+                    Box halo(std::max(x0 - 1, 0), std::min(x1 + 1, N), 0, N, 0, N);
+                    graph.add([&src, &dst, x0, x1] { smooth(src, dst, x0, x1); },
+                              Regions(1, regionOf(src, halo)),
+                              Regions(1, regionOf(dst, own)));
+                }
+            }
+        }
+        graph.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * 2*STEPS * N*N*N);
+}
+
+} // namespace
+
+BENCHMARK(BM_TaskGraphIndependent)->UseRealTime();
+BENCHMARK(BM_TaskGraphChain)->UseRealTime();
+BENCHMARK(BM_SlabSweepsSequential)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_SlabSweepsTaskGraph)->Unit(benchmark::kMillisecond)->UseRealTime();
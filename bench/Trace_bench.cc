@@ -0,0 +1,72 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include "rvlm/core/Trace.hh"
+
+using rvlm::core::TracePhase;
+using rvlm::core::TraceScope;
+using rvlm::core::TraceSession;
+using rvlm::core::traceEvent;
+
+namespace {
+
+// Cost of recording one event, with no session running, which is what
+// builds with tracing compiled in pay everywhere, and while a session
+// writes events to a file in the background.
+
+void BM_TraceEventDisabled(benchmark::State& state) {
+    for (auto _ : state)
+        traceEvent(TracePhase::Instant, "event");
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Events are recorded in batches half the size of a buffer, flushed with
+// the timer stopped, so that none are dropped.
+
+const std::size_t BATCH = rvlm::core::detail::TraceBuffer::CAPACITY / 2;
+const char* const PATH = "Trace_bench.json";
+
+void BM_TraceEventEnabled(benchmark::State& state) {
+    {
+        TraceSession session(PATH, 1000);
+        std::size_t n = 0;
+        for (auto _ : state) {
+            traceEvent(TracePhase::Instant, "event");
+            if (++n == BATCH) {
+                state.PauseTiming();
+                session.flush();
+                n = 0;
+                state.ResumeTiming();
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+        session.flush();
+        state.counters["dropped"] = static_cast<double>(session.getDroppedCount());
+    }
+    std::remove(PATH);
+}
+
+void BM_TraceScopeEnabled(benchmark::State& state) {
+    {
+        TraceSession session(PATH, 1000);
+        std::size_t n = 0;
+        for (auto _ : state) {
+            {
+                TraceScope scope("scope");
+            }
+            if (++n == BATCH / 2) {
+                state.PauseTiming();
+                session.flush();
+                n = 0;
+                state.ResumeTiming();
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * 2);
+    }
+    std::remove(PATH);
+}
+
+} // namespace
+
+BENCHMARK(BM_TraceEventDisabled);
+BENCHMARK(BM_TraceEventEnabled);
+BENCHMARK(BM_TraceScopeEnabled);
@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+#include "rvlm/core/Transpose3d.hh"
+
+using rvlm::core::Execution;
+using rvlm::core::SolidArray3d;
+namespace algo = rvlm::core;
+
+namespace {
+
+// Conversion of a 256^3 double array between C and Fortran order, blocked
+// and with the naive triple loop, and the in-place variant.
+
+typedef SolidArray3d<double> Array;
+
+const std::size_t N = 256;
+
+void BM_PermuteAxesNaive(benchmark::State& state) {
+    Array src(N, N, N, 1.0), dst(N, N, N, 0.0);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < N; ++i)
+        for (std::size_t j = 0; j < N; ++j)
+        for (std::size_t k = 0; k < N; ++k)
+            dst.at(i, j, k) = src.at<2, 1, 0>(i, j, k);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * N*N*N * sizeof(double));
+}
+
+void BM_PermuteAxes(benchmark::State& state) {
+    Array src(N, N, N, 1.0), dst(N, N, N, 0.0);
+    for (auto _ : state) {
+        algo::permuteAxes<2, 1, 0>(src, dst, Execution::Parallel);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * N*N*N * sizeof(double));
+}
+
+void BM_PermuteAxesCyclic(benchmark::State& state) {
+    Array src(N, N, N, 1.0), dst(N, N, N, 0.0);
+    for (auto _ : state) {
+        algo::permuteAxes<1, 2, 0>(src, dst, Execution::Parallel);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * N*N*N * sizeof(double));
+}
+
+void BM_PermuteAxesInPlace(benchmark::State& state) {
+    Array a(N, N, N, 1.0);
+    for (auto _ : state) {
+        algo::permuteAxesInPlace<2, 1, 0>(a, Execution::Parallel);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * N*N*N * sizeof(double));
+}
+
+} // namespace
+
+BENCHMARK(BM_PermuteAxesNaive)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PermuteAxes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PermuteAxesCyclic)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PermuteAxesInPlace)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "rvlm/core/TrilinearSampler.hh"
+
+using rvlm::core::GridGeometry;
+using rvlm::core::SolidArray3d;
+using rvlm::core::TrilinearSampler;
+using rvlm::core::Vector3d;
+namespace core = rvlm::core;
+
+namespace {
+
+// Sampling three staggered E components of a 64^3 grid at a million
+// particle positions, as in a particle push.
+
+typedef Vector3d<double> V;
+const std::size_t N = 64;
+const std::size_t PARTICLES = 1 << 20;
+
+struct Setup {
+    GridGeometry<double> grid;
+    SolidArray3d<double> ex, ey, ez;
+    std::vector<double> xs, ys, zs, out[3];
+
+    Setup(bool sorted)
+        : grid(V(0, 0, 0), V(1, 1, 1)),
+          ex(N, N, N, 1.0), ey(N, N, N, 2.0), ez(N, N, N, 3.0) {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<double> coord(0, N - 1);
+        for (std::size_t i = 0; i < PARTICLES; ++i) {
+            xs.push_back(coord(rng));
+            ys.push_back(coord(rng));
+            zs.push_back(coord(rng));
+        }
+        if (sorted) {
+            std::vector<std::size_t> p = core::sortByCell(
+                    grid, ex.getBox(), xs.data(), ys.data(), zs.data(), PARTICLES);
+            core::applyPermutation(p, xs);
+            core::applyPermutation(p, ys);
+            core::applyPermutation(p, zs);
+        }
+        for (int c = 0; c < 3; ++c)
+            out[c].resize(PARTICLES);
+    }
+};
+
+/**
+ * Hand-written scalar interpolation through cursors, the way probes were
+ * sampled before.
+ */
+double scalarSample(SolidArray3d<double> const& a, double x, double y, double z) {
+    std::size_t ix = static_cast<std::size_t>(std::floor(x));
+    std::size_t iy = static_cast<std::size_t>(std::floor(y));
+    std::size_t iz = static_cast<std::size_t>(std::floor(z));
+    double wx = x - ix, wy = y - iy, wz = z - iz;
+    double* p = a.getCursor(ix, iy, iz);
+    const std::size_t dx = N*N, dy = N;
+    double v00 = p[0]       + wz*(p[1]       - p[0]);
+    double v01 = p[dy]      + wz*(p[dy+1]    - p[dy]);
+    double v10 = p[dx]      + wz*(p[dx+1]    - p[dx]);
+    double v11 = p[dx+dy]   + wz*(p[dx+dy+1] - p[dx+dy]);
+    double v0 = v00 + wy*(v01 - v00), v1 = v10 + wy*(v11 - v10);
+    return v0 + wx*(v1 - v0);
+}
+
+void BM_ScalarSample(benchmark::State& state) {
+    Setup s(state.range(0) != 0);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < PARTICLES; ++i) {
+            s.out[0][i] = scalarSample(s.ex, s.xs[i] - 0.5, s.ys[i], s.zs[i]);
+            s.out[1][i] = scalarSample(s.ey, s.xs[i], s.ys[i] - 0.5, s.zs[i]);
+            s.out[2][i] = scalarSample(s.ez, s.xs[i], s.ys[i], s.zs[i] - 0.5);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * PARTICLES);
+}
+
+void BM_BatchSample(benchmark::State& state) {
+    Setup s(state.range(0) != 0);
+    TrilinearSampler<double> sampler(s.grid);
+    sampler.addComponent(s.ex, V(0.5, 0, 0));
+    sampler.addComponent(s.ey, V(0, 0.5, 0));
+    sampler.addComponent(s.ez, V(0, 0, 0.5));
+    double* outs[3] = { s.out[0].data(), s.out[1].data(), s.out[2].data() };
+    for (auto _ : state) {
+        sampler.sample(s.xs.data(), s.ys.data(), s.zs.data(), PARTICLES, outs);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * PARTICLES);
+}
+
+} // namespace
+
+BENCHMARK(BM_ScalarSample)->Arg(0)->Arg(1);
+BENCHMARK(BM_BatchSample)->Arg(0)->Arg(1);
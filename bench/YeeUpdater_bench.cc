@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <memory>
+#include "rvlm/core/YeeUpdater.hh"
+
+using rvlm::core::SolidArray3d;
+using rvlm::core::Vector3d;
+using rvlm::core::YeeUpdater;
+
+namespace {
+
+typedef SolidArray3d<float> Array;
+
+/**
+ * Runs fused Yee steps on a cube of @c state.range(0) cells per side and
+ * reports cells updated per second. Six float arrays take 24 bytes per
+ * cell, that is 400 MB for 256^3 and 25 GB for 1024^3.
+ */
+void BM_YeeStep(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::unique_ptr<Array> f[6];
+    for (int c = 0; c < 6; ++c)
+        f[c].reset(new Array(n, n, n, 0.0f));
+    f[2]->at(n/2, n/2, n/2) = 1.0f;
+
+    Vector3d<float> step(1e-3f, 1e-3f, 1e-3f);
+    YeeUpdater<float> updater(*f[0], *f[1], *f[2], *f[3], *f[4], *f[5], step,
+                              0.99f * YeeUpdater<float>::courantLimit(step));
+
+    for (auto _ : state) {
+        updater.step();
+        benchmark::ClobberMemory();
+    }
+
+    const double cells = static_cast<double>(n) * n * n;
+    state.counters["cells/s"] = benchmark::Counter(
+            cells * state.iterations(), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(static_cast<int64_t>(
+            state.iterations() * cells * 12 * sizeof(float)));
+}
+
+void BM_YeeSplitStep(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::unique_ptr<Array> f[6];
+    for (int c = 0; c < 6; ++c)
+        f[c].reset(new Array(n, n, n, 0.0f));
+
+    Vector3d<float> step(1e-3f, 1e-3f, 1e-3f);
+    YeeUpdater<float> updater(*f[0], *f[1], *f[2], *f[3], *f[4], *f[5], step,
+                              0.99f * YeeUpdater<float>::courantLimit(step));
+
+    for (auto _ : state) {
+        updater.updateH();
+        updater.updateE();
+        benchmark::ClobberMemory();
+    }
+
+    const double cells = static_cast<double>(n) * n * n;
+    state.counters["cells/s"] = benchmark::Counter(
+            cells * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+/**
+ * Grids of 128^3 and 256^3 cells always run. Set RVLM_BENCH_YEE_MAX to 512
+ * or 1024 to add larger grids on machines with enough memory.
+ */
+int registerYeeBenchmarks() {
+    long maxSize = 256;
+    if (char const* env = std::getenv("RVLM_BENCH_YEE_MAX"))
+        maxSize = std::strtol(env, nullptr, 10);
+
+    for (long n = 128; n <= maxSize; n *= 2) {
+        benchmark::RegisterBenchmark("BM_YeeStep", BM_YeeStep)
+            ->Arg(n)->Unit(benchmark::kMillisecond)->UseRealTime();
+        benchmark::RegisterBenchmark("BM_YeeSplitStep", BM_YeeSplitStep)
+            ->Arg(n)->Unit(benchmark::kMillisecond)->UseRealTime();
+    }
+    return 0;
+}
+
+const int registered = registerYeeBenchmarks();
+
+} // namespace
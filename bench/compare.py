@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Compares two JSON reports of rvlm-common-bench and flags regressions.
+
+Reports are written by the benchmark executable, or by the
+rvlm-common-bench-json target into bench.json of the build directory:
+
+    rvlm-common-bench --benchmark_out=base.json --benchmark_out_format=json \\
+                      --benchmark_repetitions=5
+
+When a report has repetitions, the median of every benchmark is compared;
+otherwise the mean of its runs. The script prints the change of every
+benchmark present in both reports and exits with status 1 if any got slower
+by more than the threshold, so that it can gate continuous integration.
+"""
+
+import argparse
+import json
+import sys
+
+UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path, metric):
+    """Returns {benchmark name: time in nanoseconds} of a report."""
+    with open(path) as f:
+        report = json.load(f)
+
+    medians, runs = {}, {}
+    for b in report.get("benchmarks", []):
+        if b.get("error_occurred"):
+            continue
+        name = b.get("run_name", b["name"])
+        time = b[metric] * UNITS[b.get("time_unit", "ns")]
+        if b.get("run_type") == "aggregate":
+            if b.get("aggregate_name") == "median":
+                medians[name] = time
+        else:
+            runs.setdefault(name, []).append(time)
+
+    times = dict((name, sum(t) / len(t)) for name, t in runs.items())
+    times.update(medians)
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline", help="report of the reference build")
+    parser.add_argument("contender", help="report of the build under test")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="largest tolerated slowdown, 0.10 for 10%%")
+    parser.add_argument("--metric", choices=("cpu_time", "real_time"),
+                        default="cpu_time", help="time to compare")
+    parser.add_argument("--filter", default="",
+                        help="compare only benchmarks containing this text")
+    args = parser.parse_args()
+
+    base = load(args.baseline, args.metric)
+    new = load(args.contender, args.metric)
+    names = sorted(n for n in base if n in new and args.filter in n)
+    if not names:
+        print("no common benchmarks")
+        return 1
+
+    width = max(len(n) for n in names)
+    regressions = 0
+    print("%-*s %14s %14s %9s" % (width, "benchmark", "baseline, ns",
+                                  "contender, ns", "change"))
+    for name in names:
+        change = new[name] / base[name] - 1 if base[name] > 0 else 0.0
+        mark = ""
+        if change > args.threshold:
+            mark = "  REGRESSION"
+            regressions += 1
+        print("%-*s %14.1f %14.1f %+8.1f%%%s" % (width, name, base[name],
+                                                 new[name], 100 * change, mark))
+
+    for name in sorted(set(base) ^ set(new)):
+        if args.filter in name:
+            where = "baseline" if name in base else "contender"
+            print("%s: only in %s" % (name, where))
+
+    if regressions:
+        print("%d of %d benchmarks slower by more than %.0f%%"
+              % (regressions, len(names), 100 * args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
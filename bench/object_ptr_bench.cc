@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "rvlm/object_ptr.hh"
+#include "rvlm/intrusive_object_ptr.hh"
+
+namespace {
+
+// Graph is a random DAG: node 'i' refers to a few nodes from (i, i+SPAN].
+// This keeps reference counting free of cycles while giving long walks.
+const int NODE_COUNT = 4096;
+const int EDGE_COUNT = 4;
+const int EDGE_SPAN  = 16;
+
+struct SharedNode {
+    std::vector<rvlm::object_ptr<SharedNode>> edges;
+};
+
+template <typename TPolicy>
+struct IntrusiveNode: public rvlm::ref_counted<TPolicy> {
+    std::vector<rvlm::intrusive_object_ptr<IntrusiveNode>> edges;
+};
+
+rvlm::object_ptr<SharedNode> makeNode(SharedNode*) {
+    return rvlm::make_object<SharedNode>();
+}
+
+template <typename TPolicy>
+rvlm::intrusive_object_ptr<IntrusiveNode<TPolicy>>
+makeNode(IntrusiveNode<TPolicy>*) {
+    return rvlm::make_intrusive_object<IntrusiveNode<TPolicy>>();
+}
+
+template <typename TNode, typename TPtr>
+std::vector<TPtr> buildGraph() {
+    std::mt19937 rng(12345);
+    std::vector<TPtr> nodes;
+    nodes.reserve(NODE_COUNT);
+
+    // Nodes are created from the last to the first, so that every edge
+    // target already exists. 'nodes' holds them in reverse order.
+    for (int i = NODE_COUNT - 1; i >= 0; --i) {
+        TPtr node = makeNode(static_cast<TNode*>(nullptr));
+        int span = std::min(EDGE_SPAN, NODE_COUNT - 1 - i);
+        for (int e = 0; span > 0 && e < EDGE_COUNT; ++e) {
+            int target = i + 1 + static_cast<int>(rng() % span);
+            node->edges.push_back(nodes[NODE_COUNT - 1 - target]);
+        }
+        nodes.push_back(node);
+    }
+
+    return nodes;
+}
+
+template <typename TNode, typename TPtr>
+void BM_GraphBuild(benchmark::State& state) {
+    for (auto _ : state) {
+        auto nodes = buildGraph<TNode, TPtr>();
+        benchmark::DoNotOptimize(nodes.data());
+    }
+    state.SetItemsProcessed(state.iterations() * NODE_COUNT);
+}
+
+// Random walks from the root to a leaf, recording every visited node into
+// a path. Each step copies a pointer twice and each path is released as a
+// whole, which is what graph algorithms over shared objects usually do.
+template <typename TNode, typename TPtr>
+void BM_GraphWalk(benchmark::State& state) {
+    auto nodes = buildGraph<TNode, TPtr>();
+    TPtr root = nodes.back();
+
+    std::mt19937 rng(54321);
+    std::vector<TPtr> path;
+    path.reserve(NODE_COUNT);
+
+    std::int64_t steps = 0;
+    for (auto _ : state) {
+        path.clear();
+        TPtr current = root;
+        path.push_back(current);
+        while (!current->edges.empty()) {
+            current = current->edges[rng() % current->edges.size()];
+            path.push_back(current);
+        }
+        steps += path.size();
+        benchmark::DoNotOptimize(path.data());
+    }
+    state.SetItemsProcessed(steps);
+}
+
+typedef IntrusiveNode<rvlm::atomic_ref_count> AtomicNode;
+typedef IntrusiveNode<rvlm::local_ref_count>  LocalNode;
+typedef rvlm::object_ptr<SharedNode>          SharedPtr;
+typedef rvlm::intrusive_object_ptr<AtomicNode> AtomicPtr;
+typedef rvlm::intrusive_object_ptr<LocalNode>  LocalPtr;
+
+BENCHMARK_TEMPLATE(BM_GraphBuild, SharedNode, SharedPtr);
+BENCHMARK_TEMPLATE(BM_GraphBuild, AtomicNode, AtomicPtr);
+BENCHMARK_TEMPLATE(BM_GraphBuild, LocalNode,  LocalPtr);
+
+BENCHMARK_TEMPLATE(BM_GraphWalk, SharedNode, SharedPtr);
+BENCHMARK_TEMPLATE(BM_GraphWalk, AtomicNode, AtomicPtr);
+BENCHMARK_TEMPLATE(BM_GraphWalk, LocalNode,  LocalPtr);
+
+} // namespace
@@ -0,0 +1,282 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "rvlm/core/BitArray3d.hh"
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/Kernels.hh"
+#include "rvlm/core/SolidArray3d.hh"
+#include "rvlm/core/Trace.hh"
+#include "rvlm/core/Traversable3D.hh"
+#include "rvlm/core/detail/IndexSequence.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Execution mode of generic algorithms. In parallel mode rows of a box are
+ * split between OpenMP threads, so functions passed to algorithms must be
+ * safe to call concurrently for different cells.
+ */
+enum class Execution {
+    Sequential,
+    Parallel
+};
+
+namespace detail {
+
+/**
+ * @internal
+ * Access to an item by cursor. Arrays of values give references into
+ * their storage, read-only bit arrays give @c bool values and writable bit
+ * arrays give proxy objects assignable from @c bool.
+ */
+template <typename TArray>
+struct CellAccess {
+    static auto ref(TArray& array, typename TArray::CursorType cursor)
+            -> decltype(array.at(cursor)) {
+        return array.at(cursor);
+    }
+};
+
+template <typename TValue, typename TIndex>
+struct CellAccess<SolidArray3d<TValue, TIndex>> {
+    static TValue& ref(SolidArray3d<TValue, TIndex>&, TValue* cursor) {
+        return *cursor;
+    }
+};
+
+template <typename TValue, typename TIndex>
+struct CellAccess<SolidArray3d<TValue, TIndex> const> {
+    static TValue const& ref(SolidArray3d<TValue, TIndex> const&, TValue* cursor) {
+        return *cursor;
+    }
+};
+
+template <typename TIndex>
+struct CellAccess<BitArray3d<TIndex>> {
+    class Reference {
+    public:
+        Reference(BitArray3d<TIndex>& array, std::size_t cursor)
+            : mArray(&array), mCursor(cursor) {}
+
+        operator bool() const { return mArray->at(mCursor); }
+
+        Reference& operator = (bool val) {
+            mArray->set(mCursor, val);
+            return *this;
+        }
+
+        Reference& operator = (Reference const& other) {
+            return *this = static_cast<bool>(other);
+        }
+
+    private:
+        BitArray3d<TIndex>* mArray;
+        std::size_t         mCursor;
+    };
+
+    static Reference ref(BitArray3d<TIndex>& array, std::size_t cursor) {
+        return Reference(array, cursor);
+    }
+};
+
+template <typename TIndex>
+struct CellAccess<BitArray3d<TIndex> const> {
+    static bool ref(BitArray3d<TIndex> const& array, std::size_t cursor) {
+        return array.at(cursor);
+    }
+};
+
+template <typename TArray>
+typename TArray::CursorType rowCursor(TArray& array, std::ptrdiff_t ix,
+                                      std::ptrdiff_t iy, std::ptrdiff_t iz) {
+    typedef typename TArray::IndexType I;
+    return array.getCursor(static_cast<I>(ix), static_cast<I>(iy),
+                           static_cast<I>(iz));
+}
+
+/**
+ * @internal
+ * Calls @a func for all items of one row in every array. Cursors are plain
+ * pointers or indices advancing by one, which lets the compiler vectorize
+ * the loop for arrays of values.
+ */
+template <typename TFunc, typename TArrays, std::size_t... Is>
+inline void zipRow(TFunc& func, TArrays& arrays, std::ptrdiff_t ix,
+                   std::ptrdiff_t iy, std::ptrdiff_t iz, std::size_t count,
+                   IndexSequence<Is...>) {
+    auto cursors = std::make_tuple(rowCursor(std::get<Is>(arrays), ix, iy, iz)...);
+    for (std::size_t k = 0; k < count; ++k) {
+        func(CellAccess<typename std::remove_reference<
+                typename std::tuple_element<Is, TArrays>::type>::type>
+             ::ref(std::get<Is>(arrays), std::get<Is>(cursors) + k)...);
+    }
+}
+
+constexpr bool allOf() { return true; }
+
+template <typename... TRest>
+constexpr bool allOf(bool first, TRest... rest) { return first && allOf(rest...); }
+
+template <typename TFunc>
+struct TransformOp {
+    TFunc func;
+    template <typename TDst, typename TSrc>
+    void operator () (TDst&& dst, TSrc&& src) const { dst = func(src); }
+};
+
+struct CopyOp {
+    template <typename TDst, typename TSrc>
+    void operator () (TDst&& dst, TSrc&& src) const { dst = src; }
+};
+
+template <typename TValue>
+struct FillOp {
+    TValue value;
+    template <typename TDst>
+    void operator () (TDst&& dst) const { dst = value; }
+};
+
+} // namespace detail
+
+/**
+ * Type passed to functions for items of @a TArray: a reference for arrays
+ * of values, @c bool for read-only bit arrays and a proxy assignable from
+ * @c bool for writable bit arrays.
+ */
+template <typename TArray>
+using CellReference = decltype(detail::CellAccess<TArray>::ref(
+        std::declval<TArray&>(),
+        std::declval<typename std::remove_const<TArray>::type::CursorType>()));
+
+/**
+ * Calls <tt>func(a[c], b[c], ...)</tt> for every cell @em c of @a box, with
+ * items of all @a arrays at the same global coordinates. Box must lie within
+ * every array, otherwise @c std::out_of_range is thrown. Cells are visited
+ * row by row along @em Z.
+ */
+template <typename TFunc, typename... TArrays>
+void zip(Execution exec, IndexBox<> const& box, TFunc func, TArrays&... arrays) {
+    static_assert(detail::allOf(IsTraversable3d<
+                      typename std::remove_const<TArrays>::type>::value...),
+                  "arrays must implement Traversable3D");
+
+    if (!detail::allOf(arrays.getBox().contains(box)...))
+        throw std::out_of_range("box exceeds array bounds");
+    if (box.empty())
+        return;
+
+    RVLM_TRACE_SCOPE_VALUE("zip", static_cast<std::uint64_t>(box.count()));
+
+    // Parameter packs stay outside of the parallel region.
+    typedef detail::MakeIndexSequence<sizeof...(TArrays)> Indices;
+    std::tuple<TArrays&...> refs(arrays...);
+    const std::ptrdiff_t x0 = box.start[0], x1 = box.stop[0];
+    const std::ptrdiff_t y0 = box.start[1], y1 = box.stop[1];
+    const std::ptrdiff_t z0 = box.start[2];
+    const std::size_t count = static_cast<std::size_t>(box.size(2));
+
+    #pragma omp parallel for collapse(2) schedule(static) \
+            if(exec == Execution::Parallel)
+    for (std::ptrdiff_t ix = x0; ix < x1; ++ix) {
+        for (std::ptrdiff_t iy = y0; iy < y1; ++iy) {
+            detail::zipRow(func, refs, ix, iy, z0, count, Indices());
+        }
+    }
+}
+
+template <typename TFunc, typename... TArrays>
+void zip(IndexBox<> const& box, TFunc func, TArrays&... arrays) {
+    zip(Execution::Sequential, box, func, arrays...);
+}
+
+/**
+ * Calls @a func for every item of @a array within @a box.
+ */
+template <typename TArray, typename TFunc>
+void forEach(TArray& array, IndexBox<> const& box, TFunc func,
+             Execution exec = Execution::Sequential) {
+    zip(exec, box, func, array);
+}
+
+/**
+ * Assigns @a value to every item of @a array within @a box.
+ */
+template <typename TArray, typename TValue>
+void fill(TArray& array, IndexBox<> const& box, TValue const& value,
+          Execution exec = Execution::Sequential) {
+    detail::FillOp<TValue> op = { value };
+    zip(exec, box, op, array);
+}
+
+namespace detail {
+
+template <typename T, typename TIndex>
+void fillRows(SolidArray3d<T, TIndex>& array, IndexBox<> const& box, T value,
+              Execution exec) {
+    if (!array.getBox().contains(box))
+        throw std::out_of_range("box exceeds array bounds");
+    if (box.empty())
+        return;
+
+    const std::ptrdiff_t x0 = box.start[0], x1 = box.stop[0];
+    const std::ptrdiff_t y0 = box.start[1], y1 = box.stop[1];
+    const TIndex z0 = static_cast<TIndex>(box.start[2]);
+    const std::size_t count = static_cast<std::size_t>(box.size(2));
+
+    #pragma omp parallel for collapse(2) schedule(static) \
+            if(exec == Execution::Parallel)
+    for (std::ptrdiff_t ix = x0; ix < x1; ++ix) {
+        for (std::ptrdiff_t iy = y0; iy < y1; ++iy) {
+            kernels::fill(array.getCursor(static_cast<TIndex>(ix),
+                                          static_cast<TIndex>(iy), z0),
+                          count, value);
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * Same as above for arrays of floating-point values, whose rows are filled
+ * by kernels compiled for the processor at hand.
+ */
+template <typename TIndex>
+void fill(SolidArray3d<float, TIndex>& array, IndexBox<> const& box,
+          float value, Execution exec = Execution::Sequential) {
+    detail::fillRows(array, box, value, exec);
+}
+
+template <typename TIndex>
+void fill(SolidArray3d<double, TIndex>& array, IndexBox<> const& box,
+          double value, Execution exec = Execution::Sequential) {
+    detail::fillRows(array, box, value, exec);
+}
+
+/**
+ * Copies items of @a src within @a box into items of @a dst having the
+ * same coordinates.
+ */
+template <typename TSrc, typename TDst>
+void copy(TSrc const& src, TDst& dst, IndexBox<> const& box,
+          Execution exec = Execution::Sequential) {
+    zip(exec, box, detail::CopyOp(), dst, src);
+}
+
+/**
+ * Assigns <tt>func(src[c])</tt> to <tt>dst[c]</tt> for every cell @em c
+ * of @a box. Arrays @a src and @a dst may be the same array.
+ */
+template <typename TSrc, typename TDst, typename TFunc>
+void transform(TSrc const& src, TDst& dst, IndexBox<> const& box, TFunc func,
+               Execution exec = Execution::Sequential) {
+    detail::TransformOp<TFunc> op = { func };
+    zip(exec, box, op, dst, src);
+}
+
+} // namespace core
+} // namespace rvlm
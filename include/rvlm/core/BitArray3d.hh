@@ -0,0 +1,550 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <boost/numeric/conversion/cast.hpp>
+#include "rvlm/core/memory/Allocator.hh"
+#include "rvlm/core/memory/OperatorNewAllocator.hh"
+#include "rvlm/core/NonAssignable.hh"
+#include "rvlm/core/HalfOpenRange.hh"
+#include "rvlm/core/Traversable3D.hh"
+#include "rvlm/core/detail/BitOps.hh"
+#include "rvlm/core/detail/StaticCursorHelpers.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Tridimensional array of boolean values, one bit per item.
+ *
+ * Geometry and indexing are the same as with @c SolidArray3d: items are laid
+ * out from @em X to @em Z, and coordinates may start from arbitrary begin
+ * offsets. Each row along @em Z is stored as a whole number of 64 bit words,
+ * so that rows start at word boundaries and bulk operations can process 64
+ * items at once. Padding bits at the end of each row are always kept zero.
+ *
+ * Cursors are bit positions rather than pointers, but are moved in exactly
+ * the same way as cursors of @c SolidArray3d.
+ */
+template <typename TIndex = std::size_t>
+class BitArray3d: public rvlm::core::NonAssignable,
+                  public rvlm::core::Traversable3D<BitArray3d<TIndex>> {
+public:
+
+    using ThisType          = BitArray3d<TIndex>;
+    using Allocator         = rvlm::core::memory::Allocator;
+    using StandardAllocator = rvlm::core::memory::OperatorNewAllocator;
+    using IndexType         = TIndex;
+    using ValueType         = bool;
+    using WordType          = std::uint64_t;
+    using CursorType        = std::size_t;
+
+    static const std::size_t WORD_BITS = 64;
+
+    /**
+     * Run of consecutive set items along @em Z, from @c startZ (inclusive)
+     * to @c stopZ (exclusive), in row (@c ix, @c iy).
+     */
+    struct Run {
+        IndexType ix;
+        IndexType iy;
+        IndexType startZ;
+        IndexType stopZ;
+    };
+
+private:
+    /**
+     * @internal
+     * Box of items: X and Y in global coordinates, Z as local bit positions.
+     */
+    struct Box {
+        IndexType   x0, x1;
+        IndexType   y0, y1;
+        std::size_t z0, z1;
+    };
+
+public:
+    class RunRange;
+
+    /**
+     * Constructs array with given dimentions and allocator.
+     * Arguments have the same meaning as for @c SolidArray3d constructor.
+     */
+    BitArray3d(
+        IndexType countX,
+        IndexType countY,
+        IndexType countZ,
+        bool fillValue,
+        Allocator* allocator = 0)
+        throw(std::bad_alloc, std::range_error) {
+
+        const IndexType zero = 0;
+        if (countX <= zero || countY <= zero || countZ <= zero)
+            throw std::range_error("wrong array count");
+
+        mBeginX      = 0;
+        mBeginY      = 0;
+        mBeginZ      = 0;
+        mCountX      = countX;
+        mCountY      = countY;
+        mCountZ      = countZ;
+        mRowWords    = (static_cast<std::size_t>(countZ) + WORD_BITS - 1)
+                            / WORD_BITS;
+        mWordCount   = static_cast<std::size_t>(countX) * countY * mRowWords;
+        mOffsetDX    = static_cast<std::size_t>(countY) * mRowWords * WORD_BITS;
+        mOffsetDY    = mRowWords * WORD_BITS;
+        mAllocator   = allocator ? allocator
+                                 : static_cast<Allocator*>(&mStdAllocator);
+
+        mWords = static_cast<WordType*>(
+                    mAllocator->allocate(mWordCount * sizeof(WordType)));
+        fill(fillValue);
+    }
+
+    // NB: Ranges are semi-inclusive: [start, stop).
+    BitArray3d(
+            HalfOpenRange<TIndex> const& xRange,
+            HalfOpenRange<TIndex> const& yRange,
+            HalfOpenRange<TIndex> const& zRange,
+            bool fillValue,
+            Allocator* allocator = 0)
+            throw(std::bad_alloc, std::range_error)
+                : BitArray3d(xRange.size(),
+                             yRange.size(),
+                             zRange.size(),
+                             fillValue,
+                             allocator) {
+
+        mBeginX = xRange.start;
+        mBeginY = yRange.start;
+        mBeginZ = zRange.start;
+    }
+
+    ~BitArray3d() {
+        mAllocator->deallocate(mWords);
+    }
+
+    void fill(bool val) {
+        std::fill(mWords, mWords + mWordCount, val ? ~WordType(0) : 0);
+        if (val)
+            clearPadding();
+    }
+
+    IndexType getBeginX() const { return mBeginX; }
+    IndexType getBeginY() const { return mBeginY; }
+    IndexType getBeginZ() const { return mBeginZ; }
+
+    IndexType getEndX() const { return mBeginX + mCountX; }
+    IndexType getEndY() const { return mBeginY + mCountY; }
+    IndexType getEndZ() const { return mBeginZ + mCountZ; }
+
+    IndexType getCountX() const { return mCountX; }
+    IndexType getCountY() const { return mCountY; }
+    IndexType getCountZ() const { return mCountZ; }
+
+    IndexType getTotalCount() const { return mCountX * mCountY * mCountZ; }
+
+    /**
+     * Gets number of words each row along @em Z occupies.
+     */
+    std::size_t getRowWordCount() const { return mRowWords; }
+
+    /**
+     * Gets raw words of row (@a ix, @a iy) for word-level kernels.
+     * Bit @c k of the row corresponds to item <tt>getBeginZ() + k</tt>.
+     */
+    WordType const* getRowWords(IndexType ix, IndexType iy) const {
+        return mWords + rowIndex(ix, iy) * mRowWords;
+    }
+
+    WordType* getRowWords(IndexType ix, IndexType iy) {
+        return mWords + rowIndex(ix, iy) * mRowWords;
+    }
+
+    /**
+     * Reads item by its coordinates.
+     */
+    bool at(IndexType ix, IndexType iy, IndexType iz) const {
+        return at(getCursor(ix, iy, iz));
+    }
+
+    /**
+     * Writes item by its coordinates.
+     */
+    void set(IndexType ix, IndexType iy, IndexType iz, bool val) {
+        set(getCursor(ix, iy, iz), val);
+    }
+
+    template <int Axis0, int Axis1, int Axis2>
+    CursorType getCursorX(IndexType i0, IndexType i1, IndexType i2) const {
+        return detail::GetCursorHelper<ThisType, Axis0, Axis1, Axis2>
+                     ::get(*this, i0, i1, i2);
+    }
+
+    /**
+     * Reads item pointed by cursor.
+     * @see REF_SECTION_CURSORS
+     */
+    bool at(CursorType cursor) const {
+        return (mWords[cursor / WORD_BITS] >> (cursor % WORD_BITS)) & 1;
+    }
+
+    /**
+     * Writes item pointed by cursor.
+     * @see REF_SECTION_CURSORS
+     */
+    void set(CursorType cursor, bool val) {
+        WordType mask = WordType(1) << (cursor % WORD_BITS);
+        WordType& word = mWords[cursor / WORD_BITS];
+        word = val ? (word | mask) : (word & ~mask);
+    }
+
+    CursorType getCursor(IndexType ix, IndexType iy, IndexType iz) const {
+        std::size_t aiz = boost::numeric_cast<std::size_t>(iz - mBeginZ);
+        if (aiz >= static_cast<std::size_t>(mCountZ))
+            throw std::out_of_range("bit array index out of range");
+        return rowIndex(ix, iy) * mOffsetDY + aiz;
+    }
+
+    void cursorMoveTo(
+        CursorType& cursor, IndexType ix, IndexType iy, IndexType iz) const {
+        cursor = getCursor(ix, iy, iz);
+    }
+
+    void cursorMoveToPrevX(CursorType& cursor) const { cursor -= mOffsetDX; }
+    void cursorMoveToNextX(CursorType& cursor) const { cursor += mOffsetDX; }
+    void cursorMoveToPrevY(CursorType& cursor) const { cursor -= mOffsetDY; }
+    void cursorMoveToNextY(CursorType& cursor) const { cursor += mOffsetDY; }
+    void cursorMoveToPrevZ(CursorType& cursor) const { --cursor; }
+    void cursorMoveToNextZ(CursorType& cursor) const { ++cursor; }
+
+    template <int Axis>
+    void cursorMoveToNext(CursorType& cursor) const {
+        detail::MoveCursorHelper<ThisType, Axis>
+              ::moveToNext(*this, cursor);
+    }
+
+    template <int Axis>
+    void cursorMoveToPrev(CursorType& cursor) const {
+        detail::MoveCursorHelper<ThisType, Axis>
+              ::moveToPrev(*this, cursor);
+    }
+
+    void cursorCoordinates(CursorType cursor,
+                           IndexType& ix, IndexType& iy, IndexType& iz) const {
+        iz = static_cast<IndexType>(cursor % mOffsetDY) + mBeginZ;
+        cursor /= mOffsetDY;
+        iy = static_cast<IndexType>(cursor % mCountY) + mBeginY;
+        ix = static_cast<IndexType>(cursor / mCountY) + mBeginX;
+    }
+
+    /**
+     * Intersects this mask with @a other, which must have the same geometry.
+     */
+    ThisType& operator &= (ThisType const& other) {
+        checkSameGeometry(other);
+        for (std::size_t i = 0; i < mWordCount; ++i)
+            mWords[i] &= other.mWords[i];
+        return *this;
+    }
+
+    /**
+     * Unites this mask with @a other, which must have the same geometry.
+     */
+    ThisType& operator |= (ThisType const& other) {
+        checkSameGeometry(other);
+        for (std::size_t i = 0; i < mWordCount; ++i)
+            mWords[i] |= other.mWords[i];
+        return *this;
+    }
+
+    /**
+     * Computes symmetric difference with @a other of the same geometry.
+     */
+    ThisType& operator ^= (ThisType const& other) {
+        checkSameGeometry(other);
+        for (std::size_t i = 0; i < mWordCount; ++i)
+            mWords[i] ^= other.mWords[i];
+        return *this;
+    }
+
+    /**
+     * Clears all items which are set in @a other (@em and-not operation).
+     */
+    ThisType& operator -= (ThisType const& other) {
+        checkSameGeometry(other);
+        for (std::size_t i = 0; i < mWordCount; ++i)
+            mWords[i] &= ~other.mWords[i];
+        return *this;
+    }
+
+    /**
+     * Inverts every item of the mask.
+     */
+    void invert() {
+        for (std::size_t i = 0; i < mWordCount; ++i)
+            mWords[i] = ~mWords[i];
+        clearPadding();
+    }
+
+    /**
+     * Returns number of set items in the whole array.
+     */
+    std::size_t count() const {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < mWordCount; ++i)
+            result += detail::popCount(mWords[i]);
+        return result;
+    }
+
+    /**
+     * Returns number of set items within the box. Ranges are given in
+     * global coordinates and are clipped to the array extents.
+     */
+    std::size_t count(HalfOpenRange<TIndex> const& xRange,
+                      HalfOpenRange<TIndex> const& yRange,
+                      HalfOpenRange<TIndex> const& zRange) const {
+        Box box = clip(xRange, yRange, zRange);
+        std::size_t result = 0;
+        for (IndexType ix = box.x0; ix < box.x1; ++ix)
+        for (IndexType iy = box.y0; iy < box.y1; ++iy)
+            result += countInRow(getRowWords(ix, iy), box.z0, box.z1);
+        return result;
+    }
+
+    /**
+     * Forward iterator over runs of set items, row by row.
+     * Both set and unset stretches are skipped a word at a time, so sparse
+     * masks are traversed in time proportional to their storage size rather
+     * than to the number of cells.
+     */
+    class RunIterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Run                       value_type;
+        typedef std::ptrdiff_t            difference_type;
+        typedef Run const*                pointer;
+        typedef Run const&                reference;
+
+        Run const& operator * () const { return mRun; }
+        Run const* operator -> () const { return &mRun; }
+
+        RunIterator& operator ++ () {
+            findNext(mPosition);
+            return *this;
+        }
+
+        RunIterator operator ++ (int) {
+            RunIterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        bool operator == (RunIterator const& other) const {
+            return mDone == other.mDone &&
+                   (mDone || (mRun.ix     == other.mRun.ix &&
+                              mRun.iy     == other.mRun.iy &&
+                              mRun.startZ == other.mRun.startZ));
+        }
+
+        bool operator != (RunIterator const& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        RunIterator(ThisType const* array, Box const& box, bool done)
+                : mArray(array), mBox(box), mDone(done) {
+            mRun.ix = box.x0;
+            mRun.iy = box.y0;
+            if (!mDone)
+                findNext(box.z0);
+        }
+
+        // Searches for the next run starting at local position 'from' of the
+        // current row, then proceeds to the following rows.
+        void findNext(std::size_t from) {
+            while (!mDone) {
+                if (mRun.ix < mBox.x1 && mRun.iy < mBox.y1) {
+                    WordType const* row = mArray->getRowWords(mRun.ix, mRun.iy);
+                    std::size_t start = findBit(row, from, mBox.z1, false);
+                    if (start < mBox.z1) {
+                        mPosition   = findBit(row, start, mBox.z1, true);
+                        mRun.startZ = static_cast<IndexType>(start) + mArray->mBeginZ;
+                        mRun.stopZ  = static_cast<IndexType>(mPosition) + mArray->mBeginZ;
+                        return;
+                    }
+                }
+
+                from = mBox.z0;
+                if (++mRun.iy >= mBox.y1) {
+                    mRun.iy = mBox.y0;
+                    if (++mRun.ix >= mBox.x1)
+                        mDone = true;
+                }
+            }
+        }
+
+        ThisType const* mArray;
+        Box             mBox;
+        Run             mRun;
+        std::size_t     mPosition;
+        bool            mDone;
+
+        friend class RunRange;
+    };
+
+    /**
+     * Range of runs of set items, usable in range-based @c for loops.
+     */
+    class RunRange {
+    public:
+        RunIterator begin() const { return RunIterator(mArray, mBox, mEmpty); }
+        RunIterator end()   const { return RunIterator(mArray, mBox, true); }
+
+    private:
+        RunRange(ThisType const* array, Box const& box)
+                : mArray(array), mBox(box),
+                  mEmpty(box.x0 >= box.x1 || box.y0 >= box.y1 ||
+                         box.z0 >= box.z1) {}
+
+        ThisType const* mArray;
+        Box             mBox;
+        bool            mEmpty;
+
+        friend class BitArray3d<TIndex>;
+    };
+
+    /**
+     * Returns runs of set items of the whole array:
+     * @code
+     *     for (auto const& run: mask.runs())
+     *         for (auto iz = run.startZ; iz < run.stopZ; ++iz)
+     *             update(run.ix, run.iy, iz);
+     * @endcode
+     */
+    RunRange runs() const {
+        return RunRange(this, Box{mBeginX, getEndX(), mBeginY, getEndY(),
+                                  0, static_cast<std::size_t>(mCountZ)});
+    }
+
+    /**
+     * Returns runs of set items within the box, clipped to array extents.
+     * Runs are clipped to the box as well.
+     */
+    RunRange runs(HalfOpenRange<TIndex> const& xRange,
+                  HalfOpenRange<TIndex> const& yRange,
+                  HalfOpenRange<TIndex> const& zRange) const {
+        return RunRange(this, clip(xRange, yRange, zRange));
+    }
+
+private:
+
+    Box clip(HalfOpenRange<TIndex> const& xRange,
+             HalfOpenRange<TIndex> const& yRange,
+             HalfOpenRange<TIndex> const& zRange) const {
+        IndexType z0 = std::max(zRange.start, mBeginZ);
+        IndexType z1 = std::min(zRange.stop,  getEndZ());
+        Box box;
+        box.x0 = std::max(xRange.start, mBeginX);
+        box.x1 = std::min(xRange.stop,  getEndX());
+        box.y0 = std::max(yRange.start, mBeginY);
+        box.y1 = std::min(yRange.stop,  getEndY());
+        box.z0 = static_cast<std::size_t>(z0 - mBeginZ);
+        box.z1 = z0 < z1 ? static_cast<std::size_t>(z1 - mBeginZ) : box.z0;
+        return box;
+    }
+
+    std::size_t rowIndex(IndexType ix, IndexType iy) const {
+        std::size_t aix = boost::numeric_cast<std::size_t>(ix - mBeginX);
+        std::size_t aiy = boost::numeric_cast<std::size_t>(iy - mBeginY);
+        if (aix >= static_cast<std::size_t>(mCountX) ||
+            aiy >= static_cast<std::size_t>(mCountY))
+            throw std::out_of_range("bit array index out of range");
+        return aix * mCountY + aiy;
+    }
+
+    /**
+     * @internal
+     * Returns mask of bits [from, WORD_BITS) of a word.
+     */
+    static WordType maskFrom(std::size_t from) {
+        return ~WordType(0) << from;
+    }
+
+    /**
+     * @internal
+     * Returns position of the first bit in [from, to) of the row, which is
+     * set (or clear, if @a inverted). Returns @a to if there is no such bit.
+     */
+    static std::size_t findBit(WordType const* row,
+                               std::size_t from, std::size_t to,
+                               bool inverted) {
+        if (from >= to)
+            return to;
+
+        std::size_t w = from / WORD_BITS;
+        std::size_t lastWord = (to - 1) / WORD_BITS;
+        WordType flip = inverted ? ~WordType(0) : 0;
+        WordType word = (row[w] ^ flip) & maskFrom(from % WORD_BITS);
+        while (word == 0) {
+            if (++w > lastWord)
+                return to;
+            word = row[w] ^ flip;
+        }
+
+        return std::min(to, w * WORD_BITS + detail::countTrailingZeros(word));
+    }
+
+    static std::size_t countInRow(WordType const* row,
+                                  std::size_t from, std::size_t to) {
+        if (from >= to)
+            return 0;
+
+        std::size_t w0 = from / WORD_BITS;
+        std::size_t w1 = (to - 1) / WORD_BITS;
+        WordType first = maskFrom(from % WORD_BITS);
+        WordType last  = ~WordType(0) >> (WORD_BITS - 1 - (to - 1) % WORD_BITS);
+        if (w0 == w1)
+            return detail::popCount(row[w0] & first & last);
+
+        std::size_t result = detail::popCount(row[w0] & first);
+        for (std::size_t w = w0 + 1; w < w1; ++w)
+            result += detail::popCount(row[w]);
+        return result + detail::popCount(row[w1] & last);
+    }
+
+    void clearPadding() {
+        std::size_t tail = static_cast<std::size_t>(mCountZ) % WORD_BITS;
+        if (tail == 0)
+            return;
+
+        WordType mask = ~maskFrom(tail);
+        for (std::size_t w = mRowWords - 1; w < mWordCount; w += mRowWords)
+            mWords[w] &= mask;
+    }
+
+    void checkSameGeometry(ThisType const& other) const {
+        if (mCountX != other.mCountX || mCountY != other.mCountY ||
+            mCountZ != other.mCountZ)
+            throw std::invalid_argument("bit array geometry mismatch");
+    }
+
+    IndexType      mBeginX;
+    IndexType      mBeginY;
+    IndexType      mBeginZ;
+    IndexType      mCountX;
+    IndexType      mCountY;
+    IndexType      mCountZ;
+    std::size_t    mRowWords;
+    std::size_t    mWordCount;
+    std::size_t    mOffsetDX;
+    std::size_t    mOffsetDY;
+    Allocator*     mAllocator;
+    WordType*      mWords;
+    StandardAllocator mStdAllocator;
+};
+
+} // namespace core
+} // namespace rvlm
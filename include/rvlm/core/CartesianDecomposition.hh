@@ -0,0 +1,254 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/HalfOpenRange.hh"
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/SolidArray3d.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Partition of a global box of cells into a Cartesian grid of subdomains,
+ * one per process.
+ *
+ * Processes are numbered in row-major order of their grid coordinates,
+ * with @em X being the slowest, the same way @c MPI_Cart_create does. Cell
+ * ranges along every axis are split as evenly as possible, so subdomain
+ * sizes differ by one cell at most. The class is pure index arithmetic and
+ * does not depend on any communication library.
+ */
+class CartesianDecomposition {
+public:
+
+    typedef IndexBox<std::ptrdiff_t> Box;
+
+    /**
+     * Partitions @a global box between @a processCount processes. Process
+     * grid is chosen to minimize the total area of subdomain faces, that is
+     * the amount of halo data to exchange. Throws @c std::invalid_argument
+     * if the box cannot be split into that many non-empty parts.
+     */
+    CartesianDecomposition(Box const& global, int processCount)
+            : mGlobal(global), mDims{1, 1, 1} {
+        if (processCount <= 0)
+            throw std::invalid_argument("process count must be positive");
+        if (!chooseDims(processCount))
+            throw std::invalid_argument("box is too small for process count");
+    }
+
+    /**
+     * Partitions @a global box with explicitly given process grid @a dims.
+     */
+    CartesianDecomposition(Box const& global, int const* dims)
+            : mGlobal(global), mDims{1, 1, 1} {
+        for (int axis = 0; axis < 3; ++axis) {
+            if (dims[axis] <= 0 || dims[axis] > global.size(axis))
+                throw std::invalid_argument("wrong process grid dimensions");
+            mDims[axis] = dims[axis];
+        }
+    }
+
+    Box const& getGlobalBox() const { return mGlobal; }
+
+    int getDim(int axis) const { return mDims[axis]; }
+
+    int getProcessCount() const { return mDims[0] * mDims[1] * mDims[2]; }
+
+    void coordsOf(int rank, int* coords) const {
+        coords[2] = rank % mDims[2];
+        rank /= mDims[2];
+        coords[1] = rank % mDims[1];
+        coords[0] = rank / mDims[1];
+    }
+
+    /**
+     * Gets rank of process with grid coordinates @a coords, or -1 if they
+     * lie outside of the process grid.
+     */
+    int rankOf(int const* coords) const {
+        for (int axis = 0; axis < 3; ++axis) {
+            if (coords[axis] < 0 || coords[axis] >= mDims[axis])
+                return -1;
+        }
+        return (coords[0]*mDims[1] + coords[1])*mDims[2] + coords[2];
+    }
+
+    /**
+     * Gets rank of the neighbour of process @a rank along @a axis in
+     * @a direction, which is either -1 or +1. Returns -1 at the boundary of
+     * the global box, as decompositions are not periodic.
+     */
+    int neighbor(int rank, int axis, int direction) const {
+        int coords[3];
+        coordsOf(rank, coords);
+        coords[axis] += direction;
+        return rankOf(coords);
+    }
+
+    /**
+     * Gets the smallest number of cells owned by any process along
+     * @a axis. Ranges are split evenly, so this is the same for all
+     * processes to compute and some process owns exactly that many.
+     */
+    std::ptrdiff_t minOwnedSize(int axis) const {
+        return mGlobal.size(axis) / mDims[axis];
+    }
+
+    /**
+     * Gets box of cells owned by process @a rank.
+     */
+    Box ownedBox(int rank) const {
+        int coords[3];
+        coordsOf(rank, coords);
+        std::ptrdiff_t start[3], stop[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            std::ptrdiff_t n = mGlobal.size(axis);
+            start[axis] = mGlobal.start[axis] + n *  coords[axis]      / mDims[axis];
+            stop[axis]  = mGlobal.start[axis] + n * (coords[axis] + 1) / mDims[axis];
+        }
+        return Box(start[0], stop[0], start[1], stop[1], start[2], stop[2]);
+    }
+
+private:
+
+    bool chooseDims(int processCount) {
+        double bestArea = std::numeric_limits<double>::infinity();
+        for (int a = 1; a <= processCount; ++a) {
+            if (processCount % a != 0)
+                continue;
+            for (int b = 1; b <= processCount / a; ++b) {
+                if ((processCount / a) % b != 0)
+                    continue;
+                int dims[3] = { a, b, processCount / a / b };
+                if (dims[0] > mGlobal.size(0) || dims[1] > mGlobal.size(1) ||
+                    dims[2] > mGlobal.size(2))
+                    continue;
+
+                // Every cut perpendicular to an axis adds one face area.
+                double area = 0;
+                for (int axis = 0; axis < 3; ++axis) {
+                    double face = static_cast<double>(mGlobal.size((axis + 1) % 3))
+                                * static_cast<double>(mGlobal.size((axis + 2) % 3));
+                    area += (dims[axis] - 1) * face;
+                }
+                if (area < bestArea) {
+                    bestArea = area;
+                    mDims[0] = dims[0];
+                    mDims[1] = dims[1];
+                    mDims[2] = dims[2];
+                }
+            }
+        }
+        return bestArea != std::numeric_limits<double>::infinity();
+    }
+
+    Box mGlobal;
+    int mDims[3];
+};
+
+/**
+ * Part of a decomposed grid stored by one process: the owned box of cells
+ * surrounded by @em halo layers on every side, in a @c SolidArray3d
+ * addressed by global indices.
+ *
+ * Halo cells mirror owned cells of neighbouring processes after exchange,
+ * and stay untouched at the boundary of the global box. The owned box is
+ * further split into the interior, whose cells do not depend on halos in
+ * stencils up to @em halo cells wide, and the boundary shell. Computing the
+ * interior while halos are in flight hides communication latency.
+ */
+template <typename TValue>
+class Subdomain {
+public:
+
+    typedef SolidArray3d<TValue, std::ptrdiff_t> Array;
+    typedef CartesianDecomposition::Box          Box;
+    typedef HalfOpenRange<std::ptrdiff_t>        Range;
+
+    Subdomain(CartesianDecomposition const& decomposition, int rank,
+              int halo, TValue const& fillValue = TValue())
+        : mDecomposition(decomposition), mRank(rank), mHalo(checkHalo(halo)),
+          mOwned(decomposition.ownedBox(rank)),
+          mArray(Range(mOwned.start[0] - halo, mOwned.stop[0] + halo),
+                 Range(mOwned.start[1] - halo, mOwned.stop[1] + halo),
+                 Range(mOwned.start[2] - halo, mOwned.stop[2] + halo),
+                 fillValue) {}
+
+    CartesianDecomposition const& getDecomposition() const { return mDecomposition; }
+
+    int getRank() const { return mRank; }
+
+    int getHalo() const { return mHalo; }
+
+    Array& getArray() { return mArray; }
+
+    Array const& getArray() const { return mArray; }
+
+    Box const& getOwnedBox() const { return mOwned; }
+
+    /**
+     * Gets owned cells at least @em halo cells away from faces shared with
+     * other processes. Faces on the global boundary are not shrunk, since
+     * nothing is exchanged there.
+     */
+    Box getInteriorBox() const {
+        Box box = mOwned;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (mDecomposition.neighbor(mRank, axis, -1) >= 0)
+                box.start[axis] += mHalo;
+            if (mDecomposition.neighbor(mRank, axis, +1) >= 0)
+                box.stop[axis] -= mHalo;
+        }
+        return Box(box.start[0], box.stop[0], box.start[1], box.stop[1],
+                   box.start[2], box.stop[2]).intersect(mOwned);
+    }
+
+    /**
+     * Splits owned cells outside of the interior into at most six disjoint
+     * non-empty slabs, which together with the interior cover the owned box.
+     */
+    std::vector<Box> getBoundaryBoxes() const {
+        std::vector<Box> result;
+        Box rest = mOwned;
+        Box interior = getInteriorBox();
+        for (int axis = 0; axis < 3; ++axis) {
+            std::ptrdiff_t lo = std::min(std::max(interior.start[axis],
+                                                  rest.start[axis]), rest.stop[axis]);
+            std::ptrdiff_t hi = std::min(std::max(interior.stop[axis], lo),
+                                         rest.stop[axis]);
+            Box lower = rest, upper = rest;
+            lower.stop[axis]  = lo;
+            upper.start[axis] = hi;
+            if (!lower.empty()) result.push_back(lower);
+            if (!upper.empty()) result.push_back(upper);
+            rest.start[axis] = lo;
+            rest.stop[axis]  = hi;
+        }
+        return result;
+    }
+
+private:
+
+    /**
+     * @internal
+     * Validates halo width before the array is sized by it.
+     */
+    static int checkHalo(int halo) {
+        if (halo < 0)
+            throw std::invalid_argument("halo width must not be negative");
+        return halo;
+    }
+
+    CartesianDecomposition mDecomposition;
+    int   mRank;
+    int   mHalo;
+    Box   mOwned;
+    Array mArray;
+};
+
+} // namespace core
+} // namespace rvlm
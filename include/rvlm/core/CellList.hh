@@ -0,0 +1,222 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/Algorithms3d.hh"
+#include "rvlm/core/BitArray3d.hh"
+#include "rvlm/core/CellOffsets.hh"
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/NonAssignable.hh"
+#include "rvlm/core/SolidArray3d.hh"
+#include "rvlm/core/detail/BitOps.hh"
+#include "rvlm/core/detail/IndexSequence.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Compacted per-cell state of a sparse set of cells, like polarization
+ * history of dispersive or nonlinear materials filling a small part of the
+ * grid: a list of linear offsets of the cells into arrays covering some
+ * box, with @a NState state items per cell stored structure of arrays.
+ *
+ * Offsets are the same as @c CellOffsets holds and are kept in ascending
+ * order, which is the order of cells in memory, so that batched access to
+ * parent arrays with @c updateCells, @c gather or @c scatter streams
+ * through them. State items of cell @em i are at index @em i of every
+ * state column.
+ */
+template <typename TValue, std::size_t NState>
+class CellList: public NonAssignable {
+public:
+
+    typedef IndexBox<std::ptrdiff_t> Box;
+
+    static const std::size_t STATE_COUNT = NState;
+
+    /**
+     * Constructs list of set cells of @a mask, with all state items equal
+     * to @a fillValue. Planes of the mask along @em X are scanned in
+     * parallel when OpenMP is available.
+     */
+    template <typename TIndex>
+    explicit CellList(BitArray3d<TIndex> const& mask,
+                      TValue const& fillValue = TValue())
+            : mBox(mask.getBox()) {
+        typedef typename BitArray3d<TIndex>::WordType Word;
+        const std::ptrdiff_t planes = mBox.size(0), rows = mBox.size(1);
+        const std::size_t rowWords = mask.getRowWordCount();
+        const std::size_t cz = static_cast<std::size_t>(mBox.size(2));
+
+        // Cells of each plane are counted first, then written at offsets
+        // given by the prefix sum of counts, so every plane is filled by
+        // one thread and the list comes out sorted.
+        std::vector<std::size_t> first(static_cast<std::size_t>(planes) + 1, 0);
+        #pragma omp parallel for schedule(static)
+        for (std::ptrdiff_t px = 0; px < planes; ++px) {
+            std::size_t n = 0;
+            for (std::ptrdiff_t py = 0; py < rows; ++py) {
+                Word const* row = mask.getRowWords(
+                        static_cast<TIndex>(mBox.start[0] + px),
+                        static_cast<TIndex>(mBox.start[1] + py));
+                for (std::size_t w = 0; w < rowWords; ++w)
+                    n += detail::popCount(row[w]);
+            }
+            first[px + 1] = n;
+        }
+        for (std::ptrdiff_t px = 0; px < planes; ++px)
+            first[px + 1] += first[px];
+
+        mOffsets.resize(first.back());
+        #pragma omp parallel for schedule(static)
+        for (std::ptrdiff_t px = 0; px < planes; ++px) {
+            std::size_t* out = mOffsets.data() + first[px];
+            for (std::ptrdiff_t py = 0; py < rows; ++py) {
+                Word const* row = mask.getRowWords(
+                        static_cast<TIndex>(mBox.start[0] + px),
+                        static_cast<TIndex>(mBox.start[1] + py));
+                const std::size_t base = (px * rows + py) * cz;
+                for (std::size_t w = 0; w < rowWords; ++w) {
+                    for (Word bits = row[w]; bits != 0; bits &= bits - 1)
+                        *out++ = base + w * BitArray3d<TIndex>::WORD_BITS
+                                      + detail::countTrailingZeros(bits);
+                }
+            }
+        }
+
+        for (std::size_t s = 0; s < NState; ++s)
+            mState[s].assign(mOffsets.size(), fillValue);
+    }
+
+    std::size_t size() const { return mOffsets.size(); }
+
+    bool empty() const { return mOffsets.empty(); }
+
+    Box const& getBox() const { return mBox; }
+
+    /**
+     * Gets ascending offsets of all cells, for use with raw-offset
+     * @c gather and @c scatter on other arrays of the same box.
+     */
+    std::size_t const* getOffsets() const { return mOffsets.data(); }
+
+    /**
+     * Gets state column @a s, with @c size() items.
+     */
+    TValue* getState(std::size_t s) { return mState[s].data(); }
+
+    TValue const* getState(std::size_t s) const { return mState[s].data(); }
+
+    /**
+     * Finds position of cell with given coordinates in the list, by binary
+     * search. Returns @c size() if the cell is not listed.
+     */
+    std::size_t find(std::ptrdiff_t ix, std::ptrdiff_t iy, std::ptrdiff_t iz) const {
+        if (!mBox.contains(ix, iy, iz))
+            return size();
+        const std::size_t offset = static_cast<std::size_t>(
+                ((ix - mBox.start[0]) * mBox.size(1) +
+                 (iy - mBox.start[1])) * mBox.size(2) +
+                 (iz - mBox.start[2]));
+        std::vector<std::size_t>::const_iterator it =
+                std::lower_bound(mOffsets.begin(), mOffsets.end(), offset);
+        return it != mOffsets.end() && *it == offset
+                ? static_cast<std::size_t>(it - mOffsets.begin()) : size();
+    }
+
+    /**
+     * Throws @c std::invalid_argument unless offsets are valid for @a array.
+     */
+    template <typename TArray>
+    void requireGeometryOf(TArray const& array) const {
+        if (array.getBox() != mBox)
+            throw std::invalid_argument("array geometry differs from cell list");
+    }
+
+private:
+    Box                                     mBox;
+    std::vector<std::size_t>                mOffsets;
+    std::array<std::vector<TValue>, NState> mState;
+};
+
+namespace detail {
+
+/**
+ * @internal
+ * Number of cells @c updateCells gathers into a local buffer at once;
+ * buffers of a few fields stay in L1 cache.
+ */
+const std::size_t CELL_BLOCK = 256;
+
+template <typename TFunc, typename TValue, std::size_t... Fs, std::size_t... Ss>
+inline void updateCellBlock(TFunc& func, TValue (*fields)[CELL_BLOCK],
+                            TValue* const* state, std::size_t count,
+                            IndexSequence<Fs...>, IndexSequence<Ss...>) {
+    for (std::size_t k = 0; k < count; ++k)
+        func(fields[Fs][k]..., state[Ss][k]...);
+}
+
+} // namespace detail
+
+/**
+ * Calls <tt>func(a[c], b[c], ..., s0[i], s1[i], ...)</tt> for every cell
+ * @em c listed at position @em i of @a cells, with items of all @a arrays
+ * at that cell followed by its state items; changes to array items are
+ * written back. Arrays must have the same box as @a cells, otherwise
+ * @c std::invalid_argument is thrown.
+ *
+ * Cells are processed in blocks: items of the arrays are gathered into
+ * small buffers, updated by a plain loop over buffers and state columns,
+ * which the compiler vectorizes, and scattered back, using vector gather
+ * and scatter instructions where @c gather and @c scatter do. Since listed
+ * offsets are distinct, scattering needs no conflict handling. In parallel
+ * mode blocks are split between OpenMP threads.
+ */
+template <typename TFunc, typename TValue, std::size_t NState, typename... TIndices>
+void updateCells(Execution exec, CellList<TValue, NState>& cells, TFunc func,
+                 SolidArray3d<TValue, TIndices>&... arrays) {
+    typedef detail::MakeIndexSequence<sizeof...(TIndices)> Fields;
+    typedef detail::MakeIndexSequence<NState>              States;
+    const std::size_t BLOCK = detail::CELL_BLOCK;
+    const std::size_t FIELDS = sizeof...(TIndices) > 0 ? sizeof...(TIndices) : 1;
+
+    if (!detail::allOf((arrays.getBox() == cells.getBox())...))
+        throw std::invalid_argument("array geometry differs from cell list");
+    TValue* bases[FIELDS] = { arrays.getOrigin()... };
+    TValue* columns[NState > 0 ? NState : 1];
+    for (std::size_t s = 0; s < NState; ++s)
+        columns[s] = cells.getState(s);
+
+    std::size_t const* offsets = cells.getOffsets();
+    const std::ptrdiff_t blocks = static_cast<std::ptrdiff_t>(
+            (cells.size() + BLOCK - 1) / BLOCK);
+
+    #pragma omp parallel for schedule(static) if(exec == Execution::Parallel)
+    for (std::ptrdiff_t b = 0; b < blocks; ++b) {
+        const std::size_t start = static_cast<std::size_t>(b) * BLOCK;
+        const std::size_t count = std::min(BLOCK, cells.size() - start);
+        TValue buffers[FIELDS][BLOCK];
+        TValue* state[NState > 0 ? NState : 1];
+        for (std::size_t s = 0; s < NState; ++s)
+            state[s] = columns[s] + start;
+
+        for (std::size_t f = 0; f < sizeof...(TIndices); ++f)
+            detail::BatchAccess<TValue>::gather(bases[f], offsets + start,
+                                                count, buffers[f]);
+        detail::updateCellBlock(func, buffers, state, count, Fields(), States());
+        for (std::size_t f = 0; f < sizeof...(TIndices); ++f)
+            detail::BatchAccess<TValue>::scatter(bases[f], offsets + start,
+                                                 count, buffers[f]);
+    }
+}
+
+template <typename TFunc, typename TValue, std::size_t NState, typename... TIndices>
+void updateCells(CellList<TValue, NState>& cells, TFunc func,
+                 SolidArray3d<TValue, TIndices>&... arrays) {
+    updateCells(Execution::Sequential, cells, func, arrays...);
+}
+
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,203 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/SolidArray3d.hh"
+#include "rvlm/core/detail/Simd.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * List of cells of an array geometry, stored as linear offsets into array
+ * storage, for batched access with @c gather, @c scatter and @c scatterAdd.
+ *
+ * Coordinates are range-checked once, when cells are added, and turned into
+ * the same offsets as @c SolidArray3d::getOffset gives. Since offsets depend
+ * only on the box covered by an array, a list built once (e.g. for probes,
+ * sources or boundary cells) may be reused at every time step and for every
+ * field component stored in arrays with the same box. Batched functions
+ * only check that the box matches, not individual offsets.
+ */
+class CellOffsets {
+public:
+
+    typedef IndexBox<std::ptrdiff_t> Box;
+
+    /**
+     * Constructs empty list for arrays covering @a box.
+     */
+    explicit CellOffsets(Box const& box)
+        : mBox(box) {}
+
+    /**
+     * Constructs list of @a count cells of @a array with coordinates given
+     * in separate arrays @a ix, @a iy and @a iz. Throws @c std::out_of_range
+     * if some cell lies outside of the array.
+     */
+    template <typename TArray, typename TCoord>
+    CellOffsets(TArray const& array, TCoord const* ix, TCoord const* iy,
+                TCoord const* iz, std::size_t count)
+            : mBox(array.getBox()) {
+        mOffsets.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            push(ix[i], iy[i], iz[i]);
+    }
+
+    /**
+     * Appends cell with given coordinates to the list.
+     */
+    void push(std::ptrdiff_t ix, std::ptrdiff_t iy, std::ptrdiff_t iz) {
+        if (!mBox.contains(ix, iy, iz))
+            throw std::out_of_range("cell is outside of array");
+        mOffsets.push_back(static_cast<std::size_t>(
+                ((ix - mBox.start[0]) * mBox.size(1) +
+                 (iy - mBox.start[1])) * mBox.size(2) +
+                 (iz - mBox.start[2])));
+    }
+
+    void clear() { mOffsets.clear(); }
+
+    std::size_t size() const { return mOffsets.size(); }
+
+    bool empty() const { return mOffsets.empty(); }
+
+    std::size_t const* data() const { return mOffsets.data(); }
+
+    std::size_t operator [] (std::size_t i) const { return mOffsets[i]; }
+
+    Box const& getBox() const { return mBox; }
+
+    /**
+     * Throws @c std::invalid_argument unless offsets are valid for @a array.
+     */
+    template <typename TArray>
+    void requireGeometryOf(TArray const& array) const {
+        if (array.getBox() != mBox)
+            throw std::invalid_argument("array geometry differs from offsets");
+    }
+
+private:
+    Box                      mBox;
+    std::vector<std::size_t> mOffsets;
+};
+
+namespace detail {
+
+template <typename T, std::size_t W = NativeSimdWidth<T>::value>
+struct BatchAccess {
+    typedef SimdTraits<T, W> Simd;
+
+    static void gather(T const* base, std::size_t const* offsets,
+                       std::size_t count, T* out) {
+        std::size_t i = 0;
+        for (; i + W <= count; i += W)
+            Simd::store(out + i, Simd::gather(base, offsets + i));
+        for (; i < count; ++i)
+            out[i] = base[offsets[i]];
+    }
+
+    static void scatter(T* base, std::size_t const* offsets,
+                        std::size_t count, T const* in) {
+        std::size_t i = 0;
+        for (; i + W <= count; i += W)
+            Simd::scatter(base, offsets + i, Simd::load(in + i));
+        for (; i < count; ++i)
+            base[offsets[i]] = in[i];
+    }
+};
+
+} // namespace detail
+
+/**
+ * Copies items of @a array at raw @a offsets into @a count consecutive
+ * items of @a out. Offsets are not checked. For doubles and floats, AVX2
+ * and AVX-512 gather instructions are used when the compiler targets them.
+ */
+template <typename TValue, typename TIndex>
+void gather(SolidArray3d<TValue, TIndex> const& array,
+            std::size_t const* offsets, std::size_t count, TValue* out) {
+    detail::BatchAccess<TValue>::gather(array.getOrigin(), offsets, count, out);
+}
+
+/**
+ * Copies items of @a array at all cells of @a offsets into @a out, which
+ * must have room for <tt>offsets.size()</tt> items.
+ */
+template <typename TValue, typename TIndex>
+void gather(SolidArray3d<TValue, TIndex> const& array,
+            CellOffsets const& offsets, TValue* out) {
+    offsets.requireGeometryOf(array);
+    gather(array, offsets.data(), offsets.size(), out);
+}
+
+/**
+ * Copies @a count consecutive items of @a in into @a array at raw
+ * @a offsets. If offsets repeat, the item coming last in @a in wins.
+ */
+template <typename TValue, typename TIndex>
+void scatter(SolidArray3d<TValue, TIndex>& array, std::size_t const* offsets,
+             std::size_t count, TValue const* in) {
+    detail::BatchAccess<TValue>::scatter(array.getOrigin(), offsets, count, in);
+}
+
+template <typename TValue, typename TIndex>
+void scatter(SolidArray3d<TValue, TIndex>& array, CellOffsets const& offsets,
+             TValue const* in) {
+    offsets.requireGeometryOf(array);
+    scatter(array, offsets.data(), offsets.size(), in);
+}
+
+/**
+ * Adds @a count consecutive items of @a in to items of @a array at raw
+ * @a offsets. Repeating offsets accumulate all their contributions, so
+ * this is a plain loop rather than a vector gather-add-scatter.
+ */
+template <typename TValue, typename TIndex>
+void scatterAdd(SolidArray3d<TValue, TIndex>& array, std::size_t const* offsets,
+                std::size_t count, TValue const* in) {
+    TValue* base = array.getOrigin();
+    for (std::size_t i = 0; i < count; ++i)
+        base[offsets[i]] += in[i];
+}
+
+template <typename TValue, typename TIndex>
+void scatterAdd(SolidArray3d<TValue, TIndex>& array, CellOffsets const& offsets,
+                TValue const* in) {
+    offsets.requireGeometryOf(array);
+    scatterAdd(array, offsets.data(), offsets.size(), in);
+}
+
+/**
+ * Copies items of @a array at @a count cells with coordinates @a ix, @a iy
+ * and @a iz into @a out. For one-off access; cells visited repeatedly are
+ * better turned into @c CellOffsets once.
+ */
+template <typename TValue, typename TIndex, typename TCoord>
+void gather(SolidArray3d<TValue, TIndex> const& array, TCoord const* ix,
+            TCoord const* iy, TCoord const* iz, std::size_t count, TValue* out) {
+    // Offsets are computed in small blocks first, so that the range check
+    // does not stand between independent loads. One unsigned comparison
+    // per coordinate checks both range ends.
+    const std::size_t BLOCK = 256;
+    CellOffsets::Box box = array.getBox();
+    const std::size_t cx = box.size(0), cy = box.size(1), cz = box.size(2);
+    std::size_t offsets[BLOCK];
+    for (std::size_t first = 0; first < count; first += BLOCK) {
+        const std::size_t n = std::min(BLOCK, count - first);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t rx = static_cast<std::size_t>(ix[first+i] - box.start[0]);
+            std::size_t ry = static_cast<std::size_t>(iy[first+i] - box.start[1]);
+            std::size_t rz = static_cast<std::size_t>(iz[first+i] - box.start[2]);
+            if (rx >= cx || ry >= cy || rz >= cz)
+                throw std::out_of_range("cell is outside of array");
+            offsets[i] = (rx*cy + ry)*cz + rz;
+        }
+        gather(array, offsets, n, out + first);
+    }
+}
+
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,281 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "rvlm/core/DirtyBricks.hh"
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/SolidArray3d.hh"
+
+namespace rvlm {
+namespace core {
+
+namespace detail {
+
+/**
+ * @internal
+ * Header starting every checkpoint record. Records are written in native
+ * byte order and are meant for restarts on the same kind of machine.
+ */
+struct CheckpointHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t kind;        // 0 for base, 1 for delta
+    std::uint32_t valueSize;
+    std::uint32_t brickSize;
+    std::int64_t  box[6];
+    std::uint64_t sequence;    // 0 for base, n for n-th delta after it
+    std::uint64_t brickCount;  // bricks following a delta header
+
+    static const std::uint32_t VERSION = 1;
+    static const std::uint32_t BASE    = 0;
+    static const std::uint32_t DELTA   = 1;
+
+    static char const* signature() { return "RVLMCKPT"; }
+};
+
+inline void checkpointWrite(std::ostream& out, void const* data, std::size_t size) {
+    out.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+    if (!out)
+        throw std::runtime_error("checkpoint write failed");
+}
+
+inline void checkpointRead(std::istream& in, void* data, std::size_t size) {
+    in.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+    if (static_cast<std::size_t>(in.gcount()) != size)
+        throw std::runtime_error("checkpoint is truncated");
+}
+
+/**
+ * @internal
+ * Copies rows of @a box between @a array and stream, row by row, so that
+ * memory use does not grow with the array.
+ */
+template <typename TValue, typename TIndex>
+void writeBox(std::ostream& out, SolidArray3d<TValue, TIndex> const& array,
+              IndexBox<std::ptrdiff_t> const& box) {
+    for (std::ptrdiff_t ix = box.start[0]; ix < box.stop[0]; ++ix)
+    for (std::ptrdiff_t iy = box.start[1]; iy < box.stop[1]; ++iy) {
+        TValue const* row = array.getCursor(static_cast<TIndex>(ix),
+                                            static_cast<TIndex>(iy),
+                                            static_cast<TIndex>(box.start[2]));
+        checkpointWrite(out, row, static_cast<std::size_t>(box.size(2)) * sizeof(TValue));
+    }
+}
+
+template <typename TValue, typename TIndex>
+void readBox(std::istream& in, SolidArray3d<TValue, TIndex>& array,
+             IndexBox<std::ptrdiff_t> const& box) {
+    for (std::ptrdiff_t ix = box.start[0]; ix < box.stop[0]; ++ix)
+    for (std::ptrdiff_t iy = box.start[1]; iy < box.stop[1]; ++iy) {
+        TValue* row = array.getCursor(static_cast<TIndex>(ix),
+                                      static_cast<TIndex>(iy),
+                                      static_cast<TIndex>(box.start[2]));
+        checkpointRead(in, row, static_cast<std::size_t>(box.size(2)) * sizeof(TValue));
+    }
+}
+
+} // namespace detail
+
+/**
+ * Writer of incremental checkpoints of a @c SolidArray3d.
+ *
+ * A base record holds the whole array. Every following delta record holds
+ * only bricks marked in the @c DirtyBricks tracker since the previous
+ * record, base or delta, after which the tracker is cleared. Kernels
+ * writing the array must mark what they write; bricks left unmarked are
+ * assumed unchanged. State at any checkpoint is restored by
+ * @c CheckpointReader from the base and all deltas up to it, in order.
+ *
+ * Records go to any @c std::ostream, one record per stream or several in a
+ * row. I/O errors throw @c std::runtime_error.
+ *
+ * @code
+ *     DirtyBricks dirty(field.getBox());
+ *     CheckpointWriter<float> writer(field, dirty);
+ *     writer.writeBase(baseFile);
+ *     ...                         // kernels call dirty.markDirty(box)
+ *     writer.writeDelta(deltaFile);
+ * @endcode
+ */
+template <typename TValue, typename TIndex = std::size_t>
+class CheckpointWriter {
+public:
+
+    typedef SolidArray3d<TValue, TIndex> Array;
+
+    static_assert(std::is_trivially_copyable<TValue>::value,
+                  "checkpointed values must be trivially copyable");
+
+    /**
+     * Prepares writing @a array tracked by @a bricks, which must cover the
+     * same box. Both are referenced, not copied.
+     */
+    CheckpointWriter(Array const& array, DirtyBricks& bricks)
+            : mArray(array), mBricks(bricks), mSequence(0), mHasBase(false),
+              mLastBrickCount(0) {
+        if (bricks.getBox() != array.getBox())
+            throw std::invalid_argument("dirty bricks must cover the array");
+    }
+
+    /**
+     * Writes the whole array as a new base and clears the tracker.
+     */
+    void writeBase(std::ostream& out) {
+        detail::CheckpointHeader h = header(detail::CheckpointHeader::BASE, 0, 0);
+        detail::checkpointWrite(out, &h, sizeof(h));
+        detail::writeBox(out, mArray, mArray.getBox());
+        mBricks.clear();
+        mSequence = 0;
+        mHasBase = true;
+        mLastBrickCount = mBricks.getBrickCount();
+    }
+
+    /**
+     * Writes bricks changed since the previous record and clears the
+     * tracker. Each brick is its number followed by its values in box
+     * order. Throws @c std::logic_error if no base was written yet.
+     */
+    void writeDelta(std::ostream& out) {
+        if (!mHasBase)
+            throw std::logic_error("delta checkpoint needs a base");
+        std::vector<std::size_t> dirty = mBricks.getDirtyBricks();
+        detail::CheckpointHeader h = header(detail::CheckpointHeader::DELTA,
+                                            mSequence + 1, dirty.size());
+        detail::checkpointWrite(out, &h, sizeof(h));
+        for (std::size_t i = 0; i < dirty.size(); ++i) {
+            std::uint64_t brick = dirty[i];
+            detail::checkpointWrite(out, &brick, sizeof(brick));
+            detail::writeBox(out, mArray, mBricks.getBrickBox(dirty[i]));
+        }
+        mBricks.clear();
+        ++mSequence;
+        mLastBrickCount = dirty.size();
+    }
+
+    /**
+     * Gets number of deltas written since the last base.
+     */
+    std::size_t getSequence() const { return static_cast<std::size_t>(mSequence); }
+
+    /**
+     * Gets number of bricks stored by the last record; for a base, all of
+     * them.
+     */
+    std::size_t getLastBrickCount() const { return mLastBrickCount; }
+
+private:
+
+    detail::CheckpointHeader header(std::uint32_t kind, std::uint64_t sequence,
+                                    std::uint64_t brickCount) const {
+        detail::CheckpointHeader h;
+        std::memcpy(h.magic, detail::CheckpointHeader::signature(), sizeof(h.magic));
+        h.version = detail::CheckpointHeader::VERSION;
+        h.kind = kind;
+        h.valueSize = static_cast<std::uint32_t>(sizeof(TValue));
+        h.brickSize = static_cast<std::uint32_t>(mBricks.getBrickSize());
+        IndexBox<std::ptrdiff_t> box = mArray.getBox();
+        for (int axis = 0; axis < 3; ++axis) {
+            h.box[2*axis]     = box.start[axis];
+            h.box[2*axis + 1] = box.stop[axis];
+        }
+        h.sequence = sequence;
+        h.brickCount = brickCount;
+        return h;
+    }
+
+    Array const&  mArray;
+    DirtyBricks&  mBricks;
+    std::uint64_t mSequence;
+    bool          mHasBase;
+    std::size_t   mLastBrickCount;
+};
+
+/**
+ * Restores a @c SolidArray3d from records written by @c CheckpointWriter:
+ * a base followed by its deltas in the order they were written. Records
+ * of a different array geometry or value type, deltas out of order and
+ * damaged records throw @c std::runtime_error.
+ */
+template <typename TValue, typename TIndex = std::size_t>
+class CheckpointReader {
+public:
+
+    typedef SolidArray3d<TValue, TIndex> Array;
+
+    explicit CheckpointReader(Array& array)
+            : mArray(array), mSequence(0), mHasBase(false) {}
+
+    /**
+     * Reads base record into the array.
+     */
+    void readBase(std::istream& in) {
+        detail::CheckpointHeader h = readHeader(in);
+        if (h.kind != detail::CheckpointHeader::BASE)
+            throw std::runtime_error("checkpoint record is not a base");
+        detail::readBox(in, mArray, mArray.getBox());
+        mSequence = 0;
+        mHasBase = true;
+    }
+
+    /**
+     * Reads delta record following the base or the previous delta, and
+     * overwrites bricks it holds.
+     */
+    void readDelta(std::istream& in) {
+        detail::CheckpointHeader h = readHeader(in);
+        if (h.kind != detail::CheckpointHeader::DELTA)
+            throw std::runtime_error("checkpoint record is not a delta");
+        if (!mHasBase || h.sequence != mSequence + 1)
+            throw std::runtime_error("checkpoint delta is out of order");
+
+        const IndexBox<std::ptrdiff_t> box = mArray.getBox();
+        const std::ptrdiff_t brickSize = static_cast<std::ptrdiff_t>(h.brickSize);
+        const std::size_t bricks = DirtyBricks::brickCountOf(box, brickSize);
+        for (std::uint64_t i = 0; i < h.brickCount; ++i) {
+            std::uint64_t brick;
+            detail::checkpointRead(in, &brick, sizeof(brick));
+            if (brick >= bricks)
+                throw std::runtime_error("checkpoint brick is out of range");
+            detail::readBox(in, mArray, DirtyBricks::brickBoxOf(
+                    box, brickSize, static_cast<std::size_t>(brick)));
+        }
+        mSequence = h.sequence;
+    }
+
+    /**
+     * Gets number of deltas applied since the base.
+     */
+    std::size_t getSequence() const { return static_cast<std::size_t>(mSequence); }
+
+private:
+
+    detail::CheckpointHeader readHeader(std::istream& in) const {
+        detail::CheckpointHeader h;
+        detail::checkpointRead(in, &h, sizeof(h));
+        if (std::memcmp(h.magic, detail::CheckpointHeader::signature(), sizeof(h.magic)) != 0 ||
+            h.version != detail::CheckpointHeader::VERSION)
+            throw std::runtime_error("not a checkpoint record");
+        if (h.valueSize != sizeof(TValue))
+            throw std::runtime_error("checkpoint value type differs");
+        if (h.brickSize == 0 || (h.brickSize & (h.brickSize - 1)) != 0)
+            throw std::runtime_error("checkpoint brick size is not a power of two");
+        IndexBox<std::ptrdiff_t> box = mArray.getBox();
+        for (int axis = 0; axis < 3; ++axis) {
+            if (h.box[2*axis] != box.start[axis] || h.box[2*axis + 1] != box.stop[axis])
+                throw std::runtime_error("checkpoint geometry differs");
+        }
+        return h;
+    }
+
+    Array&        mArray;
+    std::uint64_t mSequence;
+    bool          mHasBase;
+};
+
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,44 @@
+#pragma once
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Instruction set levels for which compiled kernels of the library are
+ * built, in increasing order. @c Avx2 implies FMA, @c Avx512 implies the
+ * F, VL, BW and DQ subsets of AVX-512.
+ */
+enum class Isa {
+    Generic,
+    Sse42,
+    Avx2,
+    Avx512
+};
+
+/**
+ * Gets lower-case name of @a isa, as accepted by @c parseIsa.
+ */
+char const* isaName(Isa isa);
+
+/**
+ * Parses one of "generic", "sse4.2", "avx2" and "avx512" into @a isa.
+ * Returns @c false and leaves @a isa intact for anything else.
+ */
+bool parseIsa(char const* name, Isa& isa);
+
+/**
+ * Gets the best level supported by both this processor and operating
+ * system, whether or not kernels for it were built.
+ */
+Isa detectIsa();
+
+/**
+ * Gets the level of kernels called by this process, chosen at the first
+ * call: the detected level, or a lower one given in the environment
+ * variable @c RVLM_ISA, e.g. to test or benchmark older code paths on a
+ * newer machine. Levels above the detected one are not honoured.
+ */
+Isa activeIsa();
+
+} // namespace core
+} // namespace rvlm
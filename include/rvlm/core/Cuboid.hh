@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include <cmath>
 
 namespace rvlm {
@@ -20,12 +21,44 @@ public:
     ValueType const& getX2() const { return mX2; }
     ValueType const& getY2() const { return mY2; }
     ValueType const& getZ2() const { return mZ2; }
-    ValueType const& getProjectionX() const { return mX2 - mX1; }
-    ValueType const& getProjectionY() const { return mY2 - mY1; }
-    ValueType const& getProjectionZ() const { return mZ2 - mZ1; }
-    ValueType const& getLengthX() const { return std::abs(getProjectionX()); }
-    ValueType const& getLengthY() const { return std::abs(getProjectionY()); }
-    ValueType const& getLengthZ() const { return std::abs(getProjectionZ()); }
+    ValueType getProjectionX() const { return mX2 - mX1; }
+    ValueType getProjectionY() const { return mY2 - mY1; }
+    ValueType getProjectionZ() const { return mZ2 - mZ1; }
+    ValueType getLengthX() const { return std::abs(getProjectionX()); }
+    ValueType getLengthY() const { return std::abs(getProjectionY()); }
+    ValueType getLengthZ() const { return std::abs(getProjectionZ()); }
+
+    /**
+     * Gets the lower bound along axis @a axis (0 for @em X, 1 for @em Y and
+     * 2 for @em Z), regardless of the order corners were given in.
+     */
+    ValueType getLower(int axis) const {
+        return axis == 0 ? std::min(mX1, mX2)
+             : axis == 1 ? std::min(mY1, mY2)
+             :             std::min(mZ1, mZ2);
+    }
+
+    /**
+     * Gets the upper bound along axis @a axis.
+     * @see getLower
+     */
+    ValueType getUpper(int axis) const {
+        return axis == 0 ? std::max(mX1, mX2)
+             : axis == 1 ? std::max(mY1, mY2)
+             :             std::max(mZ1, mZ2);
+    }
+
+    /**
+     * Returns whether point (@a x, @a y, @a z) lies inside the cuboid.
+     * Lower bounds are inclusive and upper bounds are exclusive, so that
+     * adjacent cuboids never both contain the same point.
+     */
+    bool contains(ValueType const& x, ValueType const& y,
+                  ValueType const& z) const {
+        return getLower(0) <= x && x < getUpper(0) &&
+               getLower(1) <= y && y < getUpper(1) &&
+               getLower(2) <= z && z < getUpper(2);
+    }
 
 private:
     ValueType mX1;
@@ -0,0 +1,343 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "rvlm/core/Cuboid.hh"
+#include "rvlm/core/GridGeometry.hh"
+#include "rvlm/core/IndexBox.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Static spatial index over a collection of cuboids.
+ *
+ * The bounding box of all cuboids is split into a uniform grid of bins, and
+ * each bin lists the cuboids overlapping it. A point query then only tests
+ * the cuboids of a single bin, and a box query only those of the bins it
+ * covers. Uniform binning is chosen over hierarchies because scene cuboids
+ * are usually of similar size and evenly spread, and it is trivially built
+ * in parallel.
+ *
+ * Cuboids are identified by their positions in the collection passed to
+ * constructor. The index keeps a copy of cuboid bounds, so the collection
+ * need not outlive it. Results of every query are sorted by identifier.
+ */
+template <typename TFloat>
+class CuboidIndex {
+public:
+
+    typedef TFloat        ValueType;
+    typedef std::uint32_t IdType;
+
+    /**
+     * Cuboid overlapping a queried cell box, along with the part of the box
+     * it covers (all cells the cuboid at least touches).
+     */
+    struct BoxHit {
+        IdType        id;
+        IndexBox<>    cells;
+    };
+
+    /**
+     * Builds index over @a cuboids. Number of bins along each axis defaults
+     * to about twice the cube root of cuboid count.
+     */
+    explicit CuboidIndex(std::vector<Cuboid<TFloat>> const& cuboids,
+                         std::size_t binsPerAxis = 0) {
+        build(cuboids, binsPerAxis);
+    }
+
+    std::size_t getCuboidCount() const { return mLower.size(); }
+    std::size_t getBinCount() const { return mBinStart.size() - 1; }
+
+    /**
+     * Calls @a func with identifier of every cuboid containing the point.
+     */
+    template <typename TFunc>
+    void forEachContaining(TFloat x, TFloat y, TFloat z, TFunc func) const {
+        TFloat p[3] = { x, y, z };
+        std::ptrdiff_t bin[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            if (!(mLow[axis] <= p[axis] && p[axis] < mHigh[axis]))
+                return;
+            bin[axis] = binOf(axis, p[axis]);
+        }
+
+        std::size_t b = binIndex(bin[0], bin[1], bin[2]);
+        for (std::size_t i = mBinStart[b]; i < mBinStart[b+1]; ++i) {
+            IdType id = mBinItems[i];
+            if (containsPoint(id, p))
+                func(id);
+        }
+    }
+
+    /**
+     * Finds cuboids containing each of @a count points given by coordinate
+     * arrays. Results are written in compressed form: identifiers for point
+     * @c i are <tt>ids[offsets[i]] .. ids[offsets[i+1]-1]</tt>. Points are
+     * processed in parallel.
+     */
+    void findContaining(std::size_t count,
+                        TFloat const* xs, TFloat const* ys, TFloat const* zs,
+                        std::vector<std::size_t>& offsets,
+                        std::vector<IdType>& ids) const {
+        batchQuery(count, offsets, ids,
+            [&](std::size_t i, std::vector<IdType>& out) {
+                forEachContaining(xs[i], ys[i], zs[i],
+                    [&](IdType id) { out.push_back(id); });
+            });
+    }
+
+    /**
+     * Calls @a func for every cuboid overlapping cell box @a box of @a grid.
+     * The hit passed to @a func holds the cells of @a box the cuboid touches.
+     * Each cuboid is reported once, even if it spans several bins.
+     */
+    template <typename TFunc>
+    void forEachOverlapping(GridGeometry<TFloat> const& grid,
+                            IndexBox<> const& box, TFunc func) const {
+        if (box.empty())
+            return;
+
+        TFloat lo[3], hi[3];
+        std::ptrdiff_t binLo[3], binHi[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            lo[axis] = grid.fromGrid(axis, static_cast<TFloat>(box.start[axis]));
+            hi[axis] = grid.fromGrid(axis, static_cast<TFloat>(box.stop[axis]));
+            if (hi[axis] <= mLow[axis] || lo[axis] >= mHigh[axis])
+                return;
+            binLo[axis] = binOf(axis, std::max(lo[axis], mLow[axis]));
+            binHi[axis] = binOf(axis, std::min(hi[axis], mHigh[axis]));
+        }
+
+        std::vector<IdType> found;
+        for (std::ptrdiff_t bx = binLo[0]; bx <= binHi[0]; ++bx)
+        for (std::ptrdiff_t by = binLo[1]; by <= binHi[1]; ++by)
+        for (std::ptrdiff_t bz = binLo[2]; bz <= binHi[2]; ++bz) {
+            std::size_t b = binIndex(bx, by, bz);
+            for (std::size_t i = mBinStart[b]; i < mBinStart[b+1]; ++i) {
+                IdType id = mBinItems[i];
+                if (!overlapsBox(id, lo, hi))
+                    continue;
+
+                // Report the cuboid only from the bin holding the lower
+                // corner of its intersection with the query, so that cuboids
+                // spanning several bins are not reported repeatedly.
+                if (binOf(0, std::max(mLower[id].v[0], lo[0])) == bx &&
+                    binOf(1, std::max(mLower[id].v[1], lo[1])) == by &&
+                    binOf(2, std::max(mLower[id].v[2], lo[2])) == bz)
+                    found.push_back(id);
+            }
+        }
+
+        std::sort(found.begin(), found.end());
+        for (std::size_t i = 0; i < found.size(); ++i) {
+            IdType id = found[i];
+            BoxHit hit;
+            hit.id = id;
+            hit.cells = box.intersect(IndexBox<>(
+                cellFloor(grid, 0, mLower[id].v[0]), cellCeil(grid, 0, mUpper[id].v[0]),
+                cellFloor(grid, 1, mLower[id].v[1]), cellCeil(grid, 1, mUpper[id].v[1]),
+                cellFloor(grid, 2, mLower[id].v[2]), cellCeil(grid, 2, mUpper[id].v[2])));
+            func(hit);
+        }
+    }
+
+    /**
+     * Finds cuboids overlapping each of the cell boxes, in parallel.
+     * Results are written in the same compressed form as for points.
+     */
+    void findOverlapping(GridGeometry<TFloat> const& grid,
+                         std::vector<IndexBox<>> const& boxes,
+                         std::vector<std::size_t>& offsets,
+                         std::vector<BoxHit>& hits) const {
+        batchQuery(boxes.size(), offsets, hits,
+            [&](std::size_t i, std::vector<BoxHit>& out) {
+                forEachOverlapping(grid, boxes[i],
+                    [&](BoxHit const& hit) { out.push_back(hit); });
+            });
+    }
+
+private:
+
+    struct Corner {
+        TFloat v[3];
+    };
+
+    void build(std::vector<Cuboid<TFloat>> const& cuboids,
+               std::size_t binsPerAxis) {
+        const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(cuboids.size());
+        mLower.resize(n);
+        mUpper.resize(n);
+
+        for (int axis = 0; axis < 3; ++axis) {
+            mLow[axis]  = 0;
+            mHigh[axis] = 1;
+        }
+
+        for (std::ptrdiff_t i = 0; i < n; ++i)
+            for (int axis = 0; axis < 3; ++axis) {
+                mLower[i].v[axis] = cuboids[i].getLower(axis);
+                mUpper[i].v[axis] = cuboids[i].getUpper(axis);
+                if (i == 0 || mLower[i].v[axis] < mLow[axis])
+                    mLow[axis] = mLower[i].v[axis];
+                if (i == 0 || mUpper[i].v[axis] > mHigh[axis])
+                    mHigh[axis] = mUpper[i].v[axis];
+            }
+
+        if (binsPerAxis == 0) {
+            double root = std::cbrt(static_cast<double>(n));
+            binsPerAxis = static_cast<std::size_t>(2*root) + 1;
+            binsPerAxis = std::min<std::size_t>(binsPerAxis, 256);
+        }
+
+        for (int axis = 0; axis < 3; ++axis) {
+            if (!(mHigh[axis] > mLow[axis]))
+                mHigh[axis] = mLow[axis] + 1;
+            mBins[axis] = static_cast<std::ptrdiff_t>(binsPerAxis);
+            mBinScale[axis] = static_cast<TFloat>(binsPerAxis)
+                                / (mHigh[axis] - mLow[axis]);
+        }
+
+        // Counting pass: number of cuboids per bin.
+        const std::size_t binCount = binsPerAxis * binsPerAxis * binsPerAxis;
+        std::vector<std::size_t> counts(binCount, 0);
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (std::ptrdiff_t i = 0; i < n; ++i)
+            forEachBinOf(static_cast<IdType>(i), [&](std::size_t b) {
+                #pragma omp atomic
+                ++counts[b];
+            });
+
+        mBinStart.assign(binCount + 1, 0);
+        for (std::size_t b = 0; b < binCount; ++b)
+            mBinStart[b+1] = mBinStart[b] + counts[b];
+
+        // Filling pass: slots within bins are claimed atomically, so their
+        // order is arbitrary and is fixed up by sorting every bin.
+        mBinItems.resize(mBinStart[binCount]);
+        std::vector<std::size_t> cursor(mBinStart.begin(), mBinStart.end() - 1);
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (std::ptrdiff_t i = 0; i < n; ++i)
+            forEachBinOf(static_cast<IdType>(i), [&](std::size_t b) {
+                std::size_t slot;
+                #pragma omp atomic capture
+                slot = cursor[b]++;
+                mBinItems[slot] = static_cast<IdType>(i);
+            });
+
+        const std::ptrdiff_t bins = static_cast<std::ptrdiff_t>(binCount);
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (std::ptrdiff_t b = 0; b < bins; ++b)
+            std::sort(mBinItems.begin() + mBinStart[b],
+                      mBinItems.begin() + mBinStart[b+1]);
+    }
+
+    template <typename TFunc>
+    void forEachBinOf(IdType id, TFunc func) const {
+        std::ptrdiff_t lo[3], hi[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            lo[axis] = binOf(axis, mLower[id].v[axis]);
+            hi[axis] = binOf(axis, mUpper[id].v[axis]);
+        }
+
+        for (std::ptrdiff_t bx = lo[0]; bx <= hi[0]; ++bx)
+        for (std::ptrdiff_t by = lo[1]; by <= hi[1]; ++by)
+        for (std::ptrdiff_t bz = lo[2]; bz <= hi[2]; ++bz)
+            func(binIndex(bx, by, bz));
+    }
+
+    /**
+     * @internal
+     * Runs @a query for each of @a count items in parallel and collects
+     * results in compressed form. Every thread takes a contiguous block of
+     * items, so concatenating per-thread outputs preserves item order.
+     */
+    template <typename TResult, typename TQuery>
+    static void batchQuery(std::size_t count,
+                           std::vector<std::size_t>& offsets,
+                           std::vector<TResult>& results,
+                           TQuery query) {
+        offsets.assign(count + 1, 0);
+        std::vector<std::vector<TResult>> partial;
+
+        #pragma omp parallel
+        {
+            std::size_t threads = 1, thread = 0;
+#ifdef _OPENMP
+            threads = static_cast<std::size_t>(omp_get_num_threads());
+            thread  = static_cast<std::size_t>(omp_get_thread_num());
+#endif
+            #pragma omp single
+            partial.resize(threads);
+
+            std::vector<TResult>& out = partial[thread];
+            std::size_t first = count * thread / threads;
+            std::size_t last  = count * (thread + 1) / threads;
+            for (std::size_t i = first; i < last; ++i) {
+                std::size_t before = out.size();
+                query(i, out);
+                offsets[i+1] = out.size() - before;
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+            offsets[i+1] += offsets[i];
+
+        results.clear();
+        results.reserve(offsets[count]);
+        for (std::size_t t = 0; t < partial.size(); ++t)
+            results.insert(results.end(), partial[t].begin(), partial[t].end());
+    }
+
+    std::ptrdiff_t binOf(int axis, TFloat x) const {
+        std::ptrdiff_t b = static_cast<std::ptrdiff_t>(
+                (x - mLow[axis]) * mBinScale[axis]);
+        return std::max<std::ptrdiff_t>(0, std::min(b, mBins[axis] - 1));
+    }
+
+    std::size_t binIndex(std::ptrdiff_t bx, std::ptrdiff_t by,
+                         std::ptrdiff_t bz) const {
+        return static_cast<std::size_t>((bx * mBins[1] + by) * mBins[2] + bz);
+    }
+
+    bool containsPoint(IdType id, TFloat const* p) const {
+        return mLower[id].v[0] <= p[0] && p[0] < mUpper[id].v[0] &&
+               mLower[id].v[1] <= p[1] && p[1] < mUpper[id].v[1] &&
+               mLower[id].v[2] <= p[2] && p[2] < mUpper[id].v[2];
+    }
+
+    bool overlapsBox(IdType id, TFloat const* lo, TFloat const* hi) const {
+        return mLower[id].v[0] < hi[0] && lo[0] < mUpper[id].v[0] &&
+               mLower[id].v[1] < hi[1] && lo[1] < mUpper[id].v[1] &&
+               mLower[id].v[2] < hi[2] && lo[2] < mUpper[id].v[2];
+    }
+
+    static std::ptrdiff_t cellFloor(GridGeometry<TFloat> const& grid,
+                                    int axis, TFloat x) {
+        return static_cast<std::ptrdiff_t>(std::floor(grid.toGrid(axis, x)));
+    }
+
+    static std::ptrdiff_t cellCeil(GridGeometry<TFloat> const& grid,
+                                   int axis, TFloat x) {
+        return static_cast<std::ptrdiff_t>(std::ceil(grid.toGrid(axis, x)));
+    }
+
+    std::vector<Corner>      mLower;
+    std::vector<Corner>      mUpper;
+    std::vector<std::size_t> mBinStart;
+    std::vector<IdType>      mBinItems;
+    TFloat                   mLow[3];
+    TFloat                   mHigh[3];
+    TFloat                   mBinScale[3];
+    std::ptrdiff_t           mBins[3];
+};
+
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,379 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/SolidArray3d.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Way @c Depositor avoids races between threads adding into the same cells.
+ */
+enum class DepositionStrategy {
+    /** Chosen by @c Depositor from particle distribution over tiles. */
+    Automatic,
+
+    /** Every contribution is added with an atomic operation. */
+    Atomic,
+
+    /**
+     * Tiles are accumulated into small per-thread buffers, which are then
+     * added into the array with one atomic operation per non-zero cell.
+     */
+    TileBuffers,
+
+    /**
+     * Tiles are processed in 8 phases by parity of their coordinates, so
+     * that tiles of one phase never touch the same cells, and contributions
+     * go straight into the array.
+     */
+    ColoredTiles
+};
+
+/**
+ * Parallel scatter-add of particle contributions (charge, current) into a
+ * @c SolidArray3d without locks or per-thread copies of the whole array.
+ *
+ * The array is split into cubic tiles of @em tileSize cells. Particles are
+ * binned into tiles by their cells, and threads take whole tiles, using one
+ * of @c DepositionStrategy methods to combine contributions of tiles which
+ * overlap near their faces. Every particle adds only to cells at most
+ * @em reach cells away from its own cell along every axis, which must lie
+ * within the array.
+ *
+ * Contributions are made by a function called as <tt>func(i, sink)</tt> for
+ * particle @em i, which calls <tt>sink.add(dx, dy, dz, value)</tt> to add
+ * @em value into the cell at offset (@em dx, @em dy, @em dz) from the cell
+ * of the particle. Sink types differ between strategies, so @em func must
+ * be a function object with a template call operator:
+ * @code
+ *     struct CloudInCell {
+ *         template <typename TSink>
+ *         void operator () (std::size_t i, TSink& sink) const {
+ *             sink.add(0, 0, 0, w000[i]);
+ *             sink.add(0, 0, 1, w001[i]);
+ *             ...
+ *         }
+ *     };
+ * @endcode
+ * Summation order differs between strategies and runs, so floating point
+ * results may differ in the last bits.
+ */
+template <typename T, typename TIndex = std::size_t>
+class Depositor {
+public:
+
+    typedef SolidArray3d<T, TIndex> Array;
+    typedef IndexBox<std::ptrdiff_t> Box;
+
+    /**
+     * Prepares deposition into @a target. Throws @c std::invalid_argument
+     * if @a reach is negative or tiles are smaller than twice the reach,
+     * which would let tiles of one color overlap.
+     */
+    Depositor(Array& target, int reach = 1, int tileSize = 8)
+            : mTarget(target), mBox(target.getBox()), mReach(reach),
+              mTileSize(tileSize), mLastStrategy(DepositionStrategy::Automatic) {
+        if (reach < 0 || tileSize <= 0 || tileSize < 2*reach)
+            throw std::invalid_argument("tiles must be at least twice the reach");
+        for (int axis = 0; axis < 3; ++axis)
+            mTiles[axis] = (mBox.size(axis) + tileSize - 1) / tileSize;
+        mStride[2] = 1;
+        mStride[1] = static_cast<std::ptrdiff_t>(mBox.size(2));
+        mStride[0] = static_cast<std::ptrdiff_t>(mBox.size(1) * mBox.size(2));
+        const std::ptrdiff_t span = tileSize + 2*reach;
+        mBufferStride[2] = 1;
+        mBufferStride[1] = span;
+        mBufferStride[0] = span * span;
+    }
+
+    int getReach() const { return mReach; }
+
+    int getTileSize() const { return mTileSize; }
+
+    /**
+     * Gets strategy used by the last call to @c deposit.
+     */
+    DepositionStrategy getLastStrategy() const { return mLastStrategy; }
+
+    /**
+     * Adds contributions of @a count particles with cells @a ix, @a iy and
+     * @a iz into the target array, and returns strategy actually used.
+     * Throws @c std::out_of_range if some particle may reach outside of
+     * the array; nothing is deposited in this case.
+     */
+    template <typename TCoord, typename TFunc>
+    DepositionStrategy deposit(TCoord const* ix, TCoord const* iy,
+                               TCoord const* iz, std::size_t count, TFunc func,
+                               DepositionStrategy strategy = DepositionStrategy::Automatic) {
+        bin(ix, iy, iz, count);
+        if (strategy == DepositionStrategy::Automatic)
+            strategy = choose();
+
+        switch (strategy) {
+        case DepositionStrategy::Atomic:
+            runAtomic(func);
+            break;
+        case DepositionStrategy::TileBuffers:
+            runTileBuffers(func);
+            break;
+        default:
+            strategy = DepositionStrategy::ColoredTiles;
+            runColored(func);
+            break;
+        }
+        mLastStrategy = strategy;
+        return strategy;
+    }
+
+    /**
+     * Sink adding straight into the array, for tiles no other thread
+     * touches at the same time.
+     */
+    class DirectSink {
+    public:
+        DirectSink(T* cell, std::ptrdiff_t const* stride)
+            : mCell(cell), mStride(stride) {}
+
+        void add(int dx, int dy, int dz, T value) {
+            mCell[dx*mStride[0] + dy*mStride[1] + dz] += value;
+        }
+
+    private:
+        T*                    mCell;
+        std::ptrdiff_t const* mStride;
+    };
+
+    class AtomicSink {
+    public:
+        AtomicSink(T* cell, std::ptrdiff_t const* stride)
+            : mCell(cell), mStride(stride) {}
+
+        void add(int dx, int dy, int dz, T value) {
+            T& item = mCell[dx*mStride[0] + dy*mStride[1] + dz];
+            #pragma omp atomic
+            item += value;
+        }
+
+    private:
+        T*                    mCell;
+        std::ptrdiff_t const* mStride;
+    };
+
+private:
+
+    std::size_t tileCount() const {
+        return static_cast<std::size_t>(mTiles[0] * mTiles[1] * mTiles[2]);
+    }
+
+    int threadCount() const {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    /**
+     * Sorts particles by tiles with counting sort. Particle cells are kept
+     * as offsets relative to the array origin.
+     */
+    template <typename TCoord>
+    void bin(TCoord const* ix, TCoord const* iy, TCoord const* iz,
+             std::size_t count) {
+        // Buffers are kept between calls to avoid reallocation every step.
+        mCellOffsets.resize(count);
+        std::vector<std::size_t>& tileOf = mScratch;
+        tileOf.resize(count);
+        mTileStart.assign(tileCount() + 1, 0);
+
+        const std::ptrdiff_t r = mReach;
+        for (std::size_t i = 0; i < count; ++i) {
+            std::ptrdiff_t c[3] = {
+                static_cast<std::ptrdiff_t>(ix[i]) - mBox.start[0],
+                static_cast<std::ptrdiff_t>(iy[i]) - mBox.start[1],
+                static_cast<std::ptrdiff_t>(iz[i]) - mBox.start[2] };
+            for (int axis = 0; axis < 3; ++axis) {
+                if (c[axis] < r || c[axis] + r >= mBox.size(axis))
+                    throw std::out_of_range("particle reaches outside of array");
+            }
+            mCellOffsets[i] = c[0]*mStride[0] + c[1]*mStride[1] + c[2];
+            tileOf[i] = static_cast<std::size_t>(
+                    ((c[0] / mTileSize) * mTiles[1] + c[1] / mTileSize)
+                    * mTiles[2] + c[2] / mTileSize);
+            ++mTileStart[tileOf[i] + 1];
+        }
+
+        for (std::size_t t = 0; t < tileCount(); ++t)
+            mTileStart[t + 1] += mTileStart[t];
+        mOrder.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+            mOrder[mTileStart[tileOf[i]]++] = i;
+
+        // Filling has moved every start to the next one.
+        for (std::size_t t = tileCount(); t > 0; --t)
+            mTileStart[t] = mTileStart[t - 1];
+        mTileStart[0] = 0;
+
+        mBusyTiles.clear();
+        for (std::size_t t = 0; t < tileCount(); ++t) {
+            if (mTileStart[t + 1] > mTileStart[t])
+                mBusyTiles.push_back(t);
+        }
+    }
+
+    /**
+     * Picks strategy by particle density. With one thread there are no
+     * races and colored tiles cost nothing extra. Evenly loaded tiles, with
+     * enough of them in every color to keep all threads busy, are colored
+     * too. Otherwise buffers pay off once contributions of a tile outnumber
+     * cells of its buffer, and sparse tiles go atomic.
+     */
+    DepositionStrategy choose() const {
+        const int threads = threadCount();
+        if (threads == 1 || mBusyTiles.empty())
+            return DepositionStrategy::ColoredTiles;
+
+        std::size_t maxLoad = 0;
+        for (std::size_t k = 0; k < mBusyTiles.size(); ++k) {
+            std::size_t t = mBusyTiles[k];
+            maxLoad = std::max(maxLoad, mTileStart[t + 1] - mTileStart[t]);
+        }
+        const double mean = static_cast<double>(mOrder.size()) / mBusyTiles.size();
+        if (mBusyTiles.size() >= 8 * 4 * static_cast<std::size_t>(threads) &&
+            maxLoad <= 4 * mean)
+            return DepositionStrategy::ColoredTiles;
+
+        const double span = mTileSize + 2*mReach;
+        const double writes = (mReach + 1.0) * (mReach + 1.0) * (mReach + 1.0);
+        return mean * writes >= span * span * span
+             ? DepositionStrategy::TileBuffers
+             : DepositionStrategy::Atomic;
+    }
+
+    template <typename TFunc>
+    void runColored(TFunc& func) {
+        T* origin = mTarget.getOrigin();
+        for (int color = 0; color < 8; ++color) {
+            std::vector<std::size_t> tiles;
+            for (std::size_t k = 0; k < mBusyTiles.size(); ++k) {
+                std::size_t t = mBusyTiles[k];
+                std::size_t tz = t % mTiles[2];
+                std::size_t ty = t / mTiles[2] % mTiles[1];
+                std::size_t tx = t / mTiles[2] / mTiles[1];
+                if (static_cast<int>((tx & 1)*4 + (ty & 1)*2 + (tz & 1)) == color)
+                    tiles.push_back(t);
+            }
+
+            const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(tiles.size());
+            #pragma omp parallel for schedule(dynamic)
+            for (std::ptrdiff_t k = 0; k < n; ++k) {
+                std::size_t t = tiles[k];
+                for (std::size_t j = mTileStart[t]; j < mTileStart[t + 1]; ++j) {
+                    std::size_t i = mOrder[j];
+                    DirectSink sink(origin + mCellOffsets[i], mStride);
+                    func(i, sink);
+                }
+            }
+        }
+    }
+
+    template <typename TFunc>
+    void runAtomic(TFunc& func) {
+        T* origin = mTarget.getOrigin();
+        const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(mBusyTiles.size());
+        #pragma omp parallel for schedule(dynamic)
+        for (std::ptrdiff_t k = 0; k < n; ++k) {
+            std::size_t t = mBusyTiles[k];
+            for (std::size_t j = mTileStart[t]; j < mTileStart[t + 1]; ++j) {
+                std::size_t i = mOrder[j];
+                AtomicSink sink(origin + mCellOffsets[i], mStride);
+                func(i, sink);
+            }
+        }
+    }
+
+    template <typename TFunc>
+    void runTileBuffers(TFunc& func) {
+        T* origin = mTarget.getOrigin();
+        const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(mBusyTiles.size());
+        const std::ptrdiff_t span = mTileSize + 2*mReach;
+
+        #pragma omp parallel
+        {
+            std::vector<T> buffer(static_cast<std::size_t>(span * span * span), T(0));
+
+            #pragma omp for schedule(dynamic)
+            for (std::ptrdiff_t k = 0; k < n; ++k) {
+                std::size_t t = mBusyTiles[k];
+                std::ptrdiff_t tile[3] = {
+                    static_cast<std::ptrdiff_t>(t / mTiles[2] / mTiles[1]),
+                    static_cast<std::ptrdiff_t>(t / mTiles[2] % mTiles[1]),
+                    static_cast<std::ptrdiff_t>(t % mTiles[2]) };
+
+                // Buffer covers the tile grown by reach, starting from cell
+                // 'lower', which may lie outside of the array.
+                std::ptrdiff_t lower[3], upper[3];
+                for (int axis = 0; axis < 3; ++axis) {
+                    lower[axis] = tile[axis]*mTileSize - mReach;
+                    upper[axis] = std::min<std::ptrdiff_t>(
+                            lower[axis] + span, mBox.size(axis));
+                }
+                const std::ptrdiff_t corner = lower[0]*mStride[0]
+                                            + lower[1]*mStride[1] + lower[2];
+
+                for (std::size_t j = mTileStart[t]; j < mTileStart[t + 1]; ++j) {
+                    std::size_t i = mOrder[j];
+                    std::ptrdiff_t cell = mCellOffsets[i];
+                    std::ptrdiff_t rx = cell / mStride[0] - lower[0];
+                    std::ptrdiff_t ry = cell % mStride[0] / mStride[1] - lower[1];
+                    std::ptrdiff_t rz = cell % mStride[1] - lower[2];
+                    DirectSink sink(&buffer[rx*mBufferStride[0] + ry*mBufferStride[1] + rz],
+                                    mBufferStride);
+                    func(i, sink);
+                }
+
+                // Clipped to the array, buffer parts beyond it stay zero.
+                for (std::ptrdiff_t bx = std::max<std::ptrdiff_t>(0, -lower[0]);
+                     bx < upper[0] - lower[0]; ++bx)
+                for (std::ptrdiff_t by = std::max<std::ptrdiff_t>(0, -lower[1]);
+                     by < upper[1] - lower[1]; ++by) {
+                    T* src = &buffer[bx*mBufferStride[0] + by*mBufferStride[1]];
+                    T* dst = origin + (corner + bx*mStride[0] + by*mStride[1]);
+                    for (std::ptrdiff_t bz = std::max<std::ptrdiff_t>(0, -lower[2]);
+                         bz < upper[2] - lower[2]; ++bz) {
+                        if (src[bz] != T(0)) {
+                            T& item = dst[bz];
+                            #pragma omp atomic
+                            item += src[bz];
+                            src[bz] = T(0);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    Array&                   mTarget;
+    Box                      mBox;
+    int                      mReach;
+    int                      mTileSize;
+    std::ptrdiff_t           mTiles[3];
+    std::ptrdiff_t           mStride[3];
+    std::ptrdiff_t           mBufferStride[3];
+    DepositionStrategy       mLastStrategy;
+    std::vector<std::ptrdiff_t> mCellOffsets;
+    std::vector<std::size_t> mOrder;
+    std::vector<std::size_t> mTileStart;
+    std::vector<std::size_t> mBusyTiles;
+    std::vector<std::size_t> mScratch;
+};
+
+} // namespace core
+} // namespace rvlm
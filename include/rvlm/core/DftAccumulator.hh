@@ -0,0 +1,228 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/SolidArray3d.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Running discrete Fourier transform of a field over a box of cells, for
+ * a set of frequencies, accumulated one time step at a time.
+ *
+ * Every call to @c accumulate adds <tt>E(t) * exp(-i*omega*t)</tt> to the
+ * result of every cell of the box and every angular frequency @em omega,
+ * where @em t is the time of the current step. Results are raw sums, to be
+ * multiplied by the time step for an approximation of the Fourier integral.
+ * Boxes one cell thick along some axis are faces, as used by near-to-far
+ * field transforms and port planes.
+ *
+ * No trigonometric functions are evaluated per cell or per step: phasors
+ * <tt>exp(-i*omega*t)</tt> advance by multiplication with constant
+ * <tt>exp(-i*omega*dt)</tt>, and are recomputed exactly every
+ * @c RESYNC_PERIOD steps to stop rounding errors from building up.
+ * Complex results are stored as separate arrays of real and imaginary
+ * parts for every frequency, in box order (@em Z changing fastest), so that
+ * updates are plain vectorizable loops. Cells are split into blocks
+ * processed by OpenMP threads; each block is read from the field once and
+ * applied to all frequencies while it stays in cache.
+ */
+template <typename T, typename TIndex = std::size_t>
+class DftAccumulator {
+public:
+
+    typedef SolidArray3d<T, TIndex>  Array;
+    typedef IndexBox<std::ptrdiff_t> Box;
+
+    static const std::size_t RESYNC_PERIOD = 1024;
+
+    /**
+     * Prepares accumulation of @a field values within @a box, for angular
+     * frequencies @a omegas. Step number @em n is at time
+     * <tt>t0 + n*dt</tt>. Throws @c std::out_of_range if the box does not
+     * lie within the field array.
+     */
+    DftAccumulator(Array const& field, Box const& box,
+                   std::vector<double> const& omegas, double dt, double t0 = 0)
+            : mField(field), mBox(box), mOmegas(omegas), mDt(dt), mT0(t0),
+              mStep(0), mCount(box.empty() ? 0 : static_cast<std::size_t>(box.count())) {
+        if (!field.getBox().contains(box))
+            throw std::out_of_range("box exceeds field array");
+        mRe.assign(mCount * omegas.size(), T(0));
+        mIm.assign(mCount * omegas.size(), T(0));
+        mPhasor.resize(omegas.size());
+        mRotation.resize(omegas.size());
+        for (std::size_t f = 0; f < omegas.size(); ++f)
+            mRotation[f] = std::polar(1.0, -omegas[f] * dt);
+        resync();
+    }
+
+    std::size_t getFrequencyCount() const { return mOmegas.size(); }
+
+    double getOmega(std::size_t f) const { return mOmegas[f]; }
+
+    Box const& getBox() const { return mBox; }
+
+    /**
+     * Gets number of steps accumulated so far.
+     */
+    std::size_t getStep() const { return mStep; }
+
+    /**
+     * Adds current field values as the next time step.
+     */
+    void accumulate() {
+        const std::size_t frequencies = mOmegas.size();
+        std::vector<T> pr(frequencies), pi(frequencies);
+        for (std::size_t f = 0; f < frequencies; ++f) {
+            pr[f] = static_cast<T>(mPhasor[f].real());
+            pi[f] = static_cast<T>(mPhasor[f].imag());
+        }
+
+        const std::ptrdiff_t blocks = static_cast<std::ptrdiff_t>(
+                (mCount + BLOCK - 1) / BLOCK);
+        #pragma omp parallel for schedule(static)
+        for (std::ptrdiff_t b = 0; b < blocks; ++b) {
+            T values[BLOCK];
+            const std::size_t first = static_cast<std::size_t>(b) * BLOCK;
+            const std::size_t n = std::min(BLOCK, mCount - first);
+            load(first, n, values);
+            for (std::size_t f = 0; f < frequencies; ++f) {
+                T* re = mRe.data() + f*mCount + first;
+                T* im = mIm.data() + f*mCount + first;
+                const T cr = pr[f], ci = pi[f];
+                for (std::size_t j = 0; j < n; ++j) {
+                    re[j] += cr * values[j];
+                    im[j] += ci * values[j];
+                }
+            }
+        }
+
+        ++mStep;
+        if (mStep % RESYNC_PERIOD == 0) {
+            resync();
+        } else {
+            for (std::size_t f = 0; f < frequencies; ++f)
+                mPhasor[f] *= mRotation[f];
+        }
+    }
+
+    /**
+     * Gets real parts of results for frequency @a f, in box order.
+     */
+    T const* getReal(std::size_t f) const { return mRe.data() + f*mCount; }
+
+    /**
+     * Gets imaginary parts of results for frequency @a f, in box order.
+     */
+    T const* getImag(std::size_t f) const { return mIm.data() + f*mCount; }
+
+    /**
+     * Gets result for frequency @a f at cell (@a ix, @a iy, @a iz) of the box.
+     */
+    std::complex<T> at(std::size_t f, std::ptrdiff_t ix, std::ptrdiff_t iy,
+                       std::ptrdiff_t iz) const {
+        if (!mBox.contains(ix, iy, iz))
+            throw std::out_of_range("cell is outside of DFT box");
+        std::size_t i = static_cast<std::size_t>(
+                ((ix - mBox.start[0]) * mBox.size(1) + (iy - mBox.start[1]))
+                * mBox.size(2) + (iz - mBox.start[2]));
+        return std::complex<T>(mRe[f*mCount + i], mIm[f*mCount + i]);
+    }
+
+    /**
+     * Resets results to zero and restarts from step 0.
+     */
+    void reset() {
+        std::fill(mRe.begin(), mRe.end(), T(0));
+        std::fill(mIm.begin(), mIm.end(), T(0));
+        mStep = 0;
+        resync();
+    }
+
+    /**
+     * Gets memory taken by results of one frequency, in bytes.
+     */
+    std::size_t bytesPerFrequency() const {
+        return 2 * mCount * sizeof(T) + sizeof(std::complex<double>) * 2
+             + sizeof(double);
+    }
+
+    /**
+     * Gets memory taken by results of all frequencies, in bytes.
+     */
+    std::size_t getMemoryUsage() const {
+        return bytesPerFrequency() * mOmegas.size();
+    }
+
+private:
+
+    static const std::size_t BLOCK = 512;
+
+    void resync() {
+        const double t = mT0 + static_cast<double>(mStep) * mDt;
+        for (std::size_t f = 0; f < mOmegas.size(); ++f)
+            mPhasor[f] = std::polar(1.0, -mOmegas[f] * t);
+    }
+
+    /**
+     * Copies @a n field values starting from cell @a first of the box,
+     * counted in box order, into @a out. Walks the box with a pointer
+     * instead of computing addresses per cell, since faces normal to
+     * @em Z have rows of a single item.
+     */
+    void load(std::size_t first, std::size_t n, T* out) const {
+        typedef typename Array::IndexType I;
+        const std::size_t sz = static_cast<std::size_t>(mBox.size(2));
+        const std::size_t sy = static_cast<std::size_t>(mBox.size(1));
+        const std::size_t row = first / sz;
+        std::size_t kz = first % sz, ky = row % sy;
+        T const* p = mField.getCursor(
+                static_cast<I>(mBox.start[0] + static_cast<std::ptrdiff_t>(row / sy)),
+                static_cast<I>(mBox.start[1] + static_cast<std::ptrdiff_t>(ky)),
+                static_cast<I>(mBox.start[2] + static_cast<std::ptrdiff_t>(kz)));
+        const std::ptrdiff_t nextRow =
+                static_cast<std::ptrdiff_t>(mField.getCountZ()) -
+                static_cast<std::ptrdiff_t>(sz);
+        const std::ptrdiff_t nextPlane =
+                static_cast<std::ptrdiff_t>(mField.getCountY() - static_cast<I>(sy)) *
+                static_cast<std::ptrdiff_t>(mField.getCountZ());
+        while (n > 0) {
+            std::size_t m = std::min(n, sz - kz);
+            out = std::copy(p, p + m, out);
+            n -= m;
+            p += m + nextRow;
+            kz = 0;
+            if (++ky == sy) {
+                p += nextPlane;
+                ky = 0;
+            }
+        }
+    }
+
+    Array const&                      mField;
+    Box                               mBox;
+    std::vector<double>               mOmegas;
+    double                            mDt;
+    double                            mT0;
+    std::size_t                       mStep;
+    std::size_t                       mCount;
+    std::vector<T>                    mRe;
+    std::vector<T>                    mIm;
+    std::vector<std::complex<double>> mPhasor;
+    std::vector<std::complex<double>> mRotation;
+};
+
+template <typename T, typename TIndex>
+const std::size_t DftAccumulator<T, TIndex>::RESYNC_PERIOD;
+
+template <typename T, typename TIndex>
+const std::size_t DftAccumulator<T, TIndex>::BLOCK;
+
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,172 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/NonAssignable.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Record of which bricks of a box were written to, for incremental
+ * processing of large arrays such as checkpoints.
+ *
+ * The box, usually that of a @c SolidArray3d, is split into cubic bricks of
+ * @em brickSize cells, the last ones along every axis possibly smaller.
+ * Kernels report boxes they write with @c markDirty, and consumers walk
+ * dirty bricks and @c clear them. Marking is a relaxed atomic store of a
+ * flag per brick, so threads of a parallel kernel may mark overlapping
+ * boxes concurrently; clearing and walking must not race with marking.
+ */
+class DirtyBricks: public NonAssignable {
+public:
+
+    typedef IndexBox<std::ptrdiff_t> Box;
+
+    /**
+     * Constructs tracker for @a box with all bricks dirty, since nothing
+     * has been processed yet. Brick size must be a power of two.
+     */
+    explicit DirtyBricks(Box const& box, std::ptrdiff_t brickSize = 16)
+            : mBox(box), mBrickSize(brickSize), mBrickShift(0) {
+        if (brickSize <= 0 || (brickSize & (brickSize - 1)) != 0)
+            throw std::invalid_argument("brick size must be a power of two");
+        while ((std::ptrdiff_t(1) << mBrickShift) < brickSize)
+            ++mBrickShift;
+        for (int axis = 0; axis < 3; ++axis)
+            mBricks[axis] = (box.size(axis) + brickSize - 1) / brickSize;
+        mCount = brickCountOf(box, brickSize);
+        mFlags.reset(new std::atomic<unsigned char>[mCount]);
+        markAllDirty();
+    }
+
+    /**
+     * Gets total number of bricks of @a brickSize cells covering @a box,
+     * without building a tracker.
+     */
+    static std::size_t brickCountOf(Box const& box, std::ptrdiff_t brickSize) {
+        std::size_t count = 1;
+        for (int axis = 0; axis < 3; ++axis)
+            count *= static_cast<std::size_t>((box.size(axis) + brickSize - 1) / brickSize);
+        return count;
+    }
+
+    /**
+     * Gets cells of brick number @a brick of @a box split into bricks of
+     * @a brickSize cells, the same as @c getBrickBox of a tracker would.
+     */
+    static Box brickBoxOf(Box const& box, std::ptrdiff_t brickSize, std::size_t brick) {
+        std::ptrdiff_t bricks[3];
+        for (int axis = 0; axis < 3; ++axis)
+            bricks[axis] = (box.size(axis) + brickSize - 1) / brickSize;
+        std::ptrdiff_t b = static_cast<std::ptrdiff_t>(brick);
+        std::ptrdiff_t coords[3];
+        coords[2] = b % bricks[2];
+        coords[1] = b / bricks[2] % bricks[1];
+        coords[0] = b / bricks[2] / bricks[1];
+        std::ptrdiff_t lo[3], hi[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            lo[axis] = box.start[axis] + coords[axis] * brickSize;
+            hi[axis] = std::min(lo[axis] + brickSize, box.stop[axis]);
+        }
+        return Box(lo[0], hi[0], lo[1], hi[1], lo[2], hi[2]);
+    }
+
+    Box const& getBox() const { return mBox; }
+
+    std::ptrdiff_t getBrickSize() const { return mBrickSize; }
+
+    /**
+     * Gets base two logarithm of the brick size.
+     */
+    int getBrickShift() const { return mBrickShift; }
+
+    /**
+     * Gets total number of bricks.
+     */
+    std::size_t getBrickCount() const { return mCount; }
+
+    /**
+     * Gets number of bricks along @a axis.
+     */
+    std::ptrdiff_t getBrickCount(int axis) const { return mBricks[axis]; }
+
+    /**
+     * Gets cells of brick number @a brick, clipped to the box. Bricks are
+     * numbered in the same order as array items, @em Z changing fastest.
+     */
+    Box getBrickBox(std::size_t brick) const {
+        return brickBoxOf(mBox, mBrickSize, brick);
+    }
+
+    /**
+     * Marks bricks intersecting @a box as written. Parts of the box outside
+     * of the tracked box are ignored.
+     */
+    void markDirty(Box const& box) {
+        Box b = box.intersect(mBox);
+        if (b.empty())
+            return;
+        std::ptrdiff_t lo[3], hi[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            lo[axis] = (b.start[axis] - mBox.start[axis]) >> mBrickShift;
+            hi[axis] = (b.stop[axis] - 1 - mBox.start[axis]) >> mBrickShift;
+        }
+        for (std::ptrdiff_t bx = lo[0]; bx <= hi[0]; ++bx)
+        for (std::ptrdiff_t by = lo[1]; by <= hi[1]; ++by)
+        for (std::ptrdiff_t bz = lo[2]; bz <= hi[2]; ++bz)
+            mFlags[static_cast<std::size_t>((bx*mBricks[1] + by)*mBricks[2] + bz)]
+                    .store(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Marks brick containing given cell as written.
+     */
+    void markDirty(std::ptrdiff_t ix, std::ptrdiff_t iy, std::ptrdiff_t iz) {
+        markDirty(Box(ix, ix + 1, iy, iy + 1, iz, iz + 1));
+    }
+
+    void markAllDirty() {
+        for (std::size_t i = 0; i < mCount; ++i)
+            mFlags[i].store(1, std::memory_order_relaxed);
+    }
+
+    bool isDirty(std::size_t brick) const {
+        return mFlags[brick].load(std::memory_order_relaxed) != 0;
+    }
+
+    /**
+     * Gets numbers of all dirty bricks in increasing order.
+     */
+    std::vector<std::size_t> getDirtyBricks() const {
+        std::vector<std::size_t> bricks;
+        for (std::size_t i = 0; i < mCount; ++i) {
+            if (isDirty(i))
+                bricks.push_back(i);
+        }
+        return bricks;
+    }
+
+    /**
+     * Marks all bricks as not written.
+     */
+    void clear() {
+        for (std::size_t i = 0; i < mCount; ++i)
+            mFlags[i].store(0, std::memory_order_relaxed);
+    }
+
+private:
+    Box                                          mBox;
+    std::ptrdiff_t                               mBrickSize;
+    int                                          mBrickShift;
+    std::ptrdiff_t                               mBricks[3];
+    std::size_t                                  mCount;
+    std::unique_ptr<std::atomic<unsigned char>[]> mFlags;
+};
+
+} // namespace core
+} // namespace rvlm
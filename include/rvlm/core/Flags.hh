@@ -1,15 +1,45 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <stdexcept>
 #include <type_traits>
+#include "rvlm/core/detail/BitOps.hh"
+#include "rvlm/core/detail/FlagsHelpers.hh"
+#include "rvlm/core/detail/IndexSequence.hh"
 
 namespace rvlm {
 namespace core {
 
 /**
+ * Default number of flags in @c Flags for enumeration @a TEnum.
+ * Specialize this template for enumerations having more than 32 items, so
+ * that @c Flags<TEnum> and the @c | operator on items pick proper width:
+ * @code
+ *     template <>
+ *     struct FlagsWidth<CellAttribute> {
+ *         static const std::size_t value = 200;
+ *     };
+ * @endcode
+ */
+template <typename TEnum>
+struct FlagsWidth {
+    static const std::size_t value = 32;
+};
+
+/**
+ * Set of enumeration items, stored as a bitmask.
  *
+ * Parameter @a TBits is the number of distinct items the set may hold, that
+ * is, the largest enumerator value plus one. Up to 64 items are stored in a
+ * single integer, wider sets use an array of 64 bit words with set operations
+ * vectorized where possible.
  */
-template<typename TEnum>
+template <typename TEnum, std::size_t TBits = FlagsWidth<TEnum>::value>
 struct Flags {
+    static_assert(std::is_enum<TEnum>::value, "TEnum must be an enumeration");
+    static_assert(TBits > 0, "TBits must be positive");
+
 public:
 
     /**
@@ -20,21 +50,41 @@ public:
 
     /**
      * Convenience alias for underlying integer type implementing bitmask.
-     * This may be useful in some rare situations.
+     * Sets wider than one integer consist of @c WORD_COUNT such words.
      */
-    typedef std::uint_fast32_t IntType;
+    typedef typename std::conditional<TBits <= 32,
+                                      std::uint_fast32_t,
+                                      std::uint64_t>::type IntType;
+
+    static const std::size_t BIT_COUNT  = TBits;
+    static const std::size_t WORD_BITS  = sizeof(IntType) * 8;
+    static const std::size_t WORD_COUNT = (TBits + WORD_BITS - 1) / WORD_BITS;
 
     /**
      * Constructs empty set of flags.
      */
-    Flags()
-        : value(0) {}
+    constexpr Flags()
+        : words{} {}
+
+    /**
+     * Constructs set with single flag @c item included.
+     * Throws @c std::out_of_range if @a item does not fit into the set.
+     */
+    constexpr Flags(const TEnum& item)
+        : Flags(detail::MakeIndexSequence<WORD_COUNT>(), item) {}
 
     /**
-      Constructs set with single flag @c item included.
+     * Constructs set with all the listed flags included.
+     * Unlike chains of @c | operators, this is a constant expression, so it
+     * is the way to define masks at compile time:
+     * @code
+     *     constexpr Flags<Material, 200> BOUNDARY(Material::Pec, Material::Pml);
+     * @endcode
      */
-    Flags(const TEnum& item)
-        : value(static_cast<IntType>(1) << static_cast<IntType>(item)) {}
+    template <typename... TRest>
+    constexpr Flags(const TEnum& first, const TEnum& second,
+                    const TRest&... rest)
+        : Flags(detail::MakeIndexSequence<WORD_COUNT>(), first, second, rest...) {}
 
     /**
      * Includes flag for @a item into this set.
@@ -57,11 +107,11 @@ public:
      * The following two expressions are semantically equivalent:
      * @code
      *     flags.empty()
-     *     flags == Flags<TEnum, TInt>()
+     *     flags == Flags<TEnum, TBits>()
      * @endcode
      */
     bool empty() const {
-        return this->value == 0;
+        return WordOps::isZero(words);
     }
 
     /**
@@ -72,177 +122,275 @@ public:
      *     item <= flags
      * @endcode
      */
-    bool contains(const TEnum& item) const {
-        return item <= *this;
+    constexpr bool contains(const TEnum& item) const {
+        return (words[bitIndex(item) / WORD_BITS]
+                    >> (bitIndex(item) % WORD_BITS)) & 1;
+    }
+
+    /**
+     * Returns number of flags included into this set.
+     */
+    std::size_t count() const {
+        return WordOps::popCount(words);
+    }
+
+    /**
+     * Forward iterator over items included into the set, in ascending order.
+     * Each step costs a single @em count-trailing-zeros instruction,
+     * regardless of how sparse the set is.
+     */
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef TEnum                     value_type;
+        typedef std::ptrdiff_t            difference_type;
+        typedef TEnum const*              pointer;
+        typedef TEnum                     reference;
+
+        TEnum operator * () const {
+            return static_cast<TEnum>(mWordIndex * WORD_BITS +
+                detail::countTrailingZeros(static_cast<std::uint64_t>(mBits)));
+        }
+
+        const_iterator& operator ++ () {
+            mBits &= mBits - 1;
+            skipEmptyWords();
+            return *this;
+        }
+
+        const_iterator operator ++ (int) {
+            const_iterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        bool operator == (const_iterator const& other) const {
+            return mWordIndex == other.mWordIndex && mBits == other.mBits;
+        }
+
+        bool operator != (const_iterator const& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        const_iterator(IntType const* words, std::size_t wordIndex)
+                : mWords(words), mWordIndex(wordIndex),
+                  mBits(wordIndex < WORD_COUNT ? words[wordIndex] : 0) {
+            skipEmptyWords();
+        }
+
+        void skipEmptyWords() {
+            while (mBits == 0 && mWordIndex < WORD_COUNT) {
+                if (++mWordIndex < WORD_COUNT)
+                    mBits = mWords[mWordIndex];
+            }
+        }
+
+        IntType const* mWords;
+        std::size_t    mWordIndex;
+        IntType        mBits;
+
+        friend struct Flags<TEnum, TBits>;
+    };
+
+    const_iterator begin() const {
+        return const_iterator(words, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(words, WORD_COUNT);
     }
 
     /**
      *
      */
-    Flags<TEnum>& operator &= (const Flags<TEnum>& other) {
-        return value &= other.value;
+    Flags& operator &= (const Flags& other) {
+        WordOps::bitAnd(words, other.words);
         return *this;
     }
 
     /**
      *
      */
-    Flags<TEnum>& operator |= (const Flags<TEnum>& other) {
-        value |= other.value;
+    Flags& operator |= (const Flags& other) {
+        WordOps::bitOr(words, other.words);
         return *this;
     }
 
     /**
      *
      */
-    Flags<TEnum>& operator ^= (const Flags<TEnum>& other) {
-        value ^= other.value;
+    Flags& operator ^= (const Flags& other) {
+        WordOps::bitXor(words, other.words);
         return *this;
     }
 
     /**
      *
      */
-    Flags<TEnum>& operator *= (const Flags<TEnum>& other) {
+    Flags& operator *= (const Flags& other) {
         return *this &= other;
     }
 
     /**
      *
      */
-    Flags<TEnum>& operator += (const Flags<TEnum>& other) {
+    Flags& operator += (const Flags& other) {
         return *this |= other;
     }
 
     /**
-     *
+     * Excludes all flags of @a other from this set (@em and-not operation).
      */
-    Flags<TEnum>& operator -= (const Flags<TEnum>& other) {
-        value &= value ^ other.value;
+    Flags& operator -= (const Flags& other) {
+        WordOps::bitAndNot(words, other.words);
         return *this;
     }
 
     /**
      *
      */
-    Flags<TEnum> operator & (const Flags<TEnum>& other) const {
-        return Flags<TEnum>::fromValue(value & other.value);
+    Flags operator & (const Flags& other) const {
+        return Flags(*this) &= other;
     }
 
     /**
      *
      */
-    Flags<TEnum> operator | (const Flags<TEnum>& other) const {
-        return Flags<TEnum>::fromValue(value | other.value);
+    Flags operator | (const Flags& other) const {
+        return Flags(*this) |= other;
     }
 
     /**
      *
      */
-    Flags<TEnum> operator ^ (const Flags<TEnum>& other) const {
-        return Flags<TEnum>::fromValue(value ^ other.value);
+    Flags operator ^ (const Flags& other) const {
+        return Flags(*this) ^= other;
     }
 
     /**
      *
      */
-    Flags<TEnum> operator * (const Flags<TEnum>& other) const {
-        return Flags<TEnum>::fromValue(value & other.value);
+    Flags operator * (const Flags& other) const {
+        return Flags(*this) &= other;
     }
 
     /**
      *
      */
-    Flags<TEnum> operator + (const Flags<TEnum>& other) const {
-        return Flags<TEnum>::fromValue(value | other.value);
+    Flags operator + (const Flags& other) const {
+        return Flags(*this) |= other;
     }
 
     /**
      *
      */
-    Flags<TEnum> operator - (const Flags<TEnum>& other) const {
-        return Flags<TEnum>::fromValue(value & (value ^ other.value));
+    Flags operator - (const Flags& other) const {
+        return Flags(*this) -= other;
     }
 
     /**
      *
      */
-    bool operator == (const Flags<TEnum>& other) const {
-        return value == other.value;
+    bool operator == (const Flags& other) const {
+        return WordOps::isEqual(words, other.words);
     }
 
     /**
      *
      */
-    bool operator != (const Flags<TEnum>& other) const {
-        return value != other.value;
+    bool operator != (const Flags& other) const {
+        return !(*this == other);
     }
 
     /**
      *
      */
-    bool operator <= (const Flags<TEnum>& other) const {
-        return *this | other == other;
+    bool operator <= (const Flags& other) const {
+        return (*this | other) == other;
     }
 
     /**
      *
      */
-    bool operator < (const Flags<TEnum>& other) const {
+    bool operator < (const Flags& other) const {
         return *this <= other && *this != other;
     }
 
     /**
      *
      */
-    bool operator >= (const Flags<TEnum>& other) const {
+    bool operator >= (const Flags& other) const {
         return other <= *this;
     }
 
     /**
      *
      */
-    bool operator > (const Flags<TEnum>& other) const {
+    bool operator > (const Flags& other) const {
         return other < *this;
     }
 
 private:
+    typedef detail::FlagsWordOps<IntType, WORD_COUNT> WordOps;
+
     /**
      * @internal
      * Raw bitmask value of enumeration flags.
-     * The rest of this class does nothing more than simply wraps this value
+     * The rest of this class does nothing more than simply wraps these words
      * with convenience operators and methods, with hope they will be optimized
-     * and inlined out by the compiler, leading to machine code accessing this
-     * value directly without any overhead.
+     * and inlined out by the compiler, leading to machine code accessing them
+     * directly without any overhead.
      */
-    IntType value;
+    IntType words[WORD_COUNT];
+
+    template <std::size_t... Indices, typename... TItems>
+    constexpr Flags(detail::IndexSequence<Indices...>, const TItems&... items)
+        : words{ wordOf(Indices, items...)... } {}
+
+    /**
+     * @internal
+     * Returns bit index of @a item, checking it fits into the set.
+     */
+    static constexpr std::size_t bitIndex(const TEnum& item) {
+        return static_cast<std::size_t>(item) < TBits
+                ? static_cast<std::size_t>(item)
+                : throw std::out_of_range("flag item does not fit into set");
+    }
 
     /**
      * @internal
-     * Returns class instance with raw value set to @a val.
-     * This method is heavily used for implementing operators on sets.
+     * Returns @a word-th word of the bitmask having only @a item included.
      */
-    static Flags<TEnum> fromValue(const IntType val) {
-        auto result = Flags<TEnum>();
-        result.value = val;
-        return result;
+    static constexpr IntType wordOf(std::size_t word, const TEnum& item) {
+        return bitIndex(item) / WORD_BITS == word
+                ? static_cast<IntType>(1) << (bitIndex(item) % WORD_BITS)
+                : static_cast<IntType>(0);
+    }
+
+    template <typename... TRest>
+    static constexpr IntType wordOf(std::size_t word, const TEnum& item,
+                                    const TEnum& next, const TRest&... rest) {
+        return wordOf(word, item) | wordOf(word, next, rest...);
     }
 };
 
 /**
  *
  */
-template<typename TEnum>
-Flags<TEnum> operator | (const TEnum& a, const TEnum& b) {
-    return Flags<TEnum>(a) | b;
+template<typename TEnum, typename =
+         typename std::enable_if<std::is_enum<TEnum>::value>::type>
+constexpr Flags<TEnum> operator | (const TEnum& a, const TEnum& b) {
+    return Flags<TEnum>(a, b);
 }
 
 /**
  *
  */
-template<typename TEnum>
-Flags<TEnum> operator + (const TEnum& a, const TEnum& b) {
-    return Flags<TEnum>(a) + b;
+template<typename TEnum, typename =
+         typename std::enable_if<std::is_enum<TEnum>::value>::type>
+constexpr Flags<TEnum> operator + (const TEnum& a, const TEnum& b) {
+    return Flags<TEnum>(a, b);
 }
 
 } // namespace core
@@ -0,0 +1,82 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include "rvlm/core/Vector3d.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Mapping between physical coordinates and cell indices of a uniform grid.
+ *
+ * Cell (@em ix, @em iy, @em iz) occupies the box from
+ * <tt>origin + (ix, iy, iz)*step</tt> to <tt>origin + (ix+1, iy+1, iz+1)*step</tt>,
+ * component-wise. Indices are the same global indices @c SolidArray3d uses,
+ * so arrays with non-zero begin offsets map onto the same grid.
+ */
+template <typename TFloat>
+class GridGeometry {
+public:
+    typedef TFloat ValueType;
+
+    /**
+     * Constructs grid with given origin and cell size. All cell size
+     * components must be positive, or @c std::invalid_argument is thrown.
+     */
+    GridGeometry(Vector3d<TFloat> const& origin, Vector3d<TFloat> const& step)
+            : mOrigin(origin), mStep(step) {
+        if (!(step.getX() > 0 && step.getY() > 0 && step.getZ() > 0))
+            throw std::invalid_argument("grid step must be positive");
+    }
+
+    Vector3d<TFloat> const& getOrigin() const { return mOrigin; }
+    Vector3d<TFloat> const& getStep()   const { return mStep; }
+
+    /**
+     * Converts physical coordinate @a x along @a axis into fractional cell
+     * coordinate, which is integral exactly at cell boundaries.
+     */
+    TFloat toGrid(int axis, TFloat x) const {
+        return (x - mOrigin.get(axis)) / mStep.get(axis);
+    }
+
+    /**
+     * Converts fractional cell coordinate back to physical coordinate.
+     */
+    TFloat fromGrid(int axis, TFloat g) const {
+        return mOrigin.get(axis) + g * mStep.get(axis);
+    }
+
+    /**
+     * Returns index of the cell containing physical coordinate @a x.
+     */
+    std::int64_t cellIndex(int axis, TFloat x) const {
+        return static_cast<std::int64_t>(std::floor(toGrid(axis, x)));
+    }
+
+    /**
+     * Returns lower corner of cell (@a ix, @a iy, @a iz).
+     */
+    Vector3d<TFloat> cellLower(std::int64_t ix, std::int64_t iy,
+                               std::int64_t iz) const {
+        return mOrigin + mStep.scale(Vector3d<TFloat>(
+            static_cast<TFloat>(ix), static_cast<TFloat>(iy),
+            static_cast<TFloat>(iz)));
+    }
+
+    /**
+     * Returns center of cell (@a ix, @a iy, @a iz).
+     */
+    Vector3d<TFloat> cellCenter(std::int64_t ix, std::int64_t iy,
+                                std::int64_t iz) const {
+        return cellLower(ix, iy, iz) + mStep / 2;
+    }
+
+private:
+    Vector3d<TFloat> mOrigin;
+    Vector3d<TFloat> mStep;
+};
+
+} // namespace core
+} // namespace rvlm
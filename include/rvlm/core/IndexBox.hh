@@ -0,0 +1,104 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include "rvlm/core/HalfOpenRange.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Box of cells in global index space: three half-open index ranges.
+ *
+ * Unlike a triple of @c HalfOpenRange objects, boxes are assignable, so they
+ * may be stored in containers, sorted and returned from queries. Empty boxes
+ * are allowed and normalized to have @c stop equal to @c start.
+ */
+template <typename TInt = std::ptrdiff_t>
+struct IndexBox {
+    TInt start[3];
+    TInt stop[3];
+
+    IndexBox()
+        : start{0, 0, 0}, stop{0, 0, 0} {}
+
+    IndexBox(TInt x0, TInt x1, TInt y0, TInt y1, TInt z0, TInt z1)
+        : start{x0, y0, z0}, stop{std::max(x0, x1), std::max(y0, y1),
+                                  std::max(z0, z1)} {}
+
+    IndexBox(HalfOpenRange<TInt> const& xRange,
+             HalfOpenRange<TInt> const& yRange,
+             HalfOpenRange<TInt> const& zRange)
+        : IndexBox(xRange.start, xRange.stop, yRange.start, yRange.stop,
+                   zRange.start, zRange.stop) {}
+
+    /**
+     * Constructs box covering the whole @a array, which may be any type
+     * having @c getBeginX, @c getEndX and so on, like @c SolidArray3d.
+     */
+    template <typename TArray>
+    static IndexBox of(TArray const& array) {
+        return IndexBox(static_cast<TInt>(array.getBeginX()),
+                        static_cast<TInt>(array.getEndX()),
+                        static_cast<TInt>(array.getBeginY()),
+                        static_cast<TInt>(array.getEndY()),
+                        static_cast<TInt>(array.getBeginZ()),
+                        static_cast<TInt>(array.getEndZ()));
+    }
+
+    HalfOpenRange<TInt> range(int axis) const {
+        return HalfOpenRange<TInt>(start[axis], stop[axis]);
+    }
+
+    TInt size(int axis) const {
+        return stop[axis] - start[axis];
+    }
+
+    /**
+     * Gets total number of cells in the box.
+     */
+    TInt count() const {
+        return size(0) * size(1) * size(2);
+    }
+
+    bool empty() const {
+        return !(start[0] < stop[0] && start[1] < stop[1] && start[2] < stop[2]);
+    }
+
+    bool contains(TInt ix, TInt iy, TInt iz) const {
+        return start[0] <= ix && ix < stop[0] &&
+               start[1] <= iy && iy < stop[1] &&
+               start[2] <= iz && iz < stop[2];
+    }
+
+    bool contains(IndexBox const& other) const {
+        return other.empty() ||
+               (start[0] <= other.start[0] && other.stop[0] <= stop[0] &&
+                start[1] <= other.start[1] && other.stop[1] <= stop[1] &&
+                start[2] <= other.start[2] && other.stop[2] <= stop[2]);
+    }
+
+    bool overlaps(IndexBox const& other) const {
+        return !intersect(other).empty();
+    }
+
+    IndexBox intersect(IndexBox const& other) const {
+        return IndexBox(std::max(start[0], other.start[0]),
+                        std::min(stop[0],  other.stop[0]),
+                        std::max(start[1], other.start[1]),
+                        std::min(stop[1],  other.stop[1]),
+                        std::max(start[2], other.start[2]),
+                        std::min(stop[2],  other.stop[2]));
+    }
+
+    bool operator == (IndexBox const& other) const {
+        return std::equal(start, start + 3, other.start) &&
+               std::equal(stop,  stop  + 3, other.stop);
+    }
+
+    bool operator != (IndexBox const& other) const {
+        return !(*this == other);
+    }
+};
+
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include "rvlm/core/CpuDispatch.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Compiled kernels over contiguous runs of @a T, usually rows of
+ * @c SolidArray3d along @em Z. Output runs must not overlap input runs.
+ */
+template <typename T>
+struct KernelSet {
+
+    /** Assigns @a value to @a n items of @a dst. */
+    void (*fill)(T* dst, std::size_t n, T value);
+
+    /** Sums @a n items of @a src in double precision. */
+    double (*sum)(T const* src, std::size_t n);
+
+    /** Computes dot product of @a n items of @a a and @a b in double precision. */
+    double (*dot)(T const* a, T const* b, std::size_t n);
+
+    /** Gets largest absolute value of @a n items of @a src, or 0 if none. */
+    T (*maxAbs)(T const* src, std::size_t n);
+
+    /**
+     * Adds <tt>scale[i]*(ca*(a[i] - a0[i]) - cb*(b[i] - b0[i]))</tt> to
+     * @a dst[i] for @a n items: one component of a Yee curl update, with
+     * @a a0 and @a b0 being rows of neighbouring cells and @a scale the
+     * per-cell medium coefficients. Null @a scale stands for all ones.
+     */
+    void (*curlUpdate)(T* dst, T const* scale,
+                       T const* a, T const* a0, T ca,
+                       T const* b, T const* b0, T cb, std::size_t n);
+};
+
+/**
+ * Complete set of compiled kernels built for one instruction set level.
+ */
+struct KernelTable {
+    Isa                isa;
+    KernelSet<float>   f32;
+    KernelSet<double>  f64;
+
+    /** Converts @a n floats to doubles. */
+    void (*widen)(float const* src, double* dst, std::size_t n);
+
+    /** Converts @a n doubles to floats, rounding to nearest. */
+    void (*narrow)(double const* src, float* dst, std::size_t n);
+};
+
+/**
+ * Gets kernels built for the best level not above @a isa. Calling kernels
+ * for levels the processor does not support crashes the program.
+ */
+KernelTable const& kernelTable(Isa isa);
+
+/**
+ * Gets kernels for @c activeIsa, which are looked up at the first call.
+ */
+KernelTable const& activeKernels();
+
+namespace kernels {
+
+namespace detail {
+
+inline KernelSet<float> const& setOf(KernelTable const& t, float*)   { return t.f32; }
+inline KernelSet<double> const& setOf(KernelTable const& t, double*) { return t.f64; }
+
+} // namespace detail
+
+/**
+ * Gets active kernels for values of type @a T, either @c float or
+ * @c double.
+ */
+template <typename T>
+KernelSet<T> const& active() {
+    return detail::setOf(activeKernels(), static_cast<T*>(0));
+}
+
+template <typename T>
+inline void fill(T* dst, std::size_t n, T value) {
+    active<T>().fill(dst, n, value);
+}
+
+template <typename T>
+inline double sum(T const* src, std::size_t n) {
+    return active<T>().sum(src, n);
+}
+
+template <typename T>
+inline double dot(T const* a, T const* b, std::size_t n) {
+    return active<T>().dot(a, b, n);
+}
+
+template <typename T>
+inline T maxAbs(T const* src, std::size_t n) {
+    return active<T>().maxAbs(src, n);
+}
+
+template <typename T>
+inline void curlUpdate(T* dst, T const* scale,
+                       T const* a, T const* a0, T ca,
+                       T const* b, T const* b0, T cb, std::size_t n) {
+    active<T>().curlUpdate(dst, scale, a, a0, ca, b, b0, cb, n);
+}
+
+inline void convert(float const* src, double* dst, std::size_t n) {
+    activeKernels().widen(src, dst, n);
+}
+
+inline void convert(double const* src, float* dst, std::size_t n) {
+    activeKernels().narrow(src, dst, n);
+}
+
+} // namespace kernels
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,265 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/CellOffsets.hh"
+#include "rvlm/core/HalfOpenRange.hh"
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/NonAssignable.hh"
+#include "rvlm/core/SolidArray3d.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Per-cell coefficients stored as material numbers of cells and a table of
+ * coefficients for every material.
+ *
+ * Every material has the same number of coefficients, e.g. inverse
+ * relative permittivity and permeability, or the pairs of update
+ * coefficients of lossy media. Instead of one array of @a TFloat per
+ * coefficient, cells keep a single @a TId, one byte for the default type,
+ * and the table of a few hundred materials stays in L1 cache. The table is
+ * kept coefficient by coefficient, so that runs of cells are looked up with
+ * SIMD gathers from one column.
+ *
+ * The grid may be built directly, by adding materials and assigning them to
+ * cells, or from existing per-cell coefficient arrays, in which case equal
+ * coefficient tuples become one material.
+ */
+template <typename TFloat, typename TId = std::uint8_t,
+          typename TIndex = std::size_t>
+class MaterialGrid: public NonAssignable {
+public:
+
+    typedef SolidArray3d<TFloat, TIndex> CoefficientArray;
+    typedef SolidArray3d<TId, TIndex>    IdArray;
+    typedef IndexBox<std::ptrdiff_t>     Box;
+
+    /**
+     * Largest number of materials representable by @a TId.
+     */
+    static const std::size_t MAX_MATERIALS =
+            static_cast<std::size_t>(std::numeric_limits<TId>::max()) + 1;
+
+    /**
+     * Constructs grid covering given ranges, with all cells made of material
+     * 0 having coefficients @a background. The number of coefficients of
+     * every material is the size of @a background.
+     */
+    MaterialGrid(HalfOpenRange<TIndex> const& xRange,
+                 HalfOpenRange<TIndex> const& yRange,
+                 HalfOpenRange<TIndex> const& zRange,
+                 std::vector<TFloat> const& background)
+            throw(std::bad_alloc, std::range_error, std::invalid_argument)
+            : mIds(xRange, yRange, zRange, 0),
+              mCoefficientCount(background.size()), mMaterialCount(0) {
+        if (background.empty())
+            throw std::invalid_argument("materials need coefficients");
+        addMaterial(background);
+    }
+
+    /**
+     * Builds grid from per-cell @a coefficients arrays of the same
+     * geometry, one array per coefficient. Cells with equal values in all
+     * arrays share the material. Throws @c std::length_error if there are
+     * more distinct tuples than @a TId can number.
+     */
+    explicit MaterialGrid(std::vector<CoefficientArray const*> const& coefficients)
+            throw(std::bad_alloc, std::range_error, std::invalid_argument,
+                  std::length_error)
+            : mIds(rangeOf(coefficients, 0), rangeOf(coefficients, 1),
+                   rangeOf(coefficients, 2), 0),
+              mCoefficientCount(coefficients.size()), mMaterialCount(0) {
+        for (std::size_t c = 1; c < coefficients.size(); ++c) {
+            if (coefficients[c]->getBox() != coefficients[0]->getBox())
+                throw std::invalid_argument("coefficient arrays differ in geometry");
+        }
+
+        // Neighbouring cells are mostly of the same material, so the
+        // previous tuple is compared first and the map is rarely searched.
+        std::map<std::vector<TFloat>, TId> known;
+        std::vector<TFloat> tuple(mCoefficientCount), last;
+        TId lastId = 0;
+        TId* ids = mIds.getOrigin();
+        const std::size_t total = static_cast<std::size_t>(mIds.getTotalCount());
+        for (std::size_t i = 0; i < total; ++i) {
+            for (std::size_t c = 0; c < mCoefficientCount; ++c)
+                tuple[c] = coefficients[c]->getOrigin()[i];
+            if (tuple != last) {
+                typename std::map<std::vector<TFloat>, TId>::iterator it =
+                        known.find(tuple);
+                if (it == known.end())
+                    it = known.insert(std::make_pair(tuple,
+                            static_cast<TId>(addMaterial(tuple)))).first;
+                lastId = it->second;
+                last = tuple;
+            }
+            ids[i] = lastId;
+        }
+    }
+
+    std::size_t getCoefficientCount() const { return mCoefficientCount; }
+
+    std::size_t getMaterialCount() const { return mMaterialCount; }
+
+    Box getBox() const { return mIds.getBox(); }
+
+    IdArray const& getIds() const { return mIds; }
+
+    /**
+     * Adds material with given @a coefficients and returns its number, or
+     * returns number of an existing material with the same coefficients.
+     * Throws @c std::length_error if the table is full.
+     */
+    std::size_t addMaterial(std::vector<TFloat> const& coefficients) {
+        if (coefficients.size() != mCoefficientCount)
+            throw std::invalid_argument("wrong number of coefficients");
+        for (std::size_t id = 0; id < mMaterialCount; ++id) {
+            bool same = true;
+            for (std::size_t c = 0; c < mCoefficientCount && same; ++c)
+                same = coefficient(c, id) == coefficients[c];
+            if (same)
+                return id;
+        }
+        if (mMaterialCount == MAX_MATERIALS)
+            throw std::length_error("too many materials for material id type");
+
+        // Columns are re-laid with the new row; this happens a few hundred
+        // times at most.
+        std::vector<TFloat> table;
+        table.reserve((mMaterialCount + 1) * mCoefficientCount);
+        for (std::size_t c = 0; c < mCoefficientCount; ++c) {
+            table.insert(table.end(), mTable.begin() + c*mMaterialCount,
+                         mTable.begin() + (c + 1)*mMaterialCount);
+            table.push_back(coefficients[c]);
+        }
+        mTable.swap(table);
+        return mMaterialCount++;
+    }
+
+    /**
+     * Gets coefficient number @a c of material @a id.
+     */
+    TFloat coefficient(std::size_t c, std::size_t id) const {
+        return mTable[c*mMaterialCount + id];
+    }
+
+    /**
+     * Gets column of coefficient @a c, indexed by material number.
+     */
+    TFloat const* getColumn(std::size_t c) const {
+        return &mTable[c*mMaterialCount];
+    }
+
+    TId getMaterial(TIndex ix, TIndex iy, TIndex iz) const {
+        return mIds.at(ix, iy, iz);
+    }
+
+    /**
+     * Assigns material @a id to a cell. Throws @c std::out_of_range if the
+     * cell lies outside the grid or the material does not exist.
+     */
+    void setMaterial(TIndex ix, TIndex iy, TIndex iz, std::size_t id) {
+        requireMaterial(id);
+        mIds.at(ix, iy, iz) = static_cast<TId>(id);
+    }
+
+    /**
+     * Assigns material @a id to all cells of @a box.
+     */
+    void setMaterial(Box const& box, std::size_t id) {
+        requireMaterial(id);
+        if (!mIds.getBox().contains(box))
+            throw std::out_of_range("box exceeds material grid");
+        for (std::ptrdiff_t ix = box.start[0]; ix < box.stop[0]; ++ix)
+        for (std::ptrdiff_t iy = box.start[1]; iy < box.stop[1]; ++iy) {
+            TId* p = mIds.getCursor(static_cast<TIndex>(ix),
+                                    static_cast<TIndex>(iy),
+                                    static_cast<TIndex>(box.start[2]));
+            std::fill(p, p + box.size(2), static_cast<TId>(id));
+        }
+    }
+
+    /**
+     * Gets coefficient @a c of the cell at given coordinates.
+     */
+    TFloat at(std::size_t c, TIndex ix, TIndex iy, TIndex iz) const {
+        return coefficient(c, mIds.at(ix, iy, iz));
+    }
+
+    /**
+     * Looks up coefficient @a c for @a n cells along @em Z starting from
+     * (@a ix, @a iy, @a iz) into @a out. Coordinates are not checked.
+     */
+    void gather(std::size_t c, TIndex ix, TIndex iy, TIndex iz, std::size_t n,
+                TFloat* out) const {
+        gather(c, mIds.getCursor(ix, iy, iz), n, out);
+    }
+
+    /**
+     * Looks up coefficient @a c for @a n materials @a ids into @a out.
+     * Where the compiler targets AVX, material numbers are widened in
+     * blocks and looked up with SIMD gathers from the column; otherwise a
+     * plain loop is faster than emulated gathers.
+     */
+    void gather(std::size_t c, TId const* ids, std::size_t n, TFloat* out) const {
+        TFloat const* column = getColumn(c);
+        if (detail::NativeSimdWidth<TFloat>::value == 1) {
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = column[ids[i]];
+            return;
+        }
+
+        const std::size_t BLOCK = 256;
+        std::size_t offsets[BLOCK];
+        for (std::size_t first = 0; first < n; first += BLOCK) {
+            const std::size_t m = std::min(BLOCK, n - first);
+            for (std::size_t i = 0; i < m; ++i)
+                offsets[i] = ids[first + i];
+            detail::BatchAccess<TFloat>::gather(column, offsets, m, out + first);
+        }
+    }
+
+    /**
+     * Gets memory taken by material numbers and the table, in bytes.
+     */
+    std::size_t getMemoryUsage() const {
+        return static_cast<std::size_t>(mIds.getTotalCount()) * sizeof(TId)
+             + mTable.size() * sizeof(TFloat);
+    }
+
+private:
+
+    static HalfOpenRange<TIndex> rangeOf(
+            std::vector<CoefficientArray const*> const& arrays, int axis) {
+        if (arrays.empty())
+            throw std::invalid_argument("materials need coefficients");
+        CoefficientArray const& a = *arrays[0];
+        switch (axis) {
+            case 0:  return HalfOpenRange<TIndex>(a.getBeginX(), a.getEndX());
+            case 1:  return HalfOpenRange<TIndex>(a.getBeginY(), a.getEndY());
+            default: return HalfOpenRange<TIndex>(a.getBeginZ(), a.getEndZ());
+        }
+    }
+
+    void requireMaterial(std::size_t id) const {
+        if (id >= mMaterialCount)
+            throw std::out_of_range("no such material");
+    }
+
+    IdArray             mIds;
+    std::size_t         mCoefficientCount;
+    std::size_t         mMaterialCount;
+    std::vector<TFloat> mTable;
+};
+
+template <typename TFloat, typename TId, typename TIndex>
+const std::size_t MaterialGrid<TFloat, TId, TIndex>::MAX_MATERIALS;
+
+} // namespace core
+} // namespace rvlm
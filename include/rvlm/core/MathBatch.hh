@@ -0,0 +1,607 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include "rvlm/core/Math.hh"
+#include "rvlm/core/SolidArray3d.hh"
+#include "rvlm/core/detail/Simd.hh"
+
+namespace rvlm {
+namespace core {
+namespace math {
+
+/**
+ * Accuracy tiers of batch math functions.
+ *
+ * @c Reference calls the C library function for every element, and so is
+ * as accurate as the C library is (correctly rounded or within a fraction
+ * of ulp on common implementations); other tiers are measured against it.
+ * @c Ulp1 evaluates vectorized polynomials having maximum error of about one
+ * unit in the last place. @c Fast uses shorter polynomials with relative
+ * error of about 1e-7, which is still below the float resolution.
+ */
+enum class Accuracy {
+    Reference,
+    Ulp1,
+    Fast
+};
+
+namespace detail {
+
+using rvlm::core::detail::SimdTraits;
+using rvlm::core::detail::NativeSimdWidth;
+
+template <Accuracy A>
+struct AccuracyTag {};
+
+/**
+ * @internal
+ * Evaluates polynomial <tt>c0 + c1*z + c2*z^2 + ...</tt> by Horner scheme.
+ */
+template <typename S, typename T>
+typename S::Register horner(typename S::Register const&, T c) {
+    return S::broadcast(c);
+}
+
+template <typename S, typename T, typename... TRest>
+typename S::Register horner(typename S::Register const& z, T c, TRest... rest) {
+    return S::fmadd(horner<S>(z, rest...), z, S::broadcast(c));
+}
+
+/**
+ * @internal
+ * Range reduction constants and polynomial coefficients for type @a T.
+ * Constants are used only by value, so they need no definitions.
+ */
+template <typename T>
+struct MathCoefficients;
+
+template <>
+struct MathCoefficients<double> {
+    // exp(x) = 2^n * exp(r), r = x - n*ln2, |r| <= ln2/2.
+    static constexpr double LOG2E  = 1.44269504088896338700e+00;
+    static constexpr double LN2_HI = 6.93147180369123816490e-01;
+    static constexpr double LN2_LO = 1.90821492927058770002e-10;
+    static constexpr double EXP_UNDERFLOW = -708.0;
+    static constexpr double EXP_OVERFLOW  = 7.09782712893383973096e+02;
+
+    // sin(x), cos(x) via r = x - q*pi/2, |r| <= pi/4, with pi/2 split into
+    // 33-bit parts, so that q*PIO2_1 is exact for |q| < 2^20.
+    static constexpr double INV_PIO2 = 6.36619772367581382433e-01;
+    static constexpr double PIO2_1   = 1.57079632673412561417e+00;
+    static constexpr double PIO2_2   = 6.07710050630396597660e-11;
+    static constexpr double PIO2_3   = 2.02226624871116645580e-21;
+    static constexpr double TRIG_LIMIT = 8.0e+05;
+
+    // Taylor series; terms up to r^13 keep truncation error below 0.05 ulp.
+    template <typename S>
+    static typename S::Register expPoly(typename S::Register const& r,
+                                        AccuracyTag<Accuracy::Ulp1>) {
+        return horner<S>(r, 1.0, 1.0, 1.0/2, 1.0/6, 1.0/24, 1.0/120,
+                         1.0/720, 1.0/5040, 1.0/40320, 1.0/362880,
+                         1.0/3628800, 1.0/39916800, 1.0/479001600,
+                         1.0/6227020800.0);
+    }
+
+    template <typename S>
+    static typename S::Register expPoly(typename S::Register const& r,
+                                        AccuracyTag<Accuracy::Fast>) {
+        return horner<S>(r, 1.0, 1.0, 1.0/2, 1.0/6, 1.0/24, 1.0/120,
+                         1.0/720, 1.0/5040);
+    }
+
+    // Minimax coefficients of FreeBSD msun __kernel_sin and __kernel_cos.
+    template <typename S>
+    static typename S::Register sinPoly(typename S::Register const& r,
+                                        typename S::Register const& z,
+                                        AccuracyTag<Accuracy::Ulp1>) {
+        return S::fmadd(S::mul(r, z), horner<S>(z,
+                -1.66666666666666324348e-01, 8.33333333332248946124e-03,
+                -1.98412698298579493134e-04, 2.75573137070700676789e-06,
+                -2.50507602534068634195e-08, 1.58969099521155010221e-10), r);
+    }
+
+    template <typename S>
+    static typename S::Register sinPoly(typename S::Register const& r,
+                                        typename S::Register const& z,
+                                        AccuracyTag<Accuracy::Fast>) {
+        return S::fmadd(S::mul(r, z), horner<S>(z,
+                -1.66666666666666324348e-01, 8.33333333332248946124e-03,
+                -1.98412698298579493134e-04, 2.75573137070700676789e-06), r);
+    }
+
+    template <typename S>
+    static typename S::Register cosPoly(typename S::Register const& z,
+                                        AccuracyTag<Accuracy::Ulp1>) {
+        return S::fmadd(S::mul(z, z), horner<S>(z,
+                4.16666666666666019037e-02, -1.38888888888741095749e-03,
+                2.48015872894767294178e-05, -2.75573143513906633035e-07,
+                2.08757232129817482790e-09, -1.13596475577881948265e-11),
+                S::fmadd(z, S::broadcast(-0.5), S::broadcast(1.0)));
+    }
+
+    template <typename S>
+    static typename S::Register cosPoly(typename S::Register const& z,
+                                        AccuracyTag<Accuracy::Fast>) {
+        return S::fmadd(S::mul(z, z), horner<S>(z,
+                4.16666666666666019037e-02, -1.38888888888741095749e-03,
+                2.48015872894767294178e-05),
+                S::fmadd(z, S::broadcast(-0.5), S::broadcast(1.0)));
+    }
+};
+
+template <>
+struct MathCoefficients<float> {
+    static constexpr float LOG2E  = 1.44269504088896341f;
+    static constexpr float LN2_HI = 0.693359375f;
+    static constexpr float LN2_LO = -2.12194440e-4f;
+    static constexpr float EXP_UNDERFLOW = -86.6f;
+    static constexpr float EXP_OVERFLOW  = 88.7228391f;
+
+    static constexpr float INV_PIO2 = 0.636619772367581343f;
+    static constexpr float PIO2_1   = 1.5703125f;
+    static constexpr float PIO2_2   = 4.837512969970703125e-4f;
+    static constexpr float PIO2_3   = 7.54978995489188216e-8f;
+    static constexpr float TRIG_LIMIT = 8192.0f;
+
+    // Coefficients of Cephes expf, sinf and cosf. Float polynomials are
+    // already short, so both tiers share them.
+    template <typename S, Accuracy A>
+    static typename S::Register expPoly(typename S::Register const& r,
+                                        AccuracyTag<A>) {
+        typename S::Register p = horner<S>(r,
+                5.0000001201e-1f, 1.6666665459e-1f, 4.1665795894e-2f,
+                8.3334519073e-3f, 1.3981999507e-3f, 1.9875691500e-4f);
+        return S::fmadd(S::mul(r, r), p, S::add(r, S::broadcast(1.0f)));
+    }
+
+    template <typename S, Accuracy A>
+    static typename S::Register sinPoly(typename S::Register const& r,
+                                        typename S::Register const& z,
+                                        AccuracyTag<A>) {
+        return S::fmadd(S::mul(r, z), horner<S>(z,
+                -1.6666654611e-1f, 8.3321608736e-3f, -1.9515295891e-4f), r);
+    }
+
+    template <typename S, Accuracy A>
+    static typename S::Register cosPoly(typename S::Register const& z,
+                                        AccuracyTag<A>) {
+        return S::fmadd(S::mul(z, z), horner<S>(z,
+                4.166664568298827e-2f, -1.388731625493765e-3f,
+                2.443315711809948e-5f),
+                S::fmadd(z, S::broadcast(-0.5f), S::broadcast(1.0f)));
+    }
+};
+
+template <typename T, typename S, Accuracy A>
+typename S::Register expKernel(typename S::Register const& x) {
+    typedef MathCoefficients<T> C;
+    typedef typename S::Register R;
+
+    R xc = S::min(S::max(x, S::broadcast(C::EXP_UNDERFLOW)),
+                            S::broadcast(C::EXP_OVERFLOW));
+    R n  = S::nearest(S::mul(xc, S::broadcast(C::LOG2E)));
+    R r  = S::fmadd(n, S::broadcast(-C::LN2_HI), xc);
+    r    = S::fmadd(n, S::broadcast(-C::LN2_LO), r);
+    R y  = S::scale2(C::template expPoly<S>(r, AccuracyTag<A>()), n);
+
+    // Results below the smallest normal number are flushed to zero. Vector
+    // min and max return the ordered operand, so NaN lanes are put back.
+    y = S::blendGreater(x, S::broadcast(C::EXP_OVERFLOW),
+                        S::broadcast(std::numeric_limits<T>::infinity()), y);
+    y = S::blendGreater(S::broadcast(C::EXP_UNDERFLOW), x,
+                        S::broadcast(T(0)), y);
+    return S::blendUnordered(x, x, x, y);
+}
+
+/**
+ * @internal
+ * Computes sine and cosine of @a x together. Quadrant number @c q selects
+ * between polynomials and their signs:
+ * <tt>sin(x) = (+s, +c, -s, -c)[q mod 4]</tt>,
+ * <tt>cos(x) = (+c, -s, -c, +s)[q mod 4]</tt>.
+ */
+template <typename T, typename S, Accuracy A>
+void sinCosKernel(typename S::Register const& x,
+                  typename S::Register* sinOut,
+                  typename S::Register* cosOut) {
+    typedef MathCoefficients<T> C;
+    typedef typename S::Register R;
+
+    R q = S::nearest(S::mul(x, S::broadcast(C::INV_PIO2)));
+    R r = S::fmadd(q, S::broadcast(-C::PIO2_1), x);
+    r   = S::fmadd(q, S::broadcast(-C::PIO2_2), r);
+    r   = S::fmadd(q, S::broadcast(-C::PIO2_3), r);
+    R z = S::mul(r, r);
+
+    R s = C::template sinPoly<S>(r, z, AccuracyTag<A>());
+    R c = C::template cosPoly<S>(z, AccuracyTag<A>());
+
+    // Bits of q as floating point values, all exact for |q| < 2^22.
+    R half    = S::broadcast(T(0.5));
+    R quarter = S::broadcast(T(0.25));
+    R two     = S::broadcast(T(2));
+    R q2 = S::floor(S::mul(q, half));
+    R q4 = S::floor(S::mul(q, quarter));
+    R odd  = S::sub(q, S::mul(q2, two));
+    R bit1 = S::sub(q2, S::mul(q4, two));
+
+    if (sinOut) {
+        R v = S::blendGreater(odd, half, c, s);
+        *sinOut = S::blendGreater(bit1, half, S::neg(v), v);
+    }
+    if (cosOut) {
+        // Sign of cosine flips where bit 1 of (q + 1) is set.
+        R v = S::blendGreater(odd, half, s, c);
+        R q1 = S::add(q, S::broadcast(T(1)));
+        R bit1c = S::sub(S::floor(S::mul(q1, half)),
+                         S::mul(S::floor(S::mul(q1, quarter)), two));
+        *cosOut = S::blendGreater(bit1c, half, S::neg(v), v);
+    }
+}
+
+/**
+ * @internal
+ * Applies @a kernel to @a count values, register by register. The tail is
+ * processed through a zero-padded register-sized buffer. Kernels declaring
+ * @c FIXUP get a chance to patch results of every register while input
+ * values are still intact, which matters when input and output coincide.
+ */
+template <typename T, typename S, typename TKernel>
+void forEachRegister(T const* in, T* out, std::size_t count, TKernel kernel) {
+    const std::size_t W = S::WIDTH;
+    T buffer[W];
+    for (std::size_t i = 0; i < count; i += W) {
+        std::size_t n = count - i < W ? count - i : W;
+        if (n == W && !TKernel::FIXUP) {
+            S::store(out + i, kernel(S::load(in + i)));
+            continue;
+        }
+
+        if (n == W) {
+            S::store(buffer, kernel(S::load(in + i)));
+        } else {
+            for (std::size_t k = 0; k < W; ++k) buffer[k] = k < n ? in[i + k] : T(0);
+            S::store(buffer, kernel(S::load(buffer)));
+        }
+        if (TKernel::FIXUP)
+            kernel.fixup(in + i, buffer, n);
+        for (std::size_t k = 0; k < n; ++k) out[i + k] = buffer[k];
+    }
+}
+
+template <typename T, Accuracy A>
+struct ExpFunctor {
+    typedef SimdTraits<T, NativeSimdWidth<T>::value> S;
+    static const bool FIXUP = false;
+
+    typename S::Register operator () (typename S::Register const& x) const {
+        return expKernel<T, S, A>(x);
+    }
+
+    void fixup(T const*, T*, std::size_t) const {}
+};
+
+/**
+ * @internal
+ * Computes sine or cosine. Arguments too large for Cody-Waite reduction
+ * are recomputed with the C library, which performs the full reduction.
+ */
+template <typename T, Accuracy A, bool Sine>
+struct SinOrCosFunctor {
+    typedef SimdTraits<T, NativeSimdWidth<T>::value> S;
+    static const bool FIXUP = true;
+
+    typename S::Register operator () (typename S::Register const& x) const {
+        typename S::Register y;
+        sinCosKernel<T, S, A>(x, Sine ? &y : nullptr, Sine ? nullptr : &y);
+        return y;
+    }
+
+    void fixup(T const* x, T* y, std::size_t n) const {
+        const T limit = MathCoefficients<T>::TRIG_LIMIT;
+        for (std::size_t k = 0; k < n; ++k) {
+            if (!(std::abs(x[k]) <= limit))
+                y[k] = Sine ? std::sin(x[k]) : std::cos(x[k]);
+        }
+    }
+};
+
+template <typename T>
+struct RoundFunctor {
+    typedef SimdTraits<T, NativeSimdWidth<T>::value> S;
+    static const bool FIXUP = false;
+
+    typename S::Register operator () (typename S::Register const& x) const {
+        return S::floor(S::add(x, S::broadcast(static_cast<T>(1)/2)));
+    }
+
+    void fixup(T const*, T*, std::size_t) const {}
+};
+
+template <Accuracy A, typename T>
+void exp(T const* in, T* out, std::size_t count, AccuracyTag<A>) {
+    typedef ExpFunctor<T, A> F;
+    forEachRegister<T, typename F::S>(in, out, count, F());
+}
+
+template <typename T>
+void exp(T const* in, T* out, std::size_t count,
+         AccuracyTag<Accuracy::Reference>) {
+    for (std::size_t i = 0; i < count; ++i) out[i] = std::exp(in[i]);
+}
+
+template <Accuracy A, typename T>
+void sin(T const* in, T* out, std::size_t count, AccuracyTag<A>) {
+    typedef SinOrCosFunctor<T, A, true> F;
+    forEachRegister<T, typename F::S>(in, out, count, F());
+}
+
+template <typename T>
+void sin(T const* in, T* out, std::size_t count,
+         AccuracyTag<Accuracy::Reference>) {
+    for (std::size_t i = 0; i < count; ++i) out[i] = std::sin(in[i]);
+}
+
+template <Accuracy A, typename T>
+void cos(T const* in, T* out, std::size_t count, AccuracyTag<A>) {
+    typedef SinOrCosFunctor<T, A, false> F;
+    forEachRegister<T, typename F::S>(in, out, count, F());
+}
+
+template <typename T>
+void cos(T const* in, T* out, std::size_t count,
+         AccuracyTag<Accuracy::Reference>) {
+    for (std::size_t i = 0; i < count; ++i) out[i] = std::cos(in[i]);
+}
+
+} // namespace detail
+
+/**
+ * Computes <tt>out[i] = exp(in[i])</tt> for @a count elements. Input and
+ * output may be the same array, but must not overlap otherwise.
+ *
+ * Vectorized tiers return zero for arguments below -708 (-86.6 for floats),
+ * where results approach the smallest normal number, and infinity for
+ * arguments whose results overflow.
+ */
+template <Accuracy A = Accuracy::Ulp1, typename TFloat>
+inline void exp(TFloat const* in, TFloat* out, std::size_t count) {
+    detail::exp(in, out, count, detail::AccuracyTag<A>());
+}
+
+/**
+ * Computes <tt>out[i] = sin(in[i])</tt> for @a count elements. Arguments
+ * larger than 8*10^5 in magnitude (8192 for floats) are passed to the C
+ * library for exact range reduction.
+ */
+template <Accuracy A = Accuracy::Ulp1, typename TFloat>
+inline void sin(TFloat const* in, TFloat* out, std::size_t count) {
+    detail::sin(in, out, count, detail::AccuracyTag<A>());
+}
+
+/**
+ * Computes <tt>out[i] = cos(in[i])</tt>, the same way @c sin does.
+ */
+template <Accuracy A = Accuracy::Ulp1, typename TFloat>
+inline void cos(TFloat const* in, TFloat* out, std::size_t count) {
+    detail::cos(in, out, count, detail::AccuracyTag<A>());
+}
+
+/**
+ * Computes both sine and cosine of @a count elements, sharing the range
+ * reduction. Output arrays must not overlap each other, but either of them
+ * may coincide with the input.
+ */
+template <Accuracy A = Accuracy::Ulp1, typename TFloat>
+inline void sincos(TFloat const* in, TFloat* sinOut, TFloat* cosOut,
+                   std::size_t count) {
+    if (A == Accuracy::Reference) {
+        for (std::size_t i = 0; i < count; ++i) {
+            TFloat x = in[i];
+            sinOut[i] = std::sin(x);
+            cosOut[i] = std::cos(x);
+        }
+        return;
+    }
+
+    typedef rvlm::core::detail::SimdTraits<TFloat,
+        rvlm::core::detail::NativeSimdWidth<TFloat>::value> S;
+    const std::size_t W = S::WIDTH;
+    const Accuracy tier = A == Accuracy::Fast ? Accuracy::Fast : Accuracy::Ulp1;
+    const TFloat limit = detail::MathCoefficients<TFloat>::TRIG_LIMIT;
+
+    TFloat xb[W], sb[W], cb[W];
+    for (std::size_t i = 0; i < count; i += W) {
+        std::size_t n = count - i < W ? count - i : W;
+        for (std::size_t k = 0; k < W; ++k) xb[k] = k < n ? in[i + k] : TFloat(0);
+
+        typename S::Register s, c;
+        detail::sinCosKernel<TFloat, S, tier>(S::load(xb), &s, &c);
+        S::store(sb, s);
+        S::store(cb, c);
+
+        for (std::size_t k = 0; k < n; ++k) {
+            if (!(std::abs(xb[k]) <= limit)) {
+                sb[k] = std::sin(xb[k]);
+                cb[k] = std::cos(xb[k]);
+            }
+            sinOut[i + k] = sb[k];
+            cosOut[i + k] = cb[k];
+        }
+    }
+}
+
+/**
+ * Rounds @a count elements to nearest integer, halves rounded up, the same
+ * way scalar @c round does.
+ */
+template <typename TFloat>
+inline void round(TFloat const* in, TFloat* out, std::size_t count) {
+    typedef detail::RoundFunctor<TFloat> F;
+    detail::forEachRegister<TFloat, typename F::S>(in, out, count, F());
+}
+
+/**
+ * Maps @a count coordinates onto indices of cells of size @a step starting
+ * at @a origin: <tt>out[i] = floor((in[i] - origin) / step)</tt>, which is
+ * what @c GridGeometry::cellIndex computes for a single coordinate.
+ * Type @a TIndex must be able to hold every resulting index.
+ */
+template <typename TFloat, typename TIndex>
+inline void floorToIndex(TFloat const* in, TIndex* out, std::size_t count,
+                         TFloat origin = 0, TFloat step = 1) {
+    typedef rvlm::core::detail::SimdTraits<TFloat,
+        rvlm::core::detail::NativeSimdWidth<TFloat>::value> S;
+    const std::size_t W = S::WIDTH;
+    const typename S::Register o = S::broadcast(origin);
+    const typename S::Register h = S::broadcast(step);
+
+    TFloat buffer[W];
+    for (std::size_t i = 0; i < count; i += W) {
+        std::size_t n = count - i < W ? count - i : W;
+        if (n < W) {
+            for (std::size_t k = 0; k < W; ++k) buffer[k] = k < n ? in[i + k] : TFloat(0);
+        }
+        const typename S::Register x = S::load(n == W ? in + i : buffer);
+        S::store(buffer, S::floor(S::div(S::sub(x, o), h)));
+        for (std::size_t k = 0; k < n; ++k)
+            out[i + k] = static_cast<TIndex>(buffer[k]);
+    }
+}
+
+/**
+ * Replaces every element of @a array with its exponent.
+ */
+template <Accuracy A = Accuracy::Ulp1, typename TFloat, typename TIndex>
+inline void exp(SolidArray3d<TFloat, TIndex>& array) {
+    TFloat* data = array.getOrigin();
+    exp<A>(data, data, array.getCountX() * array.getCountY() * array.getCountZ());
+}
+
+/**
+ * Replaces elements of row (@a ix, @a iy) of @a array with their exponents.
+ */
+template <Accuracy A = Accuracy::Ulp1, typename TFloat, typename TIndex>
+inline void exp(SolidArray3d<TFloat, TIndex>& array, TIndex ix, TIndex iy) {
+    TFloat* row = array.getCursor(ix, iy, array.getBeginZ());
+    exp<A>(row, row, array.getCountZ());
+}
+
+/**
+ * Replaces every element of @a array with its sine.
+ */
+template <Accuracy A = Accuracy::Ulp1, typename TFloat, typename TIndex>
+inline void sin(SolidArray3d<TFloat, TIndex>& array) {
+    TFloat* data = array.getOrigin();
+    sin<A>(data, data, array.getCountX() * array.getCountY() * array.getCountZ());
+}
+
+/**
+ * Replaces elements of row (@a ix, @a iy) of @a array with their sines.
+ */
+template <Accuracy A = Accuracy::Ulp1, typename TFloat, typename TIndex>
+inline void sin(SolidArray3d<TFloat, TIndex>& array, TIndex ix, TIndex iy) {
+    TFloat* row = array.getCursor(ix, iy, array.getBeginZ());
+    sin<A>(row, row, array.getCountZ());
+}
+
+/**
+ * Replaces every element of @a array with its cosine.
+ */
+template <Accuracy A = Accuracy::Ulp1, typename TFloat, typename TIndex>
+inline void cos(SolidArray3d<TFloat, TIndex>& array) {
+    TFloat* data = array.getOrigin();
+    cos<A>(data, data, array.getCountX() * array.getCountY() * array.getCountZ());
+}
+
+/**
+ * Replaces elements of row (@a ix, @a iy) of @a array with their cosines.
+ */
+template <Accuracy A = Accuracy::Ulp1, typename TFloat, typename TIndex>
+inline void cos(SolidArray3d<TFloat, TIndex>& array, TIndex ix, TIndex iy) {
+    TFloat* row = array.getCursor(ix, iy, array.getBeginZ());
+    cos<A>(row, row, array.getCountZ());
+}
+
+/**
+ * Computes sines and cosines of all elements of @a array into arrays
+ * @a sinOut and @a cosOut, which must cover the same box, otherwise
+ * @c std::invalid_argument is thrown.
+ */
+template <Accuracy A = Accuracy::Ulp1, typename TFloat, typename TIndex>
+inline void sincos(SolidArray3d<TFloat, TIndex> const& array,
+                   SolidArray3d<TFloat, TIndex>& sinOut,
+                   SolidArray3d<TFloat, TIndex>& cosOut) {
+    if (sinOut.getBox() != array.getBox() || cosOut.getBox() != array.getBox())
+        throw std::invalid_argument("array geometry differs");
+    sincos<A>(array.getOrigin(), sinOut.getOrigin(), cosOut.getOrigin(),
+              array.getCountX() * array.getCountY() * array.getCountZ());
+}
+
+/**
+ * Computes sines and cosines of row (@a ix, @a iy) of @a array into the
+ * same rows of @a sinOut and @a cosOut, which must cover the same box.
+ */
+template <Accuracy A = Accuracy::Ulp1, typename TFloat, typename TIndex>
+inline void sincos(SolidArray3d<TFloat, TIndex> const& array,
+                   SolidArray3d<TFloat, TIndex>& sinOut,
+                   SolidArray3d<TFloat, TIndex>& cosOut, TIndex ix, TIndex iy) {
+    if (sinOut.getBox() != array.getBox() || cosOut.getBox() != array.getBox())
+        throw std::invalid_argument("array geometry differs");
+    const TIndex iz = array.getBeginZ();
+    sincos<A>(array.getCursor(ix, iy, iz), sinOut.getCursor(ix, iy, iz),
+              cosOut.getCursor(ix, iy, iz), array.getCountZ());
+}
+
+/**
+ * Rounds every element of @a array to nearest integer.
+ */
+template <typename TFloat, typename TIndex>
+inline void round(SolidArray3d<TFloat, TIndex>& array) {
+    TFloat* data = array.getOrigin();
+    round(data, data, array.getCountX() * array.getCountY() * array.getCountZ());
+}
+
+/**
+ * Rounds elements of row (@a ix, @a iy) of @a array to nearest integers.
+ */
+template <typename TFloat, typename TIndex>
+inline void round(SolidArray3d<TFloat, TIndex>& array, TIndex ix, TIndex iy) {
+    TFloat* row = array.getCursor(ix, iy, array.getBeginZ());
+    round(row, row, array.getCountZ());
+}
+
+/**
+ * Maps coordinates stored in @a array onto cell indices in array @a out of
+ * the same box, as @c floorToIndex of raw arrays does. Throws
+ * @c std::invalid_argument if boxes differ.
+ */
+template <typename TFloat, typename TIndex, typename TOut, typename TOutIndex>
+inline void floorToIndex(SolidArray3d<TFloat, TIndex> const& array,
+                         SolidArray3d<TOut, TOutIndex>& out,
+                         TFloat origin = 0, TFloat step = 1) {
+    if (out.getBox() != array.getBox())
+        throw std::invalid_argument("array geometry differs");
+    floorToIndex(array.getOrigin(), out.getOrigin(),
+                 array.getCountX() * array.getCountY() * array.getCountZ(),
+                 origin, step);
+}
+
+/**
+ * Maps coordinates of row (@a ix, @a iy) of @a array onto cell indices in
+ * @a out, which must have room for <tt>array.getCountZ()</tt> items.
+ */
+template <typename TFloat, typename TIndex, typename TOut>
+inline void floorToIndex(SolidArray3d<TFloat, TIndex> const& array,
+                         TIndex ix, TIndex iy, TOut* out,
+                         TFloat origin = 0, TFloat step = 1) {
+    floorToIndex(array.getCursor(ix, iy, array.getBeginZ()), out,
+                 array.getCountZ(), origin, step);
+}
+
+} // namespace math
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,186 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "rvlm/core/NonAssignable.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Hardware events counted by @c PerfScope.
+ */
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    LlcMisses,
+    DtlbMisses,
+};
+
+const std::size_t PERF_EVENT_COUNT = 4;
+
+/**
+ * Work done by a region of code, as declared by the code itself: bytes
+ * the algorithm must move between memory and the core, cells updated and
+ * floating-point operations. These give achieved bandwidth, cell rate
+ * and arithmetic intensity independently of hardware counters.
+ */
+struct PerfWork {
+    std::uint64_t bytes;
+    std::uint64_t cells;
+    std::uint64_t flops;
+
+    PerfWork(): bytes(0), cells(0), flops(0) {}
+
+    PerfWork(std::uint64_t bytes, std::uint64_t cells, std::uint64_t flops)
+        : bytes(bytes), cells(cells), flops(flops) {}
+
+    PerfWork& operator += (PerfWork const& other) {
+        bytes += other.bytes;
+        cells += other.cells;
+        flops += other.flops;
+        return *this;
+    }
+
+    /**
+     * Work of @c KernelSet::curlUpdate over @a n items of @a T with
+     * per-cell scale: reading and writing the output and reading scale
+     * and both inputs, whose neighbour rows come from cache; three
+     * subtractions, three multiplications and an addition per item.
+     */
+    template <typename T>
+    static PerfWork curlUpdate(std::size_t n) {
+        return PerfWork(5*sizeof(T)*n, n, 7*n);
+    }
+
+    /** Work of @c KernelSet::sum over @a n items of @a T. */
+    template <typename T>
+    static PerfWork sum(std::size_t n) {
+        return PerfWork(sizeof(T)*n, n, n);
+    }
+
+    /** Work of @c KernelSet::dot over @a n items of @a T. */
+    template <typename T>
+    static PerfWork dot(std::size_t n) {
+        return PerfWork(2*sizeof(T)*n, n, 2*n);
+    }
+
+    /** Work of @c KernelSet::fill over @a n items of @a T. */
+    template <typename T>
+    static PerfWork fill(std::size_t n) {
+        return PerfWork(sizeof(T)*n, n, 0);
+    }
+};
+
+/**
+ * Totals of one region on one thread, summed over all its scopes.
+ */
+struct PerfRegionStats {
+    std::string   region;
+    unsigned      thread;      // threads are numbered in order of first scope
+    std::uint64_t calls;
+    double        seconds;
+    PerfWork      work;
+
+    // Event counts, valid only where the event could be counted.
+    std::uint64_t events[PERF_EVENT_COUNT];
+    bool          counted[PERF_EVENT_COUNT];
+
+    std::uint64_t event(PerfEvent e) const { return events[static_cast<int>(e)]; }
+    bool hasEvent(PerfEvent e) const { return counted[static_cast<int>(e)]; }
+
+    /** Gets declared bytes moved per second, in GB/s. */
+    double gigabytesPerSecond() const;
+
+    /** Gets cells per second. */
+    double cellsPerSecond() const;
+
+    /** Gets declared floating-point operations per byte. */
+    double arithmeticIntensity() const;
+
+    /** Gets instructions per cycle, or 0 if not counted. */
+    double instructionsPerCycle() const;
+
+    /**
+     * Gets memory traffic implied by last-level cache misses, one cache
+     * line per miss, in GB/s, or 0 if not counted. Unlike the declared
+     * rate it includes traffic the algorithm did not intend, such as
+     * re-reading neighbours evicted from cache.
+     */
+    double missGigabytesPerSecond() const;
+};
+
+/**
+ * Measures a named region of code on the calling thread, from
+ * construction to destruction, and adds the results to totals of that
+ * region and thread.
+ *
+ * Cycles, instructions, last-level cache misses and data TLB misses are
+ * counted by the processor through Linux @c perf_event_open, user space
+ * only, so that the default @c perf_event_paranoid setting suffices.
+ * Counters are opened once per thread. Where they cannot be opened, as on
+ * other systems, in containers without access to the PMU or on processors
+ * lacking some event, the events are reported as not counted and scopes
+ * still measure time and declared work. Reading counters takes a couple
+ * of system calls, so scopes are meant for whole sweeps, not for rows.
+ *
+ * @code
+ *     {
+ *         PerfScope scope("curl E");
+ *         for (...)
+ *             kernels::curlUpdate(...);
+ *         scope.addWork(PerfWork::curlUpdate<float>(cells));
+ *     }
+ *     ...
+ *     perfReport(std::cout);
+ * @endcode
+ */
+class PerfScope: public NonAssignable {
+public:
+
+    /**
+     * Starts measuring region @a name. Regions are told apart by name,
+     * so names should be literals or otherwise outlive the program's
+     * reporting.
+     */
+    explicit PerfScope(char const* name, PerfWork const& work = PerfWork());
+
+    ~PerfScope();
+
+    /**
+     * Declares more work done by the region.
+     */
+    void addWork(PerfWork const& work) { mWork += work; }
+
+    /**
+     * Gets whether @a event is counted on the calling thread.
+     */
+    static bool isCounted(PerfEvent event);
+
+private:
+    char const*   mName;
+    PerfWork      mWork;
+    std::uint64_t mStartNanos;
+    std::uint64_t mStart[PERF_EVENT_COUNT];
+};
+
+/**
+ * Gets totals of all regions and threads measured since the start or
+ * the last @c perfReset, ordered by region name and thread.
+ */
+std::vector<PerfRegionStats> perfSnapshot();
+
+/**
+ * Forgets all totals.
+ */
+void perfReset();
+
+/**
+ * Prints totals as a table, with "-" in place of events not counted.
+ */
+void perfReport(std::ostream& out);
+
+} // namespace core
+} // namespace rvlm
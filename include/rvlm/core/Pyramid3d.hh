@@ -0,0 +1,314 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "rvlm/core/DirtyBricks.hh"
+#include "rvlm/core/HalfOpenRange.hh"
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/NonAssignable.hh"
+#include "rvlm/core/SolidArray3d.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Way coarse pyramid cells combine their finer cells.
+ */
+enum class PyramidReduction {
+    /** Arithmetic mean. */
+    Mean,
+
+    /** Largest absolute value, which keeps peaks visible when zoomed out. */
+    MaxAbs
+};
+
+/**
+ * Multi-resolution pyramid over a @c SolidArray3d, for monitoring and
+ * visualization of large fields.
+ *
+ * Level 0 is the array itself, which is referenced, never copied. Every
+ * next level halves resolution along all axes, so its cell @em i combines
+ * cells <tt>2i</tt> and <tt>2i+1</tt> of the previous level along every
+ * axis (or just one of them at an odd-sized edge). Coarse levels are
+ * indexed from zero, level 0 keeps indices of the array.
+ *
+ * Levels are computed lazily. Writers mark changed level 0 boxes with
+ * @c markDirty, recorded by a @c DirtyBricks tracker, and before coarse
+ * data is read, only bricks of @em brickSize cells intersecting marked
+ * boxes are reduced again. Bricks of every level are reduced in parallel
+ * with OpenMP, rows of a brick in loops simple enough for the compiler to
+ * vectorize. Values must be of a floating-point type, since means of
+ * integers would be truncated.
+ */
+template <typename T, typename TIndex = std::size_t>
+class Pyramid3d: public NonAssignable {
+public:
+
+    static_assert(std::is_floating_point<T>::value,
+                  "pyramid values must be floating-point");
+
+    typedef SolidArray3d<T, TIndex>         Level0;
+    typedef SolidArray3d<T, std::ptrdiff_t> Level;
+    typedef IndexBox<std::ptrdiff_t>        Box;
+
+    /**
+     * Builds pyramid of @a levels levels over @a level0, or as many as it
+     * takes to reduce the array to a single cell if @a levels is zero.
+     * Brick size must be a power of two. All levels start dirty.
+     */
+    Pyramid3d(Level0 const& level0,
+              PyramidReduction reduction = PyramidReduction::Mean,
+              int levels = 0, std::ptrdiff_t brickSize = 16)
+            : mLevel0(level0), mReduction(reduction),
+              mDirty(level0.getBox(), brickSize), mAnyDirty(true) {
+        Box box = level0.getBox();
+        std::ptrdiff_t size[3] = { box.size(0), box.size(1), box.size(2) };
+        if (levels <= 0) {
+            levels = 1;
+            for (std::ptrdiff_t n = std::max(size[0], std::max(size[1], size[2]));
+                 n > 1; n = (n + 1) / 2)
+                ++levels;
+        }
+        for (int k = 1; k < levels; ++k) {
+            for (int axis = 0; axis < 3; ++axis)
+                size[axis] = (size[axis] + 1) / 2;
+            mLevels.push_back(std::unique_ptr<Level>(new Level(
+                    HalfOpenRange<std::ptrdiff_t>(0, size[0]),
+                    HalfOpenRange<std::ptrdiff_t>(0, size[1]),
+                    HalfOpenRange<std::ptrdiff_t>(0, size[2]), T(0))));
+        }
+    }
+
+    int getLevelCount() const { return static_cast<int>(mLevels.size()) + 1; }
+
+    PyramidReduction getReduction() const { return mReduction; }
+
+    /**
+     * Gets box of cell indices of @a level.
+     */
+    Box getLevelBox(int level) const {
+        checkLevel(level);
+        return level == 0 ? mLevel0.getBox() : mLevels[level - 1]->getBox();
+    }
+
+    /**
+     * Marks cells of level 0 within @a box as changed.
+     */
+    void markDirty(Box const& box) {
+        if (box.intersect(mLevel0.getBox()).empty())
+            return;
+        mDirty.markDirty(box);
+        mAnyDirty = true;
+    }
+
+    void markAllDirty() {
+        mDirty.markAllDirty();
+        mAnyDirty = true;
+    }
+
+    bool isDirty() const { return mAnyDirty; }
+
+    /**
+     * Recomputes coarse cells depending on dirty bricks. Called implicitly
+     * by all functions reading coarse levels.
+     */
+    void update() {
+        if (!mAnyDirty)
+            return;
+
+        std::vector<std::size_t> bricks = mDirty.getDirtyBricks();
+        const std::ptrdiff_t brickSize = mDirty.getBrickSize();
+        const std::ptrdiff_t countY = mDirty.getBrickCount(1);
+        const std::ptrdiff_t countZ = mDirty.getBrickCount(2);
+
+        // At level k a brick covers (brickSize >> k) cells. Once that gets
+        // below one cell, several bricks share coarse cells, so their
+        // indices are merged to keep boxes of one level disjoint.
+        std::vector<Box> boxes;
+        for (int k = 1; k < getLevelCount(); ++k) {
+            const int shift = std::max(0, k - mDirty.getBrickShift());
+            const std::ptrdiff_t side = std::max<std::ptrdiff_t>(brickSize >> k, 1);
+            Box levelBox = mLevels[k - 1]->getBox();
+
+            std::vector<std::ptrdiff_t> keys;
+            for (std::size_t i = 0; i < bricks.size(); ++i) {
+                std::ptrdiff_t b = static_cast<std::ptrdiff_t>(bricks[i]);
+                std::ptrdiff_t bz = b % countZ;
+                std::ptrdiff_t by = b / countZ % countY;
+                std::ptrdiff_t bx = b / countZ / countY;
+                keys.push_back((((bx >> shift) * countY + (by >> shift))
+                                * countZ) + (bz >> shift));
+            }
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+            boxes.clear();
+            for (std::size_t i = 0; i < keys.size(); ++i) {
+                std::ptrdiff_t kz = keys[i] % countZ;
+                std::ptrdiff_t ky = keys[i] / countZ % countY;
+                std::ptrdiff_t kx = keys[i] / countZ / countY;
+                boxes.push_back(Box(kx*side, (kx + 1)*side, ky*side, (ky + 1)*side,
+                                    kz*side, (kz + 1)*side).intersect(levelBox));
+            }
+
+            const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(boxes.size());
+            #pragma omp parallel for schedule(dynamic)
+            for (std::ptrdiff_t i = 0; i < n; ++i)
+                reduceBox(k, boxes[i]);
+        }
+
+        mDirty.clear();
+        mAnyDirty = false;
+    }
+
+    /**
+     * Gets coarse level @a level, which must be positive, bringing it up to
+     * date first.
+     */
+    Level const& getLevel(int level) {
+        checkLevel(level);
+        if (level == 0)
+            throw std::out_of_range("level 0 is the source array itself");
+        update();
+        return *mLevels[level - 1];
+    }
+
+    /**
+     * Copies cells of @a level within @a box into @a out, row by row along
+     * @em Z, with @em X changing slowest. Throws @c std::out_of_range if the
+     * box does not lie within the level.
+     */
+    void extract(int level, Box const& box, T* out) {
+        checkLevel(level);
+        if (!getLevelBox(level).contains(box))
+            throw std::out_of_range("box exceeds pyramid level");
+        if (box.empty())
+            return;
+        if (level == 0)
+            copyBox(mLevel0, box, out);
+        else
+            copyBox(getLevel(level), box, out);
+    }
+
+    /**
+     * Copies the whole slice of @a level perpendicular to @a axis at
+     * @a index into @a out, in the same order as @c extract.
+     */
+    void extractSlice(int level, int axis, std::ptrdiff_t index, T* out) {
+        Box box = getLevelBox(level);
+        box.start[axis] = index;
+        box.stop[axis] = index + 1;
+        extract(level, box, out);
+    }
+
+private:
+
+    void checkLevel(int level) const {
+        if (level < 0 || level >= getLevelCount())
+            throw std::out_of_range("no such pyramid level");
+    }
+
+    template <typename TArray>
+    static void copyBox(TArray const& array, Box const& box, T* out) {
+        typedef typename TArray::IndexType I;
+        const std::ptrdiff_t count = box.size(2);
+        for (std::ptrdiff_t ix = box.start[0]; ix < box.stop[0]; ++ix) {
+            for (std::ptrdiff_t iy = box.start[1]; iy < box.stop[1]; ++iy) {
+                T const* row = array.getCursor(static_cast<I>(ix), static_cast<I>(iy),
+                                               static_cast<I>(box.start[2]));
+                out = std::copy(row, row + count, out);
+            }
+        }
+    }
+
+    /**
+     * Gets pointer to row (@a ix, @a iy) of level @a k, in local indices
+     * counted from the beginning of the level.
+     */
+    T const* fineRow(int k, std::ptrdiff_t ix, std::ptrdiff_t iy) const {
+        if (k == 0) {
+            return mLevel0.getCursor(
+                    static_cast<TIndex>(mLevel0.getBeginX() + ix),
+                    static_cast<TIndex>(mLevel0.getBeginY() + iy),
+                    mLevel0.getBeginZ());
+        }
+        return mLevels[k - 1]->getCursor(ix, iy, 0);
+    }
+
+    /**
+     * Recomputes cells of level @a k within @a box from level <tt>k-1</tt>.
+     */
+    void reduceBox(int k, Box const& box) {
+        Level& coarse = *mLevels[k - 1];
+        Box fineBox = getLevelBox(k - 1);
+        const std::ptrdiff_t fineCount[3] = {
+            fineBox.size(0), fineBox.size(1), fineBox.size(2) };
+
+        const std::ptrdiff_t z0 = box.start[2], z1 = box.stop[2];
+        const std::ptrdiff_t fz0 = 2*z0;
+        const std::ptrdiff_t fz1 = std::min(2*z1, fineCount[2]);
+        std::vector<T> line(static_cast<std::size_t>(fz1 - fz0) + 1);
+
+        for (std::ptrdiff_t cx = box.start[0]; cx < box.stop[0]; ++cx) {
+            for (std::ptrdiff_t cy = box.start[1]; cy < box.stop[1]; ++cy) {
+                // Combine up to four fine rows into one line, then pairs of
+                // line items into coarse cells.
+                const std::ptrdiff_t nx = std::min<std::ptrdiff_t>(2, fineCount[0] - 2*cx);
+                const std::ptrdiff_t ny = std::min<std::ptrdiff_t>(2, fineCount[1] - 2*cy);
+                T const* rows[4];
+                int rowCount = 0;
+                for (std::ptrdiff_t dx = 0; dx < nx; ++dx)
+                    for (std::ptrdiff_t dy = 0; dy < ny; ++dy)
+                        rows[rowCount++] = fineRow(k - 1, 2*cx + dx, 2*cy + dy) + fz0;
+
+                const std::ptrdiff_t m = fz1 - fz0;
+                T* l = line.data();
+                if (mReduction == PyramidReduction::Mean) {
+                    for (std::ptrdiff_t j = 0; j < m; ++j)
+                        l[j] = rows[0][j];
+                    for (int r = 1; r < rowCount; ++r) {
+                        T const* row = rows[r];
+                        for (std::ptrdiff_t j = 0; j < m; ++j)
+                            l[j] += row[j];
+                    }
+                } else {
+                    for (std::ptrdiff_t j = 0; j < m; ++j)
+                        l[j] = std::abs(rows[0][j]);
+                    for (int r = 1; r < rowCount; ++r) {
+                        T const* row = rows[r];
+                        for (std::ptrdiff_t j = 0; j < m; ++j)
+                            l[j] = std::max(l[j], static_cast<T>(std::abs(row[j])));
+                    }
+                }
+
+                T* out = coarse.getCursor(cx, cy, z0);
+                const std::ptrdiff_t pairs = m / 2;
+                if (mReduction == PyramidReduction::Mean) {
+                    const T scale = T(1) / T(2*rowCount);
+                    for (std::ptrdiff_t j = 0; j < pairs; ++j)
+                        out[j] = (l[2*j] + l[2*j + 1]) * scale;
+                    if (m % 2)
+                        out[pairs] = l[m - 1] / T(rowCount);
+                } else {
+                    for (std::ptrdiff_t j = 0; j < pairs; ++j)
+                        out[j] = std::max(l[2*j], l[2*j + 1]);
+                    if (m % 2)
+                        out[pairs] = l[m - 1];
+                }
+            }
+        }
+    }
+
+    Level0 const&                       mLevel0;
+    PyramidReduction                    mReduction;
+    DirtyBricks                         mDirty;
+    bool                                mAnyDirty;
+    std::vector<std::unique_ptr<Level>> mLevels;
+};
+
+} // namespace core
+} // namespace rvlm
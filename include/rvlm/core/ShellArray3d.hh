@@ -0,0 +1,246 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/Algorithms3d.hh"
+#include "rvlm/core/HalfOpenRange.hh"
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/NonAssignable.hh"
+#include "rvlm/core/SolidArray3d.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Tridimensional array holding items only within a shell of a domain box:
+ * cells closer than given widths to its faces, like absorbing boundary
+ * layers, whose auxiliary fields make no sense inside the domain.
+ *
+ * The shell is stored in at most six slab @c SolidArray3d instances
+ * addressed by global indices: two @em X slabs spanning the whole domain
+ * in @em Y and @em Z, two @em Y slabs between them and two @em Z slabs in
+ * the remaining hole. Zero width leaves out the slab of that face, e.g. on
+ * periodic sides. Memory taken is that of the shell only, which for the
+ * usual width of about ten cells is a small fraction of the domain.
+ */
+template <typename TValue>
+class ShellArray3d: public NonAssignable {
+public:
+
+    typedef SolidArray3d<TValue, std::ptrdiff_t> Slab;
+    typedef IndexBox<std::ptrdiff_t>             Box;
+    typedef HalfOpenRange<std::ptrdiff_t>        Range;
+    typedef memory::Allocator                    Allocator;
+
+    /**
+     * Constructs shell of @a domain with the same @a width at every face.
+     */
+    ShellArray3d(Box const& domain, std::ptrdiff_t width,
+                 TValue const& fillValue = TValue(), Allocator* allocator = 0)
+            throw(std::bad_alloc, std::range_error)
+        : ShellArray3d(domain, uniform(width).data(), uniform(width).data(),
+                       fillValue, allocator) {}
+
+    /**
+     * Constructs shell of @a domain, which is @a lower[axis] cells wide at
+     * the lower face along @em axis and @a upper[axis] cells at the upper
+     * one. Throws @c std::range_error if widths are negative or together
+     * exceed the domain size.
+     */
+    ShellArray3d(Box const& domain, std::ptrdiff_t const lower[3],
+                 std::ptrdiff_t const upper[3],
+                 TValue const& fillValue = TValue(), Allocator* allocator = 0)
+            throw(std::bad_alloc, std::range_error)
+        : mDomain(domain), mInterior(domain) {
+
+        for (int axis = 0; axis < 3; ++axis) {
+            if (lower[axis] < 0 || upper[axis] < 0 ||
+                lower[axis] + upper[axis] > domain.size(axis))
+                throw std::range_error("wrong shell width");
+            mInterior.start[axis] += lower[axis];
+            mInterior.stop[axis] -= upper[axis];
+        }
+
+        // Slabs of each axis span what is left of the domain after slabs
+        // of the preceding axes are cut off.
+        Box rest = domain;
+        for (int axis = 0; axis < 3; ++axis) {
+            Box lo = rest, hi = rest;
+            lo.stop[axis] = mInterior.start[axis];
+            hi.start[axis] = mInterior.stop[axis];
+            addSlab(lo, fillValue, allocator);
+            addSlab(hi, fillValue, allocator);
+            rest.start[axis] = mInterior.start[axis];
+            rest.stop[axis] = mInterior.stop[axis];
+        }
+    }
+
+    Box const& getDomain() const { return mDomain; }
+
+    /**
+     * Gets box of domain cells not in the shell.
+     */
+    Box const& getInteriorBox() const { return mInterior; }
+
+    std::size_t getSlabCount() const { return mSlabs.size(); }
+
+    Slab& getSlab(std::size_t i) { return *mSlabs[i]; }
+
+    Slab const& getSlab(std::size_t i) const { return *mSlabs[i]; }
+
+    Box const& getSlabBox(std::size_t i) const { return mBoxes[i]; }
+
+    /**
+     * Gets number of items stored, which is the number of shell cells.
+     */
+    std::size_t getTotalCount() const {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < mBoxes.size(); ++i)
+            total += static_cast<std::size_t>(mBoxes[i].count());
+        return total;
+    }
+
+    bool contains(std::ptrdiff_t ix, std::ptrdiff_t iy, std::ptrdiff_t iz) const {
+        return mDomain.contains(ix, iy, iz) && !mInterior.contains(ix, iy, iz);
+    }
+
+    /**
+     * Gets whether @a other has slabs of the same boxes, so that items of
+     * both at the same position in slabs are at the same cells.
+     */
+    template <typename TOther>
+    bool isAlignedWith(ShellArray3d<TOther> const& other) const {
+        if (other.getSlabCount() != mBoxes.size())
+            return false;
+        for (std::size_t i = 0; i < mBoxes.size(); ++i) {
+            if (other.getSlabBox(i) != mBoxes[i])
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Accesses item by global coordinates of its cell. Throws
+     * @c std::out_of_range if the cell is not in the shell.
+     */
+    TValue& at(std::ptrdiff_t ix, std::ptrdiff_t iy, std::ptrdiff_t iz) {
+        return getSlab(slabIndex(ix, iy, iz)).at(ix, iy, iz);
+    }
+
+    TValue const& at(std::ptrdiff_t ix, std::ptrdiff_t iy, std::ptrdiff_t iz) const {
+        return getSlab(slabIndex(ix, iy, iz)).at(ix, iy, iz);
+    }
+
+    void fill(TValue const& value) {
+        for (std::size_t i = 0; i < mSlabs.size(); ++i)
+            mSlabs[i]->fill(value);
+    }
+
+private:
+
+    struct Widths {
+        std::ptrdiff_t value[3];
+        std::ptrdiff_t const* data() const { return value; }
+    };
+
+    static Widths uniform(std::ptrdiff_t width) {
+        Widths w = {{ width, width, width }};
+        return w;
+    }
+
+    void addSlab(Box const& box, TValue const& fillValue, Allocator* allocator) {
+        if (box.empty())
+            return;
+        mSlabs.push_back(std::unique_ptr<Slab>(new Slab(
+                box.range(0), box.range(1), box.range(2), fillValue, allocator)));
+        mBoxes.push_back(box);
+    }
+
+    std::size_t slabIndex(std::ptrdiff_t ix, std::ptrdiff_t iy, std::ptrdiff_t iz) const {
+        for (std::size_t i = 0; i < mBoxes.size(); ++i) {
+            if (mBoxes[i].contains(ix, iy, iz))
+                return i;
+        }
+        throw std::out_of_range("cell is not in the shell");
+    }
+
+    Box                                mDomain;
+    Box                                mInterior;
+    std::vector<std::unique_ptr<Slab>> mSlabs;
+    std::vector<Box>                   mBoxes;
+};
+
+namespace detail {
+
+template <typename TValue>
+inline TValue* shellRow(ShellArray3d<TValue>& shell, std::size_t slab,
+                        std::ptrdiff_t ix, std::ptrdiff_t iy, std::ptrdiff_t iz) {
+    return shell.getSlab(slab).getCursor(ix, iy, iz);
+}
+
+template <typename TArray>
+inline auto shellRow(TArray& array, std::size_t,
+                     std::ptrdiff_t ix, std::ptrdiff_t iy, std::ptrdiff_t iz)
+        -> decltype(array.getCursor(ix, iy, iz)) {
+    return array.getCursor(ix, iy, iz);
+}
+
+template <typename TShell, typename TValue>
+inline bool fitsShell(TShell const& shell, ShellArray3d<TValue> const& other) {
+    return shell.isAlignedWith(other);
+}
+
+template <typename TShell, typename TArray>
+inline bool fitsShell(TShell const& shell, TArray const& array) {
+    return array.getBox().contains(shell.getDomain());
+}
+
+template <typename TFunc, typename... TRows>
+inline void zipShellRow(TFunc& func, std::size_t count, TRows... rows) {
+    for (std::size_t k = 0; k < count; ++k)
+        func(rows[k]...);
+}
+
+} // namespace detail
+
+/**
+ * Calls <tt>func(a[c], b[c], ...)</tt> for every cell @em c of the shell
+ * of @a shell, with items of it and all @a others at that cell, in a single
+ * pass over the slabs. Others may be shells aligned with @a shell or full
+ * arrays, like @c SolidArray3d, covering its domain, e.g. field components
+ * driving the auxiliary fields; otherwise @c std::invalid_argument is
+ * thrown. Cells are visited row by row along @em Z, slab after slab.
+ */
+template <typename TFunc, typename TValue, typename... TArrays>
+void zipShell(Execution exec, TFunc func, ShellArray3d<TValue>& shell,
+              TArrays&... others) {
+    if (!detail::allOf(detail::fitsShell(shell, others)...))
+        throw std::invalid_argument("arrays do not fit the shell");
+
+    for (std::size_t s = 0; s < shell.getSlabCount(); ++s) {
+        typename ShellArray3d<TValue>::Box const& box = shell.getSlabBox(s);
+        const std::ptrdiff_t x0 = box.start[0], x1 = box.stop[0];
+        const std::ptrdiff_t y0 = box.start[1], y1 = box.stop[1];
+        const std::ptrdiff_t z0 = box.start[2];
+        const std::size_t count = static_cast<std::size_t>(box.size(2));
+
+        #pragma omp parallel for collapse(2) schedule(static) \
+                if(exec == Execution::Parallel)
+        for (std::ptrdiff_t ix = x0; ix < x1; ++ix) {
+            for (std::ptrdiff_t iy = y0; iy < y1; ++iy) {
+                detail::zipShellRow(func, count,
+                                    detail::shellRow(shell, s, ix, iy, z0),
+                                    detail::shellRow(others, s, ix, iy, z0)...);
+            }
+        }
+    }
+}
+
+template <typename TFunc, typename TValue, typename... TArrays>
+void zipShell(TFunc func, ShellArray3d<TValue>& shell, TArrays&... others) {
+    zipShell(Execution::Sequential, func, shell, others...);
+}
+
+} // namespace core
+} // namespace rvlm
@@ -7,6 +7,7 @@
 #include "rvlm/core/memory/OperatorNewAllocator.hh"
 #include "rvlm/core/NonAssignable.hh"
 #include "rvlm/core/HalfOpenRange.hh"
+#include "rvlm/core/Traversable3D.hh"
 #include "rvlm/core/detail/StaticCursorHelpers.hh"
 
 namespace rvlm {
@@ -27,7 +28,8 @@ namespace core {
  * intentionally for runtime performance.
  */
 template <typename TValue, typename TIndex = std::size_t>
-class SolidArray3d: public rvlm::core::NonAssignable {
+class SolidArray3d: public rvlm::core::NonAssignable,
+                    public rvlm::core::Traversable3D<SolidArray3d<TValue, TIndex>> {
 public:
 
     using ThisType          = SolidArray3d<TValue, TIndex>;
@@ -125,9 +127,9 @@ public:
     IndexType getBeginY() const { return mBeginY; }
     IndexType getBeginZ() const { return mBeginZ; }
 
-    IndexType getEndX() const { return mCountX - mBeginX; }
-    IndexType getEndY() const { return mCountY - mBeginY; }
-    IndexType getEndZ() const { return mCountZ - mBeginZ; }
+    IndexType getEndX() const { return mBeginX + mCountX; }
+    IndexType getEndY() const { return mBeginY + mCountY; }
+    IndexType getEndZ() const { return mBeginZ + mCountZ; }
 
     /**
      * Gets number of items along X dimension.
@@ -234,6 +236,24 @@ public:
         return itemAddress(ix, iy, iz);
     }
 
+    /**
+     * Gets linear offset of the item from the beginning of array storage.
+     * Offsets stay valid for the whole array lifetime, so they may be
+     * computed once and used for batched access to the array or any other
+     * array of the same geometry.
+     */
+    std::size_t getOffset(IndexType ix, IndexType iy, IndexType iz) const {
+        return itemIndex(ix, iy, iz);
+    }
+
+    /**
+     * Gets cursor pointing to the first item in storage, that is, the item
+     * with zero offset.
+     */
+    CursorType getOrigin() const {
+        return mData;
+    }
+
     template <int Axis0, int Axis1, int Axis2>
     CursorType getCursorX(IndexType i0, IndexType i1, IndexType i2) const {
         return detail::GetCursorHelper<ThisType, Axis0, Axis1, Axis2>
@@ -0,0 +1,372 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/NonAssignable.hh"
+#include "rvlm/core/Trace.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Part of some array read or written by a task: identity of the array
+ * object and a box of its cells.
+ */
+struct TaskRegion {
+    void const*               object;
+    IndexBox<std::ptrdiff_t>  box;
+
+    TaskRegion(void const* object, IndexBox<std::ptrdiff_t> const& box)
+        : object(object), box(box) {}
+
+    bool overlaps(TaskRegion const& other) const {
+        return object == other.object && box.overlaps(other.box);
+    }
+};
+
+/**
+ * Region of @a array covering @a box, which is not checked against the
+ * array: regions only need to be consistent between tasks.
+ */
+template <typename TArray>
+TaskRegion regionOf(TArray const& array, IndexBox<std::ptrdiff_t> const& box) {
+    return TaskRegion(&array, box);
+}
+
+/**
+ * Region covering the whole @a array.
+ */
+template <typename TArray>
+TaskRegion regionOf(TArray const& array) {
+    return TaskRegion(&array, array.getBox());
+}
+
+/**
+ * Runtime executing tasks, typically sweeps over boxes of arrays, as soon
+ * as tasks they depend on are finished.
+ *
+ * Every task declares regions it reads and writes. A new task depends on
+ * every unfinished task added before it that writes a region overlapping
+ * what the new task reads or writes, or reads a region overlapping what
+ * it writes. Tasks thus see the same data as if run one by one in the
+ * order of adding, while, say, boundary slabs of the next time step start
+ * as soon as slabs of the previous step they touch are done, and output
+ * of one step proceeds concurrently with updates of the next one.
+ *
+ * Tasks start running right when added, on a pool of worker threads. Each
+ * worker keeps its own queue, runs tasks it made ready itself first, most
+ * recent first, and steals the oldest tasks of other workers when out of
+ * work. The thread calling @c wait helps running tasks too. Tasks may add
+ * more tasks. Parallel kernels inside tasks should run sequentially, as the
+ * pool already occupies the cores.
+ *
+ * @code
+ *     TaskGraph graph;
+ *     for (int n = 0; n < steps; ++n) {
+ *         for (std::size_t s = 0; s < slabs.size(); ++s)
+ *             graph.add([&, s] { updateE(slabs[s]); },
+ *                       { regionOf(hx, grown(slabs[s])), regionOf(hy, ...) },
+ *                       { regionOf(ex, slabs[s]), regionOf(ey, slabs[s]) });
+ *         ...
+ *     }
+ *     graph.wait();
+ * @endcode
+ */
+class TaskGraph: public NonAssignable {
+public:
+
+    typedef std::size_t                 TaskId;
+    typedef std::vector<TaskRegion>     Regions;
+    typedef std::function<void()>       Function;
+
+    /**
+     * Starts @a workers threads, or one thread per hardware thread if zero.
+     */
+    explicit TaskGraph(unsigned workers = 0)
+            : mFailed(false), mRemaining(0), mStopping(false),
+              mQueued(0), mNextQueue(0) {
+        if (workers == 0)
+            workers = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i <= workers; ++i)
+            mQueues.push_back(std::unique_ptr<Queue>(new Queue()));
+        for (unsigned i = 0; i < workers; ++i)
+            mWorkers.push_back(std::thread(&TaskGraph::workerLoop, this, i));
+    }
+
+    /**
+     * Waits for all tasks and stops worker threads. Failures of tasks not
+     * reported by @c wait are ignored.
+     */
+    ~TaskGraph() {
+        try {
+            wait();
+        } catch (...) {
+        }
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            mStopping = true;
+        }
+        mWake.notify_all();
+        for (std::size_t i = 0; i < mWorkers.size(); ++i)
+            mWorkers[i].join();
+    }
+
+    std::size_t getWorkerCount() const { return mWorkers.size(); }
+
+    /**
+     * Adds task running @a func, with dependencies inferred from regions
+     * it @a reads and @a writes, and returns its number.
+     */
+    TaskId add(Function func, Regions const& reads, Regions const& writes) {
+        return add(func, reads, writes, std::vector<TaskId>());
+    }
+
+    /**
+     * Same as above, but the task also waits for tasks listed in @a after,
+     * whatever regions they touch.
+     */
+    TaskId add(Function func, Regions const& reads, Regions const& writes,
+               std::vector<TaskId> const& after) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        const TaskId id = mTasks.size();
+        mTasks.push_back(Task());
+        Task& task = mTasks.back();
+        task.func = func;
+        task.pending = 0;
+        task.done = false;
+
+        std::vector<TaskId> predecessors;
+        collectConflicts(reads, false, predecessors);
+        collectConflicts(writes, true, predecessors);
+        for (std::size_t i = 0; i < after.size(); ++i) {
+            if (after[i] >= id)
+                continue;
+            if (!taskAt(after[i]).done)
+                predecessors.push_back(after[i]);
+        }
+        std::sort(predecessors.begin(), predecessors.end());
+        predecessors.erase(std::unique(predecessors.begin(), predecessors.end()),
+                           predecessors.end());
+        for (std::size_t i = 0; i < predecessors.size(); ++i)
+            taskAt(predecessors[i]).successors.push_back(id);
+        task.pending = predecessors.size();
+
+        for (std::size_t i = 0; i < reads.size(); ++i)
+            mAccesses.push_back(Access(id, reads[i], false));
+        for (std::size_t i = 0; i < writes.size(); ++i)
+            mAccesses.push_back(Access(id, writes[i], true));
+
+        ++mRemaining;
+        const bool ready = task.pending == 0;
+        lock.unlock();
+
+        if (ready)
+            push(nextQueue(), id);
+        return id;
+    }
+
+    /**
+     * Runs tasks until all added ones are finished. If some task threw an
+     * exception, tasks not yet started are skipped, and the first exception
+     * is rethrown here. Must be called by one thread at a time and not from
+     * tasks; task numbers start over afterwards.
+     */
+    void wait() {
+        const std::size_t self = mQueues.size() - 1;
+        while (mRemaining.load() != 0) {
+            TaskId id;
+            if (take(self, id)) {
+                run(self, id);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mWake.wait(lock, [this] {
+                return mQueued.load() > 0 || mRemaining.load() == 0;
+            });
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTasks.clear();
+        mAccesses.clear();
+        mFailed = false;
+        if (mError) {
+            std::exception_ptr error = mError;
+            mError = std::exception_ptr();
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+
+    struct Task {
+        Function            func;
+        std::vector<TaskId> successors;
+        std::size_t         pending;
+        bool                done;
+    };
+
+    struct Access {
+        TaskId     task;
+        TaskRegion region;
+        bool       write;
+
+        Access(TaskId task, TaskRegion const& region, bool write)
+            : task(task), region(region), write(write) {}
+    };
+
+    struct Queue {
+        std::mutex         mutex;
+        std::deque<TaskId> tasks;
+    };
+
+    Task& taskAt(TaskId id) { return mTasks[id]; }
+
+    /**
+     * Appends unfinished tasks whose accesses conflict with @a regions to
+     * @a out. Accesses of finished tasks are dropped on the way.
+     */
+    void collectConflicts(Regions const& regions, bool write,
+                          std::vector<TaskId>& out) {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < mAccesses.size(); ++i) {
+            Access const& a = mAccesses[i];
+            if (taskAt(a.task).done)
+                continue;
+            mAccesses[kept++] = a;
+            if (!write && !a.write)
+                continue;
+            for (std::size_t r = 0; r < regions.size(); ++r) {
+                if (a.region.overlaps(regions[r])) {
+                    out.push_back(a.task);
+                    break;
+                }
+            }
+        }
+        mAccesses.erase(mAccesses.begin() + kept, mAccesses.end());
+    }
+
+    std::size_t nextQueue() {
+        return mNextQueue.fetch_add(1) % mQueues.size();
+    }
+
+    void push(std::size_t queue, TaskId id) {
+        {
+            std::lock_guard<std::mutex> lock(mQueues[queue]->mutex);
+            mQueues[queue]->tasks.push_back(id);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            ++mQueued;
+        }
+        mWake.notify_one();
+    }
+
+    /**
+     * Takes the newest task of queue @a self, or steals the oldest task of
+     * some other queue.
+     */
+    bool take(std::size_t self, TaskId& id) {
+        {
+            std::lock_guard<std::mutex> lock(mQueues[self]->mutex);
+            if (!mQueues[self]->tasks.empty()) {
+                id = mQueues[self]->tasks.back();
+                mQueues[self]->tasks.pop_back();
+                --mQueued;
+                return true;
+            }
+        }
+        for (std::size_t k = 1; k < mQueues.size(); ++k) {
+            Queue& victim = *mQueues[(self + k) % mQueues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                id = victim.tasks.front();
+                victim.tasks.pop_front();
+                --mQueued;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(std::size_t self, TaskId id) {
+        Function func;
+        bool skip;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            func.swap(taskAt(id).func);
+            skip = mFailed;
+        }
+
+        if (!skip) {
+            try {
+                RVLM_TRACE_SCOPE("task");
+                func();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (!mError)
+                    mError = std::current_exception();
+                mFailed = true;
+            }
+        }
+
+        std::vector<TaskId> ready;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            Task& task = taskAt(id);
+            task.done = true;
+            for (std::size_t i = 0; i < task.successors.size(); ++i) {
+                if (--taskAt(task.successors[i]).pending == 0)
+                    ready.push_back(task.successors[i]);
+            }
+        }
+        for (std::size_t i = 0; i < ready.size(); ++i)
+            push(self, ready[i]);
+        if (--mRemaining == 0) {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            mWake.notify_all();
+        }
+    }
+
+    void workerLoop(std::size_t self) {
+        for (;;) {
+            TaskId id;
+            if (take(self, id)) {
+                run(self, id);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mWake.wait(lock, [this] { return mStopping || mQueued.load() > 0; });
+            if (mStopping && mQueued.load() == 0)
+                return;
+        }
+    }
+
+    // Graph state, guarded by mMutex.
+    std::mutex               mMutex;
+    std::deque<Task>         mTasks;
+    std::vector<Access>      mAccesses;
+    bool                     mFailed;
+    std::exception_ptr       mError;
+    std::atomic<std::size_t> mRemaining;
+
+    // Pool state. The last queue belongs to threads calling 'wait'.
+    std::mutex                          mWakeMutex;
+    std::condition_variable             mWake;
+    bool                                mStopping;
+    std::atomic<std::ptrdiff_t>         mQueued;
+    std::atomic<std::size_t>            mNextQueue;
+    std::vector<std::unique_ptr<Queue>> mQueues;
+    std::vector<std::thread>            mWorkers;
+};
+
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,268 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "rvlm/core/NonAssignable.hh"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @def RVLM_TRACE_SCOPE(name)
+ * Records begin of region @a name here and its end at the end of the
+ * enclosing block. Like all tracing macros, it expands to nothing unless
+ * @c RVLM_CORE_TRACING is defined to 1, which the CMake option
+ * @c RVLM_CORE_USE_TRACING does for the library and its users. Names
+ * must be string literals or otherwise live until the trace is written.
+ *
+ * @def RVLM_TRACE_SCOPE_VALUE(name, value)
+ * Same as above, attaching integer @a value, e.g. a byte count, to the
+ * begin event.
+ *
+ * @def RVLM_TRACE_BEGIN(name)
+ * @def RVLM_TRACE_END(name)
+ * Record begin and end of a region spanning blocks; both must be on the
+ * same thread.
+ *
+ * @def RVLM_TRACE_INSTANT(name)
+ * Records a point in time.
+ *
+ * @def RVLM_TRACE_COUNTER(name, value)
+ * Records value of a counter, drawn as a graph in trace viewers.
+ */
+#if defined(RVLM_CORE_TRACING) && RVLM_CORE_TRACING
+#define RVLM_CORE_TRACE_CONCAT2(a, b) a##b
+#define RVLM_CORE_TRACE_CONCAT(a, b) RVLM_CORE_TRACE_CONCAT2(a, b)
+#define RVLM_TRACE_SCOPE(name) \
+    ::rvlm::core::TraceScope RVLM_CORE_TRACE_CONCAT(rvlmTraceScope, __LINE__)(name)
+#define RVLM_TRACE_SCOPE_VALUE(name, value) \
+    ::rvlm::core::TraceScope RVLM_CORE_TRACE_CONCAT(rvlmTraceScope, __LINE__)(name, value)
+#define RVLM_TRACE_BEGIN(name) \
+    ::rvlm::core::traceEvent(::rvlm::core::TracePhase::Begin, name)
+#define RVLM_TRACE_END(name) \
+    ::rvlm::core::traceEvent(::rvlm::core::TracePhase::End, name)
+#define RVLM_TRACE_INSTANT(name) \
+    ::rvlm::core::traceEvent(::rvlm::core::TracePhase::Instant, name)
+#define RVLM_TRACE_COUNTER(name, value) \
+    ::rvlm::core::traceEvent(::rvlm::core::TracePhase::Counter, name, value)
+#else
+#define RVLM_TRACE_SCOPE(name) ((void)0)
+#define RVLM_TRACE_SCOPE_VALUE(name, value) ((void)0)
+#define RVLM_TRACE_BEGIN(name) ((void)0)
+#define RVLM_TRACE_END(name) ((void)0)
+#define RVLM_TRACE_INSTANT(name) ((void)0)
+#define RVLM_TRACE_COUNTER(name, value) ((void)0)
+#endif
+
+namespace rvlm {
+namespace core {
+
+enum class TracePhase: std::uint8_t {
+    Begin,
+    End,
+    Instant,
+    Counter
+};
+
+struct TraceEvent {
+    std::uint64_t ticks;
+    char const*   name;
+    std::uint64_t value;
+    TracePhase    phase;
+};
+
+namespace detail {
+
+/**
+ * @internal
+ * Gets timestamp of the time stamp counter where there is one, which is
+ * a single instruction, or of the steady clock otherwise. Writers of
+ * traces convert ticks to time.
+ */
+inline std::uint64_t traceTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * @internal
+ * Ring of events written by one thread and read by the flusher, without
+ * locks: each side owns its own position and publishes it to the other
+ * with release stores. When the flusher falls behind, new events are
+ * dropped and counted rather than overwriting unread ones.
+ */
+class TraceBuffer: public NonAssignable {
+public:
+
+    static const std::size_t CAPACITY = std::size_t(1) << 15;
+
+    explicit TraceBuffer(unsigned thread)
+            : mEvents(new TraceEvent[CAPACITY]), mHead(0), mTail(0),
+              mDropped(0), mThread(thread), mExited(false) {}
+
+    void push(TraceEvent const& event) {
+        const std::size_t head = mHead.load(std::memory_order_relaxed);
+        if (head - mTail.load(std::memory_order_acquire) == CAPACITY) {
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        mEvents[head & (CAPACITY - 1)] = event;
+        mHead.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * Passes all published events to @a func, oldest first, and frees
+     * their slots. Must be called by one thread at a time.
+     */
+    template <typename TFunc>
+    std::size_t drain(TFunc func) {
+        std::size_t tail = mTail.load(std::memory_order_relaxed);
+        const std::size_t head = mHead.load(std::memory_order_acquire);
+        const std::size_t count = head - tail;
+        for (; tail != head; ++tail)
+            func(mEvents[tail & (CAPACITY - 1)]);
+        mTail.store(tail, std::memory_order_release);
+        return count;
+    }
+
+    std::size_t takeDropped() { return mDropped.exchange(0, std::memory_order_relaxed); }
+
+    unsigned getThread() const { return mThread; }
+
+    bool hasExited() const { return mExited.load(std::memory_order_acquire); }
+    void markExited() { mExited.store(true, std::memory_order_release); }
+
+private:
+    std::unique_ptr<TraceEvent[]> mEvents;
+    std::atomic<std::size_t>      mHead;
+    std::atomic<std::size_t>      mTail;
+    std::atomic<std::size_t>      mDropped;
+    unsigned                      mThread;
+    std::atomic<bool>             mExited;
+};
+
+extern std::atomic<bool> traceEnabled;
+
+/**
+ * @internal
+ * Creates buffer of the calling thread at its first event and registers
+ * it with the flusher.
+ */
+TraceBuffer* registerTraceThread();
+
+/**
+ * @internal
+ * Buffer of the calling thread, handed back to the flusher, which frees it
+ * once drained, when the thread exits.
+ */
+struct TraceThreadSlot {
+    TraceBuffer* buffer;
+
+    TraceThreadSlot(): buffer(0) {}
+
+    ~TraceThreadSlot() {
+        if (buffer)
+            buffer->markExited();
+    }
+};
+
+inline TraceBuffer* traceBuffer() {
+    static thread_local TraceThreadSlot slot;
+    if (!slot.buffer)
+        slot.buffer = registerTraceThread();
+    return slot.buffer;
+}
+
+} // namespace detail
+
+/**
+ * Records event on the calling thread if a @c TraceSession is running.
+ * Otherwise it costs a relaxed atomic load. Macros of @c RVLM_TRACE_*
+ * family call it when tracing is compiled in.
+ */
+inline void traceEvent(TracePhase phase, char const* name, std::uint64_t value = 0) {
+    if (!detail::traceEnabled.load(std::memory_order_relaxed))
+        return;
+    TraceEvent e = { detail::traceTicks(), name, value, phase };
+    detail::traceBuffer()->push(e);
+}
+
+/**
+ * Records begin and end of a region at construction and destruction.
+ */
+class TraceScope: public NonAssignable {
+public:
+    explicit TraceScope(char const* name, std::uint64_t value = 0)
+            : mName(name) {
+        traceEvent(TracePhase::Begin, name, value);
+    }
+
+    ~TraceScope() {
+        traceEvent(TracePhase::End, mName);
+    }
+
+private:
+    char const* mName;
+};
+
+/**
+ * Names the calling thread in traces.
+ */
+void traceThreadName(std::string const& name);
+
+/**
+ * Running trace written to a file in Chrome trace event format, which
+ * chrome://tracing and Perfetto UI open.
+ *
+ * While a session exists, events recorded by any thread go to ring
+ * buffers of their threads, and a background thread moves them to the
+ * file every @a flushMillis milliseconds. Time stamp counter ticks are
+ * converted to microseconds from the session start with the steady clock
+ * sampled at every flush, so the timeline stays exact however long the
+ * session runs. Only one session may run at a time.
+ */
+class TraceSession: public NonAssignable {
+public:
+
+    /**
+     * Starts recording into file @a path. Throws @c std::runtime_error if
+     * the file cannot be written and @c std::logic_error if another
+     * session is running.
+     */
+    explicit TraceSession(std::string const& path, unsigned flushMillis = 100);
+
+    /**
+     * Stops recording, writes remaining events and closes the file.
+     */
+    ~TraceSession();
+
+    /**
+     * Writes events recorded so far without waiting for the flusher.
+     */
+    void flush();
+
+    /**
+     * Gets number of events written so far.
+     */
+    std::size_t getEventCount() const;
+
+    /**
+     * Gets number of events lost because buffers were full.
+     */
+    std::size_t getDroppedCount() const;
+
+private:
+    class Writer;
+    std::unique_ptr<Writer> mWriter;
+};
+
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,341 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#include "rvlm/core/Algorithms3d.hh"
+#include "rvlm/core/SolidArray3d.hh"
+
+namespace rvlm {
+namespace core {
+
+namespace detail {
+
+/**
+ * @internal
+ * Transposes a square tile of @c SIZE by @c SIZE items:
+ * <tt>dst[c*dstStride + r] = src[r*srcStride + c]</tt>. Generic version is
+ * a plain loop; specializations for AVX keep the whole tile in registers.
+ */
+template <typename T>
+struct TransposeTile {
+    static const std::ptrdiff_t SIZE = 8;
+
+    static void run(T const* src, std::ptrdiff_t srcStride,
+                    T* dst, std::ptrdiff_t dstStride) {
+        for (std::ptrdiff_t r = 0; r < SIZE; ++r)
+        for (std::ptrdiff_t c = 0; c < SIZE; ++c)
+            dst[c*dstStride + r] = src[r*srcStride + c];
+    }
+};
+
+#if defined(__AVX__)
+
+template <>
+struct TransposeTile<double> {
+    static const std::ptrdiff_t SIZE = 4;
+
+    static void run(double const* src, std::ptrdiff_t srcStride,
+                    double* dst, std::ptrdiff_t dstStride) {
+        __m256d r0 = _mm256_loadu_pd(src);
+        __m256d r1 = _mm256_loadu_pd(src + srcStride);
+        __m256d r2 = _mm256_loadu_pd(src + 2*srcStride);
+        __m256d r3 = _mm256_loadu_pd(src + 3*srcStride);
+        __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+        __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+        __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+        __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+        _mm256_storeu_pd(dst,               _mm256_permute2f128_pd(t0, t2, 0x20));
+        _mm256_storeu_pd(dst + dstStride,   _mm256_permute2f128_pd(t1, t3, 0x20));
+        _mm256_storeu_pd(dst + 2*dstStride, _mm256_permute2f128_pd(t0, t2, 0x31));
+        _mm256_storeu_pd(dst + 3*dstStride, _mm256_permute2f128_pd(t1, t3, 0x31));
+    }
+};
+
+template <>
+struct TransposeTile<float> {
+    static const std::ptrdiff_t SIZE = 8;
+
+    static void run(float const* src, std::ptrdiff_t srcStride,
+                    float* dst, std::ptrdiff_t dstStride) {
+        __m256 r[8], t[8], u[8];
+        for (int i = 0; i < 8; ++i)
+            r[i] = _mm256_loadu_ps(src + i*srcStride);
+        for (int i = 0; i < 8; i += 2) {
+            t[i]     = _mm256_unpacklo_ps(r[i], r[i+1]);
+            t[i + 1] = _mm256_unpackhi_ps(r[i], r[i+1]);
+        }
+        for (int i = 0; i < 8; i += 4) {
+            u[i]     = _mm256_shuffle_ps(t[i],     t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+            u[i + 1] = _mm256_shuffle_ps(t[i],     t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+            u[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+            u[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+        }
+        for (int i = 0; i < 4; ++i) {
+            _mm256_storeu_ps(dst + i*dstStride,
+                             _mm256_permute2f128_ps(u[i], u[i + 4], 0x20));
+            _mm256_storeu_ps(dst + (i + 4)*dstStride,
+                             _mm256_permute2f128_ps(u[i], u[i + 4], 0x31));
+        }
+    }
+};
+
+#endif
+
+template <typename T>
+const std::ptrdiff_t TransposeTile<T>::SIZE;
+
+/**
+ * @internal
+ * Transposes matrix of @a rows by @a cols items:
+ * <tt>dst[c*dstStride + r] = src[r*srcStride + c]</tt>, tile by tile.
+ */
+template <typename T>
+void transposeBlock(T const* src, std::ptrdiff_t srcStride,
+                    T* dst, std::ptrdiff_t dstStride,
+                    std::ptrdiff_t rows, std::ptrdiff_t cols) {
+    const std::ptrdiff_t S = TransposeTile<T>::SIZE;
+    std::ptrdiff_t r = 0;
+    for (; r + S <= rows; r += S) {
+        std::ptrdiff_t c = 0;
+        for (; c + S <= cols; c += S)
+            TransposeTile<T>::run(src + r*srcStride + c, srcStride,
+                                  dst + c*dstStride + r, dstStride);
+        for (; c < cols; ++c)
+            for (std::ptrdiff_t k = r; k < r + S; ++k)
+                dst[c*dstStride + k] = src[k*srcStride + c];
+    }
+    for (; r < rows; ++r)
+        for (std::ptrdiff_t c = 0; c < cols; ++c)
+            dst[c*dstStride + r] = src[r*srcStride + c];
+}
+
+/**
+ * @internal
+ * Side of square blocks transposed at once, small enough for source and
+ * destination blocks to stay in L1 cache.
+ */
+const std::ptrdiff_t TRANSPOSE_BLOCK = 32;
+
+inline void checkPermutation(int const axes[3]) {
+    bool seen[3] = { false, false, false };
+    for (int k = 0; k < 3; ++k) {
+        if (axes[k] < 0 || axes[k] > 2 || seen[axes[k]])
+            throw std::invalid_argument("axes must be a permutation of 0, 1, 2");
+        seen[axes[k]] = true;
+    }
+}
+
+template <typename TArray>
+void getCountsAndStrides(TArray const& a, std::ptrdiff_t n[3], std::ptrdiff_t s[3]) {
+    n[0] = static_cast<std::ptrdiff_t>(a.getCountX());
+    n[1] = static_cast<std::ptrdiff_t>(a.getCountY());
+    n[2] = static_cast<std::ptrdiff_t>(a.getCountZ());
+    s[0] = n[1] * n[2];
+    s[1] = n[2];
+    s[2] = 1;
+}
+
+/**
+ * @internal
+ * Exchanges two axes of a cubic array of side @a n and @a strides in
+ * place. Blocks on both sides of the diagonal are transposed through a
+ * per-thread buffer.
+ */
+template <typename TValue>
+void swapAxesInPlace(TValue* data, std::ptrdiff_t n, std::ptrdiff_t const strides[3],
+                     int a, int b, Execution exec) {
+    if (a > b)
+        std::swap(a, b);
+    const int c = 3 - a - b;
+    const std::ptrdiff_t sa = strides[a], sc = strides[c];
+
+    // Exchanging X and Y moves whole rows along Z.
+    if (b != 2) {
+        const std::ptrdiff_t sb = strides[b];
+        #pragma omp parallel for schedule(dynamic) if(exec == Execution::Parallel)
+        for (std::ptrdiff_t i = 0; i < n; ++i) {
+            for (std::ptrdiff_t j = i + 1; j < n; ++j)
+                std::swap_ranges(data + i*sa + j*sb, data + i*sa + j*sb + n,
+                                 data + j*sa + i*sb);
+        }
+        return;
+    }
+
+    const std::ptrdiff_t B = TRANSPOSE_BLOCK;
+    const std::ptrdiff_t blocks = (n + B - 1) / B;
+    #pragma omp parallel if(exec == Execution::Parallel)
+    {
+        std::vector<TValue> buffer(static_cast<std::size_t>(B * B));
+        #pragma omp for collapse(2) schedule(dynamic)
+        for (std::ptrdiff_t t = 0; t < n; ++t) {
+            for (std::ptrdiff_t bi = 0; bi < blocks; ++bi) {
+                TValue* plane = data + t*sc;
+                const std::ptrdiff_t i0 = bi*B, ni = std::min(B, n - i0);
+                for (std::ptrdiff_t bj = bi; bj < blocks; ++bj) {
+                    const std::ptrdiff_t j0 = bj*B, nj = std::min(B, n - j0);
+                    TValue* upper = plane + i0*sa + j0;
+                    TValue* lower = plane + j0*sa + i0;
+                    transposeBlock(upper, sa, buffer.data(), B, ni, nj);
+                    if (bi != bj)
+                        transposeBlock(lower, sa, upper, sa, nj, ni);
+                    for (std::ptrdiff_t k = 0; k < nj; ++k)
+                        std::copy(buffer.data() + k*B, buffer.data() + k*B + ni,
+                                  lower + k*sa);
+                }
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * Copies @a src into @a dst with axes permuted, so that
+ * <tt>dst.at(j0, j1, j2)</tt> becomes <tt>src.at<A0, A1, A2>(i0, i1, i2)</tt>
+ * for corresponding indices counted from the beginning of either array. In
+ * other words, axis @em k of @a dst runs along axis <tt>axes[k]</tt> of
+ * @a src, and @a dst must have as many items along it.
+ *
+ * Permutation {2, 1, 0} turns X-major (C) layout into Z-major (Fortran)
+ * layout, as expected by most FFT and solver libraries. When the @em Z axis
+ * stays in place rows are copied as they are; otherwise planes are
+ * transposed in cache-sized blocks of register-sized tiles, using AVX
+ * shuffles for @c double and @c float items where available. In parallel
+ * mode blocks are spread over OpenMP threads.
+ *
+ * Throws @c std::invalid_argument if @a axes is not a permutation, array
+ * counts do not match, or @a src and @a dst are the same array.
+ */
+template <typename TValue, typename TIndex>
+void permuteAxes(SolidArray3d<TValue, TIndex> const& src,
+                 SolidArray3d<TValue, TIndex>& dst, int const axes[3],
+                 Execution exec = Execution::Sequential) {
+    detail::checkPermutation(axes);
+    if (&src == &dst)
+        throw std::invalid_argument("use permuteAxesInPlace for a single array");
+
+    std::ptrdiff_t n[3], s[3], dn[3], ds[3], sp[3];
+    detail::getCountsAndStrides(src, n, s);
+    detail::getCountsAndStrides(dst, dn, ds);
+    for (int k = 0; k < 3; ++k) {
+        if (dn[k] != n[axes[k]])
+            throw std::invalid_argument("destination counts do not match permutation");
+        sp[k] = s[axes[k]];
+    }
+
+    TValue const* from = src.getOrigin();
+    TValue* to = dst.getOrigin();
+
+    if (axes[2] == 2) {
+        #pragma omp parallel for collapse(2) schedule(static) \
+                if(exec == Execution::Parallel)
+        for (std::ptrdiff_t j0 = 0; j0 < dn[0]; ++j0) {
+            for (std::ptrdiff_t j1 = 0; j1 < dn[1]; ++j1) {
+                TValue const* row = from + j0*sp[0] + j1*sp[1];
+                std::copy(row, row + dn[2], to + j0*ds[0] + j1*ds[1]);
+            }
+        }
+        return;
+    }
+
+    // Destination axis 'm' runs along contiguous source items, destination
+    // axis 2 along contiguous destination items. Planes spanned by the two
+    // are transposed, one plane per index 't' along the remaining axis 'o'.
+    const int m = axes[0] == 2 ? 0 : 1;
+    const int o = 1 - m;
+    const std::ptrdiff_t B = detail::TRANSPOSE_BLOCK;
+    const std::ptrdiff_t rows = dn[2], cols = dn[m];
+    const std::ptrdiff_t blocks = (rows + B - 1) / B;
+
+    #pragma omp parallel for collapse(2) schedule(static) \
+            if(exec == Execution::Parallel)
+    for (std::ptrdiff_t t = 0; t < dn[o]; ++t) {
+        for (std::ptrdiff_t bq = 0; bq < blocks; ++bq) {
+            const std::ptrdiff_t q0 = bq*B, nq = std::min(B, rows - q0);
+            for (std::ptrdiff_t p0 = 0; p0 < cols; p0 += B) {
+                detail::transposeBlock(from + t*sp[o] + q0*sp[2] + p0, sp[2],
+                                       to + t*ds[o] + p0*ds[m] + q0, ds[m],
+                                       nq, std::min(B, cols - p0));
+            }
+        }
+    }
+}
+
+/**
+ * Same as @c permuteAxes with axes given as template arguments, in the
+ * order of @c SolidArray3d::at<Axis0, Axis1, Axis2>.
+ */
+template <int Axis0, int Axis1, int Axis2, typename TValue, typename TIndex>
+void permuteAxes(SolidArray3d<TValue, TIndex> const& src,
+                 SolidArray3d<TValue, TIndex>& dst,
+                 Execution exec = Execution::Sequential) {
+    static_assert(Axis0 + Axis1 + Axis2 == 3 && Axis0 != Axis1 &&
+                  Axis1 != Axis2 && Axis0 != Axis2,
+                  "axes must be a permutation of 0, 1, 2");
+    const int axes[3] = { Axis0, Axis1, Axis2 };
+    permuteAxes(src, dst, axes, exec);
+}
+
+/**
+ * Permutes axes of a cubic @a array in place, with the same meaning of
+ * @a axes as in @c permuteAxes. Cyclic permutations are done as two
+ * exchanges of axes. Throws @c std::invalid_argument if the array is not
+ * a cube or @a axes is not a permutation.
+ */
+template <typename TValue, typename TIndex>
+void permuteAxesInPlace(SolidArray3d<TValue, TIndex>& array, int const axes[3],
+                        Execution exec = Execution::Sequential) {
+    detail::checkPermutation(axes);
+    std::ptrdiff_t n[3], s[3];
+    detail::getCountsAndStrides(array, n, s);
+    if (n[0] != n[1] || n[1] != n[2])
+        throw std::invalid_argument("in-place permutation needs a cubic array");
+
+    // Applying swap 'first' and then swap 'second' gives permutation
+    // first[second[k]].
+    static const int SWAPS[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+    int fixed = 0;
+    for (int k = 0; k < 3; ++k)
+        fixed += axes[k] == k;
+    if (fixed == 3)
+        return;
+    if (fixed == 1) {
+        for (int k = 0; k < 3; ++k) {
+            if (axes[k] == k)
+                detail::swapAxesInPlace(array.getOrigin(), n[0], s,
+                                        (k + 1) % 3, (k + 2) % 3, exec);
+        }
+        return;
+    }
+    for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j) {
+        int first[3] = { 0, 1, 2 }, second[3] = { 0, 1, 2 };
+        std::swap(first[SWAPS[i][0]], first[SWAPS[i][1]]);
+        std::swap(second[SWAPS[j][0]], second[SWAPS[j][1]]);
+        if (first[second[0]] == axes[0] && first[second[1]] == axes[1] &&
+            first[second[2]] == axes[2]) {
+            detail::swapAxesInPlace(array.getOrigin(), n[0], s,
+                                    SWAPS[i][0], SWAPS[i][1], exec);
+            detail::swapAxesInPlace(array.getOrigin(), n[0], s,
+                                    SWAPS[j][0], SWAPS[j][1], exec);
+            return;
+        }
+    }
+}
+
+template <int Axis0, int Axis1, int Axis2, typename TValue, typename TIndex>
+void permuteAxesInPlace(SolidArray3d<TValue, TIndex>& array,
+                        Execution exec = Execution::Sequential) {
+    static_assert(Axis0 + Axis1 + Axis2 == 3 && Axis0 != Axis1 &&
+                  Axis1 != Axis2 && Axis0 != Axis2,
+                  "axes must be a permutation of 0, 1, 2");
+    const int axes[3] = { Axis0, Axis1, Axis2 };
+    permuteAxesInPlace(array, axes, exec);
+}
+
+} // namespace core
+} // namespace rvlm
@@ -1,64 +1,98 @@
 #pragma once
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "rvlm/core/IndexBox.hh"
 
 namespace rvlm {
 namespace core {
 
-template <typename valueType,
-          typename indexType,
-          typename cursorType>
+/**
+ * Base of tridimensional containers, giving them common static interface.
+ *
+ * A container @c D derives from @c Traversable3D<D> and provides the
+ * following members, which generic algorithms rely on:
+ * @code
+ *     IndexType, ValueType, CursorType
+ *     getBeginX(), getBeginY(), getBeginZ()
+ *     getEndX(),   getEndY(),   getEndZ()
+ *     getCountX(), getCountY(), getCountZ()
+ *     getCursor(ix, iy, iz)
+ *     at(cursor)
+ *     cursorMoveToNext<Axis>(cursor), cursorMoveToPrev<Axis>(cursor)
+ * @endcode
+ * In addition, items of a row along @em Z must be addressed by consecutive
+ * cursors, so that <tt>cursor + k</tt> points @em k items further along
+ * @em Z. Compliance is checked at compile time with @c IsTraversable3d.
+ *
+ * Unlike an interface with virtual functions, this base costs nothing at
+ * runtime: algorithms are instantiated for concrete containers, and every
+ * access inlines into plain pointer or index arithmetic.
+ *
+ * @see Algorithms3d.hh
+ */
+template <typename TDerived>
 class Traversable3D {
 public:
 
-    typedef indexType IndexType;
-    typedef valueType ValueType;
-    typedef cursorType CursorType;
-
-    virtual IndexType getCountX() const = 0;
-    virtual IndexType getCountY() const = 0;
-    virtual IndexType getCountZ() const = 0;
+    TDerived& derived() {
+        return static_cast<TDerived&>(*this);
+    }
 
-    IndexType getTotalCount() const {
-        return getCountX()*getCountY()*getCountZ();
+    TDerived const& derived() const {
+        return static_cast<TDerived const&>(*this);
     }
 
     /**
-     * Accesses item for reading by its coordinates.
-     * Argument indexes @a ix, @a iy and @a iz must satisfy the following
-     * range condition:
-     * @code
-     *     0 <= ix && ix < getCountX()
-     *     0 <= iy && iy < getCountY()
-     *     0 <= iz && iz < getCountZ()
-     * @endcode
-     * For performance reasons, this function DOES NOT check whether its
-     * arguments are all in valid ranges.
-     *
-     * @see at(const CursorType&) const
+     * Gets box of global indices covered by the container.
      */
-    ValueType& at(IndexType ix, IndexType iy, IndexType iz) const = 0;
-    ValueType& at(IndexType ix, IndexType iy, IndexType iz) = 0;
+    IndexBox<std::ptrdiff_t> getBox() const {
+        return IndexBox<std::ptrdiff_t>::of(derived());
+    }
 
-    ValueType& at(const CursorType& cursor) const = 0;
-    ValueType& at(const CursorType& cursor) = 0;
+protected:
+    Traversable3D() {}
+    ~Traversable3D() {}
+};
 
-    /**
-     * Constructs cursor pointing to given item.
-     * This method is the only way to obtain a valid cursor object.
-     * Arguments @a ix, @a iy and @a iz are the coordinates of the item which
-     * is pointed by the created cursor.
-     */
-    CursorType getCursor(IndexType ix, IndexType iy, IndexType iz) const = 0;
+namespace detail {
+
+/**
+ * @internal
+ * Detects members required by @c Traversable3D.
+ */
+template <typename T>
+class HasTraversable3dMembers {
+    template <typename U>
+    static auto test(U* u) -> decltype(
+        u->getBeginX(), u->getBeginY(), u->getBeginZ(),
+        u->getEndX(),   u->getEndY(),   u->getEndZ(),
+        u->getCountX(), u->getCountY(), u->getCountZ(),
+        u->at(u->getCursor(u->getBeginX(), u->getBeginY(), u->getBeginZ())),
+        u->template cursorMoveToNext<0>(
+                std::declval<typename U::CursorType&>()),
+        u->template cursorMoveToPrev<2>(
+                std::declval<typename U::CursorType&>()),
+        std::declval<typename U::CursorType>() + std::size_t(1),
+        std::true_type());
 
-    void cursorMoveTo(
-        CursorType& cursor, IndexType ix, IndexType iy, IndexType iz) const = 0;
+    template <typename U>
+    static std::false_type test(...);
 
-    void cursorMoveToPrevX(CursorType& cursor) const = 0;
-    void cursorMoveToPrevY(CursorType& cursor) const = 0;
-    void cursorMoveToPrevZ(CursorType& cursor) const = 0;
-    void cursorMoveToNextX(CursorType& cursor) const = 0;
-    void cursorMoveToNextY(CursorType& cursor) const = 0;
-    void cursorMoveToNextZ(CursorType& cursor) const = 0;
+public:
+    static const bool value = decltype(test<T>(nullptr))::value;
 };
 
+} // namespace detail
+
+/**
+ * Checks whether @a T is a tridimensional container with the interface
+ * described in @c Traversable3D.
+ */
+template <typename T>
+struct IsTraversable3d: std::integral_constant<bool,
+        std::is_base_of<Traversable3D<T>, T>::value &&
+        detail::HasTraversable3dMembers<T>::value> {};
+
 } // namespace core
 } // namespace rvlm
@@ -0,0 +1,288 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "rvlm/core/GridGeometry.hh"
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/SolidArray3d.hh"
+#include "rvlm/core/Vector3d.hh"
+#include "rvlm/core/detail/Simd.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Trilinear interpolation of one or several field components at arbitrary
+ * physical positions, in batches.
+ *
+ * Every component is a @c SolidArray3d on the same @c GridGeometry, with its
+ * own stagger: position of its values within a cell in fractions of cell
+ * size. Cell-centered values have stagger (0.5, 0.5, 0.5), @em Ex of the
+ * Yee lattice has (0.5, 0, 0) and so on. Components sharing stagger and
+ * array box also share cell indices and weights, which are computed once
+ * per position.
+ *
+ * Positions are processed @a W at a time in SIMD registers, from the
+ * structure-of-arrays layout particle codes use. Positions beyond the
+ * outermost sample points take values at the nearest boundary, so arrays
+ * need at least two items along every axis.
+ *
+ * @code
+ *     TrilinearSampler<double> sampler(grid);
+ *     sampler.addComponent(ex, Vector3d<double>(0.5, 0, 0));
+ *     sampler.addComponent(ey, Vector3d<double>(0, 0.5, 0));
+ *     sampler.addComponent(ez, Vector3d<double>(0, 0, 0.5));
+ *     double* outs[3] = { exAt, eyAt, ezAt };
+ *     sampler.sample(xs, ys, zs, count, outs);
+ * @endcode
+ */
+template <typename T, typename TIndex = std::size_t,
+          std::size_t W = detail::NativeSimdWidth<T>::value>
+class TrilinearSampler {
+public:
+
+    typedef SolidArray3d<T, TIndex>    Array;
+    typedef detail::SimdTraits<T, W>   Simd;
+    typedef typename Simd::Register    Register;
+    typedef IndexBox<std::ptrdiff_t>   Box;
+
+    static const std::size_t WIDTH = W;
+
+    explicit TrilinearSampler(GridGeometry<T> const& grid)
+        : mGrid(grid) {}
+
+    GridGeometry<T> const& getGrid() const { return mGrid; }
+
+    std::size_t getComponentCount() const { return mComponents.size(); }
+
+    /**
+     * Adds component stored in @a array with values at @a stagger within
+     * cells, and returns its number for @c sample output. Array must stay
+     * alive while the sampler is used. Throws @c std::invalid_argument if
+     * the array has less than two items along some axis.
+     */
+    std::size_t addComponent(Array const& array,
+                             Vector3d<T> const& stagger = Vector3d<T>(0, 0, 0)) {
+        Box box = array.getBox();
+        for (int axis = 0; axis < 3; ++axis) {
+            if (box.size(axis) < 2)
+                throw std::invalid_argument("array is too thin to interpolate");
+        }
+
+        std::size_t group = 0;
+        while (group < mGroups.size() &&
+               !(mGroups[group].box == box && mGroups[group].stagger == stagger))
+            ++group;
+        if (group == mGroups.size())
+            mGroups.push_back(makeGroup(box, stagger));
+
+        Component c = { &array, group };
+        mComponents.push_back(c);
+        return mComponents.size() - 1;
+    }
+
+    /**
+     * Interpolates all components at @a count positions with coordinates
+     * @a xs, @a ys and @a zs, writing values of component @em c into
+     * <tt>outs[c]</tt>.
+     */
+    void sample(T const* xs, T const* ys, T const* zs, std::size_t count,
+                T* const* outs) const {
+        std::size_t i = 0;
+        for (; i + W <= count; i += W)
+            sampleBlock(xs + i, ys + i, zs + i, outs, i, W);
+
+        // Tail is padded by repeating the last position.
+        if (i < count) {
+            T px[W], py[W], pz[W];
+            for (std::size_t l = 0; l < W; ++l) {
+                std::size_t k = std::min(i + l, count - 1);
+                px[l] = xs[k];
+                py[l] = ys[k];
+                pz[l] = zs[k];
+            }
+            sampleBlock(px, py, pz, outs, i, count - i);
+        }
+    }
+
+    /**
+     * Interpolates all components at single position @a r into @a values.
+     */
+    void sample(Vector3d<T> const& r, T* values) const {
+        T x = r.getX(), y = r.getY(), z = r.getZ();
+        std::vector<T*> outs(mComponents.size());
+        for (std::size_t c = 0; c < outs.size(); ++c)
+            outs[c] = values + c;
+        sample(&x, &y, &z, 1, outs.data());
+    }
+
+private:
+
+    struct Component {
+        Array const* array;
+        std::size_t  group;
+    };
+
+    /**
+     * Components with the same box and stagger. Grid coordinate of a
+     * position along an axis is <tt>x*scale + shift</tt>, clamped to the
+     * range of sample points <tt>[lower, upper]</tt>.
+     */
+    struct Group {
+        Box         box;
+        Vector3d<T> stagger;
+        T           scale[3];
+        T           shift[3];
+        T           lower[3];
+        T           upper[3];
+        std::size_t stride[3];
+    };
+
+    Group makeGroup(Box const& box, Vector3d<T> const& stagger) const {
+        Group g;
+        g.box = box;
+        g.stagger = stagger;
+        for (int axis = 0; axis < 3; ++axis) {
+            T step = mGrid.getStep().get(axis);
+            g.scale[axis] = T(1) / step;
+            g.shift[axis] = -mGrid.getOrigin().get(axis) / step - stagger.get(axis);
+            g.lower[axis] = static_cast<T>(box.start[axis]);
+            g.upper[axis] = static_cast<T>(box.stop[axis] - 1);
+        }
+        g.stride[2] = 1;
+        g.stride[1] = static_cast<std::size_t>(box.size(2));
+        g.stride[0] = static_cast<std::size_t>(box.size(1) * box.size(2));
+        return g;
+    }
+
+    /**
+     * Computes lower sample point and weight of the upper one along
+     * @a axis for @a W positions.
+     */
+    static void locate(Group const& g, int axis, Register const& x,
+                       Register& cell, Register& weight) {
+        Register u = Simd::fmadd(x, Simd::broadcast(g.scale[axis]),
+                                 Simd::broadcast(g.shift[axis]));
+        u = Simd::min(Simd::max(u, Simd::broadcast(g.lower[axis])),
+                      Simd::broadcast(g.upper[axis]));
+        cell = Simd::min(Simd::floor(u), Simd::broadcast(g.upper[axis] - 1));
+        weight = Simd::sub(u, cell);
+    }
+
+    static Register lerp(Register const& a, Register const& b,
+                         Register const& w) {
+        return Simd::fmadd(w, Simd::sub(b, a), a);
+    }
+
+    void sampleBlock(T const* xs, T const* ys, T const* zs, T* const* outs,
+                     std::size_t first, std::size_t valid) const {
+        const Register x = Simd::load(xs);
+        const Register y = Simd::load(ys);
+        const Register z = Simd::load(zs);
+
+        for (std::size_t gi = 0; gi < mGroups.size(); ++gi) {
+            Group const& g = mGroups[gi];
+            Register cx, cy, cz, wx, wy, wz;
+            locate(g, 0, x, cx, wx);
+            locate(g, 1, y, cy, wy);
+            locate(g, 2, z, cz, wz);
+
+            // Offsets of lower corners. Other corners are gathered with the
+            // same offsets from shifted base pointers.
+            T fx[W], fy[W], fz[W];
+            Simd::store(fx, cx);
+            Simd::store(fy, cy);
+            Simd::store(fz, cz);
+            std::size_t offsets[W];
+            for (std::size_t l = 0; l < W; ++l) {
+                offsets[l] =
+                    static_cast<std::size_t>(static_cast<std::ptrdiff_t>(fx[l]) - g.box.start[0]) * g.stride[0] +
+                    static_cast<std::size_t>(static_cast<std::ptrdiff_t>(fy[l]) - g.box.start[1]) * g.stride[1] +
+                    static_cast<std::size_t>(static_cast<std::ptrdiff_t>(fz[l]) - g.box.start[2]);
+            }
+
+            for (std::size_t c = 0; c < mComponents.size(); ++c) {
+                if (mComponents[c].group != gi)
+                    continue;
+                T const* p = mComponents[c].array->getOrigin();
+                const std::size_t dx = g.stride[0], dy = g.stride[1];
+                Register v00 = lerp(Simd::gather(p,           offsets),
+                                    Simd::gather(p + 1,       offsets), wz);
+                Register v01 = lerp(Simd::gather(p + dy,      offsets),
+                                    Simd::gather(p + dy + 1,  offsets), wz);
+                Register v10 = lerp(Simd::gather(p + dx,      offsets),
+                                    Simd::gather(p + dx + 1,  offsets), wz);
+                Register v11 = lerp(Simd::gather(p + dx + dy, offsets),
+                                    Simd::gather(p + dx + dy + 1, offsets), wz);
+                Register v = lerp(lerp(v00, v01, wy), lerp(v10, v11, wy), wx);
+
+                if (valid == W) {
+                    Simd::store(outs[c] + first, v);
+                } else {
+                    T tmp[W];
+                    Simd::store(tmp, v);
+                    std::copy(tmp, tmp + valid, outs[c] + first);
+                }
+            }
+        }
+    }
+
+    GridGeometry<T>        mGrid;
+    std::vector<Group>     mGroups;
+    std::vector<Component> mComponents;
+};
+
+/**
+ * Computes order of @a count positions sorted by cells of @a grid they lie
+ * in, with cells ordered the same way as in arrays covering @a box.
+ * Positions outside of the box are sorted as if in the nearest boundary
+ * cell. Visiting particles in this order makes interpolation and
+ * deposition walk fields almost sequentially, instead of at random.
+ *
+ * Returned permutation @em p lists old indices in new order, so that
+ * sorted data is <tt>data[p[0]], data[p[1]], ...</tt>.
+ */
+template <typename T>
+std::vector<std::size_t> sortByCell(GridGeometry<T> const& grid,
+                                    IndexBox<std::ptrdiff_t> const& box,
+                                    T const* xs, T const* ys, T const* zs,
+                                    std::size_t count) {
+    std::vector<std::pair<std::uint64_t, std::size_t>> keys(count);
+    T const* coords[3] = { xs, ys, zs };
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint64_t key = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            std::ptrdiff_t cell = static_cast<std::ptrdiff_t>(
+                    grid.cellIndex(axis, coords[axis][i]));
+            cell = std::min(std::max(cell, box.start[axis]), box.stop[axis] - 1);
+            key = key * static_cast<std::uint64_t>(box.size(axis))
+                + static_cast<std::uint64_t>(cell - box.start[axis]);
+        }
+        keys[i] = std::make_pair(key, i);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<std::size_t> permutation(count);
+    for (std::size_t i = 0; i < count; ++i)
+        permutation[i] = keys[i].second;
+    return permutation;
+}
+
+/**
+ * Reorders @a data according to @a permutation made by @c sortByCell.
+ */
+template <typename TValue>
+void applyPermutation(std::vector<std::size_t> const& permutation,
+                      std::vector<TValue>& data) {
+    std::vector<TValue> sorted;
+    sorted.reserve(permutation.size());
+    for (std::size_t i = 0; i < permutation.size(); ++i)
+        sorted.push_back(data[permutation[i]]);
+    data.swap(sorted);
+}
+
+} // namespace core
+} // namespace rvlm
@@ -1,25 +1,145 @@
 #pragma once
+#include <cmath>
+#include "rvlm/core/LeviCivita.hh"
 
 namespace rvlm {
 namespace core {
 
+/**
+ * Tridimensional vector with value semantics.
+ * All non-modifying operations are constant expressions, so vectors may be
+ * used for compile-time geometry constants.
+ */
 template<typename valueType>
 class Vector3d {
 public:
     typedef valueType ValueType;
 
-    Vector3d(ValueType const& x, ValueType const& y, ValueType const& z)
+    constexpr Vector3d()
+            : X(), Y(), Z() {}
+
+    constexpr Vector3d(ValueType const& x, ValueType const& y, ValueType const& z)
             : X(x), Y(y), Z(z) {}
 
-    ValueType getX() const { return X; }
-    ValueType getY() const { return Y; }
-    ValueType getZ() const { return Z; }
+    constexpr ValueType getX() const { return X; }
+    constexpr ValueType getY() const { return Y; }
+    constexpr ValueType getZ() const { return Z; }
+
+    /**
+     * Gets component by its axis number: 0 for @em X, 1 for @em Y and
+     * 2 for @em Z.
+     */
+    constexpr ValueType get(int axis) const {
+        return axis == 0 ? X : axis == 1 ? Y : Z;
+    }
+
+    constexpr Vector3d operator + (Vector3d const& other) const {
+        return Vector3d(X + other.X, Y + other.Y, Z + other.Z);
+    }
+
+    constexpr Vector3d operator - (Vector3d const& other) const {
+        return Vector3d(X - other.X, Y - other.Y, Z - other.Z);
+    }
+
+    constexpr Vector3d operator - () const {
+        return Vector3d(-X, -Y, -Z);
+    }
+
+    constexpr Vector3d operator * (ValueType const& factor) const {
+        return Vector3d(X * factor, Y * factor, Z * factor);
+    }
+
+    constexpr Vector3d operator / (ValueType const& divisor) const {
+        return Vector3d(X / divisor, Y / divisor, Z / divisor);
+    }
+
+    Vector3d& operator += (Vector3d const& other) {
+        return *this = *this + other;
+    }
+
+    Vector3d& operator -= (Vector3d const& other) {
+        return *this = *this - other;
+    }
+
+    Vector3d& operator *= (ValueType const& factor) {
+        return *this = *this * factor;
+    }
+
+    Vector3d& operator /= (ValueType const& divisor) {
+        return *this = *this / divisor;
+    }
+
+    constexpr bool operator == (Vector3d const& other) const {
+        return X == other.X && Y == other.Y && Z == other.Z;
+    }
+
+    constexpr bool operator != (Vector3d const& other) const {
+        return !(*this == other);
+    }
+
+    /**
+     * Multiplies vectors component by component.
+     */
+    constexpr Vector3d scale(Vector3d const& other) const {
+        return Vector3d(X * other.X, Y * other.Y, Z * other.Z);
+    }
+
+    constexpr ValueType dot(Vector3d const& other) const {
+        return X * other.X + Y * other.Y + Z * other.Z;
+    }
+
+    /**
+     * Computes cross product <tt>c[i] = e[i][j][k] * a[j] * b[k]</tt>,
+     * where @c e is the Levi-Civita symbol, keeping only the two terms of
+     * every component whose symbol is not zero.
+     */
+    constexpr Vector3d cross(Vector3d const& other) const {
+        return Vector3d(crossComponent<0>(other),
+                        crossComponent<1>(other),
+                        crossComponent<2>(other));
+    }
+
+    constexpr ValueType normSquared() const {
+        return dot(*this);
+    }
+
+    ValueType norm() const {
+        return std::sqrt(normSquared());
+    }
+
+    /**
+     * Returns vector of unit length with the same direction.
+     */
+    Vector3d normalized() const {
+        return *this / norm();
+    }
+
 private:
     ValueType X;
     ValueType Y;
     ValueType Z;
+
+    /**
+     * @internal
+     * Component @a I of cross product, the same as in @c Vector3dPack: the
+     * symbol is @c +1 for the two other axes in cyclic order and @c -1 for
+     * the other order.
+     */
+    template <int I>
+    constexpr ValueType crossComponent(Vector3d const& other) const {
+        static_assert(leviCivita(I, (I + 1) % 3, (I + 2) % 3) == 1 &&
+                      leviCivita(I, (I + 2) % 3, (I + 1) % 3) == -1,
+                      "cyclic permutation must be even");
+        return get((I + 1) % 3) * other.get((I + 2) % 3)
+             - get((I + 2) % 3) * other.get((I + 1) % 3);
+    }
 };
 
+template<typename TValue>
+constexpr Vector3d<TValue> operator * (TValue const& factor,
+                                       Vector3d<TValue> const& vector) {
+    return vector * factor;
+}
+
 }//namespace core
 }//namespace rvlm
-
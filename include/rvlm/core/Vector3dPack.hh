@@ -0,0 +1,236 @@
+#pragma once
+#include <cstddef>
+#include "rvlm/core/LeviCivita.hh"
+#include "rvlm/core/SolidArray3d.hh"
+#include "rvlm/core/Vector3d.hh"
+#include "rvlm/core/detail/Simd.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Batch of @a W tridimensional vectors processed at once.
+ *
+ * Vectors are stored in "structure of arrays" form: one SIMD register per
+ * component, holding that component of all @a W vectors. Operations mirror
+ * those of @c Vector3d and are applied lane by lane. Default width is the
+ * natural SIMD width for @a T on the target machine (e.g. 4 doubles with
+ * AVX2, 8 doubles with AVX-512), other widths are emulated.
+ *
+ * Packs are meant to be short-lived locals, loaded from and stored into
+ * component arrays of particles or into field arrays:
+ * @code
+ *     typedef Vector3dPack<double> Pack;
+ *     for (std::size_t i = 0; i + Pack::WIDTH <= n; i += Pack::WIDTH) {
+ *         Pack v = Pack::load(vx+i, vy+i, vz+i);
+ *         Pack e = Pack::gather(ex, ey, ez, offsets+i);
+ *         (v + e * qm).store(vx+i, vy+i, vz+i);
+ *     }
+ * @endcode
+ */
+template <typename T, std::size_t W = detail::NativeSimdWidth<T>::value>
+class Vector3dPack {
+public:
+
+    typedef T                              ValueType;
+    typedef detail::SimdTraits<T, W>       Simd;
+    typedef typename Simd::Register        Register;
+
+    static const std::size_t WIDTH = W;
+
+    /**
+     * Constructs pack of zero vectors.
+     */
+    Vector3dPack()
+        : mX(Simd::broadcast(0)), mY(Simd::broadcast(0)), mZ(Simd::broadcast(0)) {}
+
+    Vector3dPack(Register const& x, Register const& y, Register const& z)
+        : mX(x), mY(y), mZ(z) {}
+
+    /**
+     * Constructs pack of @a W copies of the same vector.
+     */
+    explicit Vector3dPack(Vector3d<T> const& v)
+        : mX(Simd::broadcast(v.getX())),
+          mY(Simd::broadcast(v.getY())),
+          mZ(Simd::broadcast(v.getZ())) {}
+
+    /**
+     * Loads @a W consecutive vectors from component arrays.
+     */
+    static Vector3dPack load(T const* xs, T const* ys, T const* zs) {
+        return Vector3dPack(Simd::load(xs), Simd::load(ys), Simd::load(zs));
+    }
+
+    /**
+     * Stores vectors into @a W consecutive items of component arrays.
+     */
+    void store(T* xs, T* ys, T* zs) const {
+        Simd::store(xs, mX);
+        Simd::store(ys, mY);
+        Simd::store(zs, mZ);
+    }
+
+    /**
+     * Gathers vectors from field component arrays at @a W item offsets.
+     * Offsets are obtained with @c SolidArray3d::getOffset, and all three
+     * arrays must have the same geometry.
+     */
+    template <typename TIndex>
+    static Vector3dPack gather(SolidArray3d<T, TIndex> const& fx,
+                               SolidArray3d<T, TIndex> const& fy,
+                               SolidArray3d<T, TIndex> const& fz,
+                               std::size_t const* offsets) {
+        return Vector3dPack(Simd::gather(fx.getOrigin(), offsets),
+                            Simd::gather(fy.getOrigin(), offsets),
+                            Simd::gather(fz.getOrigin(), offsets));
+    }
+
+    /**
+     * Scatters vectors into field component arrays at @a W item offsets.
+     * If offsets repeat, the last lane wins.
+     */
+    template <typename TIndex>
+    void scatter(SolidArray3d<T, TIndex>& fx,
+                 SolidArray3d<T, TIndex>& fy,
+                 SolidArray3d<T, TIndex>& fz,
+                 std::size_t const* offsets) const {
+        Simd::scatter(fx.getOrigin(), offsets, mX);
+        Simd::scatter(fy.getOrigin(), offsets, mY);
+        Simd::scatter(fz.getOrigin(), offsets, mZ);
+    }
+
+    Register const& getX() const { return mX; }
+    Register const& getY() const { return mY; }
+    Register const& getZ() const { return mZ; }
+
+    /**
+     * Gets component register by its axis number.
+     */
+    template <int Axis>
+    Register const& get() const {
+        static_assert(0 <= Axis && Axis < 3, "wrong axis");
+        return Axis == 0 ? mX : Axis == 1 ? mY : mZ;
+    }
+
+    /**
+     * Extracts single vector from lane @a lane.
+     */
+    Vector3d<T> get(std::size_t lane) const {
+        T xs[W], ys[W], zs[W];
+        store(xs, ys, zs);
+        return Vector3d<T>(xs[lane], ys[lane], zs[lane]);
+    }
+
+    Vector3dPack operator + (Vector3dPack const& other) const {
+        return Vector3dPack(Simd::add(mX, other.mX),
+                            Simd::add(mY, other.mY),
+                            Simd::add(mZ, other.mZ));
+    }
+
+    Vector3dPack operator - (Vector3dPack const& other) const {
+        return Vector3dPack(Simd::sub(mX, other.mX),
+                            Simd::sub(mY, other.mY),
+                            Simd::sub(mZ, other.mZ));
+    }
+
+    Vector3dPack operator - () const {
+        return Vector3dPack(Simd::neg(mX), Simd::neg(mY), Simd::neg(mZ));
+    }
+
+    /**
+     * Multiplies each vector by its own factor from @a factors.
+     */
+    Vector3dPack operator * (Register const& factors) const {
+        return Vector3dPack(Simd::mul(mX, factors),
+                            Simd::mul(mY, factors),
+                            Simd::mul(mZ, factors));
+    }
+
+    Vector3dPack operator * (T factor) const {
+        return *this * Simd::broadcast(factor);
+    }
+
+    Vector3dPack operator / (Register const& divisors) const {
+        return Vector3dPack(Simd::div(mX, divisors),
+                            Simd::div(mY, divisors),
+                            Simd::div(mZ, divisors));
+    }
+
+    Vector3dPack operator / (T divisor) const {
+        return *this / Simd::broadcast(divisor);
+    }
+
+    Vector3dPack& operator += (Vector3dPack const& other) {
+        return *this = *this + other;
+    }
+
+    Vector3dPack& operator -= (Vector3dPack const& other) {
+        return *this = *this - other;
+    }
+
+    /**
+     * Computes <tt>*this + a*factors</tt>, using fused multiply-add where
+     * available. This is the core of most particle push updates.
+     */
+    Vector3dPack addScaled(Vector3dPack const& a, Register const& factors) const {
+        return Vector3dPack(Simd::fmadd(a.mX, factors, mX),
+                            Simd::fmadd(a.mY, factors, mY),
+                            Simd::fmadd(a.mZ, factors, mZ));
+    }
+
+    Vector3dPack scale(Vector3dPack const& other) const {
+        return Vector3dPack(Simd::mul(mX, other.mX),
+                            Simd::mul(mY, other.mY),
+                            Simd::mul(mZ, other.mZ));
+    }
+
+    Register dot(Vector3dPack const& other) const {
+        return Simd::fmadd(mZ, other.mZ,
+               Simd::fmadd(mY, other.mY,
+               Simd::mul(mX, other.mX)));
+    }
+
+    Vector3dPack cross(Vector3dPack const& other) const {
+        return Vector3dPack(crossComponent<0>(other),
+                            crossComponent<1>(other),
+                            crossComponent<2>(other));
+    }
+
+    Register normSquared() const {
+        return dot(*this);
+    }
+
+    Register norm() const {
+        return Simd::sqrt(normSquared());
+    }
+
+private:
+    Register mX;
+    Register mY;
+    Register mZ;
+
+    /**
+     * @internal
+     * Component @a I of cross product. Only terms with @a J and @a K being
+     * the two other axes survive in <tt>e[I][J][K] * a[J] * b[K]</tt>, and
+     * the symbol is @c +1 for their cyclic order and @c -1 for the other.
+     */
+    template <int I>
+    Register crossComponent(Vector3dPack const& other) const {
+        static const int J = (I + 1) % 3;
+        static const int K = (I + 2) % 3;
+        static_assert(leviCivita(I, J, K) == 1 && leviCivita(I, K, J) == -1,
+                      "cyclic permutation must be even");
+        return Simd::sub(Simd::mul(get<J>(), other.template get<K>()),
+                         Simd::mul(get<K>(), other.template get<J>()));
+    }
+};
+
+template <typename T, std::size_t W>
+Vector3dPack<T, W> operator * (T factor, Vector3dPack<T, W> const& pack) {
+    return pack * factor;
+}
+
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,221 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "rvlm/core/Cuboid.hh"
+#include "rvlm/core/GridGeometry.hh"
+#include "rvlm/core/SolidArray3d.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Rasterizes scenes made of cuboids onto @c SolidArray3d grids.
+ *
+ * Every cuboid is added along with the value to paint and a priority.
+ * Cuboids with higher priority are painted over those with lower priority,
+ * and cuboids with equal priority are painted in the order of addition.
+ * Each cuboid is converted into index ranges once, after which cells are
+ * filled row by row with contiguous fills. Work is split between threads by
+ * @em X planes, so painting order is preserved and no synchronization is
+ * needed.
+ *
+ * Two fill modes are supported. The @c fill method paints cells whose
+ * centers lie inside a cuboid. The @c fillAveraged method accounts for
+ * partially covered cells: the value of a cell becomes the mix of its old
+ * value and the cuboid value, weighted by the covered volume fraction. This
+ * is the usual way of computing averaged material coefficients on cuboid
+ * boundaries which do not coincide with cell boundaries.
+ */
+template <typename TFloat, typename TValue>
+class Voxelizer {
+public:
+
+    typedef TFloat ValueType;
+    typedef TValue FillType;
+
+    explicit Voxelizer(GridGeometry<TFloat> const& grid)
+            : mGrid(grid) {}
+
+    /**
+     * Adds cuboid to be painted with @a value.
+     */
+    void add(Cuboid<TFloat> const& cuboid, TValue const& value,
+             int priority = 0) {
+        Shape shape;
+        shape.priority = priority;
+        shape.order    = mShapes.size();
+        shape.value    = value;
+        for (int axis = 0; axis < 3; ++axis) {
+            shape.lower[axis] = mGrid.toGrid(axis, cuboid.getLower(axis));
+            shape.upper[axis] = mGrid.toGrid(axis, cuboid.getUpper(axis));
+        }
+        mShapes.push_back(shape);
+    }
+
+    std::size_t getShapeCount() const {
+        return mShapes.size();
+    }
+
+    /**
+     * Paints every cell whose center lies inside a cuboid.
+     * Cells not covered by any cuboid keep their values.
+     */
+    template <typename TIndex>
+    void fill(SolidArray3d<TValue, TIndex>& array) const {
+        paint(array, false);
+    }
+
+    /**
+     * Paints cells mixing their values with cuboid values in proportion to
+     * the covered fraction of cell volume. Type @a TValue must support
+     * addition and multiplication by @a TFloat.
+     */
+    template <typename TIndex>
+    void fillAveraged(SolidArray3d<TValue, TIndex>& array) const {
+        paint(array, true);
+    }
+
+private:
+
+    struct Shape {
+        int         priority;
+        std::size_t order;
+        TValue      value;
+        TFloat      lower[3];
+        TFloat      upper[3];
+    };
+
+    /**
+     * @internal
+     * Cuboid converted into cell index ranges along every axis, with the
+     * fraction of each cell covered by the cuboid.
+     */
+    struct Footprint {
+        TValue                value;
+        std::int64_t          start[3];
+        std::int64_t          stop[3];
+        std::vector<TFloat>   fraction[3];
+        bool                  partial;
+    };
+
+    static bool byPriority(Shape const* a, Shape const* b) {
+        return a->priority != b->priority ? a->priority < b->priority
+                                          : a->order < b->order;
+    }
+
+    template <typename TIndex>
+    void paint(SolidArray3d<TValue, TIndex>& array, bool averaged) const {
+        std::int64_t begin[3] = { static_cast<std::int64_t>(array.getBeginX()),
+                                  static_cast<std::int64_t>(array.getBeginY()),
+                                  static_cast<std::int64_t>(array.getBeginZ()) };
+        std::int64_t end[3]   = { static_cast<std::int64_t>(array.getEndX()),
+                                  static_cast<std::int64_t>(array.getEndY()),
+                                  static_cast<std::int64_t>(array.getEndZ()) };
+
+        std::vector<Shape const*> ordered;
+        for (std::size_t i = 0; i < mShapes.size(); ++i)
+            ordered.push_back(&mShapes[i]);
+        std::sort(ordered.begin(), ordered.end(), &Voxelizer::byPriority);
+
+        std::vector<Footprint> footprints;
+        footprints.reserve(ordered.size());
+        for (std::size_t i = 0; i < ordered.size(); ++i) {
+            Footprint fp;
+            if (makeFootprint(*ordered[i], begin, end, averaged, fp))
+                footprints.push_back(fp);
+        }
+
+        const std::int64_t x0 = begin[0];
+        const std::int64_t x1 = end[0];
+        const std::int64_t shapeCount =
+                static_cast<std::int64_t>(footprints.size());
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (std::int64_t ix = x0; ix < x1; ++ix) {
+            for (std::int64_t s = 0; s < shapeCount; ++s) {
+                Footprint const& fp = footprints[s];
+                if (ix < fp.start[0] || ix >= fp.stop[0])
+                    continue;
+
+                for (std::int64_t iy = fp.start[1]; iy < fp.stop[1]; ++iy) {
+                    TValue* row = array.getCursor(
+                        static_cast<TIndex>(ix), static_cast<TIndex>(iy),
+                        static_cast<TIndex>(fp.start[2]));
+                    std::size_t count =
+                        static_cast<std::size_t>(fp.stop[2] - fp.start[2]);
+
+                    if (!fp.partial) {
+                        std::fill(row, row + count, fp.value);
+                        continue;
+                    }
+
+                    TFloat fxy = fp.fraction[0][ix - fp.start[0]]
+                               * fp.fraction[1][iy - fp.start[1]];
+                    TFloat const* fz = fp.fraction[2].data();
+                    for (std::size_t k = 0; k < count; ++k) {
+                        TFloat f = fxy * fz[k];
+                        row[k] = f >= 1 ? fp.value
+                                        : row[k]*(1 - f) + fp.value*f;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @internal
+     * Converts shape into footprint clipped to [begin, end). Returns false
+     * if nothing of the shape falls into the array.
+     */
+    bool makeFootprint(Shape const& shape,
+                       std::int64_t const* begin, std::int64_t const* end,
+                       bool averaged, Footprint& fp) const {
+        fp.value   = shape.value;
+        fp.partial = false;
+
+        for (int axis = 0; axis < 3; ++axis) {
+            TFloat lo = shape.lower[axis];
+            TFloat hi = shape.upper[axis];
+
+            // Centers of cells lie at half-integral grid coordinates. For
+            // averaging, every cell touched by the cuboid is included.
+            std::int64_t start, stop;
+            if (averaged) {
+                start = static_cast<std::int64_t>(std::floor(lo));
+                stop  = static_cast<std::int64_t>(std::ceil(hi));
+            } else {
+                start = static_cast<std::int64_t>(std::ceil(lo - TFloat(0.5)));
+                stop  = static_cast<std::int64_t>(std::ceil(hi - TFloat(0.5)));
+            }
+
+            fp.start[axis] = std::max(start, begin[axis]);
+            fp.stop[axis]  = std::min(stop,  end[axis]);
+            if (fp.start[axis] >= fp.stop[axis])
+                return false;
+
+            if (!averaged)
+                continue;
+
+            std::vector<TFloat>& fraction = fp.fraction[axis];
+            for (std::int64_t i = fp.start[axis]; i < fp.stop[axis]; ++i) {
+                TFloat cellLo = static_cast<TFloat>(i);
+                TFloat cellHi = cellLo + 1;
+                TFloat f = std::min(hi, cellHi) - std::max(lo, cellLo);
+                f = std::max(TFloat(0), std::min(TFloat(1), f));
+                fp.partial = fp.partial || f < 1;
+                fraction.push_back(f);
+            }
+        }
+
+        return true;
+    }
+
+    GridGeometry<TFloat> mGrid;
+    std::vector<Shape>   mShapes;
+};
+
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,432 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "rvlm/core/Constants.hh"
+#include "rvlm/core/Kernels.hh"
+#include "rvlm/core/LeviCivita.hh"
+#include "rvlm/core/MaterialGrid.hh"
+#include "rvlm/core/SolidArray3d.hh"
+#include "rvlm/core/Vector3d.hh"
+
+namespace rvlm {
+namespace core {
+
+/**
+ * Medium with the same relative permittivity and permeability everywhere.
+ *
+ * Media are passed to @c YeeUpdater by value and must be cheap to copy;
+ * every thread of an update works with its own copy. For every row of
+ * cells they return an object giving inverse relative permittivity
+ * (@c electric) and inverse relative permeability (@c magnetic) of the
+ * cell with given offset along the row, and the whole rows of these
+ * values (@c electricRow and @c magneticRow), or null where they are the
+ * same for all cells.
+ */
+template <typename TFloat>
+class UniformMedium {
+public:
+
+    struct Row {
+        TFloat electric(std::size_t) const { return invEps; }
+        TFloat magnetic(std::size_t) const { return invMu; }
+        TFloat const* electricRow() const { return 0; }
+        TFloat const* magneticRow() const { return 0; }
+        TFloat invEps;
+        TFloat invMu;
+    };
+
+    explicit UniformMedium(TFloat epsR = 1, TFloat muR = 1)
+            : mRow{1/epsR, 1/muR} {}
+
+    template <typename TIndex>
+    Row row(TIndex, TIndex) const { return mRow; }
+
+private:
+    Row mRow;
+};
+
+/**
+ * Medium given cell by cell with two arrays, holding inverse relative
+ * permittivity and inverse relative permeability. Inverse values are
+ * stored so that updates need no division. Arrays are referenced, not
+ * copied, and must have the same geometry as field arrays.
+ */
+template <typename TFloat, typename TIndex = std::size_t>
+class CellMedium {
+public:
+
+    struct Row {
+        TFloat electric(std::size_t k) const { return invEps[k]; }
+        TFloat magnetic(std::size_t k) const { return invMu[k]; }
+        TFloat const* electricRow() const { return invEps; }
+        TFloat const* magneticRow() const { return invMu; }
+        TFloat const* invEps;
+        TFloat const* invMu;
+    };
+
+    CellMedium(SolidArray3d<TFloat, TIndex> const& invEpsR,
+               SolidArray3d<TFloat, TIndex> const& invMuR)
+            : mInvEps(&invEpsR), mInvMu(&invMuR) {}
+
+    Row row(TIndex ix, TIndex iy) const {
+        Row r = { mInvEps->getCursor(ix, iy, mInvEps->getBeginZ()),
+                  mInvMu ->getCursor(ix, iy, mInvMu ->getBeginZ()) };
+        return r;
+    }
+
+private:
+    SolidArray3d<TFloat, TIndex> const* mInvEps;
+    SolidArray3d<TFloat, TIndex> const* mInvMu;
+};
+
+/**
+ * Medium made of a few materials, taking inverse relative permittivity and
+ * permeability from coefficients 0 and 1 of a @c MaterialGrid, which must
+ * have the same geometry as field arrays and outlive the medium.
+ *
+ * Coefficients of a row are gathered into buffers of the medium when the
+ * row is requested, so that field updates read them sequentially like
+ * @c CellMedium arrays, while memory traffic is one byte per cell. A row
+ * stays valid until the next call of @c row on the same medium object;
+ * @c YeeUpdater gives every thread its own copy.
+ */
+template <typename TFloat, typename TId = std::uint8_t,
+          typename TIndex = std::size_t>
+class MaterialMedium {
+public:
+
+    typedef MaterialGrid<TFloat, TId, TIndex> Grid;
+
+    struct Row {
+        TFloat electric(std::size_t k) const { return invEps[k]; }
+        TFloat magnetic(std::size_t k) const { return invMu[k]; }
+        TFloat const* electricRow() const { return invEps; }
+        TFloat const* magneticRow() const { return invMu; }
+        TFloat const* invEps;
+        TFloat const* invMu;
+    };
+
+    explicit MaterialMedium(Grid const& grid)
+            : mGrid(&grid) {
+        if (grid.getCoefficientCount() < 2)
+            throw std::invalid_argument("medium needs two coefficients");
+    }
+
+    Row row(TIndex ix, TIndex iy) const {
+        typename Grid::IdArray const& ids = mGrid->getIds();
+        const std::size_t n = static_cast<std::size_t>(ids.getCountZ());
+        if (mInvEps.size() < n) {
+            mInvEps.resize(n);
+            mInvMu.resize(n);
+        }
+        TId const* p = ids.getCursor(ix, iy, ids.getBeginZ());
+        mGrid->gather(0, p, n, mInvEps.data());
+        mGrid->gather(1, p, n, mInvMu.data());
+        Row r = { mInvEps.data(), mInvMu.data() };
+        return r;
+    }
+
+private:
+    Grid const*                 mGrid;
+    mutable std::vector<TFloat> mInvEps;
+    mutable std::vector<TFloat> mInvMu;
+};
+
+/**
+ * Leapfrog update of electromagnetic fields on the Yee grid.
+ *
+ * Six field components live in six arrays of the same geometry. Component
+ * arrays use the usual Yee staggering: @em E components are shifted by half
+ * a cell along their own axis, @em H components by half a cell along both
+ * other axes, so that the curl of @em E is taken with forward differences
+ * and the curl of @em H with backward differences. Fields outside of arrays
+ * are taken as zero, which is a perfectly conducting box.
+ *
+ * All six component updates come from one template: component @em I takes
+ * the curl terms along the two other axes in cyclic order, with signs given
+ * by @c leviCivita and neighbours reached with @c cursorMoveToNext and
+ * @c cursorMoveToPrev templated by axis. Rows are updated by the
+ * @c KernelSet::curlUpdate kernel for the active instruction set, so
+ * @a TFloat is either @c float or @c double.
+ *
+ * Method @c step fuses both half steps into one pass over memory: every
+ * row of @em H components is updated right before the row of @em E
+ * components at the same (@em ix, @em iy), which is the latest point when
+ * the old @em E values it needs are still intact. Threads take contiguous
+ * slabs along @em X and update @em H on the last plane of their slabs
+ * before the pass, since the next slab needs these values first.
+ */
+template <typename TFloat, typename TIndex = std::size_t,
+          typename TMedium = UniformMedium<TFloat>>
+class YeeUpdater {
+public:
+
+    typedef TFloat ValueType;
+    typedef TIndex IndexType;
+    typedef SolidArray3d<TFloat, TIndex> Array;
+
+    /**
+     * Constructs updater for given field components, cell size @a step and
+     * time step @a dt. All arrays must have the same geometry, otherwise
+     * @c std::invalid_argument is thrown.
+     */
+    YeeUpdater(Array& ex, Array& ey, Array& ez,
+               Array& hx, Array& hy, Array& hz,
+               Vector3d<TFloat> const& step, TFloat dt,
+               TMedium const& medium = TMedium())
+            : mE{&ex, &ey, &ez}, mH{&hx, &hy, &hz},
+              mMedium(medium), mKernels(&kernels::active<TFloat>()), mTimeStep(dt),
+              mZeros(static_cast<std::size_t>(ex.getCountZ()) + 1, TFloat(0)) {
+        Array* arrays[] = { &ex, &ey, &ez, &hx, &hy, &hz };
+        for (int i = 1; i < 6; ++i) {
+            if (arrays[i]->getBeginX() != ex.getBeginX() ||
+                arrays[i]->getBeginY() != ex.getBeginY() ||
+                arrays[i]->getBeginZ() != ex.getBeginZ() ||
+                arrays[i]->getCountX() != ex.getCountX() ||
+                arrays[i]->getCountY() != ex.getCountY() ||
+                arrays[i]->getCountZ() != ex.getCountZ())
+                throw std::invalid_argument("field arrays differ in geometry");
+        }
+
+        for (int axis = 0; axis < 3; ++axis) {
+            mECoef[axis] = dt / (Constants<TFloat>::EPS_0() * step.get(axis));
+            mHCoef[axis] = dt / (Constants<TFloat>::MU_0()  * step.get(axis));
+        }
+    }
+
+    /**
+     * Gets the largest stable time step for cells of size @a step in
+     * vacuum, by the Courant condition.
+     */
+    static TFloat courantLimit(Vector3d<TFloat> const& step) {
+        TFloat s = 1/(step.getX()*step.getX()) + 1/(step.getY()*step.getY())
+                 + 1/(step.getZ()*step.getZ());
+        return 1/(Constants<TFloat>::C() * std::sqrt(s));
+    }
+
+    TFloat getTimeStep() const { return mTimeStep; }
+
+    /**
+     * Advances fields by one time step: @em H by the first half step, then
+     * @em E by the second one, in a single fused pass.
+     */
+    void step() {
+        const std::int64_t x0 = static_cast<std::int64_t>(mE[0]->getBeginX());
+        const std::int64_t x1 = static_cast<std::int64_t>(mE[0]->getEndX());
+
+        #pragma omp parallel
+        {
+            std::int64_t threads = 1, thread = 0;
+#ifdef _OPENMP
+            threads = omp_get_num_threads();
+            thread  = omp_get_thread_num();
+#endif
+            std::int64_t lo = x0 + (x1 - x0) *  thread      / threads;
+            std::int64_t hi = x0 + (x1 - x0) * (thread + 1) / threads;
+            TMedium medium(mMedium);
+
+            if (lo < hi)
+                updateHPlane(static_cast<TIndex>(hi - 1), medium);
+
+            #pragma omp barrier
+
+            for (std::int64_t ix = lo; ix < hi; ++ix) {
+                forEachRow(static_cast<TIndex>(ix), [&](TIndex i, TIndex j) {
+                    if (ix != hi - 1)
+                        updateHRow(i, j, medium);
+                    updateERow(i, j, medium);
+                });
+            }
+        }
+    }
+
+    /**
+     * Advances @em H by a half step alone. Together with @c updateE this
+     * is an unfused equivalent of @c step, which leaves room to apply
+     * sources between the half steps.
+     */
+    void updateH() {
+        forEachPlane([this](TIndex ix, TMedium const& medium) {
+            updateHPlane(ix, medium);
+        });
+    }
+
+    /**
+     * Advances @em E by a half step alone.
+     */
+    void updateE() {
+        forEachPlane([this](TIndex ix, TMedium const& medium) {
+            forEachRow(ix, [&](TIndex i, TIndex j) { updateERow(i, j, medium); });
+        });
+    }
+
+private:
+
+    /**
+     * @internal
+     * Axes of the curl terms of component @a I, in cyclic order.
+     */
+    template <int I>
+    struct Curl {
+        static const int J = (I + 1) % 3;
+        static const int K = (I + 2) % 3;
+        static_assert(leviCivita(I, J, K) == 1 && leviCivita(I, K, J) == -1,
+                      "curl axes must be cyclic");
+    };
+
+    template <typename TFunc>
+    void forEachPlane(TFunc func) {
+        const std::int64_t x0 = static_cast<std::int64_t>(mE[0]->getBeginX());
+        const std::int64_t x1 = static_cast<std::int64_t>(mE[0]->getEndX());
+
+        #pragma omp parallel
+        {
+            TMedium medium(mMedium);
+            #pragma omp for schedule(static)
+            for (std::int64_t ix = x0; ix < x1; ++ix)
+                func(static_cast<TIndex>(ix), medium);
+        }
+    }
+
+    template <typename TFunc>
+    void forEachRow(TIndex ix, TFunc func) const {
+        for (TIndex iy = mE[0]->getBeginY(); iy < mE[0]->getEndY(); ++iy)
+            func(ix, iy);
+    }
+
+    void updateHPlane(TIndex ix, TMedium const& medium) {
+        forEachRow(ix, [&](TIndex i, TIndex j) { updateHRow(i, j, medium); });
+    }
+
+    /**
+     * @internal
+     * Gets row of @a array next to row (@a ix, @a iy) along @a Axis, or
+     * row of zeros beyond the array. Along @em Z this is the row itself
+     * shifted by one item, whose last item the caller must not read.
+     */
+    template <int Axis>
+    TFloat const* nextRow(Array const& array, TIndex ix, TIndex iy) const {
+        typename Array::CursorType c = array.getCursor(ix, iy, array.getBeginZ());
+        if ((Axis == 0 && ix + 1 == array.getEndX()) ||
+            (Axis == 1 && iy + 1 == array.getEndY()))
+            return mZeros.data();
+        array.template cursorMoveToNext<Axis>(c);
+        return c;
+    }
+
+    /**
+     * @internal
+     * Same as @c nextRow in the opposite direction, except that along
+     * @em Z the row itself is returned, and the caller reads it with shift.
+     */
+    template <int Axis>
+    TFloat const* prevRow(Array const& array, TIndex ix, TIndex iy) const {
+        typename Array::CursorType c = array.getCursor(ix, iy, array.getBeginZ());
+        if ((Axis == 0 && ix == array.getBeginX()) ||
+            (Axis == 1 && iy == array.getBeginY()))
+            return mZeros.data();
+        if (Axis != 2)
+            array.template cursorMoveToPrev<Axis>(c);
+        return c;
+    }
+
+    void updateHRow(TIndex ix, TIndex iy, TMedium const& medium) {
+        typename TMedium::Row m = medium.row(ix, iy);
+        updateHComponent<0>(ix, iy, m);
+        updateHComponent<1>(ix, iy, m);
+        updateHComponent<2>(ix, iy, m);
+    }
+
+    void updateERow(TIndex ix, TIndex iy, TMedium const& medium) {
+        typename TMedium::Row m = medium.row(ix, iy);
+        updateEComponent<0>(ix, iy, m);
+        updateEComponent<1>(ix, iy, m);
+        updateEComponent<2>(ix, iy, m);
+    }
+
+    /**
+     * @internal
+     * <tt>H_I -= dt/mu * (dE_K/dJ - dE_J/dK)</tt> with forward differences.
+     */
+    template <int I>
+    void updateHComponent(TIndex ix, TIndex iy, typename TMedium::Row const& m) {
+        const int J = Curl<I>::J;
+        const int K = Curl<I>::K;
+        Array const& ek = *mE[K];
+        Array const& ej = *mE[J];
+
+        TFloat*       h      = mH[I]->getCursor(ix, iy, mH[I]->getBeginZ());
+        TFloat const* ekHere = ek.getCursor(ix, iy, ek.getBeginZ());
+        TFloat const* ejHere = ej.getCursor(ix, iy, ej.getBeginZ());
+        TFloat const* ekNext = nextRow<J>(ek, ix, iy);
+        TFloat const* ejNext = nextRow<K>(ej, ix, iy);
+        const TFloat cj = mHCoef[J];
+        const TFloat ck = mHCoef[K];
+        const std::size_t n = static_cast<std::size_t>(ek.getCountZ());
+
+        // Differences are taken backwards to add instead of subtract; a
+        // medium the same everywhere is folded into the coefficients.
+        TFloat const* mu = m.magneticRow();
+        const TFloat scale = mu ? TFloat(1) : m.magnetic(0);
+        mKernels->curlUpdate(h, mu, ekHere, ekNext, scale*cj,
+                             ejHere, ejNext, scale*ck, n - 1);
+
+        // Last item: neighbour along Z is beyond the array.
+        const std::size_t k = n - 1;
+        TFloat dk = (J == 2 ? TFloat(0) : ekNext[k]) - ekHere[k];
+        TFloat dj = (K == 2 ? TFloat(0) : ejNext[k]) - ejHere[k];
+        h[k] -= m.magnetic(k) * (cj*dk - ck*dj);
+    }
+
+    /**
+     * @internal
+     * <tt>E_I += dt/eps * (dH_K/dJ - dH_J/dK)</tt> with backward differences.
+     */
+    template <int I>
+    void updateEComponent(TIndex ix, TIndex iy, typename TMedium::Row const& m) {
+        const int J = Curl<I>::J;
+        const int K = Curl<I>::K;
+        Array const& hk = *mH[K];
+        Array const& hj = *mH[J];
+
+        TFloat*       e      = mE[I]->getCursor(ix, iy, mE[I]->getBeginZ());
+        TFloat const* hkHere = hk.getCursor(ix, iy, hk.getBeginZ());
+        TFloat const* hjHere = hj.getCursor(ix, iy, hj.getBeginZ());
+        TFloat const* hkPrev = prevRow<J>(hk, ix, iy);
+        TFloat const* hjPrev = prevRow<K>(hj, ix, iy);
+        const TFloat cj = mECoef[J];
+        const TFloat ck = mECoef[K];
+        const std::size_t n = static_cast<std::size_t>(hk.getCountZ());
+        const std::size_t sj = J == 2 ? 1 : 0;
+        const std::size_t sk = K == 2 ? 1 : 0;
+
+        // First item: neighbour along Z is beyond the array.
+        TFloat dk = hkHere[0] - (J == 2 ? TFloat(0) : hkPrev[0]);
+        TFloat dj = hjHere[0] - (K == 2 ? TFloat(0) : hjPrev[0]);
+        e[0] += m.electric(0) * (cj*dk - ck*dj);
+
+        TFloat const* eps = m.electricRow();
+        const TFloat scale = eps ? TFloat(1) : m.electric(0);
+        mKernels->curlUpdate(e + 1, eps ? eps + 1 : 0,
+                             hkHere + 1, hkPrev + 1 - sj, scale*cj,
+                             hjHere + 1, hjPrev + 1 - sk, scale*ck, n - 1);
+    }
+
+    Array*                   mE[3];
+    Array*                   mH[3];
+    TMedium                  mMedium;
+    KernelSet<TFloat> const* mKernels;
+    TFloat                   mTimeStep;
+    TFloat                   mECoef[3];
+    TFloat                   mHCoef[3];
+    std::vector<TFloat>      mZeros;
+};
+
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace rvlm {
+namespace core {
+namespace detail {
+
+/**
+ * @internal
+ * Returns index of the lowest set bit in @a word, which must not be zero.
+ */
+inline unsigned countTrailingZeros(std::uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+}
+
+/**
+ * @internal
+ * Returns number of set bits in @a word.
+ */
+inline unsigned popCount(std::uint64_t word) {
+#if defined(_MSC_VER)
+    return static_cast<unsigned>(__popcnt64(word));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(word));
+#endif
+}
+
+} // namespace detail
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,188 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+#include "rvlm/core/detail/BitOps.hh"
+
+namespace rvlm {
+namespace core {
+namespace detail {
+
+/**
+ * @internal
+ * Word-wise set operations over fixed-size bitmask arrays, used by @c Flags.
+ * Generic version is a plain loop, which the compiler completely unrolls for
+ * small @a Count, so single-word masks cost exactly as much as a raw integer.
+ */
+template <typename TWord, std::size_t Count, typename = void>
+struct FlagsWordOps {
+    // NB: SIMD specializations below only match 'void' as the last argument,
+    // so they may explicitly fall back to this version by passing 'int'.
+
+    static void bitAnd(TWord* a, TWord const* b) {
+        for (std::size_t i = 0; i < Count; ++i) a[i] &= b[i];
+    }
+
+    static void bitOr(TWord* a, TWord const* b) {
+        for (std::size_t i = 0; i < Count; ++i) a[i] |= b[i];
+    }
+
+    static void bitXor(TWord* a, TWord const* b) {
+        for (std::size_t i = 0; i < Count; ++i) a[i] ^= b[i];
+    }
+
+    static void bitAndNot(TWord* a, TWord const* b) {
+        for (std::size_t i = 0; i < Count; ++i) a[i] &= ~b[i];
+    }
+
+    static bool isZero(TWord const* a) {
+        TWord acc = 0;
+        for (std::size_t i = 0; i < Count; ++i) acc |= a[i];
+        return acc == 0;
+    }
+
+    static bool isEqual(TWord const* a, TWord const* b) {
+        TWord acc = 0;
+        for (std::size_t i = 0; i < Count; ++i) acc |= a[i] ^ b[i];
+        return acc == 0;
+    }
+
+    static std::size_t popCount(TWord const* a) {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < Count; ++i)
+            result += detail::popCount(static_cast<std::uint64_t>(a[i]));
+        return result;
+    }
+};
+
+#if defined(__AVX512F__)
+
+template <std::size_t Count>
+struct FlagsWordOps<std::uint64_t, Count,
+                    typename std::enable_if<Count % 8 == 0>::type> {
+
+    static __m512i load(std::uint64_t const* p) {
+        return _mm512_loadu_si512(reinterpret_cast<void const*>(p));
+    }
+
+    static void store(std::uint64_t* p, __m512i v) {
+        _mm512_storeu_si512(reinterpret_cast<void*>(p), v);
+    }
+
+    static void bitAnd(std::uint64_t* a, std::uint64_t const* b) {
+        for (std::size_t i = 0; i < Count; i += 8)
+            store(a+i, _mm512_and_si512(load(a+i), load(b+i)));
+    }
+
+    static void bitOr(std::uint64_t* a, std::uint64_t const* b) {
+        for (std::size_t i = 0; i < Count; i += 8)
+            store(a+i, _mm512_or_si512(load(a+i), load(b+i)));
+    }
+
+    static void bitXor(std::uint64_t* a, std::uint64_t const* b) {
+        for (std::size_t i = 0; i < Count; i += 8)
+            store(a+i, _mm512_xor_si512(load(a+i), load(b+i)));
+    }
+
+    static void bitAndNot(std::uint64_t* a, std::uint64_t const* b) {
+        // Intrinsic computes (~first & second), hence swapped arguments.
+        for (std::size_t i = 0; i < Count; i += 8)
+            store(a+i, _mm512_andnot_si512(load(b+i), load(a+i)));
+    }
+
+    static bool isZero(std::uint64_t const* a) {
+        __m512i acc = _mm512_setzero_si512();
+        for (std::size_t i = 0; i < Count; i += 8)
+            acc = _mm512_or_si512(acc, load(a+i));
+        return _mm512_test_epi64_mask(acc, acc) == 0;
+    }
+
+    static bool isEqual(std::uint64_t const* a, std::uint64_t const* b) {
+        __m512i acc = _mm512_setzero_si512();
+        for (std::size_t i = 0; i < Count; i += 8)
+            acc = _mm512_or_si512(acc, _mm512_xor_si512(load(a+i), load(b+i)));
+        return _mm512_test_epi64_mask(acc, acc) == 0;
+    }
+
+    static std::size_t popCount(std::uint64_t const* a) {
+#if defined(__AVX512VPOPCNTDQ__)
+        __m512i acc = _mm512_setzero_si512();
+        for (std::size_t i = 0; i < Count; i += 8)
+            acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(load(a+i)));
+        return static_cast<std::size_t>(_mm512_reduce_add_epi64(acc));
+#else
+        return FlagsWordOps<std::uint64_t, Count, int>::popCount(a);
+#endif
+    }
+};
+
+#endif // __AVX512F__
+
+#if defined(__AVX2__)
+
+template <std::size_t Count>
+struct FlagsWordOps<std::uint64_t, Count,
+                    typename std::enable_if<Count % 4 == 0
+#if defined(__AVX512F__)
+                                            && Count % 8 != 0
+#endif
+                                            >::type> {
+
+    static __m256i load(std::uint64_t const* p) {
+        return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+    }
+
+    static void store(std::uint64_t* p, __m256i v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+
+    static void bitAnd(std::uint64_t* a, std::uint64_t const* b) {
+        for (std::size_t i = 0; i < Count; i += 4)
+            store(a+i, _mm256_and_si256(load(a+i), load(b+i)));
+    }
+
+    static void bitOr(std::uint64_t* a, std::uint64_t const* b) {
+        for (std::size_t i = 0; i < Count; i += 4)
+            store(a+i, _mm256_or_si256(load(a+i), load(b+i)));
+    }
+
+    static void bitXor(std::uint64_t* a, std::uint64_t const* b) {
+        for (std::size_t i = 0; i < Count; i += 4)
+            store(a+i, _mm256_xor_si256(load(a+i), load(b+i)));
+    }
+
+    static void bitAndNot(std::uint64_t* a, std::uint64_t const* b) {
+        // Intrinsic computes (~first & second), hence swapped arguments.
+        for (std::size_t i = 0; i < Count; i += 4)
+            store(a+i, _mm256_andnot_si256(load(b+i), load(a+i)));
+    }
+
+    static bool isZero(std::uint64_t const* a) {
+        __m256i acc = _mm256_setzero_si256();
+        for (std::size_t i = 0; i < Count; i += 4)
+            acc = _mm256_or_si256(acc, load(a+i));
+        return _mm256_testz_si256(acc, acc) != 0;
+    }
+
+    static bool isEqual(std::uint64_t const* a, std::uint64_t const* b) {
+        __m256i acc = _mm256_setzero_si256();
+        for (std::size_t i = 0; i < Count; i += 4)
+            acc = _mm256_or_si256(acc, _mm256_xor_si256(load(a+i), load(b+i)));
+        return _mm256_testz_si256(acc, acc) != 0;
+    }
+
+    // Four hardware 'popcnt' instructions per vector outperform the nibble
+    // lookup table approach, so popcount stays scalar here.
+    static std::size_t popCount(std::uint64_t const* a) {
+        return FlagsWordOps<std::uint64_t, Count, int>::popCount(a);
+    }
+};
+
+#endif // __AVX2__
+
+} // namespace detail
+} // namespace core
+} // namespace rvlm
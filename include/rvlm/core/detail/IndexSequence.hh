@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+
+namespace rvlm {
+namespace core {
+namespace detail {
+
+/**
+ * @internal
+ * Compile-time sequence of indices, a C++11 replacement for
+ * @c std::index_sequence. It is mostly used for initializing member arrays
+ * in @c constexpr constructors.
+ */
+template <std::size_t... Indices>
+struct IndexSequence {};
+
+template <std::size_t Count, std::size_t... Indices>
+struct MakeIndexSequenceHelper
+    : MakeIndexSequenceHelper<Count - 1, Count - 1, Indices...> {};
+
+template <std::size_t... Indices>
+struct MakeIndexSequenceHelper<0, Indices...> {
+    typedef IndexSequence<Indices...> Type;
+};
+
+template <std::size_t Count>
+using MakeIndexSequence = typename MakeIndexSequenceHelper<Count>::Type;
+
+} // namespace detail
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,389 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#if defined(__AVX__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace rvlm {
+namespace core {
+namespace detail {
+
+/**
+ * @internal
+ * Thin wrapper over SIMD registers holding @a W values of type @a T.
+ *
+ * Generic version emulates a register with a plain array, so that code
+ * written against this interface works for any width and on any machine.
+ * Specializations map the same operations onto AVX (4 doubles, 8 floats)
+ * and AVX-512 (8 doubles, 16 floats) intrinsics when the compiler targets
+ * these instruction sets. All loads and stores are unaligned.
+ */
+template <typename T, std::size_t W>
+struct SimdTraits {
+    struct Register {
+        T v[W];
+    };
+
+    static const std::size_t WIDTH = W;
+
+    static Register broadcast(T a) {
+        Register r;
+        for (std::size_t i = 0; i < W; ++i) r.v[i] = a;
+        return r;
+    }
+
+    static Register load(T const* p) {
+        Register r;
+        for (std::size_t i = 0; i < W; ++i) r.v[i] = p[i];
+        return r;
+    }
+
+    static void store(T* p, Register const& a) {
+        for (std::size_t i = 0; i < W; ++i) p[i] = a.v[i];
+    }
+
+    static Register gather(T const* base, std::size_t const* offsets) {
+        Register r;
+        for (std::size_t i = 0; i < W; ++i) r.v[i] = base[offsets[i]];
+        return r;
+    }
+
+    static void scatter(T* base, std::size_t const* offsets, Register const& a) {
+        for (std::size_t i = 0; i < W; ++i) base[offsets[i]] = a.v[i];
+    }
+
+#define RVLM_CORE_DETAIL_SIMD_BINARY_OP(Name, Expr)                      \
+    static Register Name(Register const& a, Register const& b) {         \
+        Register r;                                                      \
+        for (std::size_t i = 0; i < W; ++i) r.v[i] = (Expr);             \
+        return r;                                                        \
+    }
+
+    RVLM_CORE_DETAIL_SIMD_BINARY_OP(add, a.v[i] + b.v[i])
+    RVLM_CORE_DETAIL_SIMD_BINARY_OP(sub, a.v[i] - b.v[i])
+    RVLM_CORE_DETAIL_SIMD_BINARY_OP(mul, a.v[i] * b.v[i])
+    RVLM_CORE_DETAIL_SIMD_BINARY_OP(div, a.v[i] / b.v[i])
+    RVLM_CORE_DETAIL_SIMD_BINARY_OP(min, b.v[i] < a.v[i] ? b.v[i] : a.v[i])
+    RVLM_CORE_DETAIL_SIMD_BINARY_OP(max, a.v[i] < b.v[i] ? b.v[i] : a.v[i])
+#undef RVLM_CORE_DETAIL_SIMD_BINARY_OP
+
+    /** Computes <tt>a*b + c</tt>. */
+    static Register fmadd(Register const& a, Register const& b,
+                          Register const& c) {
+        Register r;
+        for (std::size_t i = 0; i < W; ++i) r.v[i] = a.v[i]*b.v[i] + c.v[i];
+        return r;
+    }
+
+    static Register sqrt(Register const& a) {
+        Register r;
+        for (std::size_t i = 0; i < W; ++i) r.v[i] = std::sqrt(a.v[i]);
+        return r;
+    }
+
+    static Register neg(Register const& a) {
+        Register r;
+        for (std::size_t i = 0; i < W; ++i) r.v[i] = -a.v[i];
+        return r;
+    }
+
+    static Register floor(Register const& a) {
+        Register r;
+        for (std::size_t i = 0; i < W; ++i) r.v[i] = std::floor(a.v[i]);
+        return r;
+    }
+
+    /** Rounds to nearest integer, ties to even. */
+    static Register nearest(Register const& a) {
+        Register r;
+        for (std::size_t i = 0; i < W; ++i) r.v[i] = std::nearbyint(a.v[i]);
+        return r;
+    }
+
+    /**
+     * Computes <tt>a * 2^n</tt> for integral-valued @a n. Arguments must
+     * keep the result a normal number, apart from overflowing to infinity.
+     */
+    static Register scale2(Register const& a, Register const& n) {
+        Register r;
+        for (std::size_t i = 0; i < W; ++i)
+            r.v[i] = std::ldexp(a.v[i], static_cast<int>(n.v[i]));
+        return r;
+    }
+
+    /** Selects lane-wise <tt>a > b ? t : f</tt>. */
+    static Register blendGreater(Register const& a, Register const& b,
+                                 Register const& t, Register const& f) {
+        Register r;
+        for (std::size_t i = 0; i < W; ++i) r.v[i] = a.v[i] > b.v[i] ? t.v[i] : f.v[i];
+        return r;
+    }
+
+    /** Selects lane-wise @a t where @a a or @a b is NaN, @a f elsewhere. */
+    static Register blendUnordered(Register const& a, Register const& b,
+                                   Register const& t, Register const& f) {
+        Register r;
+        for (std::size_t i = 0; i < W; ++i)
+            r.v[i] = a.v[i] != a.v[i] || b.v[i] != b.v[i] ? t.v[i] : f.v[i];
+        return r;
+    }
+};
+
+#define RVLM_CORE_DETAIL_SIMD_COMMON(T, W, Reg, P, S)                      \
+    typedef Reg Register;                                                 \
+    static const std::size_t WIDTH = W;                                   \
+    static Register broadcast(T a) { return _##P##_set1_##S(a); }        \
+    static Register load(T const* p) { return _##P##_loadu_##S(p); }     \
+    static void store(T* p, Register a) { _##P##_storeu_##S(p, a); }     \
+    static Register add(Register a, Register b) { return _##P##_add_##S(a, b); } \
+    static Register sub(Register a, Register b) { return _##P##_sub_##S(a, b); } \
+    static Register mul(Register a, Register b) { return _##P##_mul_##S(a, b); } \
+    static Register div(Register a, Register b) { return _##P##_div_##S(a, b); } \
+    static Register min(Register a, Register b) { return _##P##_min_##S(a, b); } \
+    static Register max(Register a, Register b) { return _##P##_max_##S(a, b); } \
+    static Register sqrt(Register a) { return _##P##_sqrt_##S(a); }      \
+    static Register neg(Register a) {                                     \
+        return _##P##_sub_##S(_##P##_setzero_##S(), a);                   \
+    }
+
+#if defined(__FMA__) || defined(__AVX512F__)
+#define RVLM_CORE_DETAIL_SIMD_FMADD(P, S)                                 \
+    static Register fmadd(Register a, Register b, Register c) {           \
+        return _##P##_fmadd_##S(a, b, c);                                 \
+    }
+#else
+#define RVLM_CORE_DETAIL_SIMD_FMADD(P, S)                                 \
+    static Register fmadd(Register a, Register b, Register c) {           \
+        return _##P##_add_##S(_##P##_mul_##S(a, b), c);                   \
+    }
+#endif
+
+#define RVLM_CORE_DETAIL_SIMD_AVX_ROUNDING(S)                              \
+    static Register floor(Register a) { return _mm256_floor_##S(a); }     \
+    static Register nearest(Register a) {                                 \
+        return _mm256_round_##S(a, _MM_FROUND_TO_NEAREST_INT |            \
+                                   _MM_FROUND_NO_EXC);                    \
+    }                                                                     \
+    static Register blendGreater(Register a, Register b,                  \
+                                 Register t, Register f) {                \
+        return _mm256_blendv_##S(f, t, _mm256_cmp_##S(a, b, _CMP_GT_OQ)); \
+    }                                                                     \
+    static Register blendUnordered(Register a, Register b,                \
+                                   Register t, Register f) {              \
+        return _mm256_blendv_##S(f, t, _mm256_cmp_##S(a, b, _CMP_UNORD_Q)); \
+    }
+
+#define RVLM_CORE_DETAIL_SIMD_AVX512_ROUNDING(S)                           \
+    static Register floor(Register a) {                                   \
+        return _mm512_roundscale_##S(a, _MM_FROUND_TO_NEG_INF |           \
+                                        _MM_FROUND_NO_EXC);               \
+    }                                                                     \
+    static Register nearest(Register a) {                                 \
+        return _mm512_roundscale_##S(a, _MM_FROUND_TO_NEAREST_INT |       \
+                                        _MM_FROUND_NO_EXC);               \
+    }                                                                     \
+    static Register scale2(Register a, Register n) {                      \
+        return _mm512_scalef_##S(a, n);                                   \
+    }                                                                     \
+    static Register blendGreater(Register a, Register b,                  \
+                                 Register t, Register f) {                \
+        return _mm512_mask_blend_##S(                                     \
+                _mm512_cmp_##S##_mask(a, b, _CMP_GT_OQ), f, t);           \
+    }                                                                     \
+    static Register blendUnordered(Register a, Register b,                \
+                                   Register t, Register f) {              \
+        return _mm512_mask_blend_##S(                                     \
+                _mm512_cmp_##S##_mask(a, b, _CMP_UNORD_Q), f, t);         \
+    }
+
+#if defined(__AVX__)
+
+template <>
+struct SimdTraits<double, 4> {
+    RVLM_CORE_DETAIL_SIMD_COMMON(double, 4, __m256d, mm256, pd)
+    RVLM_CORE_DETAIL_SIMD_FMADD(mm256, pd)
+    RVLM_CORE_DETAIL_SIMD_AVX_ROUNDING(pd)
+
+    static Register scale2(Register a, Register n) {
+#if defined(__AVX2__)
+        // Adding 1.5*2^52 places integral 'n' into the low mantissa bits,
+        // from which the biased exponent of 2^(n-1) is built. Multiplying
+        // by 2 first keeps intermediate results normal down to n = -1021.
+        const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+        __m256i bits = _mm256_sub_epi64(
+                _mm256_castpd_si256(_mm256_add_pd(n, magic)),
+                _mm256_castpd_si256(magic));
+        __m256i exponent = _mm256_slli_epi64(
+                _mm256_add_epi64(bits, _mm256_set1_epi64x(1022)), 52);
+        return _mm256_mul_pd(_mm256_add_pd(a, a),
+                             _mm256_castsi256_pd(exponent));
+#else
+        alignas(32) double ta[4], tn[4];
+        _mm256_store_pd(ta, a);
+        _mm256_store_pd(tn, n);
+        for (int i = 0; i < 4; ++i)
+            ta[i] = std::ldexp(ta[i], static_cast<int>(tn[i]));
+        return _mm256_load_pd(ta);
+#endif
+    }
+
+    static Register gather(double const* base, std::size_t const* offsets) {
+#if defined(__AVX2__)
+        __m256i idx = _mm256_loadu_si256(
+                reinterpret_cast<__m256i const*>(offsets));
+        return _mm256_i64gather_pd(base, idx, sizeof(double));
+#else
+        return _mm256_setr_pd(base[offsets[0]], base[offsets[1]],
+                              base[offsets[2]], base[offsets[3]]);
+#endif
+    }
+
+    static void scatter(double* base, std::size_t const* offsets, Register a) {
+        alignas(32) double tmp[4];
+        _mm256_store_pd(tmp, a);
+        for (int i = 0; i < 4; ++i) base[offsets[i]] = tmp[i];
+    }
+};
+
+template <>
+struct SimdTraits<float, 8> {
+    RVLM_CORE_DETAIL_SIMD_COMMON(float, 8, __m256, mm256, ps)
+    RVLM_CORE_DETAIL_SIMD_FMADD(mm256, ps)
+    RVLM_CORE_DETAIL_SIMD_AVX_ROUNDING(ps)
+
+    static Register scale2(Register a, Register n) {
+#if defined(__AVX2__)
+        // Same trick as for doubles, with 1.5*2^23 and 8-bit exponent.
+        const __m256 magic = _mm256_set1_ps(12582912.0f);
+        __m256i bits = _mm256_sub_epi32(
+                _mm256_castps_si256(_mm256_add_ps(n, magic)),
+                _mm256_castps_si256(magic));
+        __m256i exponent = _mm256_slli_epi32(
+                _mm256_add_epi32(bits, _mm256_set1_epi32(126)), 23);
+        return _mm256_mul_ps(_mm256_add_ps(a, a),
+                             _mm256_castsi256_ps(exponent));
+#else
+        alignas(32) float ta[8], tn[8];
+        _mm256_store_ps(ta, a);
+        _mm256_store_ps(tn, n);
+        for (int i = 0; i < 8; ++i)
+            ta[i] = std::ldexp(ta[i], static_cast<int>(tn[i]));
+        return _mm256_load_ps(ta);
+#endif
+    }
+
+    static Register gather(float const* base, std::size_t const* offsets) {
+#if defined(__AVX2__)
+        __m256i lo = _mm256_loadu_si256(
+                reinterpret_cast<__m256i const*>(offsets));
+        __m256i hi = _mm256_loadu_si256(
+                reinterpret_cast<__m256i const*>(offsets + 4));
+        return _mm256_set_m128(_mm256_i64gather_ps(base, hi, sizeof(float)),
+                               _mm256_i64gather_ps(base, lo, sizeof(float)));
+#else
+        return _mm256_setr_ps(base[offsets[0]], base[offsets[1]],
+                              base[offsets[2]], base[offsets[3]],
+                              base[offsets[4]], base[offsets[5]],
+                              base[offsets[6]], base[offsets[7]]);
+#endif
+    }
+
+    static void scatter(float* base, std::size_t const* offsets, Register a) {
+        alignas(32) float tmp[8];
+        _mm256_store_ps(tmp, a);
+        for (int i = 0; i < 8; ++i) base[offsets[i]] = tmp[i];
+    }
+};
+
+#endif // __AVX__
+
+#if defined(__AVX512F__)
+
+template <>
+struct SimdTraits<double, 8> {
+    RVLM_CORE_DETAIL_SIMD_COMMON(double, 8, __m512d, mm512, pd)
+    RVLM_CORE_DETAIL_SIMD_FMADD(mm512, pd)
+    RVLM_CORE_DETAIL_SIMD_AVX512_ROUNDING(pd)
+
+    static Register gather(double const* base, std::size_t const* offsets) {
+        __m512i idx = _mm512_loadu_si512(offsets);
+        return _mm512_i64gather_pd(idx, base, sizeof(double));
+    }
+
+    static void scatter(double* base, std::size_t const* offsets, Register a) {
+        __m512i idx = _mm512_loadu_si512(offsets);
+        _mm512_i64scatter_pd(base, idx, a, sizeof(double));
+    }
+};
+
+template <>
+struct SimdTraits<float, 16> {
+    RVLM_CORE_DETAIL_SIMD_COMMON(float, 16, __m512, mm512, ps)
+    RVLM_CORE_DETAIL_SIMD_FMADD(mm512, ps)
+    RVLM_CORE_DETAIL_SIMD_AVX512_ROUNDING(ps)
+
+    static Register gather(float const* base, std::size_t const* offsets) {
+        __m512i lo = _mm512_loadu_si512(offsets);
+        __m512i hi = _mm512_loadu_si512(offsets + 8);
+        __m256 rlo = _mm512_i64gather_ps(lo, base, sizeof(float));
+        __m256 rhi = _mm512_i64gather_ps(hi, base, sizeof(float));
+        return _mm512_castpd_ps(_mm512_insertf64x4(
+                _mm512_castps_pd(_mm512_castps256_ps512(rlo)),
+                _mm256_castps_pd(rhi), 1));
+    }
+
+    static void scatter(float* base, std::size_t const* offsets, Register a) {
+        __m512i lo = _mm512_loadu_si512(offsets);
+        __m512i hi = _mm512_loadu_si512(offsets + 8);
+        __m512d bits = _mm512_castps_pd(a);
+        _mm512_i64scatter_ps(base, lo,
+            _mm256_castpd_ps(_mm512_castpd512_pd256(bits)), sizeof(float));
+        _mm512_i64scatter_ps(base, hi,
+            _mm256_castpd_ps(_mm512_extractf64x4_pd(bits, 1)), sizeof(float));
+    }
+};
+
+#endif // __AVX512F__
+
+#undef RVLM_CORE_DETAIL_SIMD_AVX512_ROUNDING
+#undef RVLM_CORE_DETAIL_SIMD_AVX_ROUNDING
+#undef RVLM_CORE_DETAIL_SIMD_FMADD
+#undef RVLM_CORE_DETAIL_SIMD_COMMON
+
+/**
+ * @internal
+ * Natural SIMD width for type @a T on the target machine: the widest
+ * specialization of @c SimdTraits available, or 1 without SIMD support.
+ */
+template <typename T>
+struct NativeSimdWidth {
+    static const std::size_t value = 1;
+};
+
+template <>
+struct NativeSimdWidth<double> {
+#if defined(__AVX512F__)
+    static const std::size_t value = 8;
+#elif defined(__AVX__)
+    static const std::size_t value = 4;
+#else
+    static const std::size_t value = 1;
+#endif
+};
+
+template <>
+struct NativeSimdWidth<float> {
+#if defined(__AVX512F__)
+    static const std::size_t value = 16;
+#elif defined(__AVX__)
+    static const std::size_t value = 8;
+#else
+    static const std::size_t value = 1;
+#endif
+};
+
+} // namespace detail
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,40 @@
+#pragma once
+#include <cinttypes>
+#include <stdexcept>
+#include "rvlm/core/Trace.hh"
+#include "rvlm/core/memory/Allocator.hh"
+
+namespace rvlm {
+namespace core {
+namespace memory {
+
+/**
+ * Allocator recording every call to another allocator as a region of the
+ * running @c TraceSession, with requested size attached to allocations.
+ * Unlike @c RVLM_TRACE_* macros, it records whenever a session runs, so
+ * that allocations of chosen arrays can be traced in any build. Target
+ * allocator must outlive this one.
+ * @see Allocator
+ */
+class TracingAllocator: public virtual Allocator {
+public:
+
+    explicit TracingAllocator(Allocator* target): mTarget(target) {}
+
+    virtual void* allocate(size_t size) throw (std::bad_alloc) override {
+        TraceScope scope("allocate", size);
+        return mTarget->allocate(size);
+    }
+
+    virtual void deallocate(void* ptr) throw (std::bad_alloc) override {
+        TraceScope scope("deallocate");
+        mTarget->deallocate(ptr);
+    }
+
+private:
+    Allocator* mTarget;
+};
+
+} // namespace memory
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,211 @@
+#pragma once
+#include <mpi.h>
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "rvlm/core/CartesianDecomposition.hh"
+#include "rvlm/core/IndexBox.hh"
+#include "rvlm/core/NonAssignable.hh"
+
+namespace rvlm {
+namespace core {
+namespace mpi {
+
+/**
+ * Non-blocking exchange of face halos of a @c Subdomain with neighbouring
+ * processes.
+ *
+ * Every process calls @c begin, which packs owned cells adjacent to shared
+ * faces and posts all receives and sends, then computes whatever does not
+ * depend on halos (usually the interior box), and finally calls @c finish,
+ * which waits for messages and unpacks them into halo layers:
+ * @code
+ *     exchange.begin();
+ *     compute(sub.getInteriorBox());
+ *     exchange.finish();
+ *     for (auto const& box: sub.getBoundaryBoxes())
+ *         compute(box);
+ * @endcode
+ *
+ * Only the six face halos are exchanged, edge and corner halo cells are not
+ * updated. This is enough for stencils reaching along one axis at a time,
+ * like Yee or 7-point Laplacian ones. Values are sent as raw bytes, so
+ * @a TValue must be trivially copyable, and all processes must run on
+ * machines with the same data representation.
+ */
+template <typename TValue>
+class HaloExchange: public NonAssignable {
+public:
+
+    static_assert(std::is_trivially_copyable<TValue>::value,
+                  "halo values are sent as raw bytes");
+
+    typedef CartesianDecomposition::Box Box;
+
+    /**
+     * Prepares exchange of halos of @a subdomain within communicator
+     * @a comm, where ranks are the same as in decomposition. Throws
+     * @c std::invalid_argument if the owned box of any process is thinner
+     * than the halo along an axis split between processes; the check looks
+     * at the whole decomposition, so either all processes throw or none.
+     */
+    HaloExchange(MPI_Comm comm, Subdomain<TValue>& subdomain)
+        : mComm(comm), mSubdomain(subdomain), mActive(false) {
+
+        CartesianDecomposition const& dec = subdomain.getDecomposition();
+        const int rank = subdomain.getRank();
+        const int halo = subdomain.getHalo();
+        Box const& owned = subdomain.getOwnedBox();
+        if (halo == 0)
+            return;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (dec.getDim(axis) > 1 && dec.minOwnedSize(axis) < halo)
+                throw std::invalid_argument("subdomain is thinner than halo");
+        }
+
+        for (int axis = 0; axis < 3; ++axis) {
+            for (int side = 0; side < 2; ++side) {
+                const int direction = side ? +1 : -1;
+                Face face;
+                face.neighbor = dec.neighbor(rank, axis, direction);
+                if (face.neighbor < 0)
+                    continue;
+
+                face.sendBox = owned;
+                face.recvBox = owned;
+                if (side) {
+                    face.sendBox.start[axis] = owned.stop[axis] - halo;
+                    face.recvBox.start[axis] = owned.stop[axis];
+                    face.recvBox.stop[axis]  = owned.stop[axis] + halo;
+                } else {
+                    face.sendBox.stop[axis]  = owned.start[axis] + halo;
+                    face.recvBox.start[axis] = owned.start[axis] - halo;
+                    face.recvBox.stop[axis]  = owned.start[axis];
+                }
+
+                // Message sent towards direction d arrives into the opposite
+                // halo of the neighbour, so the receiving side expects the
+                // tag of the opposite direction.
+                face.sendTag = axis*2 + side;
+                face.recvTag = axis*2 + (1 - side);
+                face.sendBuffer.resize(static_cast<std::size_t>(face.sendBox.count()));
+                face.recvBuffer.resize(static_cast<std::size_t>(face.recvBox.count()));
+                mFaces.push_back(face);
+            }
+        }
+        mRequests.resize(2 * mFaces.size(), MPI_REQUEST_NULL);
+    }
+
+    /**
+     * Waits for an exchange left in flight, so that buffers are not freed
+     * while MPI still uses them.
+     */
+    ~HaloExchange() {
+        if (mActive)
+            MPI_Waitall(static_cast<int>(mRequests.size()), mRequests.data(),
+                        MPI_STATUSES_IGNORE);
+    }
+
+    /**
+     * Posts receives, packs owned face cells and posts sends. Owned cells
+     * adjacent to shared faces must not be modified until @c finish returns,
+     * halo cells must not be accessed at all.
+     */
+    void begin() {
+        if (mActive)
+            throw std::logic_error("halo exchange is already in progress");
+
+        for (std::size_t i = 0; i < mFaces.size(); ++i) {
+            Face& face = mFaces[i];
+            MPI_Irecv(face.recvBuffer.data(), byteCount(face.recvBuffer),
+                      MPI_BYTE, face.neighbor, face.recvTag, mComm,
+                      &mRequests[2*i]);
+        }
+        for (std::size_t i = 0; i < mFaces.size(); ++i) {
+            Face& face = mFaces[i];
+            pack(face.sendBox, face.sendBuffer);
+            MPI_Isend(face.sendBuffer.data(), byteCount(face.sendBuffer),
+                      MPI_BYTE, face.neighbor, face.sendTag, mComm,
+                      &mRequests[2*i + 1]);
+        }
+        mActive = true;
+    }
+
+    /**
+     * Waits for all messages posted by @c begin and unpacks received cells
+     * into halo layers.
+     */
+    void finish() {
+        if (!mActive)
+            throw std::logic_error("halo exchange was not started");
+
+        MPI_Waitall(static_cast<int>(mRequests.size()), mRequests.data(),
+                    MPI_STATUSES_IGNORE);
+        mActive = false;
+        for (std::size_t i = 0; i < mFaces.size(); ++i)
+            unpack(mFaces[i].recvBox, mFaces[i].recvBuffer);
+    }
+
+    /**
+     * Exchanges halos without overlapping with computation.
+     */
+    void exchange() {
+        begin();
+        finish();
+    }
+
+    bool isActive() const { return mActive; }
+
+private:
+
+    struct Face {
+        int neighbor;
+        int sendTag;
+        int recvTag;
+        Box sendBox;
+        Box recvBox;
+        std::vector<TValue> sendBuffer;
+        std::vector<TValue> recvBuffer;
+    };
+
+    static int byteCount(std::vector<TValue> const& buffer) {
+        return static_cast<int>(buffer.size() * sizeof(TValue));
+    }
+
+    void pack(Box const& box, std::vector<TValue>& buffer) {
+        typename Subdomain<TValue>::Array& array = mSubdomain.getArray();
+        TValue* out = buffer.data();
+        const std::ptrdiff_t count = box.size(2);
+        for (std::ptrdiff_t ix = box.start[0]; ix < box.stop[0]; ++ix) {
+            for (std::ptrdiff_t iy = box.start[1]; iy < box.stop[1]; ++iy) {
+                TValue const* row = array.getCursor(ix, iy, box.start[2]);
+                out = std::copy(row, row + count, out);
+            }
+        }
+    }
+
+    void unpack(Box const& box, std::vector<TValue> const& buffer) {
+        typename Subdomain<TValue>::Array& array = mSubdomain.getArray();
+        TValue const* in = buffer.data();
+        const std::ptrdiff_t count = box.size(2);
+        for (std::ptrdiff_t ix = box.start[0]; ix < box.stop[0]; ++ix) {
+            for (std::ptrdiff_t iy = box.start[1]; iy < box.stop[1]; ++iy) {
+                TValue* row = array.getCursor(ix, iy, box.start[2]);
+                std::copy(in, in + count, row);
+                in += count;
+            }
+        }
+    }
+
+    MPI_Comm                 mComm;
+    Subdomain<TValue>&       mSubdomain;
+    std::vector<Face>        mFaces;
+    std::vector<MPI_Request> mRequests;
+    bool                     mActive;
+};
+
+} // namespace mpi
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,293 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "rvlm/core/memory/Allocator.hh"
+#include "rvlm/core/memory/OperatorNewAllocator.hh"
+
+namespace rvlm {
+
+/**
+ * Reference counting policy for objects which may be shared between threads.
+ * Counter updates are atomic, which is exactly what @c std::shared_ptr does.
+ */
+struct atomic_ref_count {
+    typedef std::atomic<std::size_t> counter_type;
+
+    static void increment(counter_type& counter) noexcept {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Decrements counter and returns whether it has dropped to zero.
+     */
+    static bool decrement(counter_type& counter) noexcept {
+        return counter.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    static std::size_t load(counter_type const& counter) noexcept {
+        return counter.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Reference counting policy for objects which never leave a single thread.
+ * Counter is a plain integer, so copying a pointer costs no more than an
+ * ordinary increment.
+ */
+struct local_ref_count {
+    typedef std::size_t counter_type;
+
+    static void increment(counter_type& counter) noexcept {
+        ++counter;
+    }
+
+    static bool decrement(counter_type& counter) noexcept {
+        return --counter == 0;
+    }
+
+    static std::size_t load(counter_type const& counter) noexcept {
+        return counter;
+    }
+};
+
+template <typename T>
+class intrusive_object_ptr;
+
+/**
+ * Base class for objects owned by @c intrusive_object_ptr.
+ *
+ * Reference counter lives right inside the object, so there is neither a
+ * separate control block nor an extra allocation per object. Parameter
+ * @a TPolicy selects whether counter updates are atomic (@c atomic_ref_count)
+ * or not (@c local_ref_count). Derive from this class publicly and
+ * non-virtually:
+ * @code
+ *     class CellGroup: public rvlm::ref_counted<rvlm::local_ref_count> {
+ *         ...
+ *     };
+ * @endcode
+ *
+ * Copying the object does not copy its reference counter.
+ */
+template <typename TPolicy = atomic_ref_count>
+class ref_counted {
+public:
+    typedef TPolicy ref_count_policy;
+
+    /**
+     * Returns number of @c intrusive_object_ptr instances owning this object.
+     */
+    std::size_t use_count() const noexcept {
+        return TPolicy::load(mCount);
+    }
+
+protected:
+    ref_counted() noexcept
+        : mCount(0), mDispose(nullptr), mAllocator(nullptr) {}
+
+    ref_counted(ref_counted const&) noexcept
+        : mCount(0), mDispose(nullptr), mAllocator(nullptr) {}
+
+    ref_counted& operator=(ref_counted const&) noexcept {
+        return *this;
+    }
+
+    ~ref_counted() = default;
+
+private:
+    void add_ref() const noexcept {
+        TPolicy::increment(mCount);
+    }
+
+    void release() const noexcept {
+        if (TPolicy::decrement(mCount))
+            mDispose(const_cast<ref_counted*>(this));
+    }
+
+    /**
+     * @internal
+     * Destroys the most derived object @a T and returns its memory to the
+     * allocator it was obtained from. This way @a T does not need to have
+     * a virtual destructor even if it is owned through a base class pointer.
+     */
+    template <typename T>
+    static void dispose(ref_counted* self) {
+        T* object = static_cast<T*>(self);
+        core::memory::Allocator* allocator = self->mAllocator;
+        object->~T();
+        allocator->deallocate(object);
+    }
+
+    mutable typename TPolicy::counter_type mCount;
+    void (*mDispose)(ref_counted*);
+    core::memory::Allocator* mAllocator;
+
+template <typename T1>
+friend class intrusive_object_ptr;
+
+template <typename T1, typename... TArgs>
+friend intrusive_object_ptr<T1> allocate_intrusive_object(
+        core::memory::Allocator& allocator, TArgs&&... args);
+};
+
+/**
+ * Never-null smart pointer with reference counter embedded into the object.
+ *
+ * This is the intrusive counterpart of @c object_ptr. Like the latter, it
+ * can only be obtained from @c make_intrusive_object or
+ * @c allocate_intrusive_object, so it always points to a valid object. The
+ * only exception is a pointer which has been moved from: it may be either
+ * destroyed or assigned to, nothing else.
+ *
+ * Type @a T must be derived from @c ref_counted.
+ */
+template <typename T>
+class intrusive_object_ptr {
+public:
+    typedef T element_type;
+
+    intrusive_object_ptr(intrusive_object_ptr const& r) noexcept
+            : mPtr(r.mPtr) {
+        mPtr->add_ref();
+    }
+
+    template <typename T1, typename =
+             typename std::enable_if<std::is_convertible<T1*, T*>::value>::type>
+    intrusive_object_ptr(intrusive_object_ptr<T1> const& r) noexcept
+            : mPtr(r.get()) {
+        mPtr->add_ref();
+    }
+
+    intrusive_object_ptr(intrusive_object_ptr&& r) noexcept
+            : mPtr(r.mPtr) {
+        r.mPtr = nullptr;
+    }
+
+    template <typename T1, typename =
+             typename std::enable_if<std::is_convertible<T1*, T*>::value>::type>
+    intrusive_object_ptr(intrusive_object_ptr<T1>&& r) noexcept
+            : mPtr(r.mPtr) {
+        r.mPtr = nullptr;
+    }
+
+    ~intrusive_object_ptr() {
+        if (mPtr)
+            mPtr->release();
+    }
+
+    intrusive_object_ptr& operator=(intrusive_object_ptr const& r) noexcept {
+        intrusive_object_ptr(r).swap(*this);
+        return *this;
+    }
+
+    template <typename T1>
+    intrusive_object_ptr& operator=(intrusive_object_ptr<T1> const& r) noexcept {
+        intrusive_object_ptr(r).swap(*this);
+        return *this;
+    }
+
+    intrusive_object_ptr& operator=(intrusive_object_ptr&& r) noexcept {
+        intrusive_object_ptr(std::move(r)).swap(*this);
+        return *this;
+    }
+
+    template <typename T1>
+    intrusive_object_ptr& operator=(intrusive_object_ptr<T1>&& r) noexcept {
+        intrusive_object_ptr(std::move(r)).swap(*this);
+        return *this;
+    }
+
+    void swap(intrusive_object_ptr& other) noexcept {
+        std::swap(mPtr, other.mPtr);
+    }
+
+    T* get() const noexcept { return mPtr; }
+    T& operator*() const noexcept { return *mPtr; }
+    T* operator->() const noexcept { return mPtr; }
+
+    std::size_t use_count() const noexcept {
+        return mPtr->use_count();
+    }
+
+private:
+
+    /**
+     * @internal
+     * Adopts freshly constructed object @a p.
+     */
+    explicit intrusive_object_ptr(T* p) noexcept
+            : mPtr(p) {
+        mPtr->add_ref();
+    }
+
+    T* mPtr;
+
+template <typename T1>
+friend class intrusive_object_ptr;
+
+template <typename T1, typename... TArgs>
+friend intrusive_object_ptr<T1> allocate_intrusive_object(
+        core::memory::Allocator& allocator, TArgs&&... args);
+};
+
+template <typename T, typename T1>
+bool operator == (intrusive_object_ptr<T> const& a,
+                  intrusive_object_ptr<T1> const& b) noexcept {
+    return a.get() == b.get();
+}
+
+template <typename T, typename T1>
+bool operator != (intrusive_object_ptr<T> const& a,
+                  intrusive_object_ptr<T1> const& b) noexcept {
+    return a.get() != b.get();
+}
+
+/**
+ * Constructs object of type @a T in memory obtained from @a allocator.
+ * The allocator must outlive the object and must return memory suitably
+ * aligned for @a T. The object is returned to the same allocator when the
+ * last pointer owning it goes away.
+ */
+template <typename T, typename... TArgs>
+intrusive_object_ptr<T> allocate_intrusive_object(
+        core::memory::Allocator& allocator, TArgs&&... args) {
+
+    typedef ref_counted<typename T::ref_count_policy> BaseType;
+    static_assert(std::is_base_of<BaseType, T>::value,
+                  "object type must be derived from rvlm::ref_counted");
+
+    void* memory = allocator.allocate(sizeof(T));
+    T* object;
+    try {
+        object = ::new (memory) T(std::forward<TArgs>(args)...);
+    }
+    catch (...) {
+        allocator.deallocate(memory);
+        throw;
+    }
+
+    BaseType* base = object;
+    base->mAllocator = &allocator;
+    base->mDispose   = &BaseType::template dispose<T>;
+    return intrusive_object_ptr<T>(object);
+}
+
+/**
+ * @internal
+ * Allocator used by @c make_intrusive_object.
+ */
+inline core::memory::Allocator& default_intrusive_allocator() {
+    static core::memory::OperatorNewAllocator allocator;
+    return allocator;
+}
+
+template <typename T, typename... TArgs>
+intrusive_object_ptr<T> make_intrusive_object(TArgs&&... args) {
+    return allocate_intrusive_object<T>(default_intrusive_allocator(),
+                                        std::forward<TArgs>(args)...);
+}
+
+} // namespace rvlm
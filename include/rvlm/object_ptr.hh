@@ -48,7 +48,8 @@ private:
             throw std::bad_alloc();
     }
 
-    object_ptr(const std::shared_ptr<T>& p) {
+    object_ptr(const std::shared_ptr<T>& p)
+            : std::shared_ptr<T>(p) {
         check_not_null(p);
     }
 
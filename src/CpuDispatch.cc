@@ -0,0 +1,90 @@
+#include <cstdlib>
+#include <cstring>
+#include "rvlm/core/CpuDispatch.hh"
+#include "rvlm/core/Kernels.hh"
+
+namespace rvlm {
+namespace core {
+
+namespace detail {
+
+// Defined by Kernels*.cc. Tables hold only addresses of functions, so
+// they are initialized statically and may be used by constructors of
+// static objects elsewhere.
+extern const KernelTable genericKernels;
+#if defined(RVLM_CORE_X86_KERNELS)
+extern const KernelTable sse42Kernels;
+extern const KernelTable avx2Kernels;
+extern const KernelTable avx512Kernels;
+#endif
+
+} // namespace detail
+
+char const* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Sse42:  return "sse4.2";
+        case Isa::Avx2:   return "avx2";
+        case Isa::Avx512: return "avx512";
+        default:          return "generic";
+    }
+}
+
+bool parseIsa(char const* name, Isa& isa) {
+    const Isa all[] = { Isa::Generic, Isa::Sse42, Isa::Avx2, Isa::Avx512 };
+    for (std::size_t i = 0; i < sizeof(all)/sizeof(all[0]); ++i) {
+        if (std::strcmp(name, isaName(all[i])) == 0) {
+            isa = all[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+Isa detectIsa() {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    // Feature checks of the compiler runtime include operating system
+    // support for saving wide registers.
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+        __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq"))
+        return Isa::Avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return Isa::Avx2;
+    if (__builtin_cpu_supports("sse4.2"))
+        return Isa::Sse42;
+#endif
+    return Isa::Generic;
+}
+
+Isa activeIsa() {
+    static const Isa isa = kernelTable([] {
+        Isa detected = detectIsa(), requested;
+        char const* env = std::getenv("RVLM_ISA");
+        if (env && parseIsa(env, requested) && requested < detected)
+            return requested;
+        return detected;
+    }()).isa;
+    return isa;
+}
+
+KernelTable const& kernelTable(Isa isa) {
+#if defined(RVLM_CORE_X86_KERNELS)
+    switch (isa) {
+        case Isa::Avx512: return detail::avx512Kernels;
+        case Isa::Avx2:   return detail::avx2Kernels;
+        case Isa::Sse42:  return detail::sse42Kernels;
+        default:          break;
+    }
+#else
+    (void)isa;
+#endif
+    return detail::genericKernels;
+}
+
+KernelTable const& activeKernels() {
+    static KernelTable const& table = kernelTable(activeIsa());
+    return table;
+}
+
+} // namespace core
+} // namespace rvlm
@@ -0,0 +1,4 @@
+#define RVLM_CORE_KERNELS_NAMESPACE avx2
+#define RVLM_CORE_KERNELS_ISA       Avx2
+#define RVLM_CORE_KERNELS_TABLE     avx2Kernels
+#include "KernelsImpl.hh"
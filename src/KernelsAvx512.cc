@@ -0,0 +1,4 @@
+#define RVLM_CORE_KERNELS_NAMESPACE avx512
+#define RVLM_CORE_KERNELS_ISA       Avx512
+#define RVLM_CORE_KERNELS_TABLE     avx512Kernels
+#include "KernelsImpl.hh"
@@ -0,0 +1,4 @@
+#define RVLM_CORE_KERNELS_NAMESPACE generic
+#define RVLM_CORE_KERNELS_ISA       Generic
+#define RVLM_CORE_KERNELS_TABLE     genericKernels
+#include "KernelsImpl.hh"
@@ -0,0 +1,155 @@
+// Bodies of compiled kernels, included once by every Kernels*.cc file with
+// RVLM_CORE_KERNELS_NAMESPACE, RVLM_CORE_KERNELS_ISA and
+// RVLM_CORE_KERNELS_TABLE defined. Each file is compiled for its own
+// instruction set, and the compiler vectorizes the loops below for it.
+//
+// Everything here lives in a namespace of its own per instruction set and
+// calls nothing inline from other headers: an inline function compiled
+// with, say, AVX-512 in one file could otherwise be picked by the linker
+// for all files and run on processors lacking it.
+
+#include <cstddef>
+#include "rvlm/core/Kernels.hh"
+
+#if !defined(RVLM_CORE_KERNELS_NAMESPACE) || !defined(RVLM_CORE_KERNELS_ISA) || \
+    !defined(RVLM_CORE_KERNELS_TABLE)
+#error "kernel namespace, instruction set and table must be defined"
+#endif
+
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define RVLM_CORE_RESTRICT __restrict
+#else
+#define RVLM_CORE_RESTRICT
+#endif
+
+namespace rvlm {
+namespace core {
+namespace detail {
+namespace RVLM_CORE_KERNELS_NAMESPACE {
+
+// Reductions keep LANES independent partial results, so that the
+// compiler may put them into SIMD registers without reassociating
+// floating-point additions. Results do not depend on the instruction set.
+const std::size_t LANES = 16;
+
+template <typename T>
+void fill(T* RVLM_CORE_RESTRICT dst, std::size_t n, T value) {
+    for (std::size_t i = 0; i < n; ++i)
+        dst[i] = value;
+}
+
+template <typename T>
+double sum(T const* RVLM_CORE_RESTRICT src, std::size_t n) {
+    double acc[LANES] = {};
+    std::size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (std::size_t k = 0; k < LANES; ++k)
+            acc[k] += static_cast<double>(src[i + k]);
+    }
+    for (std::size_t k = 0; i < n; ++i, ++k)
+        acc[k] += static_cast<double>(src[i]);
+
+    double result = 0;
+    for (std::size_t k = 0; k < LANES; ++k)
+        result += acc[k];
+    return result;
+}
+
+template <typename T>
+double dot(T const* RVLM_CORE_RESTRICT a, T const* RVLM_CORE_RESTRICT b,
+           std::size_t n) {
+    double acc[LANES] = {};
+    std::size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (std::size_t k = 0; k < LANES; ++k)
+            acc[k] += static_cast<double>(a[i + k]) * static_cast<double>(b[i + k]);
+    }
+    for (std::size_t k = 0; i < n; ++i, ++k)
+        acc[k] += static_cast<double>(a[i]) * static_cast<double>(b[i]);
+
+    double result = 0;
+    for (std::size_t k = 0; k < LANES; ++k)
+        result += acc[k];
+    return result;
+}
+
+template <typename T>
+T maxAbs(T const* RVLM_CORE_RESTRICT src, std::size_t n) {
+    // Largest and smallest values are tracked instead of absolute ones,
+    // which compilers turn into plain SIMD max and min instructions.
+    T hi[LANES] = {}, lo[LANES] = {};
+    std::size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (std::size_t k = 0; k < LANES; ++k) {
+            hi[k] = hi[k] < src[i + k] ? src[i + k] : hi[k];
+            lo[k] = src[i + k] < lo[k] ? src[i + k] : lo[k];
+        }
+    }
+    for (std::size_t k = 0; i < n; ++i, ++k) {
+        hi[k] = hi[k] < src[i] ? src[i] : hi[k];
+        lo[k] = src[i] < lo[k] ? src[i] : lo[k];
+    }
+
+    T result = 0;
+    for (std::size_t k = 0; k < LANES; ++k) {
+        result = result < hi[k] ? hi[k] : result;
+        result = result < -lo[k] ? -lo[k] : result;
+    }
+    return result;
+}
+
+template <typename T>
+void curlUpdate(T* RVLM_CORE_RESTRICT dst, T const* RVLM_CORE_RESTRICT scale,
+                T const* RVLM_CORE_RESTRICT a, T const* RVLM_CORE_RESTRICT a0, T ca,
+                T const* RVLM_CORE_RESTRICT b, T const* RVLM_CORE_RESTRICT b0, T cb,
+                std::size_t n) {
+    if (scale == 0) {
+        for (std::size_t i = 0; i < n; ++i)
+            dst[i] += ca*(a[i] - a0[i]) - cb*(b[i] - b0[i]);
+        return;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+        dst[i] += scale[i] * (ca*(a[i] - a0[i]) - cb*(b[i] - b0[i]));
+}
+
+void widen(float const* RVLM_CORE_RESTRICT src, double* RVLM_CORE_RESTRICT dst,
+           std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        dst[i] = static_cast<double>(src[i]);
+}
+
+void narrow(double const* RVLM_CORE_RESTRICT src, float* RVLM_CORE_RESTRICT dst,
+            std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        dst[i] = static_cast<float>(src[i]);
+}
+
+} // namespace RVLM_CORE_KERNELS_NAMESPACE
+
+extern const KernelTable RVLM_CORE_KERNELS_TABLE;
+
+const KernelTable RVLM_CORE_KERNELS_TABLE = {
+    Isa::RVLM_CORE_KERNELS_ISA,
+    {
+        &RVLM_CORE_KERNELS_NAMESPACE::fill<float>,
+        &RVLM_CORE_KERNELS_NAMESPACE::sum<float>,
+        &RVLM_CORE_KERNELS_NAMESPACE::dot<float>,
+        &RVLM_CORE_KERNELS_NAMESPACE::maxAbs<float>,
+        &RVLM_CORE_KERNELS_NAMESPACE::curlUpdate<float>
+    },
+    {
+        &RVLM_CORE_KERNELS_NAMESPACE::fill<double>,
+        &RVLM_CORE_KERNELS_NAMESPACE::sum<double>,
+        &RVLM_CORE_KERNELS_NAMESPACE::dot<double>,
+        &RVLM_CORE_KERNELS_NAMESPACE::maxAbs<double>,
+        &RVLM_CORE_KERNELS_NAMESPACE::curlUpdate<double>
+    },
+    &RVLM_CORE_KERNELS_NAMESPACE::widen,
+    &RVLM_CORE_KERNELS_NAMESPACE::narrow
+};
+
+} // namespace detail
+} // namespace core
+} // namespace rvlm
+
+#undef RVLM_CORE_RESTRICT
@@ -0,0 +1,4 @@
+#define RVLM_CORE_KERNELS_NAMESPACE sse42
+#define RVLM_CORE_KERNELS_ISA       Sse42
+#define RVLM_CORE_KERNELS_TABLE     sse42Kernels
+#include "KernelsImpl.hh"
@@ -0,0 +1,278 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <utility>
+#include "rvlm/core/PerfCounters.hh"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace rvlm {
+namespace core {
+
+namespace {
+
+std::uint64_t nowNanos() {
+    return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * Counters of the calling thread, opened at its first scope as one group,
+ * so that all events are counted over the same intervals. Events which
+ * fail to open are left out of the group.
+ */
+class ThreadCounters: public NonAssignable {
+public:
+
+    ThreadCounters(): mLeader(-1), mCount(0) {
+        static std::atomic<unsigned> nextThread(0);
+        mThread = nextThread++;
+        for (std::size_t e = 0; e < PERF_EVENT_COUNT; ++e)
+            mSlot[e] = -1;
+        open();
+    }
+
+    ~ThreadCounters() {
+#if defined(__linux__)
+        for (std::size_t i = 0; i < mCount; ++i)
+            close(mFds[i]);
+#endif
+    }
+
+    unsigned thread() const { return mThread; }
+
+    bool isCounted(PerfEvent e) const { return mSlot[static_cast<int>(e)] >= 0; }
+
+    /**
+     * Reads running totals of all events, scaled up for the time the group
+     * was not scheduled on the processor; events not counted read 0.
+     */
+    void read(std::uint64_t values[PERF_EVENT_COUNT]) const {
+        for (std::size_t e = 0; e < PERF_EVENT_COUNT; ++e)
+            values[e] = 0;
+#if defined(__linux__)
+        if (mLeader < 0)
+            return;
+        std::uint64_t buffer[3 + PERF_EVENT_COUNT];
+        ssize_t size = ::read(mLeader, buffer, sizeof(buffer));
+        if (size < static_cast<ssize_t>(3 * sizeof(std::uint64_t)) || buffer[0] != mCount)
+            return;
+        const std::uint64_t enabled = buffer[1], running = buffer[2];
+        for (std::size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (mSlot[e] < 0)
+                continue;
+            std::uint64_t v = buffer[3 + mSlot[e]];
+            if (running > 0 && running < enabled)
+                v = static_cast<std::uint64_t>(static_cast<double>(v) * enabled / running);
+            values[e] = v;
+        }
+#endif
+    }
+
+private:
+
+    void open() {
+#if defined(__linux__)
+        const std::uint32_t types[PERF_EVENT_COUNT] = {
+            PERF_TYPE_HARDWARE,
+            PERF_TYPE_HARDWARE,
+            PERF_TYPE_HARDWARE,
+            PERF_TYPE_HW_CACHE
+        };
+        const std::uint64_t configs[PERF_EVENT_COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,   // last-level cache on common PMUs
+            PERF_COUNT_HW_CACHE_DTLB
+                | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+        };
+
+        for (std::size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP
+                             | PERF_FORMAT_TOTAL_TIME_ENABLED
+                             | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr,
+                                              0, -1, mLeader, 0));
+            if (fd < 0)
+                continue;
+            if (mLeader < 0)
+                mLeader = fd;
+            mSlot[e] = static_cast<int>(mCount);
+            mFds[mCount++] = fd;
+        }
+#endif
+    }
+
+    int         mLeader;
+    int         mFds[PERF_EVENT_COUNT];
+    int         mSlot[PERF_EVENT_COUNT];
+    std::size_t mCount;
+    unsigned    mThread;
+};
+
+ThreadCounters& threadCounters() {
+    static thread_local ThreadCounters counters;
+    return counters;
+}
+
+struct Registry {
+    std::mutex mutex;
+    std::map<std::pair<std::string, unsigned>, PerfRegionStats> regions;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+std::string formatCount(bool counted, double value) {
+    if (!counted)
+        return "-";
+    std::ostringstream s;
+    s << std::setprecision(3) << value;
+    return s.str();
+}
+
+} // namespace
+
+double PerfRegionStats::gigabytesPerSecond() const {
+    return seconds > 0 ? work.bytes / seconds * 1e-9 : 0;
+}
+
+double PerfRegionStats::cellsPerSecond() const {
+    return seconds > 0 ? work.cells / seconds : 0;
+}
+
+double PerfRegionStats::arithmeticIntensity() const {
+    return work.bytes > 0 ? static_cast<double>(work.flops) / work.bytes : 0;
+}
+
+double PerfRegionStats::instructionsPerCycle() const {
+    if (!hasEvent(PerfEvent::Cycles) || !hasEvent(PerfEvent::Instructions) ||
+        event(PerfEvent::Cycles) == 0)
+        return 0;
+    return static_cast<double>(event(PerfEvent::Instructions)) / event(PerfEvent::Cycles);
+}
+
+double PerfRegionStats::missGigabytesPerSecond() const {
+    const double LINE = 64;
+    if (!hasEvent(PerfEvent::LlcMisses) || seconds <= 0)
+        return 0;
+    return event(PerfEvent::LlcMisses) * LINE / seconds * 1e-9;
+}
+
+PerfScope::PerfScope(char const* name, PerfWork const& work)
+        : mName(name), mWork(work) {
+    threadCounters().read(mStart);
+    mStartNanos = nowNanos();
+}
+
+PerfScope::~PerfScope() {
+    const std::uint64_t stopNanos = nowNanos();
+    ThreadCounters& counters = threadCounters();
+    std::uint64_t stop[PERF_EVENT_COUNT];
+    counters.read(stop);
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::pair<std::string, unsigned> key(mName, counters.thread());
+    std::map<std::pair<std::string, unsigned>, PerfRegionStats>::iterator it =
+            r.regions.find(key);
+    if (it == r.regions.end()) {
+        PerfRegionStats s;
+        s.region = mName;
+        s.thread = counters.thread();
+        s.calls = 0;
+        s.seconds = 0;
+        for (std::size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+            s.events[e] = 0;
+            s.counted[e] = counters.isCounted(static_cast<PerfEvent>(e));
+        }
+        it = r.regions.insert(std::make_pair(key, s)).first;
+    }
+
+    PerfRegionStats& s = it->second;
+    ++s.calls;
+    s.seconds += (stopNanos - mStartNanos) * 1e-9;
+    s.work += mWork;
+    for (std::size_t e = 0; e < PERF_EVENT_COUNT; ++e)
+        s.events[e] += stop[e] >= mStart[e] ? stop[e] - mStart[e] : 0;
+}
+
+bool PerfScope::isCounted(PerfEvent event) {
+    return threadCounters().isCounted(event);
+}
+
+std::vector<PerfRegionStats> perfSnapshot() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<PerfRegionStats> result;
+    for (std::map<std::pair<std::string, unsigned>, PerfRegionStats>::const_iterator
+            it = r.regions.begin(); it != r.regions.end(); ++it)
+        result.push_back(it->second);
+    return result;
+}
+
+void perfReset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.regions.clear();
+}
+
+void perfReport(std::ostream& out) {
+    std::vector<PerfRegionStats> stats = perfSnapshot();
+    out << std::left << std::setw(20) << "region" << std::right
+        << std::setw(7)  << "thread"
+        << std::setw(8)  << "calls"
+        << std::setw(11) << "seconds"
+        << std::setw(11) << "GB/s"
+        << std::setw(11) << "Mcells/s"
+        << std::setw(10) << "flop/B"
+        << std::setw(11) << "cycles"
+        << std::setw(7)  << "IPC"
+        << std::setw(11) << "LLC miss"
+        << std::setw(11) << "miss GB/s"
+        << std::setw(11) << "dTLB miss" << '\n';
+    for (std::size_t i = 0; i < stats.size(); ++i) {
+        PerfRegionStats const& s = stats[i];
+        const bool cycles = s.hasEvent(PerfEvent::Cycles);
+        const bool ipc = cycles && s.hasEvent(PerfEvent::Instructions);
+        const bool llc = s.hasEvent(PerfEvent::LlcMisses);
+        const bool tlb = s.hasEvent(PerfEvent::DtlbMisses);
+        out << std::left << std::setw(20) << s.region << std::right
+            << std::setw(7)  << s.thread
+            << std::setw(8)  << s.calls
+            << std::setw(11) << formatCount(true, s.seconds)
+            << std::setw(11) << formatCount(true, s.gigabytesPerSecond())
+            << std::setw(11) << formatCount(true, s.cellsPerSecond() * 1e-6)
+            << std::setw(10) << formatCount(true, s.arithmeticIntensity())
+            << std::setw(11) << formatCount(cycles, double(s.event(PerfEvent::Cycles)))
+            << std::setw(7)  << formatCount(ipc, s.instructionsPerCycle())
+            << std::setw(11) << formatCount(llc, double(s.event(PerfEvent::LlcMisses)))
+            << std::setw(11) << formatCount(llc, s.missGigabytesPerSecond())
+            << std::setw(11) << formatCount(tlb, double(s.event(PerfEvent::DtlbMisses)))
+            << '\n';
+    }
+}
+
+} // namespace core
+} // namespace rvlm
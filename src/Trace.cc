@@ -0,0 +1,253 @@
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "rvlm/core/Trace.hh"
+
+namespace rvlm {
+namespace core {
+
+namespace detail {
+
+std::atomic<bool> traceEnabled(false);
+
+namespace {
+
+/**
+ * Buffers of all threads which recorded events, with their names.
+ */
+struct TraceRegistry {
+    std::mutex                                 mutex;
+    std::vector<std::unique_ptr<TraceBuffer> > buffers;
+    std::map<unsigned, std::string>            names;
+    unsigned                                   nextThread;
+    bool                                       sessionRunning;
+
+    TraceRegistry(): nextThread(0), sessionRunning(false) {}
+};
+
+TraceRegistry& traceRegistry() {
+    static TraceRegistry registry;
+    return registry;
+}
+
+std::int64_t steadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void writeString(std::ostream& out, char const* s) {
+    out << '"';
+    for (; *s; ++s) {
+        const unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\')
+            out << '\\' << *s;
+        else if (c < 0x20)
+            out << "\\u00" << std::hex << std::setw(2) << std::setfill('0')
+                << static_cast<unsigned>(c) << std::dec << std::setfill(' ');
+        else
+            out << *s;
+    }
+    out << '"';
+}
+
+} // namespace
+
+TraceBuffer* registerTraceThread() {
+    TraceRegistry& r = traceRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.buffers.push_back(std::unique_ptr<TraceBuffer>(new TraceBuffer(r.nextThread++)));
+    return r.buffers.back().get();
+}
+
+} // namespace detail
+
+void traceThreadName(std::string const& name) {
+    detail::TraceBuffer* buffer = detail::traceBuffer();
+    detail::TraceRegistry& r = detail::traceRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.names[buffer->getThread()] = name;
+}
+
+/**
+ * Output file and flusher thread of a session. Ticks are mapped to time
+ * piecewise linearly, between pairs of tick and steady clock readings
+ * taken at consecutive flushes.
+ */
+class TraceSession::Writer {
+public:
+
+    Writer(std::string const& path, unsigned flushMillis)
+            : mFirst(true), mEventCount(0), mDroppedCount(0), mStopping(false) {
+        detail::TraceRegistry& r = detail::traceRegistry();
+        {
+            // The file is opened, and truncated, only once no other session
+            // is known to be writing, possibly to the same file.
+            std::lock_guard<std::mutex> lock(r.mutex);
+            if (r.sessionRunning)
+                throw std::logic_error("trace session is already running");
+            mOut.open(path.c_str());
+            if (!mOut)
+                throw std::runtime_error("cannot write trace file " + path);
+
+            // Leftovers of earlier sessions would have no time reference.
+            for (std::size_t i = 0; i < r.buffers.size(); ++i) {
+                r.buffers[i]->drain([](TraceEvent const&) {});
+                r.buffers[i]->takeDropped();
+            }
+            r.sessionRunning = true;
+        }
+
+        mOut << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        mLastTicks = detail::traceTicks();
+        mLastNanos = mStartNanos = detail::steadyNanos();
+        mNanosPerTick = 0;
+        detail::traceEnabled.store(true);
+
+        mFlusher = std::thread([this, flushMillis] {
+            std::unique_lock<std::mutex> lock(mStopMutex);
+            while (!mStopping) {
+                mStopCondition.wait_for(lock, std::chrono::milliseconds(flushMillis));
+                lock.unlock();
+                flush();
+                lock.lock();
+            }
+        });
+    }
+
+    ~Writer() {
+        detail::traceEnabled.store(false);
+        {
+            std::lock_guard<std::mutex> lock(mStopMutex);
+            mStopping = true;
+        }
+        mStopCondition.notify_all();
+        mFlusher.join();
+        flush();
+        mOut << "\n]}\n";
+        mOut.close();
+
+        detail::TraceRegistry& r = detail::traceRegistry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.sessionRunning = false;
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> writeLock(mWriteMutex);
+        const std::uint64_t ticks = detail::traceTicks();
+        const std::int64_t nanos = detail::steadyNanos();
+        if (ticks > mLastTicks && nanos > mLastNanos)
+            mNanosPerTick = double(nanos - mLastNanos) / double(ticks - mLastTicks);
+        else if (mNanosPerTick == 0)
+            mNanosPerTick = 1;
+
+        detail::TraceRegistry& r = detail::traceRegistry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (std::map<unsigned, std::string>::const_iterator it = r.names.begin();
+                it != r.names.end(); ++it) {
+            std::string& written = mWrittenNames[it->first];
+            if (written != it->second) {
+                writeThreadName(it->first, it->second);
+                written = it->second;
+            }
+        }
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < r.buffers.size(); ++i) {
+            detail::TraceBuffer& buffer = *r.buffers[i];
+            const bool exited = buffer.hasExited();
+            const unsigned thread = buffer.getThread();
+            mEventCount += buffer.drain([this, thread](TraceEvent const& e) {
+                writeEvent(thread, e);
+            });
+            mDroppedCount += buffer.takeDropped();
+            if (exited)
+                r.buffers[i].reset();
+            else
+                r.buffers[kept++].swap(r.buffers[i]);
+        }
+        r.buffers.resize(kept);
+        mOut.flush();
+
+        mLastTicks = ticks;
+        mLastNanos = nanos;
+    }
+
+    std::size_t getEventCount() const { return mEventCount; }
+
+    std::size_t getDroppedCount() const { return mDroppedCount; }
+
+private:
+
+    void separate() {
+        mOut << (mFirst ? "\n" : ",\n");
+        mFirst = false;
+    }
+
+    void writeThreadName(unsigned thread, std::string const& name) {
+        separate();
+        mOut << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+             << ",\"args\":{\"name\":";
+        detail::writeString(mOut, name.c_str());
+        mOut << "}}";
+    }
+
+    void writeEvent(unsigned thread, TraceEvent const& e) {
+        static char const* const PHASES[] = { "B", "E", "i", "C" };
+        const double nanos = mLastNanos - mStartNanos
+                + (double(e.ticks) - double(mLastTicks)) * mNanosPerTick;
+        separate();
+        mOut << "{\"name\":";
+        detail::writeString(mOut, e.name);
+        mOut << ",\"ph\":\"" << PHASES[static_cast<int>(e.phase)] << '"'
+             << ",\"ts\":" << std::fixed << std::setprecision(3) << nanos * 1e-3
+             << ",\"pid\":1,\"tid\":" << thread;
+        if (e.phase == TracePhase::Instant)
+            mOut << ",\"s\":\"t\"";
+        if (e.phase == TracePhase::Counter ||
+            (e.phase == TracePhase::Begin && e.value != 0))
+            mOut << ",\"args\":{\"value\":" << e.value << '}';
+        mOut << '}';
+    }
+
+    std::ofstream                   mOut;
+    bool                            mFirst;
+    std::atomic<std::size_t>        mEventCount;
+    std::atomic<std::size_t>        mDroppedCount;
+    std::int64_t                    mStartNanos;
+    std::int64_t                    mLastNanos;
+    std::uint64_t                   mLastTicks;
+    double                          mNanosPerTick;
+    std::map<unsigned, std::string> mWrittenNames;
+    std::mutex                      mWriteMutex;
+
+    std::thread                     mFlusher;
+    std::mutex                      mStopMutex;
+    std::condition_variable         mStopCondition;
+    bool                            mStopping;
+};
+
+TraceSession::TraceSession(std::string const& path, unsigned flushMillis)
+        : mWriter(new Writer(path, flushMillis)) {}
+
+TraceSession::~TraceSession() {}
+
+void TraceSession::flush() {
+    mWriter->flush();
+}
+
+std::size_t TraceSession::getEventCount() const {
+    return mWriter->getEventCount();
+}
+
+std::size_t TraceSession::getDroppedCount() const {
+    return mWriter->getDroppedCount();
+}
+
+} // namespace core
+} // namespace rvlm
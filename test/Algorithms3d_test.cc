@@ -0,0 +1,102 @@
+#include <catch.hpp>
+#include "rvlm/core/Algorithms3d.hh"
+#include "rvlm/core/Vector3d.hh"
+using rvlm::core::BitArray3d;
+using rvlm::core::CellReference;
+using rvlm::core::Execution;
+using rvlm::core::HalfOpenRange;
+using rvlm::core::IndexBox;
+using rvlm::core::IsTraversable3d;
+using rvlm::core::SolidArray3d;
+using rvlm::core::Vector3d;
+namespace algo = rvlm::core;
+
+static_assert(IsTraversable3d<SolidArray3d<double>>::value, "");
+static_assert(IsTraversable3d<SolidArray3d<float, int>>::value, "");
+static_assert(IsTraversable3d<BitArray3d<>>::value, "");
+static_assert(!IsTraversable3d<Vector3d<double>>::value, "");
+
+namespace {
+
+typedef SolidArray3d<double, int> Array;
+typedef HalfOpenRange<int> Range;
+
+void enumerate(Array& a) {
+    for (int ix = a.getBeginX(); ix < a.getEndX(); ++ix)
+    for (int iy = a.getBeginY(); iy < a.getEndY(); ++iy)
+    for (int iz = a.getBeginZ(); iz < a.getEndZ(); ++iz)
+        a.at(ix, iy, iz) = 100*ix + 10*iy + iz;
+}
+
+} // namespace
+
+TEST_CASE("Fill and forEach visit exactly the box", "rvlm::core::Algorithms3d") {
+    Array a(Range(-2, 5), Range(0, 4), Range(3, 9), 0.0);
+    IndexBox<> box(-1, 3, 1, 3, 4, 8);
+
+    algo::fill(a, box, 1.0);
+    double sum = 0;
+    algo::forEach(a, a.getBox(), [&sum](double v) { sum += v; });
+    REQUIRE(sum == box.count());
+
+    for (int ix = -2; ix < 5; ++ix)
+    for (int iy = 0; iy < 4; ++iy)
+    for (int iz = 3; iz < 9; ++iz)
+        REQUIRE(a.at(ix, iy, iz) == (box.contains(ix, iy, iz) ? 1.0 : 0.0));
+
+    algo::forEach(a, box, [](double& v) { v *= 3; }, Execution::Parallel);
+    sum = 0;
+    algo::forEach(a, a.getBox(), [&sum](double v) { sum += v; });
+    REQUIRE(sum == 3*box.count());
+}
+
+TEST_CASE("Copy and transform use global coordinates", "rvlm::core::Algorithms3d") {
+    Array src(Range(0, 6), Range(0, 6), Range(0, 6), 0.0);
+    Array dst(Range(3, 9), Range(-2, 4), Range(1, 5), -1.0);
+    enumerate(src);
+
+    IndexBox<> common = src.getBox().intersect(dst.getBox());
+    algo::copy(src, dst, common, Execution::Parallel);
+    for (int ix = 3; ix < 9; ++ix)
+    for (int iy = -2; iy < 4; ++iy)
+    for (int iz = 1; iz < 5; ++iz) {
+        double expected = common.contains(ix, iy, iz) ? src.at(ix, iy, iz) : -1.0;
+        REQUIRE(dst.at(ix, iy, iz) == expected);
+    }
+
+    algo::transform(src, src, src.getBox(), [](double v) { return -2*v; });
+    REQUIRE(src.at(5, 4, 3) == -2*543);
+
+    REQUIRE_THROWS_AS(algo::copy(src, dst, src.getBox()), std::out_of_range);
+}
+
+TEST_CASE("Zip combines value and bit arrays", "rvlm::core::Algorithms3d") {
+    Array a(Range(0, 5), Range(0, 4), Range(0, 70), 0.0);
+    Array b(Range(0, 5), Range(0, 4), Range(0, 70), 0.0);
+    BitArray3d<int> mask(Range(0, 5), Range(0, 4), Range(0, 70), false);
+    enumerate(a);
+
+    // Mark cells with odd values, then double them in b.
+    algo::zip(Execution::Parallel, a.getBox(),
+        [](CellReference<BitArray3d<int>> m, double v) {
+            m = static_cast<long>(v) % 2 != 0;
+        }, mask, a);
+    REQUIRE(mask.count() == 5*4*35);
+
+    BitArray3d<int> const& cmask = mask;
+    algo::zip(a.getBox(), [](double& out, double v, bool m) {
+            out = m ? 2*v : 0;
+        }, b, a, cmask);
+
+    for (int ix = 0; ix < 5; ++ix)
+    for (int iy = 0; iy < 4; ++iy)
+    for (int iz = 0; iz < 70; ++iz) {
+        double v = a.at(ix, iy, iz);
+        REQUIRE(b.at(ix, iy, iz) == (iz % 2 ? 2*v : 0));
+    }
+
+    BitArray3d<int> copied(Range(0, 5), Range(0, 4), Range(0, 70), true);
+    algo::copy(cmask, copied, mask.getBox());
+    copied ^= mask;
+    REQUIRE(copied.count() == 0);
+}
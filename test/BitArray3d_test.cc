@@ -0,0 +1,89 @@
+#include <catch.hpp>
+#include <vector>
+#include "rvlm/core/BitArray3d.hh"
+using rvlm::core::BitArray3d;
+using rvlm::core::HalfOpenRange;
+
+TEST_CASE("Bit arrays work", "rvlm::core::BitArray3d") {
+
+    // Z count is not a multiple of word size, so padding is exercised.
+    typedef BitArray3d<int> Mask;
+    typedef HalfOpenRange<int> Range;
+    Mask mask(Range(-1, 3), Range(0, 2), Range(10, 140), false);
+
+    SECTION("Geometry and single items") {
+        REQUIRE(mask.getEndX() == 3);
+        REQUIRE(mask.getCountZ() == 130);
+        REQUIRE(mask.getRowWordCount() == 3);
+        REQUIRE(mask.count() == 0);
+
+        mask.set(-1, 1, 139, true);
+        mask.set(2, 0, 10, true);
+        REQUIRE(mask.at(-1, 1, 139));
+        REQUIRE(mask.at(2, 0, 10));
+        REQUIRE(!mask.at(2, 0, 11));
+        REQUIRE(mask.count() == 2);
+        REQUIRE_THROWS(mask.at(3, 0, 10));
+        REQUIRE_THROWS(mask.at(0, 0, 140));
+
+        auto cursor = mask.getCursor(2, 0, 9 + 1);
+        mask.cursorMoveToPrevX(cursor);
+        mask.cursorMoveToNext<0>(cursor);
+        REQUIRE(mask.at(cursor));
+        int ix, iy, iz;
+        mask.cursorCoordinates(cursor, ix, iy, iz);
+        REQUIRE(ix == 2);
+        REQUIRE(iy == 0);
+        REQUIRE(iz == 10);
+    }
+
+    SECTION("Filling, inversion and bulk operations") {
+        mask.fill(true);
+        REQUIRE(mask.count() == 4*2*130);
+        mask.invert();
+        REQUIRE(mask.count() == 0);
+
+        Mask other(Range(-1, 3), Range(0, 2), Range(10, 140), true);
+        mask.set(0, 0, 50, true);
+        mask |= other;
+        REQUIRE(mask.count() == 4*2*130);
+        mask -= other;
+        REQUIRE(mask.count() == 0);
+
+        Mask wrong(4, 2, 131, false);
+        REQUIRE_THROWS_AS(mask &= wrong, std::invalid_argument);
+    }
+
+    SECTION("Counting and runs within boxes") {
+        for (int iz = 60; iz < 75; ++iz)
+            mask.set(0, 1, iz, true);
+        for (int iz = 100; iz < 140; ++iz)
+            mask.set(1, 0, iz, true);
+        mask.set(2, 1, 10, true);
+
+        REQUIRE(mask.count(Range(-10, 10), Range(-10, 10), Range(0, 200)) == 56);
+        REQUIRE(mask.count(Range(0, 1), Range(1, 2), Range(65, 70)) == 5);
+        REQUIRE(mask.count(Range(1, 2), Range(0, 1), Range(73, 139)) == 39);
+
+        std::vector<Mask::Run> runs(mask.runs().begin(), mask.runs().end());
+        REQUIRE(runs.size() == 3);
+        REQUIRE(runs[0].ix == 0);
+        REQUIRE(runs[0].iy == 1);
+        REQUIRE(runs[0].startZ == 60);
+        REQUIRE(runs[0].stopZ == 75);
+        REQUIRE(runs[1].startZ == 100);
+        REQUIRE(runs[1].stopZ == 140);
+        REQUIRE(runs[2].ix == 2);
+        REQUIRE(runs[2].stopZ == 11);
+
+        int runCount = 0;
+        for (auto const& run: mask.runs(Range(0, 2), Range(0, 2), Range(70, 120))) {
+            REQUIRE(run.startZ >= 70);
+            REQUIRE(run.stopZ <= 120);
+            ++runCount;
+        }
+        REQUIRE(runCount == 2);
+        REQUIRE(mask.runs(Range(5, 6), Range(0, 2), Range(0, 200)).begin() ==
+                mask.runs(Range(5, 6), Range(0, 2), Range(0, 200)).end());
+    }
+}
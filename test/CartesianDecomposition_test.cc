@@ -0,0 +1,120 @@
+#include <catch.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/CartesianDecomposition.hh"
+using rvlm::core::CartesianDecomposition;
+using rvlm::core::Subdomain;
+typedef CartesianDecomposition::Box Box;
+
+TEST_CASE("Decomposition covers global box exactly once", "rvlm::core::CartesianDecomposition") {
+    Box global(-3, 14, 2, 9, 0, 23);
+    for (int p = 1; p <= 12; ++p) {
+        CartesianDecomposition dec(global, p);
+        REQUIRE(dec.getProcessCount() == p);
+
+        std::vector<int> owner(static_cast<std::size_t>(global.count()), 0);
+        for (int rank = 0; rank < p; ++rank) {
+            Box box = dec.ownedBox(rank);
+            REQUIRE(!box.empty());
+            REQUIRE(global.contains(box));
+            for (std::ptrdiff_t ix = box.start[0]; ix < box.stop[0]; ++ix)
+            for (std::ptrdiff_t iy = box.start[1]; iy < box.stop[1]; ++iy)
+            for (std::ptrdiff_t iz = box.start[2]; iz < box.stop[2]; ++iz) {
+                std::ptrdiff_t n = ((ix - global.start[0])*global.size(1) +
+                                    (iy - global.start[1]))*global.size(2) +
+                                    (iz - global.start[2]);
+                owner[static_cast<std::size_t>(n)]++;
+            }
+        }
+        for (int count : owner)
+            REQUIRE(count == 1);
+    }
+}
+
+TEST_CASE("Decomposition prefers cuts across short axes", "rvlm::core::CartesianDecomposition") {
+    CartesianDecomposition slabs(Box(0, 8, 0, 8, 0, 1000), 4);
+    REQUIRE(slabs.getDim(0) == 1);
+    REQUIRE(slabs.getDim(1) == 1);
+    REQUIRE(slabs.getDim(2) == 4);
+
+    CartesianDecomposition cube(Box(0, 64, 0, 64, 0, 64), 8);
+    REQUIRE(cube.getDim(0) == 2);
+    REQUIRE(cube.getDim(1) == 2);
+    REQUIRE(cube.getDim(2) == 2);
+
+    REQUIRE_THROWS_AS(CartesianDecomposition(Box(0, 2, 0, 2, 0, 1), 5),
+                      std::invalid_argument);
+}
+
+TEST_CASE("Decomposition neighbours are symmetric", "rvlm::core::CartesianDecomposition") {
+    const int dims[3] = { 3, 2, 2 };
+    CartesianDecomposition dec(Box(0, 9, 0, 6, 0, 5), dims);
+    for (int rank = 0; rank < dec.getProcessCount(); ++rank) {
+        int coords[3];
+        dec.coordsOf(rank, coords);
+        REQUIRE(dec.rankOf(coords) == rank);
+        for (int axis = 0; axis < 3; ++axis) {
+            int next = dec.neighbor(rank, axis, +1);
+            REQUIRE((next < 0) == (coords[axis] == dims[axis] - 1));
+            if (next >= 0) {
+                REQUIRE(dec.neighbor(next, axis, -1) == rank);
+                REQUIRE(dec.ownedBox(rank).stop[axis] ==
+                        dec.ownedBox(next).start[axis]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Subdomain splits owned box into interior and boundary", "rvlm::core::Subdomain") {
+    const int dims[3] = { 3, 1, 2 };
+    CartesianDecomposition dec(Box(0, 12, 0, 5, 0, 7), dims);
+    for (int halo = 0; halo <= 2; ++halo)
+    for (int rank = 0; rank < dec.getProcessCount(); ++rank) {
+        Subdomain<float> sub(dec, rank, halo, 0.0f);
+        Box owned = sub.getOwnedBox();
+        REQUIRE(sub.getArray().getBox() ==
+                Box(owned.start[0] - halo, owned.stop[0] + halo,
+                    owned.start[1] - halo, owned.stop[1] + halo,
+                    owned.start[2] - halo, owned.stop[2] + halo));
+
+        std::vector<Box> parts = sub.getBoundaryBoxes();
+        parts.push_back(sub.getInteriorBox());
+        std::ptrdiff_t total = 0;
+        for (std::size_t i = 0; i < parts.size(); ++i) {
+            REQUIRE(owned.contains(parts[i]));
+            for (std::size_t j = 0; j < i; ++j)
+                REQUIRE(!parts[i].overlaps(parts[j]));
+            total += parts[i].empty() ? 0 : parts[i].count();
+        }
+        REQUIRE(total == owned.count());
+
+        // Cells of the interior are at least 'halo' cells from shared faces.
+        Box interior = sub.getInteriorBox();
+        if (!interior.empty()) {
+            for (int axis = 0; axis < 3; ++axis) {
+                if (dec.neighbor(rank, axis, -1) >= 0)
+                    REQUIRE(interior.start[axis] - owned.start[axis] >= halo);
+                if (dec.neighbor(rank, axis, +1) >= 0)
+                    REQUIRE(owned.stop[axis] - interior.stop[axis] >= halo);
+            }
+        }
+    }
+}
+
+TEST_CASE("Subdomain rejects negative halo before allocating", "rvlm::core::Subdomain") {
+    CartesianDecomposition dec(Box(0, 40, 0, 40, 0, 40), 8);
+    REQUIRE_THROWS_AS(Subdomain<float>(dec, 0, -1), std::invalid_argument);
+    REQUIRE_THROWS_AS(Subdomain<float>(dec, 0, -30), std::invalid_argument);
+}
+
+TEST_CASE("Decomposition knows its thinnest subdomain", "rvlm::core::CartesianDecomposition") {
+    const int dims[3] = { 3, 4, 1 };
+    CartesianDecomposition dec(Box(0, 10, -3, 8, 0, 5), dims);
+    for (int axis = 0; axis < 3; ++axis) {
+        std::ptrdiff_t thinnest = dec.getGlobalBox().size(axis);
+        for (int rank = 0; rank < dec.getProcessCount(); ++rank)
+            thinnest = std::min(thinnest, dec.ownedBox(rank).size(axis));
+        REQUIRE(dec.minOwnedSize(axis) == thinnest);
+    }
+}
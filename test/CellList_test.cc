@@ -0,0 +1,108 @@
+#include <catch.hpp>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/CellList.hh"
+using rvlm::core::BitArray3d;
+using rvlm::core::CellList;
+using rvlm::core::Execution;
+using rvlm::core::HalfOpenRange;
+using rvlm::core::SolidArray3d;
+using rvlm::core::updateCells;
+namespace core = rvlm::core;
+
+namespace {
+
+typedef HalfOpenRange<int> Range;
+typedef BitArray3d<int> Mask;
+typedef SolidArray3d<double, int> Array;
+
+double valueAt(int ix, int iy, int iz) {
+    return 100.0*ix + 10.0*iy + iz;
+}
+
+} // namespace
+
+TEST_CASE("CellList lists set cells of a mask in memory order", "rvlm::core::CellList") {
+    // Rows longer than a word check offsets past the first word.
+    Mask mask(Range(-2, 5), Range(1, 4), Range(3, 140), false);
+    Array array(Range(-2, 5), Range(1, 4), Range(3, 140), 0.0);
+    std::mt19937 rng(5);
+    std::bernoulli_distribution pick(0.1);
+    std::size_t expected = 0;
+    for (int ix = -2; ix < 5; ++ix)
+    for (int iy = 1; iy < 4; ++iy)
+    for (int iz = 3; iz < 140; ++iz) {
+        array.at(ix, iy, iz) = valueAt(ix, iy, iz);
+        if (pick(rng)) {
+            mask.set(ix, iy, iz, true);
+            ++expected;
+        }
+    }
+
+    CellList<double, 2> cells(mask, 0.5);
+    REQUIRE(cells.size() == expected);
+    REQUIRE(cells.getBox() == array.getBox());
+    for (std::size_t i = 1; i < cells.size(); ++i)
+        REQUIRE(cells.getOffsets()[i - 1] < cells.getOffsets()[i]);
+
+    std::size_t i = 0;
+    for (int ix = -2; ix < 5; ++ix)
+    for (int iy = 1; iy < 4; ++iy)
+    for (int iz = 3; iz < 140; ++iz) {
+        if (mask.at(ix, iy, iz)) {
+            REQUIRE(cells.getOffsets()[i] == array.getOffset(ix, iy, iz));
+            REQUIRE(cells.find(ix, iy, iz) == i);
+            ++i;
+        } else {
+            REQUIRE(cells.find(ix, iy, iz) == cells.size());
+        }
+    }
+    REQUIRE(cells.find(5, 1, 3) == cells.size());
+    REQUIRE(cells.getState(0)[0] == 0.5);
+    REQUIRE(cells.getState(1)[cells.size() - 1] == 0.5);
+
+    std::vector<double> values(cells.size());
+    core::gather(array, cells.getOffsets(), cells.size(), values.data());
+    for (std::size_t k = 0; k < cells.size(); ++k)
+        REQUIRE(values[k] == array.getOrigin()[cells.getOffsets()[k]]);
+}
+
+TEST_CASE("updateCells gathers, updates and scatters back", "rvlm::core::CellList") {
+    Mask mask(Range(0, 8), Range(0, 8), Range(0, 700), false);
+    for (int ix = 0; ix < 8; ++ix)
+    for (int iz = ix; iz < 700; iz += 3)
+        mask.set(ix, ix, iz, true);
+
+    Array e(Range(0, 8), Range(0, 8), Range(0, 700), 1.0);
+    Array h(Range(0, 8), Range(0, 8), Range(0, 700), 2.0);
+    CellList<double, 2> cells(mask);
+    REQUIRE(cells.size() > core::detail::CELL_BLOCK);
+
+    // Polarization p driven by e, with its previous value kept as history.
+    for (int step = 0; step < 2; ++step) {
+        updateCells(step == 0 ? Execution::Sequential : Execution::Parallel,
+                    cells, [](double& ev, double hv, double& p, double& prev) {
+                        prev = p;
+                        p = 0.5*p + ev + hv;
+                        ev -= p;
+                    }, e, h);
+    }
+
+    for (int ix = 0; ix < 8; ++ix)
+    for (int iz = 0; iz < 700; ++iz) {
+        if (mask.at(ix, ix, iz)) {
+            std::size_t i = cells.find(ix, ix, iz);
+            REQUIRE(cells.getState(1)[i] == 3.0);
+            REQUIRE(cells.getState(0)[i] == 0.5*3.0 + (1.0 - 3.0) + 2.0);
+            REQUIRE(e.at(ix, ix, iz) == -2.0 - 1.5);
+        } else {
+            REQUIRE(e.at(ix, ix, iz) == 1.0);
+        }
+    }
+    REQUIRE(h.at(3, 3, 3) == 2.0);
+
+    Array other(Range(0, 8), Range(0, 8), Range(0, 699), 0.0);
+    REQUIRE_THROWS_AS(updateCells(cells, [](double&, double&, double&) {}, other),
+                      std::invalid_argument);
+}
@@ -0,0 +1,123 @@
+#include <catch.hpp>
+#include <random>
+#include <vector>
+#include "rvlm/core/CellOffsets.hh"
+using rvlm::core::CellOffsets;
+using rvlm::core::HalfOpenRange;
+using rvlm::core::SolidArray3d;
+namespace core = rvlm::core;
+
+namespace {
+
+typedef SolidArray3d<double, int> Array;
+
+void fillCoordinates(std::vector<int>& ix, std::vector<int>& iy,
+                     std::vector<int>& iz, std::size_t count) {
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> dx(-2, 6), dy(3, 9), dz(0, 10);
+    for (std::size_t i = 0; i < count; ++i) {
+        ix.push_back(dx(rng));
+        iy.push_back(dy(rng));
+        iz.push_back(dz(rng));
+    }
+}
+
+double valueAt(int ix, int iy, int iz) {
+    return 100.0*ix + 10.0*iy + iz;
+}
+
+} // namespace
+
+TEST_CASE("Cell offsets match array storage", "rvlm::core::CellOffsets") {
+    Array a(HalfOpenRange<int>(-2, 7), HalfOpenRange<int>(3, 10),
+            HalfOpenRange<int>(0, 11), 0.0);
+    std::vector<int> ix, iy, iz;
+    fillCoordinates(ix, iy, iz, 101);
+
+    CellOffsets offsets(a, ix.data(), iy.data(), iz.data(), ix.size());
+    REQUIRE(offsets.size() == ix.size());
+    for (std::size_t i = 0; i < offsets.size(); ++i)
+        REQUIRE(offsets[i] == a.getOffset(ix[i], iy[i], iz[i]));
+
+    REQUIRE_THROWS_AS(offsets.push(7, 3, 0), std::out_of_range);
+    REQUIRE_THROWS_AS(offsets.push(-2, 3, -1), std::out_of_range);
+    REQUIRE(offsets.size() == ix.size());
+}
+
+TEST_CASE("Batched gather and scatter agree with item access", "rvlm::core::CellOffsets") {
+    Array a(HalfOpenRange<int>(-2, 7), HalfOpenRange<int>(3, 10),
+            HalfOpenRange<int>(0, 11), 0.0);
+    for (int ix = -2; ix < 7; ++ix)
+    for (int iy = 3; iy < 10; ++iy)
+    for (int iz = 0; iz < 11; ++iz)
+        a.at(ix, iy, iz) = valueAt(ix, iy, iz);
+
+    // Odd count leaves a tail after full SIMD registers.
+    std::vector<int> ix, iy, iz;
+    fillCoordinates(ix, iy, iz, 37);
+    CellOffsets offsets(a, ix.data(), iy.data(), iz.data(), ix.size());
+
+    SECTION("Gather") {
+        std::vector<double> cached(ix.size()), direct(ix.size());
+        core::gather(a, offsets, cached.data());
+        core::gather(a, ix.data(), iy.data(), iz.data(), ix.size(), direct.data());
+        for (std::size_t i = 0; i < ix.size(); ++i) {
+            REQUIRE(cached[i] == valueAt(ix[i], iy[i], iz[i]));
+            REQUIRE(direct[i] == cached[i]);
+        }
+    }
+
+    SECTION("Scatter") {
+        Array b(HalfOpenRange<int>(-2, 7), HalfOpenRange<int>(3, 10),
+                HalfOpenRange<int>(0, 11), -1.0);
+        std::vector<double> values(ix.size());
+        core::gather(a, offsets, values.data());
+        core::scatter(b, offsets, values.data());
+        for (std::size_t i = 0; i < ix.size(); ++i)
+            REQUIRE(b.at(ix[i], iy[i], iz[i]) == valueAt(ix[i], iy[i], iz[i]));
+    }
+
+    SECTION("Accumulate with repeating cells") {
+        Array b(HalfOpenRange<int>(-2, 7), HalfOpenRange<int>(3, 10),
+                HalfOpenRange<int>(0, 11), 0.0);
+        Array expected(HalfOpenRange<int>(-2, 7), HalfOpenRange<int>(3, 10),
+                       HalfOpenRange<int>(0, 11), 0.0);
+        CellOffsets twice(b.getBox());
+        std::vector<double> values;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (std::size_t i = 0; i < ix.size(); ++i) {
+                twice.push(ix[i], iy[i], iz[i]);
+                values.push_back(0.5 + i + pass);
+                expected.at(ix[i], iy[i], iz[i]) += 0.5 + i + pass;
+            }
+        }
+        core::scatterAdd(b, twice, values.data());
+        for (std::size_t i = 0; i < ix.size(); ++i)
+            REQUIRE(b.at(ix[i], iy[i], iz[i]) == expected.at(ix[i], iy[i], iz[i]));
+    }
+
+    SECTION("Mismatching geometry") {
+        Array b(9, 7, 11, 0.0);
+        std::vector<double> values(ix.size());
+        REQUIRE_THROWS_AS(core::gather(b, offsets, values.data()),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(core::gather(a, ix.data(), ix.data(), ix.data(),
+                                       ix.size(), values.data()),
+                          std::out_of_range);
+    }
+}
+
+TEST_CASE("Batched access works for floats", "rvlm::core::CellOffsets") {
+    SolidArray3d<float> a(6, 5, 19, 0.0f);
+    CellOffsets offsets(a.getBox());
+    std::vector<float> values;
+    for (std::size_t i = 0; i < 41; ++i) {
+        std::size_t ix = (i*7) % 6, iy = (i*3) % 5, iz = (i*5) % 19;
+        a.at(ix, iy, iz) = static_cast<float>(ix*100 + iy*10 + iz);
+        offsets.push(ix, iy, iz);
+        values.push_back(static_cast<float>(ix*100 + iy*10 + iz));
+    }
+    std::vector<float> out(values.size());
+    core::gather(a, offsets, out.data());
+    REQUIRE(out == values);
+}
@@ -0,0 +1,165 @@
+#include <catch.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "rvlm/core/Checkpoint.hh"
+using rvlm::core::CheckpointReader;
+using rvlm::core::CheckpointWriter;
+using rvlm::core::DirtyBricks;
+using rvlm::core::HalfOpenRange;
+using rvlm::core::IndexBox;
+using rvlm::core::SolidArray3d;
+
+namespace {
+
+typedef SolidArray3d<double, int> Array;
+typedef IndexBox<std::ptrdiff_t> Box;
+
+const HalfOpenRange<int> RX(-5, 14), RY(2, 11), RZ(0, 23);
+
+/**
+ * Writes @a value into all cells of @a box and marks them, as a kernel
+ * would.
+ */
+void paint(Array& a, DirtyBricks& dirty, Box const& box, double value) {
+    for (std::ptrdiff_t ix = box.start[0]; ix < box.stop[0]; ++ix)
+    for (std::ptrdiff_t iy = box.start[1]; iy < box.stop[1]; ++iy)
+    for (std::ptrdiff_t iz = box.start[2]; iz < box.stop[2]; ++iz)
+        a.at(int(ix), int(iy), int(iz)) = value + ix + 0.01*iy + 0.0001*iz;
+    dirty.markDirty(box);
+}
+
+bool sameContents(Array const& a, Array const& b) {
+    for (int ix = RX.start; ix < RX.stop; ++ix)
+    for (int iy = RY.start; iy < RY.stop; ++iy)
+    for (int iz = RZ.start; iz < RZ.stop; ++iz) {
+        if (a.at(ix, iy, iz) != b.at(ix, iy, iz))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("DirtyBricks tracks written boxes", "rvlm::core::DirtyBricks") {
+    DirtyBricks dirty(Box(-5, 14, 2, 11, 0, 23), 8);
+    REQUIRE(dirty.getBrickCount(0) == 3);
+    REQUIRE(dirty.getBrickCount(1) == 2);
+    REQUIRE(dirty.getBrickCount(2) == 3);
+    REQUIRE(dirty.getBrickCount() == 18);
+    REQUIRE(dirty.getDirtyBricks().size() == 18);
+
+    dirty.clear();
+    REQUIRE(dirty.getDirtyBricks().empty());
+    dirty.markDirty(Box(0, 2, 9, 10, 15, 17));
+    dirty.markDirty(100, 100, 100);
+    std::vector<std::size_t> bricks = dirty.getDirtyBricks();
+    REQUIRE(bricks.size() == 2);
+    REQUIRE(dirty.getBrickBox(bricks[0]) == Box(-5, 3, 2, 10, 8, 16));
+    REQUIRE(dirty.getBrickBox(bricks[1]) == Box(-5, 3, 2, 10, 16, 23));
+    REQUIRE(dirty.getBrickBox(17) == Box(11, 14, 10, 11, 16, 23));
+    REQUIRE(DirtyBricks::brickCountOf(dirty.getBox(), 8) == 18);
+    for (std::size_t b = 0; b < dirty.getBrickCount(); ++b)
+        REQUIRE(DirtyBricks::brickBoxOf(dirty.getBox(), 8, b) == dirty.getBrickBox(b));
+
+    REQUIRE_THROWS_AS(DirtyBricks(Box(0, 1, 0, 1, 0, 1), 6), std::invalid_argument);
+}
+
+TEST_CASE("Checkpoint restores base and deltas", "rvlm::core::Checkpoint") {
+    Array field(RX, RY, RZ, 0.0);
+    DirtyBricks dirty(field.getBox(), 4);
+    CheckpointWriter<double, int> writer(field, dirty);
+
+    paint(field, dirty, field.getBox(), 1.0);
+    std::stringstream base;
+    writer.writeBase(base);
+    REQUIRE(dirty.getDirtyBricks().empty());
+
+    std::vector<std::string> deltas;
+    Box changes[3] = { Box(0, 3, 4, 5, 0, 23), Box(-5, -4, 2, 11, 20, 21),
+                       Box(13, 14, 10, 11, 22, 23) };
+    for (int d = 0; d < 3; ++d) {
+        paint(field, dirty, changes[d], 10.0 * (d + 2));
+        std::ostringstream delta;
+        writer.writeDelta(delta);
+        deltas.push_back(delta.str());
+        REQUIRE(writer.getSequence() == std::size_t(d + 1));
+    }
+    REQUIRE(writer.getLastBrickCount() == 1);
+    REQUIRE(deltas[2].size() < base.str().size() / 50);
+
+    // Writing nothing gives an empty delta.
+    std::ostringstream nothing;
+    writer.writeDelta(nothing);
+    REQUIRE(writer.getLastBrickCount() == 0);
+
+    Array restored(RX, RY, RZ, -1.0);
+    CheckpointReader<double, int> reader(restored);
+    reader.readBase(base);
+    REQUIRE(!sameContents(restored, field));
+    for (std::size_t d = 0; d < deltas.size(); ++d) {
+        std::istringstream in(deltas[d]);
+        reader.readDelta(in);
+    }
+    REQUIRE(reader.getSequence() == 3);
+    REQUIRE(sameContents(restored, field));
+}
+
+TEST_CASE("Checkpoint rejects mismatching records", "rvlm::core::Checkpoint") {
+    Array field(RX, RY, RZ, 1.0);
+    DirtyBricks dirty(field.getBox());
+    CheckpointWriter<double, int> writer(field, dirty);
+
+    std::ostringstream early;
+    REQUIRE_THROWS_AS(writer.writeDelta(early), std::logic_error);
+
+    std::ostringstream base, first, second;
+    writer.writeBase(base);
+    dirty.markDirty(0, 5, 5);
+    writer.writeDelta(first);
+    dirty.markDirty(0, 5, 5);
+    writer.writeDelta(second);
+
+    Array restored(RX, RY, RZ, 0.0);
+    CheckpointReader<double, int> reader(restored);
+    std::istringstream deltaFirst(first.str());
+    REQUIRE_THROWS_AS(reader.readDelta(deltaFirst), std::runtime_error);
+
+    std::istringstream baseIn(base.str());
+    reader.readBase(baseIn);
+    std::istringstream deltaSecond(second.str());
+    REQUIRE_THROWS_AS(reader.readDelta(deltaSecond), std::runtime_error);
+
+    Array other(RX, RY, HalfOpenRange<int>(0, 22), 0.0);
+    CheckpointReader<double, int> otherReader(other);
+    std::istringstream baseAgain(base.str());
+    REQUIRE_THROWS_AS(otherReader.readBase(baseAgain), std::runtime_error);
+
+    std::istringstream truncated(base.str().substr(0, 200));
+    REQUIRE_THROWS_AS(reader.readBase(truncated), std::runtime_error);
+
+    SolidArray3d<float, int> floats(RX, RY, RZ, 0.0f);
+    CheckpointReader<float, int> floatReader(floats);
+    std::istringstream baseFloat(base.str());
+    REQUIRE_THROWS_AS(floatReader.readBase(baseFloat), std::runtime_error);
+
+    // Damaged brick size must not reach brick arithmetic.
+    const std::size_t at = offsetof(rvlm::core::detail::CheckpointHeader, brickSize);
+    const std::uint32_t badSizes[] = { 0, 6 };
+    for (std::size_t i = 0; i < 2; ++i) {
+        std::string damaged = first.str();
+        std::memcpy(&damaged[at], &badSizes[i], sizeof(badSizes[i]));
+        CheckpointReader<double, int> fresh(restored);
+        std::istringstream freshBase(base.str()), delta(damaged);
+        fresh.readBase(freshBase);
+        REQUIRE_THROWS_AS(fresh.readDelta(delta), std::runtime_error);
+    }
+
+    DirtyBricks wrong(Box(0, 1, 0, 1, 0, 1));
+    typedef CheckpointWriter<double, int> Writer;
+    REQUIRE_THROWS_AS(Writer(field, wrong), std::invalid_argument);
+}
@@ -0,0 +1,78 @@
+#include <catch.hpp>
+#include <random>
+#include <vector>
+#include "rvlm/core/CuboidIndex.hh"
+using rvlm::core::Cuboid;
+using rvlm::core::CuboidIndex;
+using rvlm::core::GridGeometry;
+using rvlm::core::IndexBox;
+using rvlm::core::Vector3d;
+
+TEST_CASE("Cuboid index matches linear scan", "rvlm::core::CuboidIndex") {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> pos(-1.0, 1.0);
+    std::uniform_real_distribution<double> size(0.0, 0.6);
+    std::vector<Cuboid<double>> cuboids;
+    for (int i = 0; i < 300; ++i) {
+        double x = pos(rng), y = pos(rng), z = pos(rng);
+        cuboids.push_back(Cuboid<double>(x + size(rng), y, z + size(rng),
+                                         x, y + size(rng), z));
+    }
+    CuboidIndex<double> index(cuboids);
+
+    SECTION("Point queries") {
+        const std::size_t count = 2000;
+        std::vector<double> xs, ys, zs;
+        for (std::size_t i = 0; i < count; ++i) {
+            xs.push_back(1.2*pos(rng));
+            ys.push_back(1.2*pos(rng));
+            zs.push_back(1.2*pos(rng));
+        }
+
+        std::vector<std::size_t> offsets;
+        std::vector<CuboidIndex<double>::IdType> ids;
+        index.findContaining(count, xs.data(), ys.data(), zs.data(),
+                             offsets, ids);
+        REQUIRE(offsets.size() == count + 1);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            std::vector<CuboidIndex<double>::IdType> expected;
+            for (std::size_t c = 0; c < cuboids.size(); ++c)
+                if (cuboids[c].contains(xs[i], ys[i], zs[i]))
+                    expected.push_back(static_cast<std::uint32_t>(c));
+            std::vector<CuboidIndex<double>::IdType> actual(
+                ids.begin() + offsets[i], ids.begin() + offsets[i+1]);
+            REQUIRE(actual == expected);
+        }
+    }
+
+    SECTION("Box queries") {
+        GridGeometry<double> grid(Vector3d<double>(-1, -1, -1),
+                                  Vector3d<double>(0.05, 0.05, 0.05));
+        std::vector<IndexBox<>> boxes;
+        boxes.push_back(IndexBox<>(0, 4, 0, 4, 0, 4));
+        boxes.push_back(IndexBox<>(10, 30, 5, 6, 17, 40));
+        boxes.push_back(IndexBox<>(39, 50, 39, 50, 39, 50));
+
+        std::vector<std::size_t> offsets;
+        std::vector<CuboidIndex<double>::BoxHit> hits;
+        index.findOverlapping(grid, boxes, offsets, hits);
+
+        for (std::size_t i = 0; i < boxes.size(); ++i) {
+            std::size_t expected = 0;
+            for (std::size_t c = 0; c < cuboids.size(); ++c) {
+                bool overlaps = true;
+                for (int axis = 0; axis < 3; ++axis) {
+                    double lo = grid.fromGrid(axis, boxes[i].start[axis]);
+                    double hi = grid.fromGrid(axis, boxes[i].stop[axis]);
+                    overlaps = overlaps && cuboids[c].getLower(axis) < hi &&
+                               lo < cuboids[c].getUpper(axis);
+                }
+                expected += overlaps;
+            }
+            REQUIRE(offsets[i+1] - offsets[i] == expected);
+            for (std::size_t h = offsets[i]; h < offsets[i+1]; ++h)
+                REQUIRE(boxes[i].contains(hits[h].cells));
+        }
+    }
+}
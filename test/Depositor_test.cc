@@ -0,0 +1,137 @@
+#include <catch.hpp>
+#include <memory>
+#include <random>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "rvlm/core/Depositor.hh"
+using rvlm::core::Depositor;
+using rvlm::core::DepositionStrategy;
+using rvlm::core::HalfOpenRange;
+using rvlm::core::SolidArray3d;
+
+namespace {
+
+typedef SolidArray3d<double, int> Array;
+
+/**
+ * Adds integral weights around the particle cell, reaching one cell in
+ * both directions. Integral values keep sums exact in any order.
+ */
+struct Stencil {
+    std::vector<double> const* charge;
+
+    template <typename TSink>
+    void operator () (std::size_t i, TSink& sink) const {
+        double q = (*charge)[i];
+        sink.add(0, 0, 0, 4*q);
+        sink.add(1, 0, 0, q);
+        sink.add(-1, 0, 0, 2*q);
+        sink.add(0, 1, 1, 3*q);
+        sink.add(0, -1, 0, q);
+        sink.add(-1, -1, -1, 5*q);
+        sink.add(1, 1, 1, 6*q);
+    }
+};
+
+struct Particles {
+    std::vector<int> ix, iy, iz;
+    std::vector<double> charge;
+
+    // Particles crowd into a corner, leaving most tiles sparse or empty.
+    Particles(std::size_t count, bool clustered) {
+        std::mt19937 rng(17);
+        std::uniform_int_distribution<int> x(-4, 14), y(1, 22), z(3, 12);
+        std::uniform_int_distribution<int> q(1, 9);
+        for (std::size_t i = 0; i < count; ++i) {
+            int cx = x(rng), cy = y(rng), cz = z(rng);
+            if (clustered && i % 4 != 0) {
+                cx = -4 + static_cast<int>(i % 3);
+                cy = 1 + static_cast<int>(i / 3 % 3);
+            }
+            ix.push_back(cx);
+            iy.push_back(cy);
+            iz.push_back(cz);
+            charge.push_back(q(rng));
+        }
+    }
+
+    void reference(Array& a) const {
+        const int d[7][3] = { {0,0,0}, {1,0,0}, {-1,0,0}, {0,1,1},
+                              {0,-1,0}, {-1,-1,-1}, {1,1,1} };
+        const double w[7] = { 4, 1, 2, 3, 1, 5, 6 };
+        for (std::size_t i = 0; i < ix.size(); ++i)
+            for (int k = 0; k < 7; ++k)
+                a.at(ix[i] + d[k][0], iy[i] + d[k][1], iz[i] + d[k][2]) += w[k]*charge[i];
+    }
+};
+
+bool equal(Array const& a, Array const& b) {
+    for (int ix = a.getBeginX(); ix < a.getEndX(); ++ix)
+    for (int iy = a.getBeginY(); iy < a.getEndY(); ++iy)
+    for (int iz = a.getBeginZ(); iz < a.getEndZ(); ++iz)
+        if (a.at(ix, iy, iz) != b.at(ix, iy, iz))
+            return false;
+    return true;
+}
+
+Array* makeArray() {
+    return new Array(HalfOpenRange<int>(-5, 16), HalfOpenRange<int>(0, 24),
+                     HalfOpenRange<int>(2, 14), 1.0);
+}
+
+} // namespace
+
+TEST_CASE("All deposition strategies give the same result", "rvlm::core::Depositor") {
+    const DepositionStrategy strategies[4] = {
+        DepositionStrategy::Atomic, DepositionStrategy::TileBuffers,
+        DepositionStrategy::ColoredTiles, DepositionStrategy::Automatic };
+
+#ifdef _OPENMP
+    const int maxThreads = omp_get_max_threads();
+#endif
+    for (int clustered = 0; clustered < 2; ++clustered) {
+        Particles particles(3000, clustered != 0);
+        std::unique_ptr<Array> expected(makeArray());
+        particles.reference(*expected);
+        Stencil stencil = { &particles.charge };
+
+        for (int threads = 1; threads <= 4; ++threads) {
+#ifdef _OPENMP
+            omp_set_num_threads(threads);
+#endif
+            for (int tile = 2; tile <= 8; tile *= 2)
+            for (int s = 0; s < 4; ++s) {
+                std::unique_ptr<Array> a(makeArray());
+                Depositor<double, int> depositor(*a, 1, tile);
+                DepositionStrategy used = depositor.deposit(
+                        particles.ix.data(), particles.iy.data(),
+                        particles.iz.data(), particles.ix.size(),
+                        stencil, strategies[s]);
+                REQUIRE(used != DepositionStrategy::Automatic);
+                REQUIRE(used == depositor.getLastStrategy());
+                if (s != 3)
+                    REQUIRE(used == strategies[s]);
+                REQUIRE(equal(*a, *expected));
+            }
+        }
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+}
+
+TEST_CASE("Depositor checks its arguments", "rvlm::core::Depositor") {
+    std::unique_ptr<Array> a(makeArray());
+    typedef Depositor<double, int> IntDepositor;
+    REQUIRE_THROWS_AS(IntDepositor(*a, 2, 3), std::invalid_argument);
+
+    IntDepositor depositor(*a, 1, 4);
+    std::vector<double> charge(1, 1.0);
+    Stencil stencil = { &charge };
+    int ix[1] = { -5 }, iy[1] = { 5 }, iz[1] = { 5 };
+    REQUIRE_THROWS_AS(depositor.deposit(ix, iy, iz, 1, stencil),
+                      std::out_of_range);
+    REQUIRE(a->at(-4, 5, 5) == 1.0);
+}
@@ -0,0 +1,127 @@
+#include <catch.hpp>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/DftAccumulator.hh"
+using rvlm::core::DftAccumulator;
+using rvlm::core::HalfOpenRange;
+using rvlm::core::IndexBox;
+using rvlm::core::SolidArray3d;
+
+namespace {
+
+typedef SolidArray3d<double, int> Array;
+typedef IndexBox<std::ptrdiff_t> Box;
+
+double fieldValue(int ix, int iy, int iz, double t) {
+    return std::cos(0.7*t + 0.1*ix) * (1 + 0.2*iy) - 0.3*std::sin(1.9*t) * iz;
+}
+
+void fill(Array& a, double t) {
+    for (int ix = a.getBeginX(); ix < a.getEndX(); ++ix)
+    for (int iy = a.getBeginY(); iy < a.getEndY(); ++iy)
+    for (int iz = a.getBeginZ(); iz < a.getEndZ(); ++iz)
+        a.at(ix, iy, iz) = fieldValue(ix, iy, iz, t);
+}
+
+/**
+ * Runs accumulator over @a box for @a steps steps and compares it to
+ * direct summation with complex exponent evaluated at every step.
+ */
+void checkAgainstDirectSum(Box const& box, std::size_t steps) {
+    Array a(HalfOpenRange<int>(-2, 7), HalfOpenRange<int>(3, 9),
+            HalfOpenRange<int>(0, 11), 0.0);
+    std::vector<double> omegas;
+    omegas.push_back(0.0);
+    omegas.push_back(0.7);
+    omegas.push_back(1.9);
+    omegas.push_back(3.1);
+    const double dt = 0.05, t0 = 0.5*dt;
+
+    DftAccumulator<double, int> dft(a, box, omegas, dt, t0);
+    std::vector<std::complex<double>> expected(omegas.size() * box.count());
+    for (std::size_t n = 0; n < steps; ++n) {
+        const double t = t0 + n*dt;
+        fill(a, t);
+        dft.accumulate();
+
+        std::size_t i = 0;
+        for (std::size_t f = 0; f < omegas.size(); ++f)
+        for (std::ptrdiff_t ix = box.start[0]; ix < box.stop[0]; ++ix)
+        for (std::ptrdiff_t iy = box.start[1]; iy < box.stop[1]; ++iy)
+        for (std::ptrdiff_t iz = box.start[2]; iz < box.stop[2]; ++iz)
+            expected[i++] += fieldValue(int(ix), int(iy), int(iz), t)
+                           * std::polar(1.0, -omegas[f]*t);
+    }
+    REQUIRE(dft.getStep() == steps);
+
+    std::size_t i = 0;
+    for (std::size_t f = 0; f < omegas.size(); ++f) {
+        for (std::ptrdiff_t ix = box.start[0]; ix < box.stop[0]; ++ix)
+        for (std::ptrdiff_t iy = box.start[1]; iy < box.stop[1]; ++iy)
+        for (std::ptrdiff_t iz = box.start[2]; iz < box.stop[2]; ++iz) {
+            std::complex<double> v = dft.at(f, ix, iy, iz);
+            REQUIRE(std::abs(v - expected[i]) < 1e-9 * steps);
+            REQUIRE(dft.getReal(f)[i % box.count()] == v.real());
+            REQUIRE(dft.getImag(f)[i % box.count()] == v.imag());
+            ++i;
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("DftAccumulator matches direct summation over box", "rvlm::core::DftAccumulator") {
+    checkAgainstDirectSum(Box(-1, 5, 4, 8, 2, 9), 50);
+}
+
+TEST_CASE("DftAccumulator matches direct summation over faces", "rvlm::core::DftAccumulator") {
+    checkAgainstDirectSum(Box(0, 1, 3, 9, 0, 11), 30);
+    checkAgainstDirectSum(Box(-2, 7, 3, 9, 5, 6), 30);
+}
+
+TEST_CASE("DftAccumulator stays accurate over long runs", "rvlm::core::DftAccumulator") {
+    // Crosses several phasor resynchronizations.
+    checkAgainstDirectSum(Box(1, 2, 4, 6, 3, 5), 5000);
+}
+
+TEST_CASE("DftAccumulator in single precision", "rvlm::core::DftAccumulator") {
+    SolidArray3d<float> a(4, 4, 40, 1.0f);
+    std::vector<double> omegas(1, 2.0);
+    const double dt = 0.01;
+    DftAccumulator<float> dft(a, a.getBox(), omegas, dt);
+    std::complex<double> expected = 0;
+    for (std::size_t n = 0; n < 3000; ++n) {
+        dft.accumulate();
+        expected += std::polar(1.0, -2.0*n*dt);
+    }
+    std::complex<float> v = dft.at(0, 3, 2, 39);
+    REQUIRE(std::abs(std::complex<double>(v) - expected) < 1e-2);
+}
+
+TEST_CASE("DftAccumulator reports memory and resets", "rvlm::core::DftAccumulator") {
+    Array a(5, 6, 7, 1.0);
+    std::vector<double> omegas(3, 1.0);
+    DftAccumulator<double, int> dft(a, Box(0, 5, 0, 6, 3, 4), omegas, 0.1);
+    REQUIRE(dft.getFrequencyCount() == 3);
+    REQUIRE(dft.bytesPerFrequency() >= 2 * 30 * sizeof(double));
+    REQUIRE(dft.getMemoryUsage() == 3 * dft.bytesPerFrequency());
+
+    dft.accumulate();
+    REQUIRE(dft.at(1, 4, 5, 3).real() == 1.0);
+    dft.reset();
+    REQUIRE(dft.getStep() == 0);
+    REQUIRE(dft.at(1, 4, 5, 3) == std::complex<double>(0, 0));
+
+    REQUIRE_THROWS_AS(dft.at(0, 0, 0, 0), std::out_of_range);
+    typedef DftAccumulator<double, int> Accumulator;
+
+    Accumulator empty(a, Box(0, 5, 0, 6, 3, 3), omegas, 0.1);
+    empty.accumulate();
+    REQUIRE(empty.getReal(2) == empty.getReal(0));
+    REQUIRE(empty.getImag(2) == empty.getImag(0));
+
+    REQUIRE_THROWS_AS(Accumulator(a, Box(0, 6, 0, 6, 0, 7), omegas, 0.1),
+                      std::out_of_range);
+}
@@ -1,4 +1,5 @@
-#include <catch/catch.hpp>
+#include <catch.hpp>
+#include <vector>
 #include "rvlm/core/Flags.hh"
 using rvlm::core::Flags;
 using rvlm::core::operator |;
@@ -15,6 +16,25 @@ enum class TestEnum {
     Item28, Item29, Item30, Item31,
 };
 
+enum class WideEnum {
+    Item000 = 0,
+    Item001 = 1,
+    Item063 = 63,
+    Item064 = 64,
+    Item127 = 127,
+    Item128 = 128,
+    Item199 = 199,
+};
+
+namespace rvlm {
+namespace core {
+template <>
+struct FlagsWidth<WideEnum> {
+    static const std::size_t value = 200;
+};
+}
+}
+
 // TODO: Incomprehensive test.
 TEST_CASE("Flags work", "rvlm::core::Flags") {
 
@@ -119,5 +139,60 @@ TEST_CASE("Flags work", "rvlm::core::Flags") {
         REQUIRE(flagsOdd == flagsAll - flagsEven);
         REQUIRE(flagsEven == flagsAll - flagsOdd);
         REQUIRE((flagsOdd & flagsEven).empty());
+        REQUIRE(flagsOdd.count() == 16);
+        REQUIRE(flagsOdd < flagsAll);
+        REQUIRE(!(flagsOdd <= flagsEven));
+        REQUIRE(flagsAll >= flagsFirstHalf);
+
+        Flags<TestEnum> flagsAnd = flagsAll;
+        flagsAnd &= flagsFirstHalf;
+        REQUIRE(flagsAnd == flagsFirstHalf);
+    }
+
+    SECTION("Iterating over included items") {
+        Flags<TestEnum> flags =
+            TestEnum::Item00 | TestEnum::Item07 | TestEnum::Item31;
+        std::vector<TestEnum> items(flags.begin(), flags.end());
+        REQUIRE(items.size() == 3);
+        REQUIRE(items[0] == TestEnum::Item00);
+        REQUIRE(items[1] == TestEnum::Item07);
+        REQUIRE(items[2] == TestEnum::Item31);
+        REQUIRE(Flags<TestEnum>().begin() == Flags<TestEnum>().end());
     }
+
+    SECTION("Constant expressions") {
+        constexpr Flags<TestEnum> flags(TestEnum::Item02, TestEnum::Item30);
+        static_assert(flags.contains(TestEnum::Item02), "");
+        static_assert(!flags.contains(TestEnum::Item03), "");
+        constexpr Flags<TestEnum> pair = TestEnum::Item02 | TestEnum::Item30;
+        REQUIRE(pair == flags);
+    }
+}
+
+TEST_CASE("Wide flags work", "rvlm::core::Flags") {
+    typedef Flags<WideEnum> WideFlags;
+    static_assert(WideFlags::WORD_COUNT == 4, "");
+
+    WideFlags flags = WideEnum::Item001 | WideEnum::Item064;
+    flags.include(WideEnum::Item199);
+    REQUIRE(flags.count() == 3);
+    REQUIRE(flags.contains(WideEnum::Item064));
+    REQUIRE(!flags.contains(WideEnum::Item063));
+
+    WideFlags other(WideEnum::Item063, WideEnum::Item064, WideEnum::Item128);
+    REQUIRE((flags & other) == WideEnum::Item064);
+    REQUIRE((flags | other).count() == 5);
+    REQUIRE((flags ^ other).count() == 4);
+    REQUIRE((flags - other) == (WideEnum::Item001 | WideEnum::Item199));
+    REQUIRE(!(flags - other - flags - other).contains(WideEnum::Item001));
+    REQUIRE((flags - other - flags).empty());
+
+    std::vector<WideEnum> items(other.begin(), other.end());
+    REQUIRE(items.size() == 3);
+    REQUIRE(items[0] == WideEnum::Item063);
+    REQUIRE(items[1] == WideEnum::Item064);
+    REQUIRE(items[2] == WideEnum::Item128);
+
+    REQUIRE_THROWS_AS(Flags<TestEnum>(static_cast<TestEnum>(32)),
+                      std::out_of_range);
 }
@@ -0,0 +1,129 @@
+#include <catch.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "rvlm/core/Kernels.hh"
+using rvlm::core::Isa;
+using rvlm::core::KernelSet;
+using rvlm::core::KernelTable;
+using rvlm::core::activeIsa;
+using rvlm::core::detectIsa;
+using rvlm::core::isaName;
+using rvlm::core::kernelTable;
+using rvlm::core::parseIsa;
+
+namespace {
+
+/**
+ * Gets kernel tables of all levels this machine can run.
+ */
+std::vector<KernelTable const*> runnableTables() {
+    std::vector<KernelTable const*> tables;
+    const Isa all[] = { Isa::Generic, Isa::Sse42, Isa::Avx2, Isa::Avx512 };
+    for (std::size_t i = 0; i < 4; ++i) {
+        if (all[i] <= detectIsa())
+            tables.push_back(&kernelTable(all[i]));
+    }
+    return tables;
+}
+
+KernelSet<float> const& setOf(KernelTable const& t, float*)   { return t.f32; }
+KernelSet<double> const& setOf(KernelTable const& t, double*) { return t.f64; }
+
+/**
+ * Checks kernels of every level against plain loops for run lengths
+ * around SIMD widths, starting at unaligned addresses.
+ */
+template <typename T>
+void checkKernels() {
+    const std::ptrdiff_t S = 7;
+    std::vector<T> a(200), b(200);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<T>(std::sin(0.37*i) * 10);
+        b[i] = static_cast<T>(std::cos(0.11*i) - 0.5);
+    }
+
+    std::vector<KernelTable const*> tables = runnableTables();
+    for (std::size_t t = 0; t < tables.size(); ++t) {
+        KernelSet<T> const& k = setOf(*tables[t], static_cast<T*>(0));
+        INFO("instruction set " << isaName(tables[t]->isa));
+        for (std::size_t n = 0; n < 70; ++n)
+        for (std::size_t offset = 0; offset < 3; ++offset) {
+            T const* pa = &a[S + offset];
+            T const* pb = &b[S + offset];
+
+            double sum = 0, dot = 0;
+            T maxAbs = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                sum += pa[i];
+                dot += static_cast<double>(pa[i]) * pb[i];
+                maxAbs = std::max(maxAbs, std::abs(pa[i]));
+            }
+            REQUIRE(k.sum(pa, n) == Approx(sum).margin(1e-9));
+            REQUIRE(k.dot(pa, pb, n) == Approx(dot).margin(1e-9));
+            REQUIRE(k.maxAbs(pa, n) == maxAbs);
+
+            std::vector<T> filled(n + 2, T(-1));
+            k.fill(&filled[1], n, T(3));
+            REQUIRE(filled.front() == T(-1));
+            REQUIRE(filled.back() == T(-1));
+            for (std::size_t i = 1; i <= n; ++i)
+                REQUIRE(filled[i] == T(3));
+
+            std::vector<T> dst(n, T(1)), expected(n, T(1));
+            std::vector<T> scaled(n, T(1)), expectedScaled(n, T(1));
+            for (std::size_t i = 0; i < n; ++i) {
+                T curl = T(0.5)*(pa[i] - pa[i - 1]) - T(0.25)*(pb[i] - pb[i - S]);
+                expected[i] += curl;
+                expectedScaled[i] += pb[i] * curl;
+            }
+            k.curlUpdate(dst.data(), 0, pa, pa - 1, T(0.5), pb, pb - S, T(0.25), n);
+            k.curlUpdate(scaled.data(), pb, pa, pa - 1, T(0.5), pb, pb - S, T(0.25), n);
+            for (std::size_t i = 0; i < n; ++i) {
+                REQUIRE(dst[i] == Approx(expected[i]));
+                REQUIRE(scaled[i] == Approx(expectedScaled[i]));
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("Instruction set names round trip", "rvlm::core::Kernels") {
+    const Isa all[] = { Isa::Generic, Isa::Sse42, Isa::Avx2, Isa::Avx512 };
+    for (std::size_t i = 0; i < 4; ++i) {
+        Isa isa = Isa::Generic;
+        REQUIRE(parseIsa(isaName(all[i]), isa));
+        REQUIRE(isa == all[i]);
+    }
+    Isa isa = Isa::Avx2;
+    REQUIRE_FALSE(parseIsa("neon", isa));
+    REQUIRE(isa == Isa::Avx2);
+}
+
+TEST_CASE("Active kernels are runnable on this machine", "rvlm::core::Kernels") {
+    REQUIRE(activeIsa() <= detectIsa());
+    REQUIRE(rvlm::core::activeKernels().isa == activeIsa());
+    REQUIRE(kernelTable(Isa::Generic).isa == Isa::Generic);
+}
+
+TEST_CASE("Kernels of all instruction sets agree with plain loops", "rvlm::core::Kernels") {
+    checkKernels<float>();
+    checkKernels<double>();
+}
+
+TEST_CASE("Kernels convert between precisions", "rvlm::core::Kernels") {
+    std::vector<KernelTable const*> tables = runnableTables();
+    for (std::size_t t = 0; t < tables.size(); ++t) {
+        std::vector<float> f(37), back(37);
+        std::vector<double> d(37);
+        for (std::size_t i = 0; i < f.size(); ++i)
+            f[i] = 0.1f * i - 1.7f;
+        tables[t]->widen(f.data(), d.data(), f.size());
+        tables[t]->narrow(d.data(), back.data(), d.size());
+        for (std::size_t i = 0; i < f.size(); ++i) {
+            REQUIRE(d[i] == static_cast<double>(f[i]));
+            REQUIRE(back[i] == f[i]);
+        }
+    }
+}
@@ -0,0 +1,141 @@
+#include <catch.hpp>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/MaterialGrid.hh"
+#include "rvlm/core/YeeUpdater.hh"
+using rvlm::core::CellMedium;
+using rvlm::core::HalfOpenRange;
+using rvlm::core::IndexBox;
+using rvlm::core::MaterialGrid;
+using rvlm::core::MaterialMedium;
+using rvlm::core::SolidArray3d;
+using rvlm::core::Vector3d;
+using rvlm::core::YeeUpdater;
+
+namespace {
+
+typedef SolidArray3d<double, int> Array;
+typedef MaterialGrid<double, std::uint8_t, int> Grid;
+typedef MaterialMedium<double, std::uint8_t, int> Medium;
+
+const HalfOpenRange<int> RX(-2, 9), RY(1, 8), RZ(0, 37);
+
+/**
+ * Fills arrays of inverse permittivity and permeability with three
+ * materials arranged in layers and a block.
+ */
+void fillMaterials(Array& invEps, Array& invMu) {
+    for (int ix = RX.start; ix < RX.stop; ++ix)
+    for (int iy = RY.start; iy < RY.stop; ++iy)
+    for (int iz = RZ.start; iz < RZ.stop; ++iz) {
+        int m = (ix + iz / 5) % 2 == 0 ? 0 : 1;
+        if (ix > 2 && iy < 4 && iz > 10)
+            m = 2;
+        invEps.at(ix, iy, iz) = 1.0 / (1 + m);
+        invMu .at(ix, iy, iz) = m == 2 ? 0.5 : 1.0;
+    }
+}
+
+} // namespace
+
+TEST_CASE("MaterialGrid deduplicates coefficient arrays", "rvlm::core::MaterialGrid") {
+    Array invEps(RX, RY, RZ, 0.0), invMu(RX, RY, RZ, 0.0);
+    fillMaterials(invEps, invMu);
+    std::vector<Array const*> arrays;
+    arrays.push_back(&invEps);
+    arrays.push_back(&invMu);
+
+    Grid grid(arrays);
+    REQUIRE(grid.getMaterialCount() == 3);
+    REQUIRE(grid.getCoefficientCount() == 2);
+    REQUIRE(grid.getBox() == invEps.getBox());
+    REQUIRE(grid.getMemoryUsage() ==
+            static_cast<std::size_t>(invEps.getTotalCount()) + 6 * sizeof(double));
+
+    std::vector<double> row(RZ.stop - RZ.start);
+    for (int ix = RX.start; ix < RX.stop; ++ix)
+    for (int iy = RY.start; iy < RY.stop; ++iy) {
+        for (int iz = RZ.start; iz < RZ.stop; ++iz) {
+            REQUIRE(grid.at(0, ix, iy, iz) == invEps.at(ix, iy, iz));
+            REQUIRE(grid.at(1, ix, iy, iz) == invMu.at(ix, iy, iz));
+        }
+        grid.gather(1, ix, iy, RZ.start, row.size(), row.data());
+        for (int iz = RZ.start; iz < RZ.stop; ++iz)
+            REQUIRE(row[iz - RZ.start] == invMu.at(ix, iy, iz));
+    }
+}
+
+TEST_CASE("MaterialGrid is built material by material", "rvlm::core::MaterialGrid") {
+    std::vector<double> vacuum(2, 1.0), glass(2, 1.0);
+    glass[0] = 0.25;
+    Grid grid(RX, RY, RZ, vacuum);
+    REQUIRE(grid.getMaterialCount() == 1);
+    REQUIRE(grid.addMaterial(glass) == 1);
+    REQUIRE(grid.addMaterial(vacuum) == 0);
+    REQUIRE(grid.getMaterialCount() == 2);
+
+    grid.setMaterial(IndexBox<std::ptrdiff_t>(0, 3, 2, 4, 5, 30), 1);
+    grid.setMaterial(-2, 1, 0, 1);
+    REQUIRE(grid.getMaterial(1, 3, 29) == 1);
+    REQUIRE(grid.getMaterial(1, 3, 30) == 0);
+    REQUIRE(grid.at(0, -2, 1, 0) == 0.25);
+    REQUIRE(grid.coefficient(0, 1) == 0.25);
+    REQUIRE(grid.getColumn(1)[1] == 1.0);
+
+    REQUIRE_THROWS_AS(grid.setMaterial(0, 2, 3, 2), std::out_of_range);
+    REQUIRE_THROWS_AS(grid.setMaterial(IndexBox<std::ptrdiff_t>(0, 20, 2, 4, 5, 30), 0),
+                      std::out_of_range);
+    REQUIRE_THROWS_AS(grid.addMaterial(std::vector<double>(3, 1.0)),
+                      std::invalid_argument);
+}
+
+TEST_CASE("MaterialGrid rejects too many materials", "rvlm::core::MaterialGrid") {
+    Array a(20, 20, 1, 0.0);
+    for (int ix = 0; ix < 20; ++ix)
+    for (int iy = 0; iy < 20; ++iy)
+        a.at(ix, iy, 0) = ix * 20 + iy;
+    std::vector<Array const*> arrays(1, &a);
+    REQUIRE_THROWS_AS(Grid(arrays), std::length_error);
+
+    MaterialGrid<double, std::uint16_t, int> wide(arrays);
+    REQUIRE(wide.getMaterialCount() == 400);
+    REQUIRE(wide.at(0, 19, 7, 0) == 387);
+}
+
+TEST_CASE("MaterialGrid medium updates fields as per-cell arrays", "rvlm::core::MaterialGrid") {
+    Array invEps(RX, RY, RZ, 0.0), invMu(RX, RY, RZ, 0.0);
+    fillMaterials(invEps, invMu);
+    std::vector<Array const*> arrays;
+    arrays.push_back(&invEps);
+    arrays.push_back(&invMu);
+    Grid grid(arrays);
+
+    std::unique_ptr<Array> f[2][6];
+    for (int s = 0; s < 2; ++s) {
+        for (int c = 0; c < 6; ++c)
+            f[s][c].reset(new Array(RX, RY, RZ, 0.0));
+        f[s][2]->at(3, 4, 18) = 1.0;
+        f[s][4]->at(0, 2, 9) = -0.5;
+    }
+
+    Vector3d<double> step(1e-3, 1e-3, 1e-3);
+    const double dt = 0.9 * YeeUpdater<double, int>::courantLimit(step);
+    YeeUpdater<double, int, CellMedium<double, int>> cells(
+            *f[0][0], *f[0][1], *f[0][2], *f[0][3], *f[0][4], *f[0][5], step, dt,
+            CellMedium<double, int>(invEps, invMu));
+    YeeUpdater<double, int, Medium> materials(
+            *f[1][0], *f[1][1], *f[1][2], *f[1][3], *f[1][4], *f[1][5], step, dt,
+            Medium(grid));
+    for (int n = 0; n < 10; ++n) {
+        cells.step();
+        materials.step();
+    }
+
+    for (int c = 0; c < 6; ++c)
+    for (int ix = RX.start; ix < RX.stop; ++ix)
+    for (int iy = RY.start; iy < RY.stop; ++iy)
+    for (int iz = RZ.start; iz < RZ.stop; ++iz)
+        REQUIRE(f[1][c]->at(ix, iy, iz) == f[0][c]->at(ix, iy, iz));
+}
@@ -0,0 +1,245 @@
+#include <catch.hpp>
+#include <cfenv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/MathBatch.hh"
+using rvlm::core::SolidArray3d;
+namespace math = rvlm::core::math;
+using math::Accuracy;
+
+namespace {
+
+std::int64_t orderedBits(double x) {
+    std::int64_t i;
+    std::memcpy(&i, &x, sizeof i);
+    return i < 0 ? std::numeric_limits<std::int64_t>::min() - i : i;
+}
+
+std::int64_t orderedBits(float x) {
+    std::int32_t i;
+    std::memcpy(&i, &x, sizeof i);
+    return i < 0 ? std::numeric_limits<std::int32_t>::min() - i : i;
+}
+
+/**
+ * Distance between two numbers in units in the last place.
+ */
+template <typename T>
+double ulpDistance(T a, T b) {
+    if (a == b) return 0;
+    if (std::isnan(a) || std::isnan(b)) return std::numeric_limits<double>::infinity();
+    return std::fabs(static_cast<double>(orderedBits(a) - orderedBits(b)));
+}
+
+template <typename T>
+std::vector<T> uniform(T lo, T hi, std::size_t count) {
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<T> dist(lo, hi);
+    std::vector<T> v(count);
+    for (std::size_t i = 0; i < count; ++i) v[i] = dist(gen);
+    return v;
+}
+
+struct Errors {
+    double ulp;
+    double relative;
+    double absolute;
+};
+
+template <typename T, typename TBatch, typename TReference>
+Errors measure(std::vector<T> const& x, TBatch batch, TReference reference) {
+    std::vector<T> y(x.size());
+    batch(x.data(), y.data(), x.size());
+
+    Errors e = { 0, 0, 0 };
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        T r = reference(x[i]);
+        double d = std::fabs(static_cast<double>(y[i]) - r);
+        e.ulp      = std::max(e.ulp, ulpDistance(y[i], r));
+        e.absolute = std::max(e.absolute, d);
+        if (r != 0) e.relative = std::max(e.relative, d / std::fabs(r));
+    }
+    return e;
+}
+
+template <typename T> T refExp(T x) { return std::exp(x); }
+template <typename T> T refSin(T x) { return std::sin(x); }
+template <typename T> T refCos(T x) { return std::cos(x); }
+
+} // namespace
+
+TEST_CASE("Batch exp matches libm within tier error", "rvlm::core::math") {
+    const std::size_t N = 100003;  // Not a multiple of any SIMD width.
+
+    std::vector<double> xd = uniform(-700.0, 700.0, N);
+    Errors e = measure(xd, math::exp<Accuracy::Reference, double>, refExp<double>);
+    REQUIRE(e.ulp == 0);
+    e = measure(xd, math::exp<Accuracy::Ulp1, double>, refExp<double>);
+    REQUIRE(e.ulp <= 2);
+    e = measure(xd, math::exp<Accuracy::Fast, double>, refExp<double>);
+    REQUIRE(e.relative < 2e-7);
+
+    std::vector<float> xf = uniform(-86.0f, 88.0f, N);
+    Errors f = measure(xf, math::exp<Accuracy::Ulp1, float>, refExp<float>);
+    REQUIRE(f.ulp <= 2);
+    f = measure(xf, math::exp<Accuracy::Fast, float>, refExp<float>);
+    REQUIRE(f.relative < 2e-7);
+
+    double special[] = { -1000, -708.5, 0, 1, 709.9, 1000,
+                         std::numeric_limits<double>::infinity(),
+                         std::numeric_limits<double>::quiet_NaN() };
+    double out[8];
+    math::exp(special, out, 8);
+    REQUIRE(out[0] == 0);
+    REQUIRE(out[1] == 0);
+    REQUIRE(out[2] == 1);
+    REQUIRE(ulpDistance(out[3], std::exp(1.0)) <= 1);
+    REQUIRE(std::isinf(out[4]));
+    REQUIRE(std::isinf(out[5]));
+    REQUIRE(std::isinf(out[6]));
+    REQUIRE(std::isnan(out[7]));
+
+    // Long enough for full vectors of every width.
+    std::vector<float> specialf(32, 0.0f), outf(32);
+    specialf[17] = std::numeric_limits<float>::quiet_NaN();
+    specialf[18] = -std::numeric_limits<float>::infinity();
+    math::exp(specialf.data(), outf.data(), specialf.size());
+    REQUIRE(outf[16] == 1);
+    REQUIRE(std::isnan(outf[17]));
+    REQUIRE(outf[18] == 0);
+}
+
+TEST_CASE("Batch sin and cos match libm within tier error", "rvlm::core::math") {
+    const std::size_t N = 100003;
+
+    std::vector<double> xd = uniform(-100.0, 100.0, N);
+    Errors e = measure(xd, math::sin<Accuracy::Ulp1, double>, refSin<double>);
+    REQUIRE(e.absolute <= 2*std::numeric_limits<double>::epsilon());
+    e = measure(xd, math::cos<Accuracy::Ulp1, double>, refCos<double>);
+    REQUIRE(e.absolute <= 2*std::numeric_limits<double>::epsilon());
+    e = measure(xd, math::sin<Accuracy::Fast, double>, refSin<double>);
+    REQUIRE(e.absolute < 1e-7);
+    e = measure(xd, math::cos<Accuracy::Fast, double>, refCos<double>);
+    REQUIRE(e.absolute < 1e-7);
+
+    // Near zero sine is small, so its relative error counts.
+    std::vector<double> small = uniform(-0.7, 0.7, N);
+    e = measure(small, math::sin<Accuracy::Ulp1, double>, refSin<double>);
+    REQUIRE(e.ulp <= 2);
+
+    std::vector<float> xf = uniform(-100.0f, 100.0f, N);
+    Errors f = measure(xf, math::sin<Accuracy::Ulp1, float>, refSin<float>);
+    REQUIRE(f.absolute <= 2*std::numeric_limits<float>::epsilon());
+    f = measure(xf, math::cos<Accuracy::Ulp1, float>, refCos<float>);
+    REQUIRE(f.absolute <= 2*std::numeric_limits<float>::epsilon());
+
+    // Large arguments fall back to full range reduction.
+    std::vector<double> large = uniform(-1e9, 1e9, 1001);
+    e = measure(large, math::sin<Accuracy::Ulp1, double>, refSin<double>);
+    REQUIRE(e.ulp == 0);
+
+    std::vector<double> s(N), c(N);
+    math::sincos(xd.data(), s.data(), c.data(), N);
+    std::vector<double> s1(N), c1(N);
+    math::sin(xd.data(), s1.data(), N);
+    math::cos(xd.data(), c1.data(), N);
+    REQUIRE(s == s1);
+    REQUIRE(c == c1);
+
+    // Output may coincide with input.
+    std::vector<double> inPlace = large;
+    math::sincos(inPlace.data(), inPlace.data(), c.data(), inPlace.size());
+    for (std::size_t i = 0; i < large.size(); ++i) {
+        REQUIRE(inPlace[i] == std::sin(large[i]));
+        REQUIRE(c[i] == std::cos(large[i]));
+    }
+}
+
+TEST_CASE("Batch rounding maps coordinates onto indices", "rvlm::core::math") {
+    double x[] = { -1.5, -0.5, -0.2, 0, 0.5, 2.5, 3.49, 7.999 };
+    double r[8];
+    math::round(x, r, 8);
+    for (int i = 0; i < 8; ++i)
+        REQUIRE(r[i] == math::round(x[i]));
+
+    long idx[8];
+    math::floorToIndex(x, idx, 8, -1.0, 0.5);
+    for (int i = 0; i < 8; ++i)
+        REQUIRE(idx[i] == static_cast<long>(std::floor((x[i] + 1.0) / 0.5)));
+
+    // Short and ragged runs from unaligned addresses; lanes beyond the
+    // run must not feed garbage into the arithmetic.
+    std::vector<float> xs(40);
+    for (std::size_t i = 0; i < xs.size(); ++i)
+        xs[i] = 0.37f * static_cast<float>(i) - 5.0f;
+    for (std::size_t n = 1; n < 38; ++n) {
+        int out[40];
+        std::feclearexcept(FE_INVALID);
+        math::floorToIndex(&xs[1], out, n, -2.0f, 0.25f);
+        REQUIRE(std::fetestexcept(FE_INVALID) == 0);
+        for (std::size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == static_cast<int>(std::floor((xs[i + 1] + 2.0f) / 0.25f)));
+    }
+}
+
+TEST_CASE("Batch functions apply to SolidArray3d rows", "rvlm::core::math") {
+    SolidArray3d<double> a(3, 4, 5, 0.0), b(3, 4, 5, 0.0), c(3, 4, 5, 0.0);
+    for (std::size_t ix = 0; ix < 3; ++ix)
+    for (std::size_t iy = 0; iy < 4; ++iy)
+    for (std::size_t iz = 0; iz < 5; ++iz)
+        a.at(ix, iy, iz) = b.at(ix, iy, iz) = c.at(ix, iy, iz)
+                         = 0.1*ix + 0.2*iy + 0.3*iz;
+
+    math::exp(b, std::size_t(1), std::size_t(2));
+    math::sin(a);
+    for (std::size_t ix = 0; ix < 3; ++ix)
+    for (std::size_t iy = 0; iy < 4; ++iy)
+    for (std::size_t iz = 0; iz < 5; ++iz) {
+        double v = c.at(ix, iy, iz);
+        REQUIRE(ulpDistance(a.at(ix, iy, iz), std::sin(v)) <= 2);
+        if (ix == 1 && iy == 2)
+            REQUIRE(ulpDistance(b.at(ix, iy, iz), std::exp(v)) <= 2);
+        else
+            REQUIRE(b.at(ix, iy, iz) == v);
+    }
+}
+
+TEST_CASE("Batch rounding and sincos apply to SolidArray3d rows", "rvlm::core::math") {
+    SolidArray3d<double> a(2, 3, 9, 0.0), s(2, 3, 9, 0.0), c(2, 3, 9, 0.0);
+    SolidArray3d<int> idx(2, 3, 9, 0);
+    for (std::size_t ix = 0; ix < 2; ++ix)
+    for (std::size_t iy = 0; iy < 3; ++iy)
+    for (std::size_t iz = 0; iz < 9; ++iz)
+        a.at(ix, iy, iz) = 0.75*iz - 2.5 + ix - 0.5*iy;
+
+    math::sincos(a, s, c);
+    math::floorToIndex(a, idx, -1.0, 0.5);
+    int row[9];
+    math::floorToIndex(a, std::size_t(1), std::size_t(2), row, 0.0, 2.0);
+    for (std::size_t ix = 0; ix < 2; ++ix)
+    for (std::size_t iy = 0; iy < 3; ++iy)
+    for (std::size_t iz = 0; iz < 9; ++iz) {
+        double v = a.at(ix, iy, iz);
+        REQUIRE(ulpDistance(s.at(ix, iy, iz), std::sin(v)) <= 2);
+        REQUIRE(ulpDistance(c.at(ix, iy, iz), std::cos(v)) <= 2);
+        REQUIRE(idx.at(ix, iy, iz) == static_cast<int>(std::floor((v + 1.0) / 0.5)));
+        if (ix == 1 && iy == 2)
+            REQUIRE(row[iz] == static_cast<int>(std::floor(v / 2.0)));
+    }
+
+    math::round(a, std::size_t(0), std::size_t(1));
+    REQUIRE(a.at(0, 1, 0) == math::round(-3.0));
+    REQUIRE(a.at(0, 1, 1) == math::round(-2.25));
+    REQUIRE(a.at(0, 2, 1) == -2.75);
+    math::round(a);
+    REQUIRE(a.at(0, 2, 1) == -3.0);
+    REQUIRE(a.at(1, 0, 4) == math::round(1.5));
+
+    SolidArray3d<double> other(2, 3, 8, 0.0);
+    REQUIRE_THROWS_AS(math::sincos(a, s, other), std::invalid_argument);
+}
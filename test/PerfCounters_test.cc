@@ -0,0 +1,92 @@
+#include <catch.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "rvlm/core/Kernels.hh"
+#include "rvlm/core/PerfCounters.hh"
+using rvlm::core::PerfEvent;
+using rvlm::core::PerfRegionStats;
+using rvlm::core::PerfScope;
+using rvlm::core::PerfWork;
+using rvlm::core::perfReport;
+using rvlm::core::perfReset;
+using rvlm::core::perfSnapshot;
+namespace kernels = rvlm::core::kernels;
+
+namespace {
+
+PerfRegionStats const* find(std::vector<PerfRegionStats> const& stats,
+                            std::string const& region) {
+    for (std::size_t i = 0; i < stats.size(); ++i) {
+        if (stats[i].region == region)
+            return &stats[i];
+    }
+    return 0;
+}
+
+double sweep(std::vector<float> const& data) {
+    PerfScope scope("sum");
+    double s = kernels::sum(data.data(), data.size());
+    scope.addWork(PerfWork::sum<float>(data.size()));
+    return s;
+}
+
+} // namespace
+
+TEST_CASE("PerfScope accumulates time and declared work", "rvlm::core::PerfCounters") {
+    perfReset();
+    std::vector<float> data(1 << 20, 1.0f);
+    double total = 0;
+    for (int i = 0; i < 5; ++i)
+        total += sweep(data);
+    REQUIRE(total == 5.0 * data.size());
+
+    std::vector<PerfRegionStats> stats = perfSnapshot();
+    PerfRegionStats const* s = find(stats, "sum");
+    REQUIRE(s != 0);
+    REQUIRE(s->calls == 5);
+    REQUIRE(s->seconds > 0);
+    REQUIRE(s->work.bytes == 5 * data.size() * sizeof(float));
+    REQUIRE(s->work.cells == 5 * data.size());
+    REQUIRE(s->gigabytesPerSecond() > 0);
+    REQUIRE(s->cellsPerSecond() > 0);
+    REQUIRE(s->arithmeticIntensity() == Approx(0.25));
+
+    // Events are counted only where the system allows, but when they are,
+    // sweeping four megabytes takes many instructions.
+    if (PerfScope::isCounted(PerfEvent::Instructions)) {
+        REQUIRE(s->hasEvent(PerfEvent::Instructions));
+        REQUIRE(s->event(PerfEvent::Instructions) > data.size() / 16);
+    } else {
+        REQUIRE_FALSE(s->hasEvent(PerfEvent::Instructions));
+        REQUIRE(s->instructionsPerCycle() == 0);
+    }
+}
+
+TEST_CASE("PerfScope keeps threads apart and reports", "rvlm::core::PerfCounters") {
+    perfReset();
+    std::vector<float> data(4096, 2.0f);
+    std::thread worker([&] { sweep(data); });
+    worker.join();
+    sweep(data);
+    {
+        PerfScope scope("stencil", PerfWork::curlUpdate<double>(100));
+    }
+
+    std::vector<PerfRegionStats> stats = perfSnapshot();
+    REQUIRE(stats.size() == 3);
+    REQUIRE(stats[0].region == "stencil");
+    REQUIRE(stats[0].arithmeticIntensity() == Approx(7.0 / 40));
+    REQUIRE(stats[1].region == "sum");
+    REQUIRE(stats[2].region == "sum");
+    REQUIRE(stats[1].thread != stats[2].thread);
+
+    std::ostringstream out;
+    perfReport(out);
+    REQUIRE(out.str().find("stencil") != std::string::npos);
+    REQUIRE(out.str().find("GB/s") != std::string::npos);
+
+    perfReset();
+    REQUIRE(perfSnapshot().empty());
+}
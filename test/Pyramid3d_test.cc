@@ -0,0 +1,131 @@
+#include <catch.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "rvlm/core/Pyramid3d.hh"
+using rvlm::core::HalfOpenRange;
+using rvlm::core::IndexBox;
+using rvlm::core::Pyramid3d;
+using rvlm::core::PyramidReduction;
+using rvlm::core::SolidArray3d;
+
+namespace {
+
+typedef SolidArray3d<double, int> Array;
+typedef IndexBox<std::ptrdiff_t> Box;
+
+/**
+ * Straightforward reduction of level 0 into level @a k, combining every
+ * coarse cell from the previous level the same way the pyramid does.
+ */
+std::vector<double> reference(Array const& a, int k, PyramidReduction r,
+                              std::ptrdiff_t size[3]) {
+    size[0] = a.getCountX(); size[1] = a.getCountY(); size[2] = a.getCountZ();
+    std::vector<double> fine;
+    for (int ix = a.getBeginX(); ix < a.getEndX(); ++ix)
+    for (int iy = a.getBeginY(); iy < a.getEndY(); ++iy)
+    for (int iz = a.getBeginZ(); iz < a.getEndZ(); ++iz)
+        fine.push_back(a.at(ix, iy, iz));
+
+    for (int level = 1; level <= k; ++level) {
+        std::ptrdiff_t c[3] = { (size[0]+1)/2, (size[1]+1)/2, (size[2]+1)/2 };
+        std::vector<double> coarse;
+        for (std::ptrdiff_t x = 0; x < c[0]; ++x)
+        for (std::ptrdiff_t y = 0; y < c[1]; ++y)
+        for (std::ptrdiff_t z = 0; z < c[2]; ++z) {
+            double sum = 0, peak = 0;
+            int n = 0;
+            for (std::ptrdiff_t fx = 2*x; fx < std::min(2*x+2, size[0]); ++fx)
+            for (std::ptrdiff_t fy = 2*y; fy < std::min(2*y+2, size[1]); ++fy)
+            for (std::ptrdiff_t fz = 2*z; fz < std::min(2*z+2, size[2]); ++fz) {
+                double v = fine[static_cast<std::size_t>((fx*size[1] + fy)*size[2] + fz)];
+                sum += v;
+                peak = std::max(peak, std::fabs(v));
+                ++n;
+            }
+            coarse.push_back(r == PyramidReduction::Mean ? sum / n : peak);
+        }
+        fine.swap(coarse);
+        std::copy(c, c + 3, size);
+    }
+    return fine;
+}
+
+void checkLevels(Pyramid3d<double, int>& pyramid, Array const& a) {
+    for (int k = 1; k < pyramid.getLevelCount(); ++k) {
+        std::ptrdiff_t size[3];
+        std::vector<double> expected = reference(a, k, pyramid.getReduction(), size);
+        Box box = pyramid.getLevelBox(k);
+        REQUIRE(box == Box(0, size[0], 0, size[1], 0, size[2]));
+        std::vector<double> actual(expected.size());
+        pyramid.extract(k, box, actual.data());
+        for (std::size_t i = 0; i < actual.size(); ++i)
+            REQUIRE(actual[i] == Approx(expected[i]).epsilon(1e-12));
+    }
+}
+
+} // namespace
+
+TEST_CASE("Pyramid levels reduce level 0", "rvlm::core::Pyramid3d") {
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<double> value(-1, 1);
+    Array a(HalfOpenRange<int>(-3, 20), HalfOpenRange<int>(4, 13),
+            HalfOpenRange<int>(0, 37), 0.0);
+    for (int ix = -3; ix < 20; ++ix)
+    for (int iy = 4; iy < 13; ++iy)
+    for (int iz = 0; iz < 37; ++iz)
+        a.at(ix, iy, iz) = value(rng);
+
+    const PyramidReduction reductions[2] = { PyramidReduction::Mean,
+                                             PyramidReduction::MaxAbs };
+    for (int r = 0; r < 2; ++r) {
+        Pyramid3d<double, int> pyramid(a, reductions[r], 0, 4);
+        REQUIRE(pyramid.getLevelCount() == 7);
+        REQUIRE(pyramid.getLevel(6).getBox() == Box(0, 1, 0, 1, 0, 1));
+        REQUIRE(!pyramid.isDirty());
+        checkLevels(pyramid, a);
+
+        // Change a few scattered boxes, only their bricks get reduced.
+        for (int n = 0; n < 3; ++n) {
+            Box changed(-3 + 7*n, -1 + 7*n, 5, 6 + n, 10*n, 10*n + 3);
+            for (std::ptrdiff_t ix = changed.start[0]; ix < changed.stop[0]; ++ix)
+            for (std::ptrdiff_t iy = changed.start[1]; iy < changed.stop[1]; ++iy)
+            for (std::ptrdiff_t iz = changed.start[2]; iz < changed.stop[2]; ++iz)
+                a.at(ix, iy, iz) = 5.0 * value(rng);
+            pyramid.markDirty(changed);
+        }
+        REQUIRE(pyramid.isDirty());
+        checkLevels(pyramid, a);
+    }
+}
+
+TEST_CASE("Pyramid extracts boxes and slices", "rvlm::core::Pyramid3d") {
+    SolidArray3d<float> a(16, 8, 12, 0.0f);
+    for (std::size_t ix = 0; ix < 16; ++ix)
+    for (std::size_t iy = 0; iy < 8; ++iy)
+    for (std::size_t iz = 0; iz < 12; ++iz)
+        a.at(ix, iy, iz) = static_cast<float>(ix*100 + iy*10 + iz);
+
+    Pyramid3d<float> pyramid(a, PyramidReduction::MaxAbs, 3);
+    REQUIRE(pyramid.getLevelCount() == 3);
+
+    // Maximum of each 4x4x4 block is at its upper corner.
+    std::vector<float> slice(4 * 3);
+    pyramid.extractSlice(2, 1, 1, slice.data());
+    for (std::size_t x = 0; x < 4; ++x)
+    for (std::size_t z = 0; z < 3; ++z)
+        REQUIRE(slice[x*3 + z] == (4*x + 3)*100 + 70 + 4*z + 3);
+
+    std::vector<float> box(2 * 2 * 2);
+    pyramid.extract(0, Box(1, 3, 2, 4, 5, 7), box.data());
+    REQUIRE(box[0] == 125);
+    REQUIRE(box[7] == 236);
+
+    std::vector<float> row(9);
+    REQUIRE_THROWS_AS(pyramid.extract(1, Box(0, 9, 0, 1, 0, 1), row.data()),
+                      std::out_of_range);
+    REQUIRE_THROWS_AS(pyramid.getLevel(3), std::out_of_range);
+    REQUIRE_THROWS_AS(Pyramid3d<float>(a, PyramidReduction::Mean, 0, 6),
+                      std::invalid_argument);
+}
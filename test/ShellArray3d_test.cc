@@ -0,0 +1,94 @@
+#include <catch.hpp>
+#include <stdexcept>
+#include "rvlm/core/ShellArray3d.hh"
+using rvlm::core::Execution;
+using rvlm::core::ShellArray3d;
+using rvlm::core::SolidArray3d;
+using rvlm::core::zipShell;
+
+namespace {
+
+typedef ShellArray3d<double> Shell;
+typedef Shell::Box Box;
+
+} // namespace
+
+TEST_CASE("ShellArray3d stores shell cells only", "rvlm::core::ShellArray3d") {
+    Box domain(-4, 16, 0, 12, 2, 10);
+    Shell shell(domain, 2, 1.5);
+
+    REQUIRE(shell.getSlabCount() == 6);
+    REQUIRE(shell.getInteriorBox() == Box(-2, 14, 2, 10, 4, 8));
+    REQUIRE(shell.getTotalCount() ==
+            static_cast<std::size_t>(domain.count() - shell.getInteriorBox().count()));
+
+    // Slabs are disjoint and cover exactly the shell.
+    std::size_t covered = 0;
+    for (std::ptrdiff_t ix = -5; ix <= 16; ++ix)
+    for (std::ptrdiff_t iy = -1; iy <= 12; ++iy)
+    for (std::ptrdiff_t iz = 1; iz <= 10; ++iz) {
+        int owners = 0;
+        for (std::size_t s = 0; s < shell.getSlabCount(); ++s)
+            owners += shell.getSlabBox(s).contains(ix, iy, iz) ? 1 : 0;
+        REQUIRE(owners == (shell.contains(ix, iy, iz) ? 1 : 0));
+        covered += owners;
+        if (shell.contains(ix, iy, iz)) {
+            REQUIRE(shell.at(ix, iy, iz) == 1.5);
+            shell.at(ix, iy, iz) = 100.0*ix + 10.0*iy + iz;
+        }
+    }
+    REQUIRE(covered == shell.getTotalCount());
+    REQUIRE(shell.at(-4, 0, 2) == -400.0 + 2);
+    REQUIRE(shell.at(15, 11, 9) == 1500.0 + 110 + 9);
+    REQUIRE(shell.at(5, 5, 3) == 500.0 + 50 + 3);
+
+    REQUIRE_THROWS_AS(shell.at(5, 5, 5), std::out_of_range);
+    REQUIRE_THROWS_AS(shell.at(16, 0, 2), std::out_of_range);
+}
+
+TEST_CASE("ShellArray3d leaves out faces of zero width", "rvlm::core::ShellArray3d") {
+    const std::ptrdiff_t lower[3] = { 3, 0, 1 };
+    const std::ptrdiff_t upper[3] = { 3, 0, 0 };
+    ShellArray3d<float> shell(Box(0, 10, 0, 10, 0, 10), lower, upper);
+    REQUIRE(shell.getSlabCount() == 3);
+    REQUIRE(shell.getTotalCount() == 1000 - 4*10*9);
+    REQUIRE_FALSE(shell.contains(5, 0, 5));
+    REQUIRE(shell.contains(5, 0, 0));
+
+    const std::ptrdiff_t tooWide[3] = { 8, 0, 0 };
+    REQUIRE_THROWS_AS(ShellArray3d<float>(Box(0, 10, 0, 10, 0, 10), tooWide, upper),
+                      std::range_error);
+    REQUIRE_THROWS_AS(ShellArray3d<float>(Box(0, 10, 0, 10, 0, 10), -1),
+                      std::range_error);
+}
+
+TEST_CASE("zipShell updates aligned shells in one pass", "rvlm::core::ShellArray3d") {
+    Box domain(0, 12, 0, 10, 0, 8);
+    SolidArray3d<double, std::ptrdiff_t> field(12, 10, 8, 0.0);
+    for (std::ptrdiff_t ix = 0; ix < 12; ++ix)
+    for (std::ptrdiff_t iy = 0; iy < 10; ++iy)
+    for (std::ptrdiff_t iz = 0; iz < 8; ++iz)
+        field.at(ix, iy, iz) = ix + iy + iz;
+
+    Shell psi(domain, 3, 1.0);
+    ShellArray3d<float> decay(domain, 3, 0.5f);
+    std::size_t visited = 0;
+    zipShell(Execution::Parallel,
+             [](double& p, float b, double e) { p = b*p + e; },
+             psi, decay, field);
+    zipShell([&](double&) { ++visited; }, psi);
+
+    REQUIRE(visited == psi.getTotalCount());
+    REQUIRE(psi.at(0, 0, 0) == 0.5);
+    REQUIRE(psi.at(11, 9, 7) == 0.5 + 27);
+    REQUIRE(psi.at(6, 5, 1) == 0.5 + 12);
+
+    ShellArray3d<float> other(domain, 2);
+    REQUIRE_FALSE(psi.isAlignedWith(other));
+    REQUIRE_THROWS_AS(zipShell([](double&, float&) {}, psi, other),
+                      std::invalid_argument);
+
+    SolidArray3d<double, std::ptrdiff_t> small(10, 10, 8, 0.0);
+    REQUIRE_THROWS_AS(zipShell([](double&, double) {}, psi, small),
+                      std::invalid_argument);
+}
@@ -0,0 +1,173 @@
+#include <catch.hpp>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "rvlm/core/SolidArray3d.hh"
+#include "rvlm/core/TaskGraph.hh"
+using rvlm::core::IndexBox;
+using rvlm::core::SolidArray3d;
+using rvlm::core::TaskGraph;
+using rvlm::core::regionOf;
+
+namespace {
+
+typedef IndexBox<std::ptrdiff_t> Box;
+typedef TaskGraph::Regions Regions;
+
+/**
+ * Log of task numbers in order of completion.
+ */
+class Log {
+public:
+    void record(int task) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mOrder.push_back(task);
+    }
+
+    std::size_t position(int task) const {
+        for (std::size_t i = 0; i < mOrder.size(); ++i) {
+            if (mOrder[i] == task)
+                return i;
+        }
+        return mOrder.size();
+    }
+
+    std::size_t size() const { return mOrder.size(); }
+
+private:
+    std::mutex       mMutex;
+    std::vector<int> mOrder;
+};
+
+} // namespace
+
+TEST_CASE("TaskGraph orders tasks touching overlapping regions", "rvlm::core::TaskGraph") {
+    for (unsigned workers = 1; workers <= 4; ++workers) {
+        SolidArray3d<int> a(8, 8, 8, 0), b(8, 8, 8, 0);
+        Box left(0, 4, 0, 8, 0, 8), right(4, 8, 0, 8, 0, 8);
+        Log log;
+        TaskGraph graph(workers);
+        REQUIRE(graph.getWorkerCount() == workers);
+
+        // 0 writes left of a, 1 reads it: read after write.
+        // 2 writes left of a again: write after read and write.
+        // 3 touches right of a only and depends on nothing.
+        // 4 reads a whole and b, so waits for 0, 2 and 3.
+        graph.add([&] { log.record(0); }, Regions(), Regions(1, regionOf(a, left)));
+        graph.add([&] { log.record(1); }, Regions(1, regionOf(a, left)),
+                  Regions(1, regionOf(b, left)));
+        graph.add([&] { log.record(2); }, Regions(), Regions(1, regionOf(a, left)));
+        graph.add([&] { log.record(3); }, Regions(), Regions(1, regionOf(a, right)));
+        Regions both;
+        both.push_back(regionOf(a));
+        both.push_back(regionOf(b));
+        graph.add([&] { log.record(4); }, both, Regions());
+        graph.wait();
+
+        REQUIRE(log.size() == 5);
+        REQUIRE(log.position(0) < log.position(1));
+        REQUIRE(log.position(1) < log.position(2));
+        REQUIRE(log.position(2) < log.position(4));
+        REQUIRE(log.position(3) < log.position(4));
+    }
+}
+
+TEST_CASE("TaskGraph keeps sequential results of slab sweeps", "rvlm::core::TaskGraph") {
+    const int N = 16, SLABS = 4, STEPS = 10;
+    for (unsigned workers = 1; workers <= 3; ++workers) {
+        SolidArray3d<int> u(N, N, N, 1), v(N, N, N, 0);
+        TaskGraph graph(workers);
+
+        // Each step makes v from neighbouring x-planes of u and then u from
+        // v, slab by slab; a slab reads one plane beyond its own on both
+        // sides, which is what links tasks of neighbouring slabs.
+        for (int step = 0; step < STEPS; ++step) {
+            for (int pass = 0; pass < 2; ++pass) {
+                SolidArray3d<int>& src = pass == 0 ? u : v;
+                SolidArray3d<int>& dst = pass == 0 ? v : u;
+                for (int s = 0; s < SLABS; ++s) {
+                    const int x0 = s*N/SLABS, x1 = (s + 1)*N/SLABS;
+                    Box own(x0, x1, 0, N, 0, N);
+                    Box halo(std::max(x0 - 1, 0), std::min(x1 + 1, N), 0, N, 0, N);
+                    graph.add([&src, &dst, x0, x1, N] {
+                        for (int ix = x0; ix < x1; ++ix)
+                        for (int iy = 0; iy < N; ++iy)
+                        for (int iz = 0; iz < N; ++iz) {
+                            int left  = ix > 0     ? src.at(ix - 1, iy, iz) : 0;
+                            int right = ix < N - 1 ? src.at(ix + 1, iy, iz) : 0;
+                            dst.at(ix, iy, iz) = (left + right + 3*src.at(ix, iy, iz)) % 1009;
+                        }
+                    }, Regions(1, regionOf(src, halo)), Regions(1, regionOf(dst, own)));
+                }
+            }
+        }
+        graph.wait();
+
+        SolidArray3d<int> eu(N, N, N, 1), ev(N, N, N, 0);
+        for (int step = 0; step < STEPS; ++step) {
+            for (int pass = 0; pass < 2; ++pass) {
+                SolidArray3d<int>& src = pass == 0 ? eu : ev;
+                SolidArray3d<int>& dst = pass == 0 ? ev : eu;
+                for (int ix = 0; ix < N; ++ix)
+                for (int iy = 0; iy < N; ++iy)
+                for (int iz = 0; iz < N; ++iz) {
+                    int left  = ix > 0     ? src.at(ix - 1, iy, iz) : 0;
+                    int right = ix < N - 1 ? src.at(ix + 1, iy, iz) : 0;
+                    dst.at(ix, iy, iz) = (left + right + 3*src.at(ix, iy, iz)) % 1009;
+                }
+            }
+        }
+
+        bool same = true;
+        for (int ix = 0; ix < N; ++ix)
+        for (int iy = 0; iy < N; ++iy)
+        for (int iz = 0; iz < N; ++iz)
+            same = same && u.at(ix, iy, iz) == eu.at(ix, iy, iz);
+        REQUIRE(same);
+    }
+}
+
+TEST_CASE("TaskGraph honours explicit dependencies", "rvlm::core::TaskGraph") {
+    Log log;
+    TaskGraph graph(2);
+    TaskGraph::TaskId first = graph.add([&] { log.record(0); }, Regions(), Regions());
+    graph.add([&] { log.record(1); }, Regions(), Regions(),
+              std::vector<TaskGraph::TaskId>(1, first));
+    graph.wait();
+    REQUIRE(log.size() == 2);
+    REQUIRE(log.position(0) < log.position(1));
+}
+
+TEST_CASE("TaskGraph runs tasks added by tasks", "rvlm::core::TaskGraph") {
+    std::atomic<int> count(0);
+    TaskGraph graph(2);
+    for (int i = 0; i < 10; ++i) {
+        graph.add([&] {
+            for (int k = 0; k < 10; ++k)
+                graph.add([&] { ++count; }, Regions(), Regions());
+        }, Regions(), Regions());
+    }
+    graph.wait();
+    REQUIRE(count.load() == 100);
+
+    // The graph is reusable after waiting.
+    graph.add([&] { ++count; }, Regions(), Regions());
+    graph.wait();
+    REQUIRE(count.load() == 101);
+}
+
+TEST_CASE("TaskGraph reports the first failure", "rvlm::core::TaskGraph") {
+    SolidArray3d<int> a(4, 4, 4, 0);
+    std::atomic<int> count(0);
+    TaskGraph graph(2);
+    graph.add([] { throw std::runtime_error("task failed"); },
+              Regions(), Regions(1, regionOf(a)));
+    graph.add([&] { ++count; }, Regions(1, regionOf(a)), Regions());
+    REQUIRE_THROWS_AS(graph.wait(), std::runtime_error);
+    REQUIRE(count.load() == 0);
+
+    graph.add([&] { ++count; }, Regions(1, regionOf(a)), Regions());
+    graph.wait();
+    REQUIRE(count.load() == 1);
+}
@@ -0,0 +1,120 @@
+#include <catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "rvlm/core/Trace.hh"
+#include "rvlm/core/memory/OperatorNewAllocator.hh"
+#include "rvlm/core/memory/TracingAllocator.hh"
+using rvlm::core::TracePhase;
+using rvlm::core::TraceScope;
+using rvlm::core::TraceSession;
+using rvlm::core::traceEvent;
+using rvlm::core::traceThreadName;
+using rvlm::core::memory::OperatorNewAllocator;
+using rvlm::core::memory::TracingAllocator;
+
+namespace {
+
+const char* const PATH = "Trace_test.json";
+
+std::string readTrace() {
+    std::ifstream in(PATH);
+    std::ostringstream s;
+    s << in.rdbuf();
+    return s.str();
+}
+
+std::size_t occurrences(std::string const& text, std::string const& what) {
+    std::size_t n = 0;
+    for (std::size_t p = text.find(what); p != std::string::npos;
+            p = text.find(what, p + 1))
+        ++n;
+    return n;
+}
+
+} // namespace
+
+TEST_CASE("TraceSession writes events in Chrome trace format", "rvlm::core::Trace") {
+    traceEvent(TracePhase::Instant, "before");
+    {
+        TraceSession session(PATH, 10);
+        traceThreadName("main \"thread\"");
+        {
+            TraceScope scope("outer", 42);
+            traceEvent(TracePhase::Instant, "tick");
+            traceEvent(TracePhase::Counter, "cells", 7);
+        }
+        session.flush();
+        REQUIRE(session.getEventCount() == 4);
+        REQUIRE(session.getDroppedCount() == 0);
+
+        OperatorNewAllocator heap;
+        TracingAllocator allocator(&heap);
+        allocator.deallocate(allocator.allocate(100));
+        session.flush();
+        REQUIRE(session.getEventCount() == 8);
+    }
+    traceEvent(TracePhase::Instant, "after");
+
+    std::string trace = readTrace();
+    std::remove(PATH);
+    REQUIRE(trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") == 0);
+    REQUIRE(trace.find("]}") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"outer\",\"ph\":\"B\"") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"outer\",\"ph\":\"E\"") != std::string::npos);
+    REQUIRE(trace.find("\"args\":{\"value\":42}") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"tick\",\"ph\":\"i\"") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"cells\",\"ph\":\"C\"") != std::string::npos);
+    REQUIRE(trace.find("\"args\":{\"value\":100}") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"deallocate\",\"ph\":\"E\"") != std::string::npos);
+    REQUIRE(trace.find("\"args\":{\"name\":\"main \\\"thread\\\"\"}") != std::string::npos);
+    REQUIRE(trace.find("before") == std::string::npos);
+    REQUIRE(trace.find("after") == std::string::npos);
+
+    // Time stamps are microseconds from the start and never go back.
+    std::size_t begin = trace.find("\"ts\":");
+    std::size_t end = trace.find("\"ts\":", begin + 1);
+    double t0 = std::stod(trace.substr(begin + 5));
+    double t1 = std::stod(trace.substr(end + 5));
+    REQUIRE(t0 >= 0);
+    REQUIRE(t1 >= t0);
+    REQUIRE(t1 < 1e6);
+}
+
+TEST_CASE("TraceSession collects events of all threads", "rvlm::core::Trace") {
+    const int EVENTS = 1000;
+    std::size_t count;
+    {
+        TraceSession session(PATH, 1);
+
+        std::thread workers[4];
+        for (int t = 0; t < 4; ++t) {
+            workers[t] = std::thread([t] {
+                traceThreadName("worker " + std::to_string(t));
+                for (int i = 0; i < EVENTS; ++i) {
+                    TraceScope scope("work");
+                }
+            });
+        }
+        for (int t = 0; t < 4; ++t)
+            workers[t].join();
+        session.flush();
+        count = session.getEventCount() + session.getDroppedCount();
+
+        // A rejected session must leave the running session's file alone.
+        REQUIRE_THROWS_AS(TraceSession(PATH), std::logic_error);
+    }
+
+    std::string trace = readTrace();
+    std::remove(PATH);
+    REQUIRE(trace.compare(0, 18, "{\"displayTimeUnit\"") == 0);
+    REQUIRE(count == 4 * 2 * EVENTS);
+    REQUIRE(occurrences(trace, "\"name\":\"work\"") == 4 * 2 * EVENTS);
+    for (int t = 0; t < 4; ++t)
+        REQUIRE(trace.find("worker " + std::to_string(t)) != std::string::npos);
+
+    REQUIRE_THROWS_AS(TraceSession("no/such/directory/trace.json"), std::runtime_error);
+}
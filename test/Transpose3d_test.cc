@@ -0,0 +1,117 @@
+#include <catch.hpp>
+#include <stdexcept>
+#include "rvlm/core/Transpose3d.hh"
+using rvlm::core::Execution;
+using rvlm::core::HalfOpenRange;
+using rvlm::core::SolidArray3d;
+namespace algo = rvlm::core;
+
+namespace {
+
+const int PERMUTATIONS[6][3] = {
+    { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+
+template <typename TValue>
+void enumerate(SolidArray3d<TValue, int>& a) {
+    for (int ix = a.getBeginX(); ix < a.getEndX(); ++ix)
+    for (int iy = a.getBeginY(); iy < a.getEndY(); ++iy)
+    for (int iz = a.getBeginZ(); iz < a.getEndZ(); ++iz)
+        a.at(ix, iy, iz) = static_cast<TValue>(10000*ix + 100*iy + iz);
+}
+
+/**
+ * Checks that <tt>dst(j) == src(i)</tt> with <tt>i[axes[k]] == j[k]</tt>,
+ * indices counted from array beginnings.
+ */
+template <typename TValue>
+bool isPermutation(SolidArray3d<TValue, int> const& src,
+                   SolidArray3d<TValue, int> const& dst, int const axes[3]) {
+    int srcBegin[3] = { src.getBeginX(), src.getBeginY(), src.getBeginZ() };
+    for (int j0 = 0; j0 < dst.getCountX(); ++j0)
+    for (int j1 = 0; j1 < dst.getCountY(); ++j1)
+    for (int j2 = 0; j2 < dst.getCountZ(); ++j2) {
+        int j[3] = { j0, j1, j2 }, i[3];
+        for (int k = 0; k < 3; ++k)
+            i[axes[k]] = srcBegin[axes[k]] + j[k];
+        if (dst.at(dst.getBeginX() + j0, dst.getBeginY() + j1, dst.getBeginZ() + j2)
+                != src.at(i[0], i[1], i[2]))
+            return false;
+    }
+    return true;
+}
+
+template <typename TValue>
+void checkAllPermutations(Execution exec) {
+    const int n[3] = { 13, 37, 45 };
+    SolidArray3d<TValue, int> src(HalfOpenRange<int>(-4, -4 + n[0]),
+                                  HalfOpenRange<int>(2, 2 + n[1]),
+                                  HalfOpenRange<int>(0, n[2]), TValue());
+    enumerate(src);
+    for (int p = 0; p < 6; ++p) {
+        int const* axes = PERMUTATIONS[p];
+        SolidArray3d<TValue, int> dst(HalfOpenRange<int>(1, 1 + n[axes[0]]),
+                                      HalfOpenRange<int>(0, n[axes[1]]),
+                                      HalfOpenRange<int>(-7, -7 + n[axes[2]]),
+                                      TValue());
+        algo::permuteAxes(src, dst, axes, exec);
+        REQUIRE(isPermutation(src, dst, axes));
+    }
+}
+
+template <typename TValue>
+void checkInPlace(int n) {
+    SolidArray3d<TValue, int> original(n, n, n, TValue());
+    enumerate(original);
+    for (int p = 0; p < 6; ++p) {
+        SolidArray3d<TValue, int> a(n, n, n, TValue());
+        enumerate(a);
+        algo::permuteAxesInPlace(a, PERMUTATIONS[p], Execution::Parallel);
+        REQUIRE(isPermutation(original, a, PERMUTATIONS[p]));
+    }
+}
+
+} // namespace
+
+TEST_CASE("permuteAxes handles all permutations", "rvlm::core::Transpose3d") {
+    checkAllPermutations<double>(Execution::Sequential);
+    checkAllPermutations<float>(Execution::Sequential);
+    checkAllPermutations<int>(Execution::Sequential);
+    checkAllPermutations<double>(Execution::Parallel);
+    checkAllPermutations<float>(Execution::Parallel);
+}
+
+TEST_CASE("permuteAxes with static axes matches at<>", "rvlm::core::Transpose3d") {
+    SolidArray3d<double, int> src(5, 6, 7, 0.0), dst(7, 5, 6, 0.0);
+    enumerate(src);
+    algo::permuteAxes<2, 0, 1>(src, dst);
+    for (int i = 0; i < 7; ++i)
+    for (int j = 0; j < 5; ++j)
+    for (int k = 0; k < 6; ++k)
+        REQUIRE(dst.at(i, j, k) == src.at<2, 0, 1>(i, j, k));
+}
+
+TEST_CASE("permuteAxesInPlace handles all permutations of cubes", "rvlm::core::Transpose3d") {
+    checkInPlace<double>(37);
+    checkInPlace<float>(40);
+    checkInPlace<int>(9);
+
+    SolidArray3d<double, int> a(6, 6, 6, 0.0), b(6, 6, 6, 0.0), c(6, 6, 6, 0.0);
+    enumerate(a);
+    enumerate(b);
+    algo::permuteAxesInPlace<1, 2, 0>(a);
+    algo::permuteAxes<1, 2, 0>(b, c);
+    for (int i = 0; i < 6; ++i)
+    for (int j = 0; j < 6; ++j)
+    for (int k = 0; k < 6; ++k)
+        REQUIRE(a.at(i, j, k) == c.at(i, j, k));
+}
+
+TEST_CASE("permuteAxes rejects wrong arguments", "rvlm::core::Transpose3d") {
+    SolidArray3d<double, int> a(4, 5, 6, 0.0), b(4, 5, 6, 0.0), c(6, 6, 6, 0.0);
+    const int bad[3] = { 0, 0, 2 }, swap[3] = { 1, 0, 2 }, same[3] = { 0, 1, 2 };
+    REQUIRE_THROWS_AS(algo::permuteAxes(a, b, bad), std::invalid_argument);
+    REQUIRE_THROWS_AS(algo::permuteAxes(a, b, swap), std::invalid_argument);
+    REQUIRE_THROWS_AS(algo::permuteAxes(a, a, same), std::invalid_argument);
+    REQUIRE_THROWS_AS(algo::permuteAxesInPlace(a, swap), std::invalid_argument);
+    REQUIRE_THROWS_AS(algo::permuteAxesInPlace(c, bad), std::invalid_argument);
+}
@@ -0,0 +1,165 @@
+#include <catch.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "rvlm/core/TrilinearSampler.hh"
+using rvlm::core::GridGeometry;
+using rvlm::core::HalfOpenRange;
+using rvlm::core::SolidArray3d;
+using rvlm::core::TrilinearSampler;
+using rvlm::core::Vector3d;
+namespace core = rvlm::core;
+
+namespace {
+
+typedef SolidArray3d<double, int> Array;
+typedef Vector3d<double> V;
+
+const GridGeometry<double> GRID(V(-1.0, 0.5, 2.0), V(0.1, 0.2, 0.25));
+
+/**
+ * Straightforward scalar interpolation with clamping to the outermost
+ * sample points, used as a reference.
+ */
+double reference(Array const& a, V const& stagger, V const& r) {
+    double u[3];
+    int lo[3];
+    int begin[3] = { a.getBeginX(), a.getBeginY(), a.getBeginZ() };
+    int end[3]   = { a.getEndX(),   a.getEndY(),   a.getEndZ() };
+    for (int axis = 0; axis < 3; ++axis) {
+        u[axis] = GRID.toGrid(axis, r.get(axis)) - stagger.get(axis);
+        u[axis] = std::min(std::max(u[axis], double(begin[axis])), double(end[axis] - 1));
+        lo[axis] = std::min(static_cast<int>(std::floor(u[axis])), end[axis] - 2);
+        u[axis] -= lo[axis];
+    }
+    double sum = 0;
+    for (int c = 0; c < 8; ++c) {
+        int dx = c >> 2, dy = (c >> 1) & 1, dz = c & 1;
+        double w = (dx ? u[0] : 1 - u[0]) * (dy ? u[1] : 1 - u[1])
+                 * (dz ? u[2] : 1 - u[2]);
+        sum += w * a.at(lo[0] + dx, lo[1] + dy, lo[2] + dz);
+    }
+    return sum;
+}
+
+void fillRandom(Array& a, std::mt19937& rng) {
+    std::uniform_real_distribution<double> value(-1, 1);
+    for (int ix = a.getBeginX(); ix < a.getEndX(); ++ix)
+    for (int iy = a.getBeginY(); iy < a.getEndY(); ++iy)
+    for (int iz = a.getBeginZ(); iz < a.getEndZ(); ++iz)
+        a.at(ix, iy, iz) = value(rng);
+}
+
+} // namespace
+
+TEST_CASE("Sampler matches scalar interpolation on staggered components", "rvlm::core::TrilinearSampler") {
+    std::mt19937 rng(5);
+    Array ex(HalfOpenRange<int>(2, 12), HalfOpenRange<int>(-3, 5), HalfOpenRange<int>(0, 7), 0.0);
+    Array ey(HalfOpenRange<int>(2, 12), HalfOpenRange<int>(-3, 5), HalfOpenRange<int>(0, 7), 0.0);
+    Array ez(HalfOpenRange<int>(2, 12), HalfOpenRange<int>(-3, 5), HalfOpenRange<int>(0, 7), 0.0);
+    Array rho(HalfOpenRange<int>(2, 12), HalfOpenRange<int>(-3, 5), HalfOpenRange<int>(0, 7), 0.0);
+    fillRandom(ex, rng);
+    fillRandom(ey, rng);
+    fillRandom(ez, rng);
+    fillRandom(rho, rng);
+
+    const V staggers[4] = { V(0.5, 0, 0), V(0, 0.5, 0), V(0, 0, 0.5), V(0.5, 0.5, 0.5) };
+    Array const* arrays[4] = { &ex, &ey, &ez, &rho };
+
+    TrilinearSampler<double, int> sampler(GRID);
+    for (int c = 0; c < 4; ++c)
+        REQUIRE(sampler.addComponent(*arrays[c], staggers[c]) == std::size_t(c));
+
+    // Some positions lie outside of the arrays, count leaves a tail.
+    const std::size_t n = 203;
+    std::uniform_real_distribution<double> px(-1.0 + 0.1, -1.0 + 1.3);
+    std::uniform_real_distribution<double> py(0.5 - 0.8, 0.5 + 1.1);
+    std::uniform_real_distribution<double> pz(2.0 - 0.2, 2.0 + 1.9);
+    std::vector<double> xs(n), ys(n), zs(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        xs[i] = px(rng);
+        ys[i] = py(rng);
+        zs[i] = pz(rng);
+    }
+
+    std::vector<double> out[4];
+    double* outs[4];
+    for (int c = 0; c < 4; ++c) {
+        out[c].assign(n, 0.0);
+        outs[c] = out[c].data();
+    }
+    sampler.sample(xs.data(), ys.data(), zs.data(), n, outs);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        V r(xs[i], ys[i], zs[i]);
+        double single[4];
+        sampler.sample(r, single);
+        for (int c = 0; c < 4; ++c) {
+            double expected = reference(*arrays[c], staggers[c], r);
+            REQUIRE(out[c][i] == Approx(expected).margin(1e-12));
+            REQUIRE(single[c] == out[c][i]);
+        }
+    }
+}
+
+TEST_CASE("Sampler reproduces linear fields", "rvlm::core::TrilinearSampler") {
+    SolidArray3d<float> f(8, 9, 10, 0.0f);
+    GridGeometry<float> grid(Vector3d<float>(0, 0, 0), Vector3d<float>(1, 1, 1));
+    for (std::size_t ix = 0; ix < 8; ++ix)
+    for (std::size_t iy = 0; iy < 9; ++iy)
+    for (std::size_t iz = 0; iz < 10; ++iz)
+        f.at(ix, iy, iz) = 2.0f*ix - 1.0f*iy + 0.5f*iz;
+
+    TrilinearSampler<float> sampler(grid);
+    sampler.addComponent(f);
+    std::vector<float> xs, ys, zs;
+    for (int i = 0; i < 50; ++i) {
+        xs.push_back(0.13f * i);
+        ys.push_back(0.151f * i);
+        zs.push_back(8.9f - 0.17f * i);
+    }
+    std::vector<float> out(xs.size());
+    float* outs[1] = { out.data() };
+    sampler.sample(xs.data(), ys.data(), zs.data(), xs.size(), outs);
+    for (std::size_t i = 0; i < xs.size(); ++i)
+        REQUIRE(out[i] == Approx(2*xs[i] - ys[i] + 0.5f*zs[i]).epsilon(1e-5).margin(1e-5));
+
+    SolidArray3d<float> thin(8, 1, 10, 0.0f);
+    REQUIRE_THROWS_AS(sampler.addComponent(thin), std::invalid_argument);
+}
+
+TEST_CASE("Positions sort by containing cell", "rvlm::core::sortByCell") {
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> coord(-1.5, 3.0);
+    std::vector<double> xs(500), ys(500), zs(500);
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        xs[i] = coord(rng);
+        ys[i] = coord(rng);
+        zs[i] = coord(rng);
+    }
+    core::IndexBox<> box(-2, 8, 0, 6, 1, 9);
+    std::vector<std::size_t> p = core::sortByCell(GRID, box, xs.data(),
+                                                  ys.data(), zs.data(), xs.size());
+
+    std::vector<std::size_t> sorted(p);
+    std::sort(sorted.begin(), sorted.end());
+    for (std::size_t i = 0; i < sorted.size(); ++i)
+        REQUIRE(sorted[i] == i);
+
+    core::applyPermutation(p, xs);
+    core::applyPermutation(p, ys);
+    core::applyPermutation(p, zs);
+    long previous = -1;
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        long key = 0;
+        V r(xs[i], ys[i], zs[i]);
+        for (int axis = 0; axis < 3; ++axis) {
+            long cell = static_cast<long>(GRID.cellIndex(axis, r.get(axis)));
+            cell = std::min(std::max(cell, long(box.start[axis])), long(box.stop[axis] - 1));
+            key = key * box.size(axis) + (cell - box.start[axis]);
+        }
+        REQUIRE(key >= previous);
+        previous = key;
+    }
+}
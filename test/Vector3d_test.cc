@@ -0,0 +1,114 @@
+#include <catch.hpp>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "rvlm/core/Vector3d.hh"
+#include "rvlm/core/Vector3dPack.hh"
+using rvlm::core::Vector3d;
+using rvlm::core::Vector3dPack;
+using rvlm::core::SolidArray3d;
+
+TEST_CASE("Vector arithmetic works", "rvlm::core::Vector3d") {
+    typedef Vector3d<double> V;
+
+    constexpr V ex(1, 0, 0);
+    constexpr V ey(0, 1, 0);
+    static_assert(ex.cross(ey) == V(0, 0, 1), "");
+    static_assert(ey.cross(ex) == V(0, 0, -1), "");
+    static_assert((ex + ey*2).dot(ey) == 2, "");
+    static_assert((2.0*ex - ey).normSquared() == 5, "");
+
+    V a(1, 2, 3), b(-4, 5, 0.5);
+    V c = a.cross(b);
+    REQUIRE(c == V(2*0.5 - 3*5, 3*-4 - 1*0.5, 1*5 - 2*-4));
+    REQUIRE(c.dot(a) == Approx(0));
+    REQUIRE(V(3, 4, 0).norm() == 5);
+    REQUIRE(V(0, 0, 2).normalized() == V(0, 0, 1));
+
+    a += b;
+    REQUIRE(a == V(-3, 7, 3.5));
+    a /= 2;
+    REQUIRE(a == V(-1.5, 3.5, 1.75));
+}
+
+namespace {
+
+template <typename T>
+bool sameOrBothNaN(Vector3d<T> const& a, Vector3d<T> const& b) {
+    for (int axis = 0; axis < 3; ++axis) {
+        T x = a.get(axis), y = b.get(axis);
+        if (!(x == y || (std::isnan(x) && std::isnan(y))))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("Vector cross product keeps non-finite values", "rvlm::core::Vector3d") {
+    typedef Vector3d<double> V;
+    typedef Vector3dPack<double, 4> Pack;
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    V c = V(inf, 0, 0).cross(V(0, 1, 0));
+    REQUIRE(c.getX() == 0);
+    REQUIRE(std::isnan(c.getY()));
+    REQUIRE(c.getZ() == inf);
+
+    const V as[4] = { V(inf, 0, 0), V(1, -inf, 2), V(nan, 1, 0), V(1.5, 2, -3) };
+    const V bs[4] = { V(0, 1, 0), V(0, 0, 1), V(0, 0, 1), V(-4, inf, 0.25) };
+    double ax[4], ay[4], az[4], bx[4], by[4], bz[4];
+    for (std::size_t i = 0; i < 4; ++i) {
+        ax[i] = as[i].getX(); ay[i] = as[i].getY(); az[i] = as[i].getZ();
+        bx[i] = bs[i].getX(); by[i] = bs[i].getY(); bz[i] = bs[i].getZ();
+    }
+    Pack cross = Pack::load(ax, ay, az).cross(Pack::load(bx, by, bz));
+    for (std::size_t i = 0; i < 4; ++i)
+        REQUIRE(sameOrBothNaN(as[i].cross(bs[i]), cross.get(i)));
+}
+
+template <typename T, std::size_t W>
+void checkPack() {
+    typedef Vector3dPack<T, W> Pack;
+    typedef Vector3d<T> V;
+
+    std::vector<T> ax, ay, az, bx, by, bz;
+    for (std::size_t i = 0; i < W; ++i) {
+        ax.push_back(T(i) + 1);  ay.push_back(T(2) - T(i)); az.push_back(T(0.5)*T(i));
+        bx.push_back(T(3) - T(i)); by.push_back(T(i)*T(i)); bz.push_back(T(1));
+    }
+
+    Pack a = Pack::load(ax.data(), ay.data(), az.data());
+    Pack b = Pack::load(bx.data(), by.data(), bz.data());
+    Pack sum   = a + b * T(2);
+    Pack cross = a.cross(b);
+    T dots[W];
+    Pack::Simd::store(dots, a.dot(b));
+
+    for (std::size_t i = 0; i < W; ++i) {
+        V va(ax[i], ay[i], az[i]), vb(bx[i], by[i], bz[i]);
+        REQUIRE(sum.get(i) == va + vb*T(2));
+        REQUIRE(cross.get(i) == va.cross(vb));
+        REQUIRE(dots[i] == Approx(va.dot(vb)));
+    }
+
+    SolidArray3d<T> fx(3, 4, 5, T(0)), fy(3, 4, 5, T(0)), fz(3, 4, 5, T(0));
+    std::vector<std::size_t> offsets;
+    for (std::size_t i = 0; i < W; ++i)
+        offsets.push_back(fx.getOffset(i % 3, (i*7) % 4, (i*3) % 5));
+    Pack single(V(1, 2, 3));
+    single.scatter(fx, fy, fz, offsets.data());
+    Pack loaded = Pack::gather(fx, fy, fz, offsets.data());
+    for (std::size_t i = 0; i < W; ++i)
+        REQUIRE(loaded.get(i) == V(1, 2, 3));
+    REQUIRE(fy.at(0, 0, 0) == T(2));
+}
+
+TEST_CASE("Vector packs work", "rvlm::core::Vector3dPack") {
+    checkPack<double, 1>();
+    checkPack<double, 4>();
+    checkPack<double, 8>();
+    checkPack<float, 8>();
+    checkPack<float, 16>();
+}
@@ -0,0 +1,55 @@
+#include <catch.hpp>
+#include "rvlm/core/Voxelizer.hh"
+using rvlm::core::Cuboid;
+using rvlm::core::GridGeometry;
+using rvlm::core::HalfOpenRange;
+using rvlm::core::SolidArray3d;
+using rvlm::core::Vector3d;
+using rvlm::core::Voxelizer;
+
+TEST_CASE("Voxelizer works", "rvlm::core::Voxelizer") {
+    typedef Vector3d<double> V;
+    typedef HalfOpenRange<int> Range;
+    GridGeometry<double> grid(V(0, 0, 0), V(0.5, 0.5, 0.5));
+    SolidArray3d<double, int> array(Range(-2, 10), Range(0, 8), Range(0, 8), 0.0);
+
+    SECTION("Priorities and clipping") {
+        Voxelizer<double, double> voxelizer(grid);
+        voxelizer.add(Cuboid<double>(-10, 0, 0, 10, 4, 4), 1.0, 0);
+        voxelizer.add(Cuboid<double>(2, 1, 1, 1, 2, 2), 3.0, 5);
+        voxelizer.add(Cuboid<double>(1, 1, 1, 2, 2, 2), 2.0, 0);
+        voxelizer.fill(array);
+
+        REQUIRE(array.at(-2, 0, 0) == 1.0);
+        REQUIRE(array.at(9, 7, 7) == 1.0);
+        REQUIRE(array.at(2, 2, 2) == 3.0);
+        REQUIRE(array.at(3, 3, 3) == 3.0);
+        REQUIRE(array.at(4, 3, 3) == 1.0);
+    }
+
+    SECTION("Cell centers decide coverage") {
+        Voxelizer<double, double> voxelizer(grid);
+        voxelizer.add(Cuboid<double>(0.3, 0.3, 0.3, 0.8, 0.8, 0.76), 1.0);
+        voxelizer.add(Cuboid<double>(0.3, 2.0, 0.3, 0.8, 2.2, 0.76), 1.0);
+        voxelizer.fill(array);
+
+        // Grid coordinates of the first cuboid are [0.6, 1.6) x [0.6, 1.6) x
+        // [0.6, 1.52), so only cell 1 has its center inside. The second one
+        // spans [4.0, 4.4) along Y and misses center 4.5 entirely.
+        REQUIRE(array.at(1, 1, 1) == 1.0);
+        REQUIRE(array.at(0, 1, 1) == 0.0);
+        REQUIRE(array.at(1, 1, 2) == 0.0);
+        REQUIRE(array.at(1, 4, 1) == 0.0);
+    }
+
+    SECTION("Averaged fill") {
+        Voxelizer<double, double> voxelizer(grid);
+        voxelizer.add(Cuboid<double>(0.25, 0, 0, 1.0, 0.5, 0.5), 4.0);
+        voxelizer.fillAveraged(array);
+
+        REQUIRE(array.at(0, 0, 0) == Approx(2.0));
+        REQUIRE(array.at(1, 0, 0) == Approx(4.0));
+        REQUIRE(array.at(2, 0, 0) == 0.0);
+        REQUIRE(array.at(0, 1, 0) == 0.0);
+    }
+}
@@ -0,0 +1,243 @@
+#include <catch.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "rvlm/core/YeeUpdater.hh"
+using rvlm::core::CellMedium;
+using rvlm::core::Constants;
+using rvlm::core::HalfOpenRange;
+using rvlm::core::MaterialMedium;
+using rvlm::core::SolidArray3d;
+using rvlm::core::UniformMedium;
+using rvlm::core::Vector3d;
+using rvlm::core::YeeUpdater;
+
+namespace {
+
+const int NX = 9, NY = 6, NZ = 5;
+const int BX = -3, BY = 2, BZ = 0;
+
+/**
+ * Straightforward Yee update with every component written out by hand,
+ * used as a reference. Fields outside the grid are zero.
+ */
+struct Reference {
+    std::vector<double> f[6];  // Ex, Ey, Ez, Hx, Hy, Hz
+    std::vector<double> invEps, invMu;
+    double dx, dy, dz, dt;
+
+    static int idx(int i, int j, int k) { return (i*NY + j)*NZ + k; }
+
+    double get(int c, int i, int j, int k) const {
+        if (i < 0 || i >= NX || j < 0 || j >= NY || k < 0 || k >= NZ)
+            return 0;
+        return f[c][idx(i, j, k)];
+    }
+
+    void step() {
+        const double ch = dt / Constants<double>::MU_0();
+        const double ce = dt / Constants<double>::EPS_0();
+        std::vector<double> g[6];
+        for (int c = 0; c < 6; ++c) g[c] = f[c];
+
+        for (int i = 0; i < NX; ++i)
+        for (int j = 0; j < NY; ++j)
+        for (int k = 0; k < NZ; ++k) {
+            int n = idx(i, j, k);
+            double m = ch * invMu[n];
+            g[3][n] -= m * ((get(2, i, j+1, k) - get(2, i, j, k))/dy
+                          - (get(1, i, j, k+1) - get(1, i, j, k))/dz);
+            g[4][n] -= m * ((get(0, i, j, k+1) - get(0, i, j, k))/dz
+                          - (get(2, i+1, j, k) - get(2, i, j, k))/dx);
+            g[5][n] -= m * ((get(1, i+1, j, k) - get(1, i, j, k))/dx
+                          - (get(0, i, j+1, k) - get(0, i, j, k))/dy);
+        }
+        for (int c = 3; c < 6; ++c) f[c] = g[c];
+
+        for (int i = 0; i < NX; ++i)
+        for (int j = 0; j < NY; ++j)
+        for (int k = 0; k < NZ; ++k) {
+            int n = idx(i, j, k);
+            double e = ce * invEps[n];
+            g[0][n] += e * ((get(5, i, j, k) - get(5, i, j-1, k))/dy
+                          - (get(4, i, j, k) - get(4, i, j, k-1))/dz);
+            g[1][n] += e * ((get(3, i, j, k) - get(3, i, j, k-1))/dz
+                          - (get(5, i, j, k) - get(5, i-1, j, k))/dx);
+            g[2][n] += e * ((get(4, i, j, k) - get(4, i-1, j, k))/dx
+                          - (get(3, i, j, k) - get(3, i, j-1, k))/dy);
+        }
+        for (int c = 0; c < 3; ++c) f[c] = g[c];
+    }
+};
+
+typedef SolidArray3d<double, int> Array;
+
+struct Fields {
+    Array ex, ey, ez, hx, hy, hz;
+    Array* all[6];
+
+    Fields()
+        : ex(HalfOpenRange<int>(BX, BX+NX), HalfOpenRange<int>(BY, BY+NY),
+             HalfOpenRange<int>(BZ, BZ+NZ), 0.0),
+          ey(HalfOpenRange<int>(BX, BX+NX), HalfOpenRange<int>(BY, BY+NY),
+             HalfOpenRange<int>(BZ, BZ+NZ), 0.0),
+          ez(HalfOpenRange<int>(BX, BX+NX), HalfOpenRange<int>(BY, BY+NY),
+             HalfOpenRange<int>(BZ, BZ+NZ), 0.0),
+          hx(HalfOpenRange<int>(BX, BX+NX), HalfOpenRange<int>(BY, BY+NY),
+             HalfOpenRange<int>(BZ, BZ+NZ), 0.0),
+          hy(HalfOpenRange<int>(BX, BX+NX), HalfOpenRange<int>(BY, BY+NY),
+             HalfOpenRange<int>(BZ, BZ+NZ), 0.0),
+          hz(HalfOpenRange<int>(BX, BX+NX), HalfOpenRange<int>(BY, BY+NY),
+             HalfOpenRange<int>(BZ, BZ+NZ), 0.0),
+          all{&ex, &ey, &ez, &hx, &hy, &hz} {}
+
+    void load(Reference const& ref) {
+        for (int c = 0; c < 6; ++c)
+            for (int i = 0; i < NX; ++i)
+            for (int j = 0; j < NY; ++j)
+            for (int k = 0; k < NZ; ++k)
+                all[c]->at(BX+i, BY+j, BZ+k) = ref.f[c][Reference::idx(i, j, k)];
+    }
+
+    double maxDifference(Reference const& ref) const {
+        double d = 0;
+        for (int c = 0; c < 6; ++c)
+            for (int i = 0; i < NX; ++i)
+            for (int j = 0; j < NY; ++j)
+            for (int k = 0; k < NZ; ++k) {
+                double a = all[c]->at(BX+i, BY+j, BZ+k);
+                double b = ref.f[c][Reference::idx(i, j, k)];
+                d = std::max(d, std::fabs(a - b) / (1 + std::fabs(b)));
+            }
+        return d;
+    }
+};
+
+Reference makeReference(bool uniform) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> value(-1, 1);
+    std::uniform_real_distribution<double> material(0.25, 1);
+
+    Reference ref;
+    ref.dx = 1e-3; ref.dy = 2e-3; ref.dz = 1.5e-3;
+    ref.dt = 0.9 * YeeUpdater<double>::courantLimit(
+            Vector3d<double>(ref.dx, ref.dy, ref.dz));
+    for (int c = 0; c < 6; ++c) {
+        ref.f[c].resize(NX*NY*NZ);
+        for (double& v : ref.f[c])
+            v = c < 3 ? value(rng) : value(rng) / Constants<double>::ETA_0();
+    }
+    ref.invEps.assign(NX*NY*NZ, 1.0);
+    ref.invMu.assign(NX*NY*NZ, 1.0);
+    if (!uniform) {
+        for (double& v : ref.invEps) v = material(rng);
+        for (double& v : ref.invMu)  v = material(rng);
+    }
+    return ref;
+}
+
+} // namespace
+
+TEST_CASE("Fused Yee step matches hand-written update", "rvlm::core::YeeUpdater") {
+    Reference ref = makeReference(true);
+    Vector3d<double> step(ref.dx, ref.dy, ref.dz);
+
+    Fields fused, split;
+    fused.load(ref);
+    split.load(ref);
+
+    YeeUpdater<double, int> a(fused.ex, fused.ey, fused.ez,
+                              fused.hx, fused.hy, fused.hz, step, ref.dt);
+    YeeUpdater<double, int> b(split.ex, split.ey, split.ez,
+                              split.hx, split.hy, split.hz, step, ref.dt);
+
+#ifdef _OPENMP
+    const int maxThreads = omp_get_max_threads();
+#endif
+    for (int threads = 1; threads <= 4; ++threads) {
+#ifdef _OPENMP
+        omp_set_num_threads(threads);
+#endif
+        ref.step();
+        a.step();
+        b.updateH();
+        b.updateE();
+        REQUIRE(fused.maxDifference(ref) < 1e-12);
+        REQUIRE(split.maxDifference(ref) < 1e-12);
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+}
+
+TEST_CASE("Yee update supports per-cell and per-material media", "rvlm::core::YeeUpdater") {
+    Vector3d<double> step(1e-3, 2e-3, 1.5e-3);
+
+    SECTION("Per-cell coefficients") {
+        Reference ref = makeReference(false);
+        Fields fields;
+        fields.load(ref);
+
+        Array invEps(HalfOpenRange<int>(BX, BX+NX), HalfOpenRange<int>(BY, BY+NY),
+                     HalfOpenRange<int>(BZ, BZ+NZ), 0.0);
+        Array invMu(HalfOpenRange<int>(BX, BX+NX), HalfOpenRange<int>(BY, BY+NY),
+                    HalfOpenRange<int>(BZ, BZ+NZ), 0.0);
+        for (int i = 0; i < NX; ++i)
+        for (int j = 0; j < NY; ++j)
+        for (int k = 0; k < NZ; ++k) {
+            invEps.at(BX+i, BY+j, BZ+k) = ref.invEps[Reference::idx(i, j, k)];
+            invMu .at(BX+i, BY+j, BZ+k) = ref.invMu [Reference::idx(i, j, k)];
+        }
+
+        typedef CellMedium<double, int> Medium;
+        YeeUpdater<double, int, Medium> updater(
+                fields.ex, fields.ey, fields.ez, fields.hx, fields.hy, fields.hz,
+                step, ref.dt, Medium(invEps, invMu));
+        for (int n = 0; n < 3; ++n) {
+            ref.step();
+            updater.step();
+        }
+        REQUIRE(fields.maxDifference(ref) < 1e-12);
+    }
+
+    SECTION("Per-material coefficients") {
+        Reference ref = makeReference(true);
+        typedef MaterialMedium<double, std::uint8_t, int> Medium;
+        const double table[3][2] = { { 1.0, 1.0 }, { 1/4.0, 1.0 }, { 1/2.0, 1/3.0 } };
+        Medium::Grid grid(HalfOpenRange<int>(BX, BX+NX), HalfOpenRange<int>(BY, BY+NY),
+                          HalfOpenRange<int>(BZ, BZ+NZ),
+                          std::vector<double>(table[0], table[0] + 2));
+        grid.addMaterial(std::vector<double>(table[1], table[1] + 2));
+        grid.addMaterial(std::vector<double>(table[2], table[2] + 2));
+
+        for (int i = 0; i < NX; ++i)
+        for (int j = 0; j < NY; ++j)
+        for (int k = 0; k < NZ; ++k) {
+            int id = (i + 2*j + k) % 3;
+            grid.setMaterial(BX+i, BY+j, BZ+k, id);
+            ref.invEps[Reference::idx(i, j, k)] = table[id][0];
+            ref.invMu [Reference::idx(i, j, k)] = table[id][1];
+        }
+
+        Fields fields;
+        fields.load(ref);
+        YeeUpdater<double, int, Medium> updater(
+                fields.ex, fields.ey, fields.ez, fields.hx, fields.hy, fields.hz,
+                step, ref.dt, Medium(grid));
+        for (int n = 0; n < 3; ++n) {
+            ref.step();
+            updater.step();
+        }
+        REQUIRE(fields.maxDifference(ref) < 1e-12);
+    }
+}
+
+TEST_CASE("Yee updater rejects mismatching arrays", "rvlm::core::YeeUpdater") {
+    SolidArray3d<double> a(4, 4, 4, 0.0), b(4, 4, 5, 0.0);
+    Vector3d<double> step(1, 1, 1);
+    REQUIRE_THROWS_AS(YeeUpdater<double>(a, a, a, a, a, b, step, 1e-9),
+                      std::invalid_argument);
+}
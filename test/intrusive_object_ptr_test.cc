@@ -0,0 +1,91 @@
+#include <catch.hpp>
+#include "rvlm/intrusive_object_ptr.hh"
+#include "rvlm/core/memory/OperatorNewAllocator.hh"
+using rvlm::intrusive_object_ptr;
+using rvlm::make_intrusive_object;
+using rvlm::allocate_intrusive_object;
+
+namespace {
+
+class CountingAllocator: public rvlm::core::memory::OperatorNewAllocator {
+public:
+    CountingAllocator(): allocations(0), deallocations(0) {}
+
+    virtual void* allocate(size_t size) throw (std::bad_alloc) override {
+        ++allocations;
+        return OperatorNewAllocator::allocate(size);
+    }
+
+    virtual void deallocate(void* ptr) throw (std::bad_alloc) override {
+        ++deallocations;
+        OperatorNewAllocator::deallocate(ptr);
+    }
+
+    int allocations;
+    int deallocations;
+};
+
+struct Base: public rvlm::ref_counted<rvlm::local_ref_count> {
+    explicit Base(int* destroyed): destroyed(destroyed) {}
+    ~Base() { ++*destroyed; }
+    int* destroyed;
+};
+
+struct Padding {
+    double padding[3];
+};
+
+struct Derived: public Padding, public Base {
+    Derived(int* destroyed, int value): Base(destroyed), value(value) {}
+    int value;
+};
+
+struct Shared: public rvlm::ref_counted<> {
+    int value = 42;
+};
+
+} // namespace
+
+TEST_CASE("Intrusive object pointers work", "rvlm::intrusive_object_ptr") {
+
+    SECTION("Copies share object and counter") {
+        auto p1 = make_intrusive_object<Shared>();
+        REQUIRE(p1.use_count() == 1);
+        {
+            auto p2 = p1;
+            REQUIRE(p1 == p2);
+            REQUIRE(p1.use_count() == 2);
+        }
+        REQUIRE(p1.use_count() == 1);
+        REQUIRE(p1->value == 42);
+    }
+
+    SECTION("Object is destroyed through base pointer and deallocated") {
+        CountingAllocator allocator;
+        int destroyed = 0;
+        {
+            auto derived = allocate_intrusive_object<Derived>(
+                                allocator, &destroyed, 7);
+            intrusive_object_ptr<Base> base = derived;
+            REQUIRE(base.use_count() == 2);
+            REQUIRE(allocator.allocations == 1);
+
+            intrusive_object_ptr<Base> moved = std::move(base);
+            REQUIRE(moved.use_count() == 2);
+            REQUIRE(destroyed == 0);
+        }
+        REQUIRE(destroyed == 1);
+        REQUIRE(allocator.deallocations == 1);
+    }
+
+    SECTION("Assignment releases previous object") {
+        int destroyed = 0;
+        auto p1 = make_intrusive_object<Base>(&destroyed);
+        auto p2 = make_intrusive_object<Base>(&destroyed);
+        p1 = p2;
+        REQUIRE(destroyed == 1);
+        REQUIRE(p2.use_count() == 2);
+        p1 = p1;
+        REQUIRE(p2.use_count() == 2);
+    }
+}
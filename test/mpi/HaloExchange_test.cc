@@ -0,0 +1,137 @@
+#include <catch.hpp>
+#include <mpi.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "rvlm/core/CartesianDecomposition.hh"
+#include "rvlm/core/mpi/HaloExchange.hh"
+using rvlm::core::CartesianDecomposition;
+using rvlm::core::Subdomain;
+using rvlm::core::mpi::HaloExchange;
+typedef CartesianDecomposition::Box Box;
+
+namespace {
+
+const Box GLOBAL(-2, 15, 0, 11, 3, 16);
+
+double valueAt(std::ptrdiff_t ix, std::ptrdiff_t iy, std::ptrdiff_t iz) {
+    if (!GLOBAL.contains(ix, iy, iz))
+        return 0;
+    return 1000.0*ix + 10.0*iy + 0.1*iz;
+}
+
+int worldRank() {
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    return rank;
+}
+
+int worldSize() {
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    return size;
+}
+
+void fillOwned(Subdomain<double>& sub) {
+    Box owned = sub.getOwnedBox();
+    for (std::ptrdiff_t ix = owned.start[0]; ix < owned.stop[0]; ++ix)
+    for (std::ptrdiff_t iy = owned.start[1]; iy < owned.stop[1]; ++iy)
+    for (std::ptrdiff_t iz = owned.start[2]; iz < owned.stop[2]; ++iz)
+        sub.getArray().at(ix, iy, iz) = valueAt(ix, iy, iz);
+}
+
+/**
+ * Sum of the cell and its neighbours up to 'reach' cells away along each
+ * axis, with zero outside of the global box.
+ */
+template <typename TGet>
+double stencil(TGet get, std::ptrdiff_t ix, std::ptrdiff_t iy,
+               std::ptrdiff_t iz, int reach) {
+    double sum = get(ix, iy, iz);
+    for (int d = 1; d <= reach; ++d) {
+        sum += get(ix-d, iy, iz) + get(ix+d, iy, iz)
+             + get(ix, iy-d, iz) + get(ix, iy+d, iz)
+             + get(ix, iy, iz-d) + get(ix, iy, iz+d);
+    }
+    return sum;
+}
+
+} // namespace
+
+TEST_CASE("Face halos receive owned cells of neighbours", "rvlm::core::mpi::HaloExchange") {
+    CartesianDecomposition dec(GLOBAL, worldSize());
+    for (int halo = 1; halo <= 2; ++halo) {
+        Subdomain<double> sub(dec, worldRank(), halo, -1.0);
+        fillOwned(sub);
+        HaloExchange<double> exchange(MPI_COMM_WORLD, sub);
+        exchange.exchange();
+        REQUIRE(!exchange.isActive());
+
+        Box owned = sub.getOwnedBox();
+        for (int axis = 0; axis < 3; ++axis)
+        for (int side = 0; side < 2; ++side) {
+            Box face = owned;
+            face.start[axis] = side ? owned.stop[axis] : owned.start[axis] - halo;
+            face.stop[axis]  = side ? owned.stop[axis] + halo : owned.start[axis];
+            const bool shared = dec.neighbor(worldRank(), axis, side ? 1 : -1) >= 0;
+            for (std::ptrdiff_t ix = face.start[0]; ix < face.stop[0]; ++ix)
+            for (std::ptrdiff_t iy = face.start[1]; iy < face.stop[1]; ++iy)
+            for (std::ptrdiff_t iz = face.start[2]; iz < face.stop[2]; ++iz) {
+                double expected = shared ? valueAt(ix, iy, iz) : -1.0;
+                REQUIRE(sub.getArray().at(ix, iy, iz) == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Stencil overlapped with halo exchange matches serial result", "rvlm::core::mpi::HaloExchange") {
+    CartesianDecomposition dec(GLOBAL, worldSize());
+    const int halo = 2;
+    Subdomain<double> sub(dec, worldRank(), halo, 0.0);
+    Subdomain<double> out(dec, worldRank(), halo, 0.0);
+    fillOwned(sub);
+
+    auto local = [&sub](std::ptrdiff_t ix, std::ptrdiff_t iy, std::ptrdiff_t iz) {
+        return sub.getArray().at(ix, iy, iz);
+    };
+    auto compute = [&](Box const& box) {
+        for (std::ptrdiff_t ix = box.start[0]; ix < box.stop[0]; ++ix)
+        for (std::ptrdiff_t iy = box.start[1]; iy < box.stop[1]; ++iy)
+        for (std::ptrdiff_t iz = box.start[2]; iz < box.stop[2]; ++iz)
+            out.getArray().at(ix, iy, iz) = stencil(local, ix, iy, iz, halo);
+    };
+
+    HaloExchange<double> exchange(MPI_COMM_WORLD, sub);
+    exchange.begin();
+    compute(sub.getInteriorBox());
+    exchange.finish();
+    for (Box const& box : sub.getBoundaryBoxes())
+        compute(box);
+
+    Box owned = sub.getOwnedBox();
+    double maxError = 0;
+    for (std::ptrdiff_t ix = owned.start[0]; ix < owned.stop[0]; ++ix)
+    for (std::ptrdiff_t iy = owned.start[1]; iy < owned.stop[1]; ++iy)
+    for (std::ptrdiff_t iz = owned.start[2]; iz < owned.stop[2]; ++iz) {
+        double expected = stencil(valueAt, ix, iy, iz, halo);
+        maxError = std::max(maxError,
+                            std::fabs(out.getArray().at(ix, iy, iz) - expected));
+    }
+    REQUIRE(maxError == 0);
+}
+
+TEST_CASE("All processes reject halo wider than the thinnest subdomain", "rvlm::core::mpi::HaloExchange") {
+    // Only the last process owns a single layer along X, yet every process
+    // must refuse, or its neighbours would wait for halos forever.
+    const int size = worldSize();
+    const int dims[3] = { size, 1, 1 };
+    CartesianDecomposition dec(Box(0, 2*size - 1, 0, 4, 0, 4), dims);
+    Subdomain<double> sub(dec, worldRank(), 2, 0.0);
+    if (size > 1) {
+        REQUIRE_THROWS_AS(HaloExchange<double>(MPI_COMM_WORLD, sub),
+                          std::invalid_argument);
+    } else {
+        HaloExchange<double> exchange(MPI_COMM_WORLD, sub);
+        exchange.exchange();
+    }
+}
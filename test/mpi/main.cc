@@ -0,0 +1,15 @@
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <mpi.h>
+
+int main(int argc, char* argv[]) {
+    MPI_Init(&argc, &argv);
+    int result = Catch::Session().run(argc, argv);
+
+    // Every process must agree on the exit status, otherwise failure on
+    // one rank may be masked by success of the launcher.
+    int worst = 0;
+    MPI_Allreduce(&result, &worst, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return worst;
+}